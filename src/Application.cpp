@@ -51,6 +51,7 @@
 #include "database/Database.h"
 #include "LatestReleaseFinder.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "MainWindow.h"
 #include "measurement/ColorMethods.h"
 #include "measurement/IbuMethods.h"
@@ -373,6 +374,7 @@ int Application::run() {
    qApp->processEvents();
    if (!Application::initialize()) {
       Application::cleanup();
+      Logging::terminateLogging();
       return 1;
    }
 
@@ -425,6 +427,13 @@ int Application::run() {
 
    qDebug() << Q_FUNC_INFO << "Cleaned up.  Returning " << ret;
 
+   //
+   // Stop the log writer thread, having written out everything logged so far, and close the log file.  (We don't want
+   // to leave this to static destructors at program exit, as the order they run in is not something we control.)  Any
+   // logging after this point goes straight to stderr.
+   //
+   Logging::terminateLogging();
+
    return ret;
 }
 
@@ -44,6 +44,31 @@ namespace {
    QString currentTwoLetterLanguageCode{""};
    QLocale currentLanguageLocale{};
 
+   //
+   // The locale we use for parsing numbers, and its separators.  See Localization::getNumberSeparators.  This is the
+   // default locale, which is the system one unless overridden in initSystemLocale().
+   //
+   struct NumberParsing {
+      QLocale locale;
+      Localization::NumberSeparators separators;
+   };
+
+   NumberParsing makeNumberParsing() {
+      QLocale const locale{};
+      return NumberParsing{locale, {locale.decimalPoint(), locale.groupSeparator()}};
+   }
+
+   /**
+    * \brief Use this rather than accessing the cache directly, so that it gets initialised on first use.
+    *
+    *        NB: The cache is only ever refreshed on the GUI thread (in initSystemLocale() and setLanguage()) at times
+    *            when we are not in the middle of parsing anything.
+    */
+   NumberParsing & numberParsing() {
+      static NumberParsing cachedNumberParsing = makeNumberParsing();
+      return cachedNumberParsing;
+   }
+
    //
    // It's not super-well explained in the Qt documentation (or the wiki article at
    // https://wiki.qt.io/How_to_create_a_multi_language_application), but there are, typically, two sets of translation
@@ -143,6 +168,8 @@ namespace {
          // instead of Localization::getLocale().  Note that QLocale::setDefault() is not reentrant, but that's OK as
          // we are guaranteed to be single-threaded here.
          QLocale::setDefault(forcedLocale);
+         numberParsing() = makeNumberParsing();
+         PersistentSettings::clearParsedValueCache();
          return forcedLocale;
       }
       return systemLocale;
@@ -213,6 +240,10 @@ QLocale const & Localization::getLocale() {
    return systemLocale;
 }
 
+Localization::NumberSeparators const & Localization::getNumberSeparators() {
+   return numberParsing().separators;
+}
+
 void Localization::setDateFormat(NumericDateFormat newDateFormat) {
    dateFormat = newDateFormat;
    return;
@@ -322,6 +353,13 @@ void Localization::setLanguage(QLocale const & newLanguageLocale) {
       currentTwoLetterLanguageCode.truncate(2);
    }
    qDebug() << Q_FUNC_INFO << "currentTwoLetterLanguageCode" << currentTwoLetterLanguageCode;
+
+   numberParsing() = makeNumberParsing();
+   qDebug() <<
+      Q_FUNC_INFO << "Parsing numbers with decimal point" << numberParsing().separators.decimalPoint <<
+      "and group separator" << numberParsing().separators.groupSeparator;
+   // Settings that were parsed as numbers under the old locale need parsing again
+   PersistentSettings::clearParsedValueCache();
    return;
 }
 
@@ -388,8 +426,7 @@ double Localization::toDouble(QString text, bool * ok) {
    double ret = 0.0;
 
    try {
-      QLocale sysDefault = QLocale();
-      ret = sysDefault.toDouble(text, &success);
+      ret = numberParsing().locale.toDouble(text, &success);
 
       // If we failed, try C locale (ie what QString now does by default)
       if (!success) {
@@ -50,6 +50,19 @@ namespace Localization {
     */
    QLocale const & getLocale();
 
+   /**
+    * \brief The decimal point and digit grouping separator to use when parsing numbers (eg in
+    *        \c Measurement::Unit::splitAmountString).
+    *
+    *        We parse a lot of numbers (eg when importing recipes), so these, along with the locale \c toDouble uses,
+    *        are worked out once and cached, rather than on every call.  The cache is refreshed by \c setLanguage.
+    */
+   struct NumberSeparators {
+      QString decimalPoint;
+      QString groupSeparator;
+   };
+   NumberSeparators const & getNumberSeparators();
+
    /**
     * \brief Coding for the three main numeric date formats
     *        See https://en.wikipedia.org/wiki/Date_format_by_country for which countries use which date formats
@@ -18,13 +18,19 @@
  =====================================================================================================================*/
 #include "Logging.h"
 
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
 #include <sstream>      // For std::ostringstream
+#include <thread>
 
 //#include <stacktrace>
 #include <boost/stacktrace.hpp>
 
 #include <QApplication>
 #include <QDebug>
+#include <QLoggingCategory>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QObject>
@@ -98,6 +104,399 @@ namespace {
       bool savedState;
    };
 
+   //
+   // This is what gets put on the queue for the log writer thread.  We format the message on the thread that logged it
+   // (so that the timestamp and thread ID are right) and the log writer thread just writes it out.
+   //
+   struct LogEntry {
+      QString text;
+      bool toStderr = false;
+   };
+
+   /**
+    * \brief Fixed-size lock-free queue of \c LogEntry objects.  Any number of threads can push, but only one thread
+    *        at a time may pop.
+    *
+    *        This is Dmitry Vyukov's bounded MPMC queue
+    *        (https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue), simplified for a single
+    *        consumer.  Each cell has a sequence number that tells producers whether it is free to write to and the
+    *        consumer whether it is ready to read, so, in the normal case, a push is a single compare-and-swap and a pop
+    *        does not need one at all.
+    */
+   class LogRingBuffer {
+   public:
+      LogRingBuffer() : m_cells{std::make_unique<Cell[]>(capacity)} {
+         for (std::size_t ii = 0; ii < capacity; ++ii) {
+            this->m_cells[ii].sequence.store(ii, std::memory_order_relaxed);
+         }
+         return;
+      }
+
+      /**
+       * \brief If there is space in the buffer, moves \c entry into it
+       *
+       * \return \c false if the buffer is full (in which case \c entry is untouched)
+       */
+      bool tryPush(LogEntry & entry) {
+         std::size_t position = this->m_pushPosition.load(std::memory_order_relaxed);
+         Cell * cell;
+         for (;;) {
+            cell = &this->m_cells[position & mask];
+            std::size_t const sequence = cell->sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (diff == 0) {
+               // Cell is free.  Try to claim it.  (If another producer beats us to it, position gets updated and we
+               // go round again.)
+               if (this->m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                  break;
+               }
+            } else if (diff < 0) {
+               // Cell still holds an entry from last time round the buffer, so the buffer is full
+               return false;
+            } else {
+               // Another producer has claimed this cell since we read m_pushPosition
+               position = this->m_pushPosition.load(std::memory_order_relaxed);
+            }
+         }
+         cell->entry = std::move(entry);
+         cell->sequence.store(position + 1, std::memory_order_release);
+         return true;
+      }
+
+      /**
+       * \return \c false if there is nothing (yet) to pop.  NB: This can be the case even if other entries have been
+       *         pushed, if the producer of the entry at the front of the queue has not quite finished writing it.
+       */
+      bool tryPop(LogEntry & entry) {
+         Cell & cell = this->m_cells[this->m_popPosition & mask];
+         if (cell.sequence.load(std::memory_order_acquire) != this->m_popPosition + 1) {
+            return false;
+         }
+         entry = std::move(cell.entry);
+         // Mark the cell as free for the producer that will come to it on the next time round the buffer
+         cell.sequence.store(this->m_popPosition + capacity, std::memory_order_release);
+         ++this->m_popPosition;
+         return true;
+      }
+
+   private:
+      // Needs to be a power of 2.  Each log message is typically 100-200 characters, so this is a few MB at most.
+      static constexpr std::size_t capacity = 8192;
+      static constexpr std::size_t mask = capacity - 1;
+
+      struct Cell {
+         std::atomic<std::size_t> sequence;
+         LogEntry entry;
+      };
+      std::unique_ptr<Cell[]> m_cells;
+
+      // Keep the producers' and consumer's positions on separate cache lines
+      alignas(64) std::atomic<std::size_t> m_pushPosition{0};
+      alignas(64) std::size_t m_popPosition{0};
+   };
+
+   //
+   // Approximate size of the current log file, so we don't have to ask the file system after every message.  (It's
+   // approximate because we count characters rather than bytes, but, since most log output is ASCII, it's close
+   // enough.)
+   //
+   std::atomic<qint64> logFileBytes{0};
+
+   /**
+    * \brief Writes one entry to stderr and/or the log file.  Caller is responsible for holding the mutex.
+    */
+   void writeEntry(LogEntry const & entry) {
+      if (entry.toStderr) {
+         errStream << entry.text << '\n';
+      }
+      if (stream) {
+         *stream << entry.text << '\n';
+         logFileBytes += entry.text.size() + 1;
+      }
+      return;
+   }
+
+   /**
+    * \brief Caller is responsible for holding the mutex
+    */
+   void flushStreams() {
+      errStream.flush();
+      if (stream) {
+         stream->flush();
+      }
+      return;
+   }
+
+   void pruneLogFiles();
+   bool openLogFile();
+
+   //
+   // Set on the log writer thread, so we can spot when a message is logged from that thread (eg by openLogFile()) and
+   // write it out directly rather than queue it for ourselves.
+   //
+   thread_local bool isLogWriterThread{false};
+
+   /**
+    * \brief Writes log messages to stderr and the log file on a background thread, so that logging does not have to
+    *        wait for file I/O, and takes care of rotating and pruning log files.
+    *
+    *        Threads logging messages do not take any locks: they push onto a \c LogRingBuffer and only wake the writer
+    *        thread if it is waiting for something to do.  If the buffer is full, they wait for the writer to catch up.
+    *        (We'd rather slow the program down than lose log messages.)
+    */
+   class AsyncLogWriter {
+   public:
+      AsyncLogWriter() = default;
+      ~AsyncLogWriter() {
+         this->stop();
+         return;
+      }
+
+      void start() {
+         if (this->m_thread.joinable()) {
+            return;
+         }
+         this->m_stopRequested = false;
+         this->m_thread = std::thread{[this]() { this->run(); }};
+         this->m_isRunning = true;
+         return;
+      }
+
+      /**
+       * \brief Stops the writer thread after it has written out everything queued
+       */
+      void stop() {
+         if (!this->m_thread.joinable()) {
+            return;
+         }
+         // Anything logged from now on will be written directly by the thread that logs it
+         this->m_isRunning = false;
+         this->m_stopRequested = true;
+         this->wakeWriter();
+         this->m_thread.join();
+
+         //
+         // There is a small window where another thread can have seen m_isRunning as true just before we set it to
+         // false, and then pushed an entry after the writer thread exited.  So we write out any such stragglers here.
+         //
+         QMutexLocker locker(&mutex);
+         LogEntry entry;
+         quint64 numWritten = 0;
+         while (this->m_ringBuffer.tryPop(entry)) {
+            writeEntry(entry);
+            ++numWritten;
+         }
+         flushStreams();
+         this->m_numWritten += numWritten;
+         this->m_numWritten.notify_all();
+         return;
+      }
+
+      /**
+       * \brief Queue an entry to be written by the writer thread.
+       *
+       * \return \c true if the entry was queued (in which case it has been moved from), \c false if the caller needs to
+       *         write it out directly because the writer thread is not running or the caller is the writer thread.
+       */
+      bool enqueue(LogEntry & entry) {
+         if (!this->m_isRunning || isLogWriterThread) {
+            return false;
+         }
+         while (!this->m_ringBuffer.tryPush(entry)) {
+            if (!this->m_isRunning) {
+               return false;
+            }
+            std::this_thread::yield();
+         }
+         ++this->m_numPushed;
+         if (this->m_writerIsWaiting) {
+            this->wakeWriter();
+         }
+         return true;
+      }
+
+      /**
+       * \brief See \c Logging::flush
+       */
+      void flush() {
+         if (!this->m_isRunning || isLogWriterThread) {
+            return;
+         }
+         quint64 const target = this->m_numPushed;
+         for (quint64 numWritten = this->m_numWritten; numWritten < target; numWritten = this->m_numWritten) {
+            this->m_numWritten.wait(numWritten);
+         }
+         return;
+      }
+
+      /**
+       * \brief For when the program is about to die.  Like \c flush, except that we give up after \c timeout rather
+       *        than risk hanging (eg if the writer thread is what has gone wrong), and, if we are on the writer thread,
+       *        we write out what's left in the buffer ourselves.
+       */
+      void drain(std::chrono::milliseconds const timeout) {
+         if (!this->m_isRunning) {
+            return;
+         }
+         if (isLogWriterThread) {
+            // We are the only consumer, so it's safe to pop here.  But we might have died part-way through writing an
+            // entry, in which case we would already be holding the mutex.
+            if (mutex.tryLock()) {
+               LogEntry entry;
+               while (this->m_ringBuffer.tryPop(entry)) {
+                  writeEntry(entry);
+               }
+               flushStreams();
+               mutex.unlock();
+            }
+            return;
+         }
+         auto const deadline = std::chrono::steady_clock::now() + timeout;
+         quint64 const target = this->m_numPushed;
+         while (this->m_numWritten < target && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+         }
+         return;
+      }
+
+   private:
+      void wakeWriter() {
+         ++this->m_wakeUps;
+         this->m_wakeUps.notify_one();
+         return;
+      }
+
+      void run() {
+         isLogWriterThread = true;
+         LogEntry entry;
+         for (;;) {
+            quint64 numWritten = 0;
+            while (this->m_ringBuffer.tryPop(entry)) {
+               bool needsRotation = false;
+               {
+                  QMutexLocker locker(&mutex);
+                  writeEntry(entry);
+                  // Same test as in openLogFile() for whether the log file needs to be renamed
+                  needsRotation = stream && logFileBytes > Logging::logFileSize;
+               }
+               ++numWritten;
+               if (needsRotation) {
+                  // Both these functions take the mutex themselves
+                  pruneLogFiles();
+                  openLogFile();
+               }
+            }
+
+            if (numWritten > 0) {
+               {
+                  QMutexLocker locker(&mutex);
+                  flushStreams();
+               }
+               this->m_numWritten += numWritten;
+               this->m_numWritten.notify_all();
+               // More entries may have arrived while we were writing, so go round again before thinking about waiting
+               continue;
+            }
+
+            if (this->m_numPushed != this->m_numWritten) {
+               // Something has been pushed but we couldn't pop it, because another producer has claimed an earlier cell
+               // and not quite finished writing it.
+               std::this_thread::yield();
+               continue;
+            }
+
+            if (this->m_stopRequested) {
+               break;
+            }
+
+            //
+            // Nothing to do, so wait to be woken.  Producers only bother to wake us if m_writerIsWaiting is set, so,
+            // having set it, we need to check again that nothing was pushed in the meantime.  Conversely, if a
+            // producer wakes us between our reading m_wakeUps and calling wait(), the value will have changed, so
+            // wait() returns immediately.
+            //
+            quint32 const wakeUps = this->m_wakeUps;
+            this->m_writerIsWaiting = true;
+            if (this->m_numPushed == this->m_numWritten && !this->m_stopRequested) {
+               this->m_wakeUps.wait(wakeUps);
+            }
+            this->m_writerIsWaiting = false;
+         }
+         return;
+      }
+
+      LogRingBuffer m_ringBuffer;
+      std::thread m_thread;
+      std::atomic<bool> m_isRunning{false};
+      std::atomic<bool> m_stopRequested{false};
+      std::atomic<bool> m_writerIsWaiting{false};
+      std::atomic<quint32> m_wakeUps{0};
+      std::atomic<quint64> m_numPushed{0};
+      std::atomic<quint64> m_numWritten{0};
+   };
+
+   //
+   // NB: This needs to be declared after logFile, stream, etc, so that it gets destroyed (and its thread stopped)
+   //     before they do when the program exits.
+   //
+   AsyncLogWriter asyncLogWriter;
+
+   //
+   // If the program dies via std::terminate (eg an uncaught exception, including one thrown from a noexcept function),
+   // make sure that whatever has been logged so far actually gets written out, as it's likely to be what explains the
+   // problem.  (Messages logged via qFatal() are handled in doLog().)
+   //
+   std::terminate_handler previousTerminateHandler = nullptr;
+   [[noreturn]] void terminateHandler() {
+      asyncLogWriter.drain(std::chrono::seconds{2});
+      if (mutex.tryLock()) {
+         writeEntry(LogEntry{
+            QString{"[%1] std::terminate called\n%2"}.arg(QTime::currentTime().toString(timeFormat))
+                                                     .arg(Logging::getStackTrace()),
+            true
+         });
+         flushStreams();
+         mutex.unlock();
+      }
+      if (previousTerminateHandler) {
+         previousTerminateHandler();
+      }
+      std::abort();
+   }
+
+   //
+   // Set the enabled levels of our own logging category (see Logging::category) and of Qt's "default" category
+   // according to currentLoggingLevel.  Other categories (eg Qt's own "qt.*" ones) are left to whatever filter was
+   // installed before ours.
+   //
+   QLoggingCategory::CategoryFilter previousCategoryFilter = nullptr;
+   void categoryFilter(QLoggingCategory * category) {
+      if (qstrcmp(category->categoryName(), DEF_CONFIG_APPLICATION_NAME_LC) == 0 ||
+          qstrcmp(category->categoryName(), "default") == 0) {
+         category->setEnabled(QtDebugMsg  , currentLoggingLevel <= Logging::LogLevel_DEBUG  );
+         category->setEnabled(QtInfoMsg   , currentLoggingLevel <= Logging::LogLevel_INFO   );
+         category->setEnabled(QtWarningMsg, currentLoggingLevel <= Logging::LogLevel_WARNING);
+         category->setEnabled(QtCriticalMsg, true);
+      } else if (previousCategoryFilter) {
+         previousCategoryFilter(category);
+      }
+      return;
+   }
+
+   /**
+    * \brief (Re)install our category filter, which makes Qt re-run it for all existing categories
+    */
+   void applyLogLevelToCategories() {
+      if (!previousCategoryFilter) {
+         // Installing nullptr puts back Qt's default filter and returns the one that was there before, which, since we
+         // have not yet installed ours, is the one we want to chain to.  We need to get it before installing our own
+         // because Qt calls the new filter for all existing categories as part of installing it.
+         previousCategoryFilter = QLoggingCategory::installFilter(nullptr);
+      }
+      QLoggingCategory::installFilter(categoryFilter);
+      return;
+   }
+
    //
    // We use the Qt functions (qDebug(), qInfo(), etc) do our logging but we need to convert from QtMsgType to our own
    // logging level for two reasons:
@@ -116,17 +515,32 @@ namespace {
    }
 
    //
-   // This is what actually outputs a message to the log file and/or std::cerr
+   // This is what actually outputs a message to the log file and/or std::cerr -- usually by handing it to the log
+   // writer thread.
+   //
+   // Errors (ie QtCriticalMsg and QtFatalMsg) are written before we return, as the program may be about to crash (and,
+   // for QtFatalMsg, Qt is going to abort it as soon as the message handler returns).  So as to keep messages in
+   // order, we first wait for everything already queued to be written.
    //
    void doLog(const Logging::Level level, const QString message) {
-      QString logEntry = QString{"[%1] (%2) %3 : %4"}.arg(QTime::currentTime().toString(timeFormat))
-                                                     .arg(threadId)
-                                                     .arg(Logging::getStringFromLogLevel(level))
-                                                     .arg(message);
+      LogEntry logEntry{
+         QString{"[%1] (%2) %3 : %4"}.arg(QTime::currentTime().toString(timeFormat))
+                                     .arg(threadId)
+                                     .arg(Logging::getStringFromLogLevel(level))
+                                     .arg(message),
+         isLoggingToStderr || forceStderrLogging
+      };
+      if (level < Logging::LogLevel_ERROR) {
+         if (asyncLogWriter.enqueue(logEntry)) {
+            return;
+         }
+      } else {
+         asyncLogWriter.flush();
+      }
+
       QMutexLocker locker(&mutex);
-      if (isLoggingToStderr ||
-          forceStderrLogging) { errStream << logEntry << Qt::endl; }
-      if (stream)             {   *stream << logEntry << Qt::endl; }
+      writeEntry(logEntry);
+      flushStreams();
       return;
    }
 
@@ -204,6 +618,7 @@ namespace {
       logFile.setFileName(logDirectory.filePath(logFileFullName()));
       if (logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
          stream = new QTextStream(&logFile);
+         logFileBytes = logFile.size();
          qInfo() << Q_FUNC_INFO << "Logging to file" << QFileInfo(logFile).canonicalFilePath();
          return true;
       }
@@ -217,6 +632,7 @@ namespace {
       if (logFile.open(QFile::WriteOnly | QFile::Truncate)) {
          logFile.setPermissions(QFileDevice::WriteUser | QFileDevice::ReadUser | QFileDevice::ExeUser);
          stream = new QTextStream(&logFile);
+         logFileBytes = 0;
          qWarning() <<
             Q_FUNC_INFO << "Log file is in a temporary directory: " << QFileInfo(logFile).canonicalFilePath();
          return true;
@@ -266,20 +682,14 @@ namespace {
       // after that we're all set, Log away!
       //
 
-      // Check that we're set to log this level, this is set by the user options.
+      // Check that we're set to log this level, this is set by the user options.  (For messages in our own category
+      // and Qt's default one, this will usually already have been done by categoryFilter(), but messages in other
+      // categories still need to be checked here.)
       if (logLevelOfMessage < currentLoggingLevel) {
          return;
       }
 
-      // Check if there is a file actually set yet.  In a rare case if the logfile was not created at initialization,
-      // then we won't be logging to a file, the location may not yet have been loaded from the settings, thus only logging to the stderr.
-      // In this case we cannot do any of the pruning or filename generation.
-      if (stream) {
-         if (logFile.size() >= Logging::logFileSize) {
-            pruneLogFiles();
-            openLogFile();
-         }
-      }
+      // NB: Rotating and pruning log files is done by the log writer thread -- see AsyncLogWriter::run().
 
       // Writing the actual log
       //
@@ -304,6 +714,10 @@ namespace {
 }
 
 
+namespace Logging {
+   Q_LOGGING_CATEGORY(category, DEF_CONFIG_APPLICATION_NAME_LC)
+}
+
 QVector<Logging::LevelDetail> const Logging::levelDetails{
    { Logging::LogLevel_DEBUG,   "DEBUG",   QObject::tr("Detailed (for debugging)")},
    { Logging::LogLevel_INFO,    "INFO",    QObject::tr("Normal")},
@@ -337,6 +751,7 @@ Logging::Level Logging::getLogLevel() {
 
 void Logging::setLogLevel(Level newLevel) {
    currentLoggingLevel = newLevel;
+   applyLogLevelToCategories();
    PersistentSettings::insert_ck(PersistentSettings::Names::LoggingLevel, Logging::getStringFromLogLevel(currentLoggingLevel));
    return;
 }
@@ -365,7 +780,12 @@ bool Logging::initializeLogging() {
          std::optional<QDir>(PersistentSettings::value_ck(PersistentSettings::Names::LogDirectory).toString()) : std::optional<QDir>(std::nullopt)
    );
 
+   applyLogLevelToCategories();
    qInstallMessageHandler(logMessageHandler);
+   asyncLogWriter.start();
+   if (std::get_terminate() != terminateHandler) {
+      previousTerminateHandler = std::set_terminate(terminateHandler);
+   }
    qDebug() << Q_FUNC_INFO << "Logging initialized.  Logs will be written to" << logDirectory.absolutePath();
 
    // It's quite useful on debug builds to check that stack trace logging is working, rather than to find out it's not
@@ -511,7 +931,13 @@ QFileInfoList Logging::getLogFileList() {
 }
 
 
+void Logging::flush() {
+   asyncLogWriter.flush();
+   return;
+}
+
 void Logging::terminateLogging() {
+   asyncLogWriter.stop();
    QMutexLocker locker(&mutex);
    closeLogFile();
    return;
@@ -1,5 +1,5 @@
 /*======================================================================================================================
- * Logging.h is part of Brewken, and is copyright the following authors 2009-2021:
+ * Logging.h is part of Brewken, and is copyright the following authors 2009-2025:
  *   • Mattias Måhl <mattias@kejsarsten.com>
  *   • Matt Young <mfsy@yahoo.com>
  *   • Maxime Lavigne <duguigne@gmail.com>
@@ -23,6 +23,7 @@
 
 #include <QDir>
 #include <QFileInfoList>
+#include <QLoggingCategory>
 #include <QString>
 #include <QVector>
 
@@ -76,6 +77,19 @@ namespace Logging {
     */
    extern Level getLogLevelFromString(QString const level = QString("INFO"));
 
+   /**
+    * \brief Our own logging category, whose enabled levels track \c getLogLevel().  (The same is true of Qt's "default"
+    *        category, used by qDebug(), qInfo(), etc.)
+    *
+    *        The difference from qDebug() etc is that, with qCDebug(Logging::category) etc, the arguments are not even
+    *        evaluated if the level is disabled.  (With qDebug(), they are evaluated and formatted, and the message only
+    *        discarded afterwards.)  So this is what to use for debug logging on hot paths, or where the arguments are
+    *        expensive to produce, eg:
+    *
+    *           qCDebug(Logging::category).noquote() << Q_FUNC_INFO << "Tree:\n" << this->m_rootNode->subTreeToString();
+    */
+   Q_DECLARE_LOGGING_CATEGORY(category)
+
    /**
     * \brief Get current logging level
     */
@@ -157,6 +171,12 @@ namespace Logging {
     */
    extern QFileInfoList getLogFileList();
 
+   /**
+    * \brief Log messages are written to the log file (and stderr) on a background thread.  This blocks until all
+    *        messages logged (by any thread) before the call have been written.
+    */
+   extern void flush();
+
    /**
     * \brief Terminate logging
     */
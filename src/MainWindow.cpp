@@ -113,6 +113,7 @@
 #include "config.h"
 #include "database/Database.h"
 #include "database/ObjectStoreWrapper.h"
+#include "database/SqliteBackupJob.h"
 #include "editors/BoilEditor.h"
 #include "editors/BoilStepEditor.h"
 #include "editors/EquipmentEditor.h"
@@ -938,6 +939,12 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), pimpl{std::make_u
       }
    }
 
+   //
+   // Now everything is loaded, we can batch up DB writes for property changes rather than writing each one in its own
+   // transaction.  See ObjectStore::setWriteBehindEnabled for more details.
+   //
+   ObjectStore::setWriteBehindEnabled(true);
+
    // Set the window title and a couple of other strings.  (This replaces the corresponding texts in the mainWindow.ui
    // file.)
    this->setWindowTitle(QString{"%1 - %2"}.arg(CONFIG_APPLICATION_NAME_UC, CONFIG_VERSION_STRING) );
@@ -2298,13 +2305,37 @@ void MainWindow::backup() {
    qDebug() << QString("Database backup filename \"%1\"").arg(backupFileName);
 
    // If the filename returned from the dialog is empty, it means the user clicked cancel, so we should stop trying to do the backup
-   if (!backupFileName.isEmpty())
-   {
-      bool success = Database::instance().backupToFile(backupFileName);
+   if (backupFileName.isEmpty()) {
+      return;
+   }
 
-      if( ! success )
-         QMessageBox::warning( this, tr("Oops!"), tr("Could not copy the files for some reason."));
+   //
+   // The backup runs on a worker thread, so the UI stays responsive.  We show progress in the status bar and tell the
+   // user if it didn't work.
+   //
+   SqliteBackupJob * backupJob = Database::instance().startBackupToFile(backupFileName, this);
+   if (!backupJob) {
+      QMessageBox::warning(this, tr("Oops!"), tr("Could not copy the files for some reason."));
+      return;
    }
+
+   connect(backupJob, &SqliteBackupJob::progress, this, [this](qint64 const bytesCopied, qint64 const bytesTotal) {
+      if (bytesTotal > 0) {
+         this->updateStatus(tr("Backing up database: %1%").arg(100 * bytesCopied / bytesTotal));
+      }
+      return;
+   });
+   connect(backupJob, &SqliteBackupJob::finished, this, [this, backupJob](bool const succeeded) {
+      if (succeeded) {
+         this->updateStatus(tr("Database backed up"));
+      } else {
+         this->updateStatus(tr("Database backup failed"));
+         QMessageBox::warning(this, tr("Oops!"), tr("Could not copy the files for some reason."));
+      }
+      backupJob->deleteLater();
+      return;
+   });
+   return;
 }
 
 void MainWindow::restoreFromBackup() {
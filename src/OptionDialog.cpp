@@ -35,6 +35,7 @@
 #include <QIcon>
 #include <QMap>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSizePolicy>
 #include <QString>
 #include <QVector>
@@ -42,6 +43,7 @@
 
 #include "config.h"
 #include "database/Database.h"
+#include "database/NewDbWriteProgress.h"
 #include "Localization.h"
 #include "Logging.h"
 #include "MainWindow.h"
@@ -987,12 +989,42 @@ bool OptionDialog::transferDatabase() {
          tr("Would you like %1 to transfer your data to the new database? "
             "NOTE: If you've already loaded the data, say No").arg(CONFIG_APPLICATION_NAME_UC);
       if (QMessageBox::Yes == QMessageBox::question(this, tr("Transfer database"), theQuestion)) {
+         //
+         // The copy can take a while for a big database, so we show how it's going.  There is no cancel button, as
+         // stopping part way through would leave the new database in an indeterminate state.
+         //
+         QProgressDialog progressDialog{tr("Copying data to the new database..."), QString{}, 0, 100, this};
+         progressDialog.setWindowTitle(tr("Transfer database"));
+         progressDialog.setWindowModality(Qt::WindowModal);
+         progressDialog.setMinimumDuration(0);
+         progressDialog.setAutoClose(false);
+         NewDbWriteProgress progress;
+         connect(&progress,
+                 &NewDbWriteProgress::rowsWritten,
+                 &progressDialog,
+                 [&progressDialog](qint64 const rowsWrittenSoFar, qint64 const totalRows) {
+                    if (totalRows > 0) {
+                       progressDialog.setValue(static_cast<int>(100 * rowsWrittenSoFar / totalRows));
+                    }
+                    return;
+                 });
+         connect(&progress,
+                 &NewDbWriteProgress::storeWritten,
+                 &progressDialog,
+                 [&progressDialog](QString const storeName, qint64 const storesWrittenSoFar, qint64 const totalStores) {
+                    progressDialog.setLabelText(
+                       tr("Copied %1 (%2 of %3 tables)").arg(storeName).arg(storesWrittenSoFar).arg(totalStores)
+                    );
+                    return;
+                 });
          Database::instance().convertDatabase(this->pimpl->input_pgHostname.text(),
                                               this->pimpl->input_pgDbName.text(),
                                               this->pimpl->input_pgUsername.text(),
                                               this->pimpl->input_pgPassword.text(),
                                               this->pimpl->input_pgPortNum.text().toInt(),
-                                              static_cast<Database::DbType>(this->comboBox_engine->currentData().toInt()));
+                                              static_cast<Database::DbType>(this->comboBox_engine->currentData().toInt()),
+                                              &progress);
+         progressDialog.setValue(100);
       }
       // Database engine stuff
       int engine = comboBox_engine->currentData().toInt();
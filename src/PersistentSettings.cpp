@@ -34,12 +34,17 @@
 #include "PersistentSettings.h"
 
 #include <memory>
+#include <optional>
 
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSettings>
 #include <QStandardPaths>
 
 #include "config.h"
+#include "Localization.h"
 
 //
 // Anonymous namespace for constants, global variables and functions used only in this file
@@ -97,6 +102,54 @@ namespace {
    QDir configDir{""};
    QDir userDataDir{""};
 
+   //
+   // Going to QSettings for every read is relatively slow, which matters for settings that are read during
+   // calculations (eg every time we recalculate IBUs).  So we cache what we read, keyed by fully-qualified key.
+   //
+   // In valueCache, std::nullopt means we know there is no stored value for the key.  We don't cache the value written
+   // by insert(), because QSettings does not necessarily give back the same QVariant type as was stored (eg with
+   // IniFormat, most things come back as QString), so we just invalidate the cache entry and let the next read get the
+   // value the same way as if it had been read from the file.
+   //
+   // doubleCache holds the result of parsing the stored value as a double, for valueAsDouble_ck().  Parsing depends on
+   // the locale, so this cache also needs clearing when the language changes (see clearParsedValueCache()).
+   //
+   // Both caches are guarded by cacheMutex as, in principle, settings can be read from more than one thread.
+   // doubleCacheGeneration, also guarded by cacheMutex, is incremented whenever anything is removed from doubleCache, so
+   // that valueAsDouble_ck(), which parses without holding the mutex, can tell whether its result is still valid.
+   //
+   QMutex cacheMutex;
+   QHash<QString, std::optional<QVariant>> valueCache;
+   QHash<QString, double> doubleCache;
+   quint64 doubleCacheGeneration = 0;
+
+   /**
+    * \brief Returns the stored value (if any) for the supplied fully-qualified key, reading it from QSettings only if
+    *        we don't already have it in the cache.  Caller is responsible for holding \c cacheMutex.
+    */
+   std::optional<QVariant> const & cachedValue(QString const & fqKey) {
+      auto entry = valueCache.find(fqKey);
+      if (entry == valueCache.end()) {
+         entry = valueCache.insert(
+            fqKey,
+            qSettings->contains(fqKey) ? std::optional<QVariant>{qSettings->value(fqKey)} : std::nullopt
+         );
+      }
+      return *entry;
+   }
+
+   /**
+    * \brief Drop everything we know about the supplied fully-qualified key, including any subkeys (in case it is the
+    *        name of a section).  Caller is responsible for holding \c cacheMutex.
+    */
+   void invalidateCache(QString const & fqKey) {
+      QString const subKeyPrefix{fqKey + '/'};
+      valueCache .removeIf([&](auto const & entry) { return entry.key() == fqKey || entry.key().startsWith(subKeyPrefix); });
+      doubleCache.removeIf([&](auto const & entry) { return entry.key() == fqKey || entry.key().startsWith(subKeyPrefix); });
+      ++doubleCacheGeneration;
+      return;
+   }
+
 }
 
 void PersistentSettings::initialise(QString customUserDataDir) {
@@ -213,7 +266,8 @@ bool PersistentSettings::contains  (QString const & key,
                                     QString const section,
                                     PersistentSettings::Extension extension) {
    Q_ASSERT(initialised);
-   return qSettings->contains(generateFqKey(key, section, extension));
+   QMutexLocker locker(&cacheMutex);
+   return cachedValue(generateFqKey(key, section, extension)).has_value();
 }
 
 bool PersistentSettings::contains_ck(BtStringConst const & constKey,
@@ -237,9 +291,12 @@ void PersistentSettings::insert   (QString const & key,
                                    QString const section,
                                    PersistentSettings::Extension extension) {
    Q_ASSERT(initialised);
+   QString const fqKey{generateFqKey(key, section, extension)};
+   QMutexLocker locker(&cacheMutex);
    // QSettings is a bit inconsistent here in using setValue() when QMap, QHash etc use insert() for the equivalent
    // functionality
-   qSettings->setValue(generateFqKey(key, section, extension), value);
+   qSettings->setValue(fqKey, value);
+   invalidateCache(fqKey);
    return;
 }
 
@@ -268,7 +325,8 @@ QVariant PersistentSettings::value   (QString const & key,
                                       QString const section,
                                       PersistentSettings::Extension extension) {
    Q_ASSERT(initialised);
-   return qSettings->value(generateFqKey(key, section, extension), defaultValue);
+   QMutexLocker locker(&cacheMutex);
+   return cachedValue(generateFqKey(key, section, extension)).value_or(defaultValue);
 }
 
 QVariant PersistentSettings::value_ck(BtStringConst const & constKey,
@@ -289,6 +347,47 @@ QVariant PersistentSettings::value_ck(BtStringConst const & constKey,
    return PersistentSettings::value_ck(constKey, defaultValue, section, extension);
 }
 
+double PersistentSettings::valueAsDouble_ck(BtStringConst const & constKey,
+                                            double const defaultValue,
+                                            QString const section,
+                                            PersistentSettings::Extension extension) {
+   Q_ASSERT(initialised);
+   Q_ASSERT(!constKey.isNull());
+   QString const fqKey{generateFqKey(*constKey, section, extension)};
+   QMutexLocker locker(&cacheMutex);
+   auto parsed = doubleCache.constFind(fqKey);
+   if (parsed != doubleCache.constEnd()) {
+      return *parsed;
+   }
+
+   std::optional<QVariant> const & storedValue = cachedValue(fqKey);
+   if (!storedValue) {
+      // Note that we don't cache the default, as it's up to the caller and could, in principle, differ between calls
+      return defaultValue;
+   }
+
+   //
+   // Parsing can log, and takes locks of its own, so we don't want to hold cacheMutex while we do it.  If the cache was
+   // invalidated in the meantime, our result may be out of date, so we return it but don't cache it.
+   //
+   QString const storedText = storedValue->toString();
+   quint64 const generation = doubleCacheGeneration;
+   locker.unlock();
+   double const result = Localization::toDouble(storedText, Q_FUNC_INFO);
+   locker.relock();
+   if (generation == doubleCacheGeneration) {
+      doubleCache.insert(fqKey, result);
+   }
+   return result;
+}
+
+void PersistentSettings::clearParsedValueCache() {
+   QMutexLocker locker(&cacheMutex);
+   doubleCache.clear();
+   ++doubleCacheGeneration;
+   return;
+}
+
 void PersistentSettings::remove   (QString const & key,
                                    QString const section,
                                    PersistentSettings::Extension extension) {
@@ -298,7 +397,9 @@ void PersistentSettings::remove   (QString const & key,
    // Not entirely clear from Qt docs whether we need to bother checking contains() before calling remove(), but it
    // doesn't hurt any.
    if (PersistentSettings::contains(fqKey)) {
+      QMutexLocker locker(&cacheMutex);
       qSettings->remove(fqKey);
+      invalidateCache(fqKey);
    }
    return;
 }
@@ -82,6 +82,7 @@ AddSettingName(geometry_yeastCatalog       )  // MainWindow section
 AddSettingName(geometry_stockWindow) // MainWindow section
 AddSettingName(ibu_formula)
 AddSettingName(language)
+AddSettingName(lastChangeCounter)                // backups section
 AddSettingName(last_db_merge_req)
 AddSettingName(LogDirectory)
 AddSettingName(LoggingLevel)
@@ -239,6 +240,21 @@ namespace PersistentSettings {
    QVariant value_ck(BtStringConst const & constKey, QVariant const defaultValue = QVariant(), QString const section = QString(),  Extension = PersistentSettings::Extension::NONE);
    QVariant value_ck(BtStringConst const & constKey, QVariant const defaultValue,              BtStringConst const & constSection, Extension = PersistentSettings::Extension::NONE);
 
+   /**
+    * \brief Typed version of \c value_ck for numeric settings that are read in calculation hot paths (eg
+    *        \c Recipe::ibuFromHopAddition).  The stored value is parsed (via \c Localization::toDouble) the first time
+    *        it is read and then cached until the setting is next changed via \c insert or \c remove.
+    *
+    *        Returns \c defaultValue if there is no stored value.
+    */
+   double valueAsDouble_ck(BtStringConst const & constKey, double const defaultValue, QString const section = QString(), Extension = PersistentSettings::Extension::NONE);
+
+   /**
+    * \brief Forget the cached results of parsing settings as numbers (see \c valueAsDouble_ck).  Needs to be called
+    *        when the locale used for parsing numbers changes.
+    */
+   void clearParsedValueCache();
+
    /**
     * \brief Removes the item matching key (unless key is the name of a section, in which case it removes all keys in
     *        that section -- hence one reason you don't want keys and sections to share names).
@@ -89,6 +89,12 @@ void ScaleRecipeTool::scale(Equipment* equip, double newEff) {
    double oldEfficiency = m_recObs->efficiency_pct();
    double effRatio = oldEfficiency / newEff;
 
+   //
+   // We are about to make a lot of changes to the Recipe, each of which would otherwise trigger a DB write, a signal
+   // and, in many cases, a full recalculation.  Batching them up means we just do each of these once at the end.
+   //
+   NamedEntityBatchEdit batchEdit{*this->m_recObs};
+
    this->m_recObs->setEquipment(equipment);
    this->m_recObs->setBatchSize_l(newBatchSize_l);
    this->m_recObs->nonOptBoil()->setPreBoilSize_l(equipment->kettleBoilSize_l());
@@ -36,10 +36,11 @@
  =====================================================================================================================*/
 #include "database/Database.h"
 
-#include <filesystem>
 #include <iostream> // For writing to std::cerr in destructor
 #include <mutex>    // For std::once_flag etc
+#include <optional>
 
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
@@ -61,10 +62,12 @@
 #include "database/BtSqlQuery.h"
 #include "database/DefaultContentLoader.h"
 #include "database/DatabaseSchemaHelper.h"
+#include "database/ObjectStore.h"
+#include "database/SqliteBackup.h"
+#include "database/SqliteBackupJob.h"
 #include "PersistentSettings.h"
 #include "utils/BtStringConst.h"
 #include "utils/EnumStringMapping.h"
-#include "utils/ErrorCodeToStream.h"
 
 namespace {
    EnumStringMapping const dbTypeToName {
@@ -233,7 +236,8 @@ public:
                                    loaded{false},
                                    loadWasSuccessful{false},
                                    mutex{},
-                                   userDatabaseDidNotExist{false} {
+                                   userDatabaseDidNotExist{false},
+                                   backupInProgress{false} {
       return;
    }
 
@@ -296,6 +300,8 @@ public:
          qCritical() << Q_FUNC_INFO << "Could not enable foreign keys: " << pragma.lastError().text();
          return false;
       }
+      // NB: Exclusive locking stops other connections, including our own worker threads' ones, from reading the DB.
+      //     See Database::setExclusiveLocking() for how we relax it when we need to.
       if ( ! pragma.exec( "PRAGMA locking_mode = EXCLUSIVE")) {
          qCritical() << Q_FUNC_INFO << "Could not enable exclusive locks: " << pragma.lastError().text();
          return false;
@@ -542,6 +548,27 @@ public:
                                                          PersistentSettings::Sections::backups).toString();
       QStringList fileNames = listOfFiles.split(",", Qt::SkipEmptyParts);
 
+      //
+      // If the database has not changed since the last automatic backup (and that backup is still there) then there is
+      // no point in making another identical one.  We know about changes from the SQLite file change counter (see
+      // SqliteBackup::readFileChangeCounter), which we can safely read here as all connections are closed.
+      //
+      std::optional<quint32> const changeCounter = SqliteBackup::readFileChangeCounter(this->dbFile.fileName());
+      if (changeCounter && !fileNames.isEmpty() && QFile::exists(backupDir + "/" + fileNames.last())) {
+         QVariant const lastChangeCounter = PersistentSettings::value_ck(PersistentSettings::Names::lastChangeCounter,
+                                                                         QVariant(),
+                                                                         PersistentSettings::Sections::backups);
+         if (lastChangeCounter.isValid() && lastChangeCounter.toUInt() == *changeCounter) {
+            //
+            // NB: We deliberately do not store the incremented count here.  Leaving it as it was means we'll check
+            //     again next time, and make a backup then if anything has changed.
+            //
+            qInfo() <<
+               Q_FUNC_INFO << "Skipping automatic backup as database unchanged since last backup" << fileNames.last();
+            return;
+         }
+      }
+
       QString halfName = QString("%1.%2").arg("databaseBackup").arg(QDate::currentDate().toString("yyyyMMdd"));
       QString newName = halfName;
       // Unique filenames are a pain in the ass. In the case you open the application twice in a day, this loop makes
@@ -556,7 +583,11 @@ public:
          }
       }
       // backup the file first
-      database.backupToDir(backupDir, newName);
+      if (database.backupToDir(backupDir, newName) && changeCounter) {
+         PersistentSettings::insert_ck(PersistentSettings::Names::lastChangeCounter,
+                                       *changeCounter,
+                                       PersistentSettings::Sections::backups);
+      }
 
       // If we have maxBackups == -1, it means never clean. It also means we
       // don't track the filenames.
@@ -600,6 +631,35 @@ public:
       return;
    }
 
+   /**
+    * \brief Checks common to \c Database::backupToFile and \c Database::startBackupToFile, and things that need to
+    *        happen before either of them starts copying the database.
+    *
+    * \return \c true if it's OK to go ahead with the backup, \c false otherwise
+    */
+   bool prepareForBackup(QString const & newDbFileName) {
+      if (this->dbType != Database::DbType::SQLITE) {
+         qWarning() << Q_FUNC_INFO << "Can only back up SQLite databases";
+         return false;
+      }
+
+      // Backing up the database onto itself would be bad, as the last thing the backup does is replace the target
+      // file!  (QFileInfo::canonicalFilePath() returns an empty string if the file does not exist, which is fine here.)
+      if (QFileInfo{this->dbFileName}.canonicalFilePath() == QFileInfo{newDbFileName}.canonicalFilePath()) {
+         qWarning() << Q_FUNC_INFO << "Refusing to back up" << this->dbFileName << "onto itself";
+         return false;
+      }
+
+      if (this->backupInProgress) {
+         qWarning() << Q_FUNC_INFO << "Can't back up to" << newDbFileName << "as another backup is still running";
+         return false;
+      }
+
+      // If there are any pending writes (see ObjectStore::setWriteBehindEnabled), we want them in the backup
+      ObjectStore::flushAllPendingWrites();
+      return true;
+   }
+
    //============================================== impl member variables ==============================================
 
    Database::DbType dbType;
@@ -617,6 +677,9 @@ public:
 
    bool userDatabaseDidNotExist;
 
+   // Set while a backup started by Database::startBackupToFile is running
+   bool backupInProgress;
+
 
    // These are for SQLite databases
    QFile dbFile;
@@ -717,7 +780,11 @@ QSqlDatabase Database::sqlDatabase() const {
       }
       qCritical() << Q_FUNC_INFO << errorMessage;
 
-      if (Application::isInteractive()) {
+      // We can only show a message box on the main (GUI) thread.  Worker threads just have to rely on their callers
+      // catching the exception below.
+      QCoreApplication const * const application = QCoreApplication::instance();
+      bool const isOnMainThread = !application || QThread::currentThread() == application->thread();
+      if (isOnMainThread && Application::isInteractive()) {
          QMessageBox::critical(nullptr,
                                QObject::tr("Database Failure"),
                                errorMessage);
@@ -730,6 +797,52 @@ QSqlDatabase Database::sqlDatabase() const {
    return connection;
 }
 
+void Database::closeConnectionForThisThread() const {
+   QString const connectionName = dbConnectionNamesForThisThread.value(this->pimpl->dbType);
+   if (!QSqlDatabase::contains(connectionName)) {
+      return;
+   }
+   qDebug() << Q_FUNC_INFO << "Closing connection" << connectionName;
+   {
+      // Extra braces here are to ensure that this QSqlDatabase object is out of scope before the call to
+      // QSqlDatabase::removeDatabase() below
+      QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+      if (connection.isOpen()) {
+         connection.close();
+      }
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   return;
+}
+
+bool Database::setExclusiveLocking(bool const exclusive) {
+   if (this->pimpl->dbType != Database::DbType::SQLITE) {
+      return true;
+   }
+   QSqlDatabase connection = this->sqlDatabase();
+   BtSqlQuery pragma{connection};
+   QString const lockingMode{exclusive ? "EXCLUSIVE" : "NORMAL"};
+   if (!pragma.exec(QString{"PRAGMA locking_mode = %1"}.arg(lockingMode))) {
+      qCritical() <<
+         Q_FUNC_INFO << "Could not set locking mode to" << lockingMode << ":" << pragma.lastError().text();
+      return false;
+   }
+   //
+   // Per https://www.sqlite.org/pragma.html#pragma_locking_mode, when we go back to NORMAL, any lock we already hold is
+   // not released until the next time the database file is read or written, so we do a trivial read to make that
+   // happen now.  (Going to EXCLUSIVE needs no such step, as the lock is taken the next time we need it.)
+   //
+   if (!exclusive) {
+      if (!pragma.exec("SELECT COUNT(*) FROM sqlite_master")) {
+         qCritical() << Q_FUNC_INFO << "Could not release exclusive lock: " << pragma.lastError().text();
+         return false;
+      }
+      pragma.finish();
+   }
+   qDebug() << Q_FUNC_INFO << "Locking mode now" << lockingMode;
+   return true;
+}
+
 bool Database::load() {
    this->pimpl->createFromScratch = false;
    this->pimpl->schemaUpdated = false;
@@ -866,13 +979,21 @@ void Database::unload() {
       return;
    }
 
+   // Make sure any property changes that object stores are holding in write-behind mode get written before we close
+   // the connections.  Note that we turn write-behind off (which also flushes) rather than just flushing, as anything
+   // that gets changed after this point needs to be written straight away (or, more likely, is a coding error).
+   if (!ObjectStore::setWriteBehindEnabled(false)) {
+      qCritical() << Q_FUNC_INFO << "Some property changes could not be written to the DB and will be lost";
+   }
+
    // This RAII wrapper does all the hard work on mutex.lock() and mutex.unlock() in an exception-safe way
    QMutexLocker locker(&this->pimpl->mutex);
 
    // We only want to close connections that relate to this instance of Database
    QString ourConnectionPrefix = QString{"%1-"}.arg(getDbNativeName(displayableDbType, this->pimpl->dbType));
 
-   // So far, it seems we only create one connection to the db per database type, so this is likely overkill
+   // Worker threads close their own connections (see closeConnectionForThisThread()), so normally there should only be
+   // one connection per database type here, and this is likely overkill
    QStringList allConnectionNames{QSqlDatabase::connectionNames()};
    for (QString conName : allConnectionNames) {
       if (0 == conName.indexOf(ourConnectionPrefix)) {
@@ -957,59 +1078,56 @@ char const * Database::getDefaultBackupFileName() {
 }
 
 bool Database::backupToFile(QString const & newDbFileName) {
-   QString const curDbFileName = this->pimpl->dbFile.fileName();
-
-   qDebug() << Q_FUNC_INFO << "Database backup from" << curDbFileName << "to" << newDbFileName;
+   qDebug() << Q_FUNC_INFO << "Database backup from" << this->pimpl->dbFileName << "to" << newDbFileName;
+   if (!this->pimpl->prepareForBackup(newDbFileName)) {
+      return false;
+   }
 
    //
-   // In earlier versions of the code, we just used the copy() member function of QFile.  When this works it is fine,
-   // but when there is an error, the diagnostics are not always very helpful.  Eg getting QFileDevice::CopyError back
-   // from the error() member function doesn't really tell us why the file could not be copied.
+   // SqliteBackup uses a connection of its own, which can't read the database while ours is in exclusive locking mode.
+   // If our connection is closed (eg because we are shutting down) then there is nothing to do.
    //
-   // Using the Filesystem library from the C++ standard library gives us better (albeit not perfect) diagnostics when
-   // things go wrong.
+   bool const connectionIsOpen = QSqlDatabase::database(this->pimpl->dbConName, false).isOpen();
+   if (connectionIsOpen && !this->setExclusiveLocking(false)) {
+      return false;
+   }
+   bool const succeeded = SqliteBackup::backupToFile(this->pimpl->dbFileName, newDbFileName);
+   if (connectionIsOpen && !this->setExclusiveLocking(true)) {
+      // Not fatal -- things will just be a bit slower
+      qWarning() << Q_FUNC_INFO << "Could not restore exclusive locking after backup";
+   }
+   return succeeded;
+}
+
+SqliteBackupJob * Database::startBackupToFile(QString const & newDbFileName, QObject * parent) {
+   qDebug() << Q_FUNC_INFO << "Database backup from" << this->pimpl->dbFileName << "to" << newDbFileName;
+   if (!this->pimpl->prepareForBackup(newDbFileName) || !this->setExclusiveLocking(false)) {
+      return nullptr;
+   }
+   this->pimpl->backupInProgress = true;
+
+   auto backupJob = new SqliteBackupJob{this->pimpl->dbFileName, newDbFileName, parent};
+
    //
-   // The std::filesystem functions typically come in two versions: one using an error code and one throwing an
-   // exception.  Since we're going to abort on the first error, the exception-throwing versions make the code a bit
-   // simpler.  The `operation` variable keeps track of what we were doing when the exception occurred so we can give a
-   // clue about what caused the error.
+   // Once the backup is done, we go back to exclusive locking.  Because we connect to SqliteBackupJob::finished before
+   // the caller can, this happens before the caller hears about the backup finishing.  (We also catch the job being
+   // destroyed before it could tell us it had finished.)
    //
-   this->pimpl->dbFile.close();
-   char const * operation = "Allocate";
-   try {
-      std::filesystem::path source{curDbFileName.toStdString()};
-      std::filesystem::path target{newDbFileName.toStdString()};
-      // Note that std::filesystem::canonical needs its parameter to exist, whereas std::filesystem::weakly_canonical
-      // does not.
-      source = std::filesystem::canonical(source);
-      target = std::filesystem::weakly_canonical(target);
-      operation = "See if target already exists";
-      if (std::filesystem::exists(target)) {
-         // AFAICT std::filesystem::copy should overwrite its target if it exists, but it's helpful for diagnostics to
-         // pull that case out as a separate step.
-         operation = "Remove existing target";
-         qInfo() <<
-            Q_FUNC_INFO << "Removing existing file" << newDbFileName << "before copying" << curDbFileName;
-         std::filesystem::remove(target);
+   auto backupDone = [this]() {
+      if (this->pimpl->backupInProgress) {
+         this->pimpl->backupInProgress = false;
+         if (!this->setExclusiveLocking(true)) {
+            // Not fatal -- things will just be a bit slower
+            qWarning() << Q_FUNC_INFO << "Could not restore exclusive locking after backup";
+         }
       }
-      operation = "Copy";
-      std::filesystem::copy(source, target);
-   } catch (std::filesystem::filesystem_error & fsError) {
-      std::error_code errorCode = fsError.code();
-      qWarning() <<
-         Q_FUNC_INFO << "Error backing up database file " << curDbFileName << "to" << newDbFileName << ":" <<
-         operation << "failed with" << errorCode << ".  Error message:" << fsError.what();
-      return false;
-   } catch (std::exception & exception) {
-      // Most probably this would be std::bad_alloc, in which case we'd probably even have difficulty logging, but we
-      // might as well try!
-      qCritical() <<
-         Q_FUNC_INFO << "Unexpected error backing up database file " << curDbFileName << "to" << newDbFileName << ":" <<
-         operation << "failed:" << exception.what();
-      return false;
-   }
+      return;
+   };
+   QObject::connect(backupJob, &SqliteBackupJob::finished , backupJob, backupDone);
+   QObject::connect(backupJob, &SqliteBackupJob::destroyed, backupDone);
 
-   return true;
+   backupJob->start();
+   return backupJob;
 }
 
 bool Database::backupToDir(QString dir, QString filename) {
@@ -1094,7 +1212,8 @@ bool Database::verifyDbConnection(Database::DbType testDb,
 
 void Database::convertDatabase(QString const& Hostname, QString const& DbName,
                                QString const& Username, QString const& Password,
-                               int Portnum, Database::DbType newType) {
+                               int Portnum, Database::DbType newType,
+                               NewDbWriteProgress * progress) {
    QSqlDatabase connectionNew;
 
    try {
@@ -1119,7 +1238,9 @@ void Database::convertDatabase(QString const& Hostname, QString const& DbName,
       // Don't get newDatabase via Database::instance() as we don't want to use the connection details from
       // PersistentSettings (or to attempt to read data from newDatabase)
       Database newDatabase{newType};
-      DatabaseSchemaHelper::copyToNewDatabase(newDatabase, connectionNew);
+      if (!DatabaseSchemaHelper::copyToNewDatabase(newDatabase, connectionNew, progress)) {
+         throw QString("Could not copy data to the new database");
+      }
    }
    catch (QString e) {
       qCritical() << QString("%1 %2").arg(Q_FUNC_INFO).arg(e);
@@ -1276,6 +1397,26 @@ bool Database::updatePrimaryKeySequenceIfNecessary(QSqlDatabase & connection,
    return true;
 }
 
+int Database::maxBindValuesPerQuery() const {
+   switch (this->pimpl->dbType) {
+      case Database::DbType::SQLITE:
+         //
+         // Per https://www.sqlite.org/limits.html#max_variable_number, this is 32766 since SQLite 3.32.0, but 999 in
+         // earlier versions, and we don't always know which version is built into the Qt driver.
+         //
+         return 999;
+      case Database::DbType::PGSQL:
+         // The PostgreSQL wire protocol uses a 16-bit count of parameters
+         return 65535;
+      default:
+         // It's a coding error (somewhere) if we get here!
+         Q_ASSERT(false);
+         break;
+   }
+   // On non-debug builds, the safe minimum
+   return 999;
+}
+
 template<class S>
 S & operator<<(S & stream, Database::DbType const dbType) {
    try {
@@ -40,6 +40,9 @@
 #include "utils/NoCopy.h"
 
 class BtStringConst;
+class NewDbWriteProgress;
+class QObject;
+class SqliteBackupJob;
 
 /*!
  * \class Database
@@ -105,6 +108,30 @@ public:
     */
    QSqlDatabase sqlDatabase() const;
 
+   /**
+    * \brief Close and remove the calling thread's connection to this database, if it has one.
+    *
+    *        Qt requires a connection to be used and removed only on the thread that created it, so any worker thread
+    *        that calls \c sqlDatabase() must call this before it finishes.  (The main thread's connection is dealt with
+    *        by \c unload().)  As with \c QSqlDatabase::removeDatabase, the caller must not be holding any
+    *        \c QSqlDatabase or \c QSqlQuery objects for the connection.
+    */
+   void closeConnectionForThisThread() const;
+
+   /**
+    * \brief For SQLite, the main connection normally runs in \c EXCLUSIVE locking mode, so that once it has read or
+    *        written the database it never releases its lock.  This makes access quicker but means no other connection
+    *        (including our own worker threads' ones) can read the database.  So, around any work that has worker
+    *        threads read the DB, call this with \c false beforehand and with \c true afterwards.
+    *
+    *        Should be called on the main thread.  Does nothing for PostgreSQL.
+    *
+    * \param exclusive \c true for \c EXCLUSIVE locking mode, \c false for \c NORMAL
+    *
+    * \return \c true if succeeded (or nothing to do), \c false otherwise
+    */
+   bool setExclusiveLocking(bool const exclusive);
+
    //! \brief Should be called when we are about to close down.
    void unload();
 
@@ -122,9 +149,25 @@ public:
 
    static char const * getDefaultBackupFileName();
 
-   //! backs up database to chosen file
+   /**
+    * \brief Backs up (SQLite) database to chosen file, blocking until done.  See \c SqliteBackup.
+    *
+    *        Whilst the backup is being made, our connection is switched out of exclusive locking mode (see
+    *        \c setExclusiveLocking), so that the backup's own connection can read the database.
+    */
    bool backupToFile(QString const & newDbFileName);
 
+   /**
+    * \brief As \c backupToFile, but makes the backup on a worker thread and returns straight away.  Exclusive locking
+    *        is restored when the returned job emits \c SqliteBackupJob::finished (or is destroyed).
+    *
+    * \param parent The owner of the returned job.  Either way, the caller is responsible for making sure the job is
+    *               deleted once it has finished.
+    *
+    * \return \c nullptr if the backup could not be started (eg because another one is still running)
+    */
+   SqliteBackupJob * startBackupToFile(QString const & newDbFileName, QObject * parent = nullptr);
+
    //! backs up database to 'dir' in chosen directory
    bool backupToDir(QString dir, QString filename="");
 
@@ -148,9 +191,11 @@ public:
 
    //! \brief Figures out what databases we are copying to and from, opens what
    //   needs opens and then calls the appropriate workhorse to get it done.
+   //   If supplied, \c progress is told how the copy is going -- see \c WriteAllObjectStoresToNewDb.
    void convertDatabase(QString const& Hostname, QString const& DbName,
                         QString const& Username, QString const& Password,
-                        int Portnum, Database::DbType newType);
+                        int Portnum, Database::DbType newType,
+                        NewDbWriteProgress * progress = nullptr);
 
    /*!
     * \brief If we are supporting multiple databases, we need some way to
@@ -219,6 +264,12 @@ public:
                                             BtStringConst const & tableName,
                                             BtStringConst const & columnName) const;
 
+   /**
+    * \brief The most bind values (ie parameters) we can use in a single query on this type of database.  Used to size
+    *        multi-row INSERT statements.
+    */
+   int maxBindValuesPerQuery() const;
+
 private:
    // Private implementation details - see https://herbsutter.com/gotw/_100/
    class impl;
@@ -37,7 +37,7 @@
 #include "database/ObjectStoreTyped.h"
 #include "model/Salt.h"
 
-int constexpr DatabaseSchemaHelper::latestVersion = 19;
+int constexpr DatabaseSchemaHelper::latestVersion = 21;
 
 // Default namespace hides functions from everything outside this file.
 namespace {
@@ -2738,6 +2738,90 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
+   /**
+    * \brief Secondary indexes on foreign key columns.  These need to match the \c ObjectStore::TableIndex declarations
+    *        in ObjectStoreTyped.cpp, which is what creates them on a new database.
+    *
+    *        NB: We deliberately spell out the SQL here rather than call \c ObjectStore::createIndexes, because the
+    *            latter will change as the schema evolves, whereas this migration always runs against a version 19
+    *            database.
+    */
+   bool migrate_to_20([[maybe_unused]] Database & db, BtSqlQuery & q) {
+      QVector<QueryAndParameters> migrationQueries{
+         //
+         // Steps are always looked up by their owner and then ordered by step number
+         //
+         {QString("CREATE INDEX IF NOT EXISTS mash_step_mash_id_idx "
+                  "ON mash_step (mash_id, step_number)")},
+         {QString("CREATE INDEX IF NOT EXISTS boil_step_boil_id_idx "
+                  "ON boil_step (boil_id, step_number)")},
+         {QString("CREATE INDEX IF NOT EXISTS fermentation_step_fermentation_id_idx "
+                  "ON fermentation_step (fermentation_id, step_number)")},
+         {QString("CREATE INDEX IF NOT EXISTS instruction_recipe_id_idx "
+                  "ON instruction (recipe_id, step_number)")},
+         //
+         // Recipe versioning and brew notes
+         //
+         {QString("CREATE INDEX IF NOT EXISTS recipe_ancestor_id_idx ON recipe   (ancestor_id)")},
+         {QString("CREATE INDEX IF NOT EXISTS brewnote_recipe_id_idx ON brewnote (recipe_id)")},
+      };
+
+      //
+      // Recipe additions -- by recipe and by ingredient
+      //
+      for (char const * baseName : {"fermentable", "hop", "misc", "yeast", "salt", "water"}) {
+         migrationQueries.append({QString("CREATE INDEX IF NOT EXISTS %1_in_recipe_recipe_id_idx "
+                                          "ON %1_in_recipe (recipe_id)").arg(baseName)});
+         migrationQueries.append({QString("CREATE INDEX IF NOT EXISTS %1_in_recipe_%1_id_idx "
+                                          "ON %1_in_recipe (%1_id)").arg(baseName)});
+      }
+
+      //
+      // Stock purchases by ingredient, and stock uses by purchase and by brew note
+      //
+      for (char const * baseName : {"fermentable", "hop", "misc", "salt", "yeast"}) {
+         migrationQueries.append({QString("CREATE INDEX IF NOT EXISTS %1_stock_purchase_%1_id_idx "
+                                          "ON %1_stock_purchase (%1_id)").arg(baseName)});
+         migrationQueries.append({QString("CREATE INDEX IF NOT EXISTS %1_stock_use_%1_purchase_id_idx "
+                                          "ON %1_stock_use (%1_purchase_id)").arg(baseName)});
+         migrationQueries.append({QString("CREATE INDEX IF NOT EXISTS %1_stock_use_brewnote_id_idx "
+                                          "ON %1_stock_use (brewnote_id)").arg(baseName)});
+      }
+
+      return executeSqlQueries(q, migrationQueries);
+   }
+
+   /**
+    * \brief Prior versions of a Recipe now share additions, salt adjustments and water uses with later versions
+    *        rather than having their own copies.  See \c Recipe::makePriorVersion and
+    *        \c OwnedSetOptions::sharedWithPriorVersions.
+    */
+   bool migrate_to_21(Database & db, BtSqlQuery & q) {
+      QVector<QueryAndParameters> migrationQueries{
+         {QString("ALTER TABLE recipe ADD COLUMN version_number %1").arg(db.getDbNativeTypeName<int>())},
+         {QString("UPDATE      recipe SET version_number = 0")},
+      };
+
+      //
+      // Everything a Recipe owns so far is in its current version
+      //
+      for (char const * baseName : {"fermentable", "hop", "misc", "yeast", "salt", "water"}) {
+         migrationQueries.append({QString("ALTER TABLE %1_in_recipe ADD COLUMN recipe_version %2")
+                                     .arg(baseName)
+                                     .arg(db.getDbNativeTypeName<int>())});
+         migrationQueries.append({QString("UPDATE      %1_in_recipe SET recipe_version = 0").arg(baseName)});
+      }
+
+      //
+      // Existing prior versions are full copies of the versions after them, so they must not also see what the later
+      // versions own
+      //
+      migrationQueries.append({QString("UPDATE recipe SET version_number = -1 "
+                                       "WHERE id IN (SELECT ancestor_id FROM recipe WHERE ancestor_id <> id)")});
+
+      return executeSqlQueries(q, migrationQueries);
+   }
+
    //
    // Next time - maybe fix remaining issues listed in ObjectStore legacyBadTypes
    //
@@ -2771,6 +2855,8 @@ namespace {
          case 16: ret &= migrate_to_17 (database, sqlQuery); break;
          case 17: ret &= migrate_to_18 (database, sqlQuery); break;
          case 18: ret &= migrate_to_19 (database, sqlQuery); break;
+         case 19: ret &= migrate_to_20 (database, sqlQuery); break;
+         case 20: ret &= migrate_to_21 (database, sqlQuery); break;
          default:
             qCritical() << QString("Unknown version %1").arg(oldVersion);
             return false;
@@ -2937,7 +3023,9 @@ int DatabaseSchemaHelper::schemaVersion(QSqlDatabase & db) {
    return -1;
 }
 
-bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew) {
+bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase,
+                                             QSqlDatabase & connectionNew,
+                                             NewDbWriteProgress * progress) {
 
    // this is to prevent us from over-writing or doing heavens knows what to an existing db
    if (connectionNew.tables().contains(QLatin1String("settings"))) {
@@ -2952,7 +3040,7 @@ bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase, QSqlDatabas
       return false;
    }
 
-   if (!WriteAllObjectStoresToNewDb(newDatabase, connectionNew)) {
+   if (!WriteAllObjectStoresToNewDb(newDatabase, connectionNew, progress)) {
       qCritical() << Q_FUNC_INFO << "Error writing data to new DB";
       return false;
    }
@@ -24,6 +24,7 @@
 
 #include "Database.h"
 
+class NewDbWriteProgress;
 class QTextStream;
 
 /*!
@@ -53,8 +54,14 @@ namespace DatabaseSchemaHelper {
    //! \brief Current schema version of the given database
    int schemaVersion(QSqlDatabase & db);
 
-   //! \brief does the heavy lifting to copy the contents from one db to the next
-   bool copyToNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew);
+   /**
+    * \brief does the heavy lifting to copy the contents from one db to the next
+    *
+    * \param progress If supplied, told about progress writing data to the new DB.  See \c WriteAllObjectStoresToNewDb.
+    */
+   bool copyToNewDatabase(Database & newDatabase,
+                          QSqlDatabase & connectionNew,
+                          NewDbWriteProgress * progress = nullptr);
 }
 
 #endif
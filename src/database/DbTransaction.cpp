@@ -16,11 +16,21 @@
 #include "database/DbTransaction.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QSqlError>
 
 #include "database/Database.h"
 #include "Logging.h"
 
+namespace {
+   //
+   // Number of open transactions, keyed by connection name.  Each thread has its own DB connection(s) (see
+   // Database::sqlDatabase()), so this can be thread-local and does not need a mutex.  In practice the count for any
+   // one connection will only ever be 0 or 1, because neither SQLite nor PostgreSQL supports nested transactions.
+   //
+   thread_local QHash<QString, int> numOpenTransactions;
+}
+
 DbTransaction::DbTransaction(Database & database,
                              QSqlDatabase & connection,
                              QString const nameForLogging,
@@ -29,6 +39,7 @@ DbTransaction::DbTransaction(Database & database,
    connection{connection},
    nameForLogging{nameForLogging},
    committed{false},
+   open{false},
    specialBehaviours{specialBehaviours} {
    // Note that, on SQLite at least, turning foreign keys on and off has to happen outside a transaction, so we have to
    // be careful about the order in which we do things.
@@ -46,6 +57,9 @@ DbTransaction::DbTransaction(Database & database,
       qCritical() <<
          Q_FUNC_INFO << "Unable to start database transaction" << this->nameForLogging << ":" << connection.lastError().text();
       qCritical().noquote() << Q_FUNC_INFO << Logging::getStackTrace();
+   } else {
+      this->open = true;
+      ++numOpenTransactions[this->connection.connectionName()];
    }
    return;
 }
@@ -62,6 +76,7 @@ DbTransaction::~DbTransaction() {
             Q_FUNC_INFO << "Unable to rollback database transaction" << this->nameForLogging << ":" << connection.lastError().text();
       }
    }
+   this->finished();
 
    // See comment above about why we need to do this _after_ the transaction has finished
    if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
@@ -77,6 +92,23 @@ bool DbTransaction::commit() {
    if (!this->committed) {
       qCritical() <<
          Q_FUNC_INFO << "Unable to commit database transaction" << this->nameForLogging << ":" << connection.lastError().text();
+   } else {
+      this->finished();
    }
    return this->committed;
 }
+
+void DbTransaction::finished() {
+   if (this->open) {
+      this->open = false;
+      QString const connectionName = this->connection.connectionName();
+      if (--numOpenTransactions[connectionName] <= 0) {
+         numOpenTransactions.remove(connectionName);
+      }
+   }
+   return;
+}
+
+bool DbTransaction::isOpenOn(QSqlDatabase const & connection) {
+   return numOpenTransactions.value(connection.connectionName(), 0) > 0;
+}
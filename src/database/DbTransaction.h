@@ -1,5 +1,5 @@
 /*======================================================================================================================
- * database/DbTransaction.h is part of Brewken, and is copyright the following authors 2021-2024:
+ * database/DbTransaction.h is part of Brewken, and is copyright the following authors 2021-2025:
  *   • Matt Young <mfsy@yahoo.com>
  *
  * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
@@ -52,7 +52,19 @@ public:
     */
    bool commit();
 
+   /**
+    * \brief Whether there is a \c DbTransaction open (ie started but not yet committed or rolled back) on the supplied
+    *        connection.  Useful for code that needs to start its own transaction and must not be called in the middle
+    *        of someone else's.
+    */
+   static bool isOpenOn(QSqlDatabase const & connection);
+
 private:
+   /**
+    * \brief Called when our transaction has been committed or rolled back
+    */
+   void finished();
+
    Database & database;
    // This is intended to be a short-lived object, so it's OK to store a reference to a QSqlDatabase object
    QSqlDatabase & connection;
@@ -60,6 +72,8 @@ private:
    // 'Unable to start database transaction: "cannot start a transaction within a transaction Unable to begin transaction"'
    QString const nameForLogging;
    bool committed;
+   // True from when the transaction successfully starts until it is committed or rolled back
+   bool open;
    int specialBehaviours;
 
    // RAII class shouldn't be getting copied or moved
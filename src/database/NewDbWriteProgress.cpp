@@ -0,0 +1,67 @@
+/*======================================================================================================================
+ * database/NewDbWriteProgress.cpp is part of Brewken, and is copyright the following authors 2026:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "database/NewDbWriteProgress.h"
+
+#include <atomic>
+
+// This private implementation class holds all private non-virtual members of NewDbWriteProgress
+class NewDbWriteProgress::impl {
+public:
+   impl() : m_totalStores{0},
+            m_totalRows{0},
+            m_storesWritten{0},
+            m_rowsWritten{0} {
+      return;
+   }
+
+   ~impl() = default;
+
+   // Totals are only set (by start()) before any worker threads are running, so they don't need to be atomic
+   qint64 m_totalStores;
+   qint64 m_totalRows;
+   std::atomic<qint64> m_storesWritten;
+   std::atomic<qint64> m_rowsWritten;
+};
+
+NewDbWriteProgress::NewDbWriteProgress(QObject * parent) :
+   QObject{parent},
+   pimpl{std::make_unique<impl>()} {
+   return;
+}
+
+NewDbWriteProgress::~NewDbWriteProgress() = default;
+
+void NewDbWriteProgress::start(qint64 const totalStores, qint64 const totalRows) {
+   this->pimpl->m_totalStores = totalStores;
+   this->pimpl->m_totalRows = totalRows;
+   this->pimpl->m_storesWritten = 0;
+   this->pimpl->m_rowsWritten = 0;
+   emit this->rowsWritten(0, totalRows);
+   return;
+}
+
+void NewDbWriteProgress::recordRowsWritten(qint64 const numRows) {
+   // NB: fetch_add returns the value _before_ the addition
+   qint64 const rowsWrittenSoFar = this->pimpl->m_rowsWritten.fetch_add(numRows) + numRows;
+   emit this->rowsWritten(rowsWrittenSoFar, this->pimpl->m_totalRows);
+   return;
+}
+
+void NewDbWriteProgress::recordStoreWritten(QString const & storeName) {
+   qint64 const storesWrittenSoFar = ++this->pimpl->m_storesWritten;
+   emit this->storeWritten(storeName, storesWrittenSoFar, this->pimpl->m_totalStores);
+   return;
+}
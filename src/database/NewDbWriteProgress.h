@@ -0,0 +1,73 @@
+/*======================================================================================================================
+ * database/NewDbWriteProgress.h is part of Brewken, and is copyright the following authors 2026:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef DATABASE_NEWDBWRITEPROGRESS_H
+#define DATABASE_NEWDBWRITEPROGRESS_H
+#pragma once
+
+#include <memory>
+
+#include <QObject>
+#include <QString>
+
+/**
+ * \brief Reports progress of \c WriteAllObjectStoresToNewDb (eg to show in the UI when copying data to a new
+ *        database).
+ *
+ *        The \c record... member functions are called by the code doing the writing, possibly from several worker
+ *        threads at once.  The signals are emitted from whichever thread does the recording, so, for receivers on the
+ *        thread this object belongs to (normally the main thread), they are queued.  \c WriteAllObjectStoresToNewDb
+ *        delivers queued signals before it returns.
+ */
+class NewDbWriteProgress : public QObject {
+   Q_OBJECT
+
+public:
+   NewDbWriteProgress(QObject * parent = nullptr);
+   ~NewDbWriteProgress();
+
+   /**
+    * \brief Called once, before anything is written, with the totals for the whole copy
+    */
+   void start(qint64 const totalStores, qint64 const totalRows);
+
+   /**
+    * \brief Called after each batch of rows is written.  Safe to call from any thread.
+    */
+   void recordRowsWritten(qint64 const numRows);
+
+   /**
+    * \brief Called after all the rows of an object store are written.  Safe to call from any thread.
+    */
+   void recordStoreWritten(QString const & storeName);
+
+signals:
+   /**
+    * \brief Emitted after each batch of rows is written
+    */
+   void rowsWritten(qint64 rowsWrittenSoFar, qint64 totalRows);
+
+   /**
+    * \brief Emitted after all the rows of an object store are written
+    */
+   void storeWritten(QString storeName, qint64 storesWrittenSoFar, qint64 totalStores);
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+};
+
+#endif
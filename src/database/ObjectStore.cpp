@@ -15,24 +15,35 @@
  =====================================================================================================================*/
 #include "database/ObjectStore.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream> // For start-up errors!
+#include <optional>
 #include <tuple>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QCoreApplication>
 #include <QHash>
 #include <QMap>
+#include <QRegularExpression>
+#include <QSet>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
 #include <QVector>
 #include <qglobal.h> // For Q_ASSERT and Q_UNREACHABLE
 
 #include "database/BtSqlQuery.h"
 #include "database/Database.h"
 #include "database/DbTransaction.h"
+#include "database/NewDbWriteProgress.h"
 #include "Logging.h"
+#include "model/NamedEntity.h"
 #include "model/NamedParameterBundle.h"
 #include "utils/MetaTypes.h"
 #include "utils/OptionalHelpers.h"
@@ -257,6 +268,50 @@ namespace {
       return true;
    }
 
+   /**
+    * \brief Create the secondary indexes declared on a table.  We use CREATE INDEX IF NOT EXISTS (which both SQLite and
+    *        PostgreSQL support) so it is harmless to call this on a table whose indexes already exist.
+    *
+    * \return true if succeeded, false otherwise
+    */
+   bool createIndexesOnTable(QSqlDatabase & connection, ObjectStore::TableDefinition const & tableDefinition) {
+      //
+      // We're building SQL strings of the form
+      //    CREATE INDEX IF NOT EXISTS foobar_bah_idx ON foobar (bah, hum) WHERE NOT deleted;
+      //
+      BtSqlQuery sqlQuery{connection};
+      for (auto const & indexDefn : tableDefinition.tableIndexes) {
+         // It's a coding error to have an index without any columns
+         Q_ASSERT(!indexDefn.columnNames.isEmpty());
+
+         QString queryString{"CREATE INDEX IF NOT EXISTS "};
+         QTextStream queryStringAsStream{&queryString};
+         queryStringAsStream << indexDefn.indexName << " ON " << tableDefinition.tableName << " (";
+         bool firstColumnOutput = false;
+         for (auto const & columnName : indexDefn.columnNames) {
+            if (firstColumnOutput) {
+               queryStringAsStream << ", ";
+            }
+            firstColumnOutput = true;
+            queryStringAsStream << columnName;
+         }
+         queryStringAsStream << ")";
+         if (!indexDefn.whereClause.isNull()) {
+            queryStringAsStream << " WHERE " << indexDefn.whereClause;
+         }
+         queryStringAsStream << ";";
+         qDebug().noquote() << Q_FUNC_INFO << "Index creation: " << queryString;
+
+         sqlQuery.prepare(queryString);
+         if (!sqlQuery.exec()) {
+            qCritical() <<
+               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            return false;
+         }
+      }
+      return true;
+   }
+
    /**
     * \brief Converts a QVariant to a QString, but with a special value for a null QVariant
     */
@@ -369,25 +424,90 @@ namespace {
    }
 
    /**
-    * \brief Insert data from an object property to a junction table
+    * \brief Read, from an object property, the data to insert in a junction table.  Needs to be called on the thread
+    *        that owns \c object.
     *
     * \param junctionTable
     * \param object
-    * \param primaryKey  Note that this must be supplied separately as, for a new object, we may not (yet) have set its
-    *                    primary key (ie we cannot just read primary key from object)
-    * \param connection
+    * \param primaryKey  Only used for logging
+    * \param propertyValues  Set to the values read.  Left empty if the property is a single foreign key that is unset.
     *
     * \return \c true if succeeded, \c false otherwise
     */
-   bool insertIntoJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
-                                          QObject const & object,
-                                          QVariant const & primaryKey,
-                                          QSqlDatabase & connection) {
-      qDebug() <<
-         Q_FUNC_INFO << "Writing" << object.metaObject()->className() << "property" <<
-         GetJunctionTableDefinitionPropertyName(junctionTable) << " into junction table " <<
-         junctionTable.tableName;
+   bool readJunctionTablePropertyValues(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                        QObject const & object,
+                                        QVariant const & primaryKey,
+                                        QVector<int> & propertyValues) {
+      propertyValues.clear();
+      QVariant propertyValuesWrapper = object.property(*GetJunctionTableDefinitionPropertyName(junctionTable));
+      if (!propertyValuesWrapper.isValid()) {
+         // It's a programming error if we couldn't read a property value
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to read" << object.metaObject()->className() << "property" <<
+            GetJunctionTableDefinitionPropertyName(junctionTable);
+         Q_ASSERT(false); // Stop here on debug builds
+         return false;
+      }
+
+      // We now need to extract the property values from their QVariant wrapper
+      if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
+         // If it's single entry only, just turn it into a one-item list so that the remaining processing is the same
+         bool succeeded = false;
+         int theValue = propertyValuesWrapper.toInt(&succeeded);
+         if (!succeeded) {
+            qCritical() << Q_FUNC_INFO << "Can't convert QVariant of" << propertyValuesWrapper.typeName() << "to int";
+            Q_ASSERT(false); // Stop here on debug builds
+            return false;    // Continue but bail out of the current DB transaction on other builds
+         }
 
+         // If the foreign key returned is not valid, it's not an error, it just means there is no associated object,
+         // eg this Hop does not have a parent.
+         if (theValue <= 0) {
+            qDebug() <<
+               Q_FUNC_INFO << "Property" << GetJunctionTableDefinitionPropertyName(junctionTable) << "of" <<
+               object.metaObject()->className() << "#" << primaryKey.toInt() << "is" << theValue <<
+               "which we assume means \"unset\", so nothing to write to junction table" <<
+               junctionTable.tableName;
+            return true;
+         }
+
+         propertyValues.append(theValue);
+      } else {
+         //
+         // The propertyValuesWrapper QVariant should hold QVector<int>.  If it doesn't it's a coding error (because we
+         // have a property getter that's returning something else).
+         //
+         // Note that QVariant::toList() is NOT going to be useful to us here because that ONLY works if the contained
+         // type is QList<QVariant> (aka QVariantList) or QStringList.  If your QVariant contains some other list-like
+         // structure then toList() will just return an empty list.
+         //
+         if (!propertyValuesWrapper.canConvert< QVector<int> >()) {
+            qCritical() <<
+               Q_FUNC_INFO << "Can't convert QVariant of" << propertyValuesWrapper.typeName() << "to QVector<int>";
+            Q_ASSERT(false); // Stop here on debug builds
+            return false;    // Continue but bail out of the current DB transaction on other builds
+         }
+         propertyValues = propertyValuesWrapper.value< QVector<int> >();
+      }
+
+      return true;
+   }
+
+   /**
+    * \brief Insert rows in a junction table.  Does not touch any objects, so can be called from any thread that has a
+    *        connection to the database.
+    *
+    * \param junctionTable
+    * \param primaryKey  Primary key of the object that the rows belong to
+    * \param propertyValues  As read by \c readJunctionTablePropertyValues
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool insertJunctionTableRows(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                QVariant const & primaryKey,
+                                QVector<int> const & propertyValues,
+                                QSqlDatabase & connection) {
       //
       // It's a coding error if the caller has supplied us anything other than an int inside the primaryKey QVariant.
       //
@@ -400,6 +520,10 @@ namespace {
          return false;    // Continue but bail out of the current DB transaction on other builds
       }
 
+      if (propertyValues.isEmpty()) {
+         return true;
+      }
+
       //
       // Construct the query
       //
@@ -447,65 +571,12 @@ namespace {
       BtSqlQuery sqlQuery{connection};
       sqlQuery.prepare(queryString);
 
-      // Get the list of data to bind to it
-      QVariant propertyValuesWrapper = object.property(*GetJunctionTableDefinitionPropertyName(junctionTable));
-      if (!propertyValuesWrapper.isValid()) {
-         // It's a programming error if we couldn't read a property value
-         qCritical() <<
-            Q_FUNC_INFO << "Unable to read" << object.metaObject()->className() << "property" <<
-            GetJunctionTableDefinitionPropertyName(junctionTable);
-         Q_ASSERT(false); // Stop here on debug builds
-         return false;
-      }
-
-      // We now need to extract the property values from their QVariant wrapper
-      QVector<int> propertyValues;
-      if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
-         // If it's single entry only, just turn it into a one-item list so that the remaining processing is the same
-         bool succeeded = false;
-         int theValue = propertyValuesWrapper.toInt(&succeeded);
-         if (!succeeded) {
-            qCritical() << Q_FUNC_INFO << "Can't convert QVariant of" << propertyValuesWrapper.typeName() << "to int";
-            Q_ASSERT(false); // Stop here on debug builds
-            return false;    // Continue but bail out of the current DB transaction on other builds
-         }
-
-         // If the foreign key returned is not valid, it's not an error, it just means there is no associated object,
-         // eg this Hop does not have a parent.
-         if (theValue <= 0) {
-            qDebug() <<
-               Q_FUNC_INFO << "Property" << GetJunctionTableDefinitionPropertyName(junctionTable) << "of" <<
-               object.metaObject()->className() << "#" << primaryKey.toInt() << "is" << theValue <<
-               "which we assume means \"unset\", so nothing to write to junction table" <<
-               junctionTable.tableName;
-            return true;
-         }
-
-         propertyValues.append(theValue);
-      } else {
-         //
-         // The propertyValuesWrapper QVariant should hold QVector<int>.  If it doesn't it's a coding error (because we
-         // have a property getter that's returning something else).
-         //
-         // Note that QVariant::toList() is NOT going to be useful to us here because that ONLY works if the contained
-         // type is QList<QVariant> (aka QVariantList) or QStringList.  If your QVariant contains some other list-like
-         // structure then toList() will just return an empty list.
-         //
-         if (!propertyValuesWrapper.canConvert< QVector<int> >()) {
-            qCritical() <<
-               Q_FUNC_INFO << "Can't convert QVariant of" << propertyValuesWrapper.typeName() << "to QVector<int>";
-            Q_ASSERT(false); // Stop here on debug builds
-            return false;    // Continue but bail out of the current DB transaction on other builds
-         }
-         propertyValues = propertyValuesWrapper.value< QVector<int> >();
-      }
-
       // Now loop through and bind/run the insert query once for each item in the list
       int itemNumber = 1;
       qDebug() <<
-         Q_FUNC_INFO << propertyValues.size() << "value(s) (in" << propertyValuesWrapper.typeName() <<
-         ") for property" << GetJunctionTableDefinitionPropertyName(junctionTable) << "of" <<
-         object.metaObject()->className() << "#" << primaryKey.toInt();
+         Q_FUNC_INFO << propertyValues.size() << "value(s) for" <<
+         GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << "#" << primaryKey.toInt() << "in" <<
+         junctionTable.tableName;
       for (int curValue : propertyValues) {
          sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
          sqlQuery.bindValue(otherPrimaryKeyBindName, curValue);
@@ -528,6 +599,33 @@ namespace {
       return true;
    }
 
+   /**
+    * \brief Insert data from an object property to a junction table
+    *
+    * \param junctionTable
+    * \param object
+    * \param primaryKey  Note that this must be supplied separately as, for a new object, we may not (yet) have set its
+    *                    primary key (ie we cannot just read primary key from object)
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool insertIntoJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                          QObject const & object,
+                                          QVariant const & primaryKey,
+                                          QSqlDatabase & connection) {
+      qDebug() <<
+         Q_FUNC_INFO << "Writing" << object.metaObject()->className() << "property" <<
+         GetJunctionTableDefinitionPropertyName(junctionTable) << " into junction table " <<
+         junctionTable.tableName;
+
+      QVector<int> propertyValues;
+      if (!readJunctionTablePropertyValues(junctionTable, object, primaryKey, propertyValues)) {
+         return false;
+      }
+      return insertJunctionTableRows(junctionTable, primaryKey, propertyValues, connection);
+   }
+
    /**
     * \brief Delete rows relating to a particular object from a junction table
     *
@@ -679,11 +777,22 @@ ObjectStore::TableField::TableField(ObjectStore::FieldType                 const
    return;
 }
 
+ObjectStore::TableIndex::TableIndex(char const *                  const indexName,
+                                    std::initializer_list<BtStringConst> columnNames,
+                                    char const *                  const whereClause) :
+   indexName{indexName},
+   columnNames{columnNames},
+   whereClause{whereClause} {
+   return;
+}
+
 ObjectStore::TableDefinition::TableDefinition(char const * const tableName,
                                               std::initializer_list<TableField> thisTableFields,
-                                              std::initializer_list<std::vector<TableField> const *> commonFields) :
+                                              std::initializer_list<std::vector<TableField> const *> commonFields,
+                                              std::initializer_list<TableIndex> tableIndexes) :
    tableName{tableName},
-   tableFields{thisTableFields, commonFields} {
+   tableFields{thisTableFields, commonFields},
+   tableIndexes{tableIndexes} {
 
    //
    // Uncomment the following if trying to debug issues with foreign keys.
@@ -708,30 +817,579 @@ ObjectStore::TableDefinition::TableDefinition(char const * const tableName,
 //      }
 //   }
 
-   return;
-}
+   return;
+}
+
+namespace {
+   /**
+    * \brief A simple secondary index: for each value (eg of a foreign key such as ingredient ID) the IDs of all objects
+    *        with that value.  We also keep the reverse mapping (object ID to value) so that we can tell when an
+    *        object's value has changed without having to know what it was before.
+    */
+   template<typename K>
+   class ValueIndex {
+   public:
+      void set(int const id, K const & value) {
+         auto existing = this->m_valueById.constFind(id);
+         if (existing != this->m_valueById.cend()) {
+            if (existing.value() == value) {
+               return;
+            }
+            this->removeFromSet(existing.value(), id);
+         }
+         this->m_valueById.insert(id, value);
+         this->m_idsByValue[value].insert(id);
+         return;
+      }
+
+      void remove(int const id) {
+         auto existing = this->m_valueById.constFind(id);
+         if (existing == this->m_valueById.cend()) {
+            return;
+         }
+         this->removeFromSet(existing.value(), id);
+         this->m_valueById.erase(existing);
+         return;
+      }
+
+      /**
+       * \return IDs in ascending order.  QSet doesn't give us any ordering, so we sort to at least give callers
+       *         consistent results.
+       */
+      QVector<int> ids(K const & value) const {
+         QVector<int> results;
+         auto matches = this->m_idsByValue.constFind(value);
+         if (matches != this->m_idsByValue.cend()) {
+            results.reserve(matches.value().size());
+            for (int const id : matches.value()) {
+               results.append(id);
+            }
+            std::sort(results.begin(), results.end());
+         }
+         return results;
+      }
+
+   private:
+      void removeFromSet(K const & value, int const id) {
+         auto matches = this->m_idsByValue.find(value);
+         if (matches != this->m_idsByValue.end()) {
+            matches.value().remove(id);
+            if (matches.value().isEmpty()) {
+               this->m_idsByValue.erase(matches);
+            }
+         }
+         return;
+      }
+
+      QHash<K, QSet<int>> m_idsByValue;
+      QHash<int, K> m_valueById;
+   };
+
+   /**
+    * \brief Index of object names, so that name clash resolution (see \c ObjectStoreUtils::normaliseName) is a lookup
+    *        rather than a search through all objects.  Names are simplified (as \c QString::simplified) before going in
+    *        the index, which is also how \c normaliseName compares them.
+    *
+    *        As well as which names are in use, for each "base" name (ie with any " (n)" suffix used to avoid name
+    *        clashes removed) we keep a count of the objects using each suffix number.  This means we can find the
+    *        highest number in use without looking at all the names with that base.
+    */
+   class NameIndex {
+   public:
+      void set(int const id, QString const & name) {
+         QString const simplifiedName = name.simplified();
+         auto existing = this->m_nameById.constFind(id);
+         if (existing != this->m_nameById.cend()) {
+            if (existing.value() == simplifiedName) {
+               return;
+            }
+            this->remove(id);
+         }
+         this->m_nameById.insert(id, simplifiedName);
+         ++this->m_countByName[simplifiedName];
+         auto const [baseName, number] = splitName(simplifiedName);
+         ++this->m_numberCountsByBaseName[baseName][number];
+         return;
+      }
+
+      void remove(int const id) {
+         auto existing = this->m_nameById.constFind(id);
+         if (existing == this->m_nameById.cend()) {
+            return;
+         }
+         QString const simplifiedName = existing.value();
+         this->m_nameById.erase(existing);
+
+         if (--this->m_countByName[simplifiedName] <= 0) {
+            this->m_countByName.remove(simplifiedName);
+         }
+         auto const [baseName, number] = splitName(simplifiedName);
+         auto numberCounts = this->m_numberCountsByBaseName.find(baseName);
+         if (numberCounts != this->m_numberCountsByBaseName.end()) {
+            if (--numberCounts.value()[number] <= 0) {
+               numberCounts.value().remove(number);
+            }
+            if (numberCounts.value().isEmpty()) {
+               this->m_numberCountsByBaseName.erase(numberCounts);
+            }
+         }
+         return;
+      }
+
+      bool contains(QString const & name) const {
+         return this->m_countByName.contains(name.simplified());
+      }
+
+      int highestNumber(QString const & baseName) const {
+         auto numberCounts = this->m_numberCountsByBaseName.constFind(baseName.simplified());
+         if (numberCounts == this->m_numberCountsByBaseName.cend()) {
+            return -1;
+         }
+         // QMap is sorted by key, so the last key is the highest
+         return numberCounts.value().lastKey();
+      }
+
+   private:
+      /**
+       * \brief Split, eg, "Foobar (2)" into "Foobar" and 2.  If there is no number on the end of the name, we return 0
+       *        for it.
+       */
+      static std::pair<QString, int> splitName(QString const & simplifiedName) {
+         QRegularExpressionMatch const match = NamedEntity::getDuplicateNameNumberMatcher().match(simplifiedName);
+         if (match.hasMatch()) {
+            return {simplifiedName.left(match.capturedStart(0)), match.captured(1).toInt()};
+         }
+         return {simplifiedName, 0};
+      }
+
+      QHash<int, QString> m_nameById;
+      QHash<QString, int> m_countByName;
+      QHash<QString, QMap<int, int>> m_numberCountsByBaseName;
+   };
+
+   /**
+    * \brief Property indexes are keyed on the string form of the property value.  This is fine for the sorts of things
+    *        we index (integer foreign keys and names) and saves us having to hash arbitrary QVariant values.
+    */
+   QString indexKeyFor(QVariant const & value) {
+      return value.toString();
+   }
+
+   //
+   // Write-behind state.  This is shared across all object stores because we want to flush all pending writes in a
+   // single transaction.
+   //
+   // There is deliberately no mutex here: this state (and the pending writes in each ObjectStore) must only be touched
+   // from the main thread.  That is the thread that owns the object model, so it is where all calls to
+   // ObjectStore::updateProperty come from, and it is where the flush timer fires.  Functions that use this state check
+   // isOnMainThread() in debug builds.
+   //
+   bool writeBehindEnabled = false;
+   bool flushScheduled = false;
+   QList<ObjectStore *> storesWithPendingWrites;
+
+   //
+   // How long after the first pending write we wait before flushing.  Zero means the flush happens as soon as control
+   // returns to the event loop, ie once whatever bulk operation (recipe scaling, import, etc) generated the writes has
+   // finished.
+   //
+   constexpr int writeBehindFlushDelay_ms = 0;
+
+   //
+   // If a flush fails, how long we wait before trying again.  The pending writes are retained, so a transient problem
+   // (eg the DB being locked by another process) should not cause anything to be lost.
+   //
+   constexpr int writeBehindRetryDelay_ms = 1000;
+
+   bool isOnMainThread() {
+      QCoreApplication const * const application = QCoreApplication::instance();
+      return !application || QThread::currentThread() == application->thread();
+   }
+
+   /**
+    * \brief Arrange for \c ObjectStore::flushAllPendingWrites to be called from the event loop, unless it already is
+    */
+   void scheduleFlush(int const delay_ms) {
+      Q_ASSERT(isOnMainThread());
+      if (!flushScheduled) {
+         flushScheduled = true;
+         QTimer::singleShot(delay_ms, []() { ObjectStore::flushAllPendingWrites(); });
+      }
+      return;
+   }
+}
+
+// This private implementation class holds all private non-virtual members of ObjectStore
+class ObjectStore::impl {
+public:
+
+   /**
+    * Constructor
+    */
+   impl(char const *                   const   className,
+        TypeLookup                     const & typeLookup,
+        TableDefinition                const & primaryTable,
+        JunctionTableDefinitions       const & junctionTables,
+        IndexedProperties              const & indexedProperties,
+        std::optional<LazyLoadOptions> const & lazyLoadOptions) : m_className{className},
+                                                                 m_state{ObjectStore::State::NotYetInitialised},
+                                                                 typeLookup{typeLookup},
+                                                                 primaryTable{primaryTable},
+                                                                 junctionTables{junctionTables},
+                                                                 indexedProperties{indexedProperties},
+                                                                 lazyLoadOptions{lazyLoadOptions},
+                                                                 m_allObjects{},
+                                                                 m_unhydrated{},
+                                                                 m_ownerIdGetter{},
+                                                                 m_ownerIndex{},
+                                                                 m_matchKeyProperty{nullptr},
+                                                                 m_matchKeyFunction{},
+                                                                 m_matchKeyIndex{},
+                                                                 m_nameIndex{},
+                                                                 m_pendingWrites{},
+                                                                 m_propertyIndexes{},
+                                                                 database{nullptr},
+                                                                 m_prefetched{} {
+      for (BtStringConst const * propertyName : indexedProperties) {
+         this->m_propertyIndexes.insert(**propertyName, ValueIndex<QString>{});
+      }
+      return;
+   }
+
+   ~impl() = default;
+
+   /**
+    * \brief Add or update the entries for the object with the supplied ID in the owner index and all the property
+    *        indexes.
+    *
+    *        It's cheap to ask an object for its owner ID, so we just do that and let the index work out whether
+    *        anything changed, rather than trying to work out which property names correspond to "owner ID" on which
+    *        classes.
+    */
+   void addToIndexes(int const id, QObject const & object) {
+      if (this->m_ownerIdGetter) {
+         this->m_ownerIndex.set(id, this->m_ownerIdGetter(object));
+      }
+      for (auto index = this->m_propertyIndexes.begin(); index != this->m_propertyIndexes.end(); ++index) {
+         index.value().set(id, indexKeyFor(object.property(index.key().toLatin1().constData())));
+      }
+      if (this->m_matchKeyProperty) {
+         this->m_matchKeyIndex.set(id, this->m_matchKeyFunction(object.property(**this->m_matchKeyProperty)));
+      }
+      this->m_nameIndex.set(id, object.property(*PropertyNames::NamedEntity::name).toString());
+      return;
+   }
+
+   /**
+    * \brief Equivalent of \c addToIndexes for an object in a lazy store that has not yet been hydrated, where all we
+    *        have is the raw data read from the DB.
+    */
+   void addToIndexes(int const id, QVector<QVariant> const & row) {
+      Q_ASSERT(this->lazyLoadOptions);
+      BtStringConst const * ownerIdProperty = this->lazyLoadOptions->ownerIdProperty;
+      if (ownerIdProperty) {
+         if (auto const ownerId = this->valueFromRow(row, *ownerIdProperty); ownerId) {
+            this->m_ownerIndex.set(id, ownerId->toInt());
+         }
+      }
+      for (BtStringConst const * propertyName : this->indexedProperties) {
+         if (auto const value = this->valueFromRow(row, *propertyName); value) {
+            this->m_propertyIndexes[**propertyName].set(id, indexKeyFor(*value));
+         }
+      }
+      if (this->m_matchKeyProperty) {
+         if (auto const value = this->valueFromRow(row, *this->m_matchKeyProperty); value) {
+            this->m_matchKeyIndex.set(id, this->m_matchKeyFunction(*value));
+         }
+      }
+      if (auto const name = this->valueFromRow(row, PropertyNames::NamedEntity::name); name) {
+         this->m_nameIndex.set(id, name->toString());
+      }
+      return;
+   }
+
+   /**
+    * \brief Called when a single property has changed to update the owner index and, if the property is indexed, its
+    *        index.
+    */
+   void updateIndexes(int const id, QObject const & object, BtStringConst const & propertyName) {
+      if (this->m_ownerIdGetter) {
+         this->m_ownerIndex.set(id, this->m_ownerIdGetter(object));
+      }
+      auto index = this->m_propertyIndexes.find(*propertyName);
+      if (index != this->m_propertyIndexes.end()) {
+         index.value().set(id, indexKeyFor(object.property(*propertyName)));
+      }
+      if (this->m_matchKeyProperty && *this->m_matchKeyProperty == propertyName) {
+         this->m_matchKeyIndex.set(id, this->m_matchKeyFunction(object.property(*propertyName)));
+      }
+      if (propertyName == PropertyNames::NamedEntity::name) {
+         this->m_nameIndex.set(id, object.property(*propertyName).toString());
+      }
+      return;
+   }
+
+   /**
+    * \brief Write all pending property changes for this store to the DB.  Caller is responsible for the transaction.
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool writePendingToDb(QSqlDatabase & connection) {
+      for (auto pending = this->m_pendingWrites.cbegin(); pending != this->m_pendingWrites.cend(); ++pending) {
+         // If the object got hard deleted in the meantime, we will already have discarded its pending writes, so it's a
+         // coding error if it's not in the cache.
+         auto object = this->m_allObjects.value(pending.key());
+         Q_ASSERT(object);
+         if (!object) {
+            continue;
+         }
+         for (BtStringConst const * propertyName : pending.value()) {
+            if (!this->updatePropertyInDb(connection, *object, *propertyName)) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   /**
+    * \brief Everything \c loadAll needs from the DB to create the objects for this store.  This is just plain data (no
+    *        QObjects), so it can be read in on one thread and used on another.
+    */
+   struct DataFromDb {
+      //! Primary key and raw column values for each row of the primary table -- see \c bundleFromRow
+      QVector<std::pair<int, QVector<QVariant>>> rows;
+      //! For each junction table (in the same order as \c junctionTables), map from our ID to the ordered list of
+      //  other IDs
+      QVector<QMap<int, QVector<int>>> junctionMappings;
+   };
+
+   /**
+    * \brief Run all the queries to read in the data for this store from the DB.  Defined below, out of the class
+    *        definition, as it's rather long.
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool readAllFromDb(DataFromDb & dataFromDb);
+
+   /**
+    * \brief Turn the raw column values for one row of the primary table (as read by \c readAllFromDb) into the
+    *        parameters for the object's constructor.
+    */
+   NamedParameterBundle bundleFromRow(QVector<QVariant> const & row) const {
+      NamedParameterBundle namedParameterBundle;
+      qsizetype columnIndex = 0;
+      for (auto const & fieldDefn : this->primaryTable.tableFields) {
+         qsizetype const firstColumnIndex = columnIndex;
+         columnIndex += fieldDefn.columnNames.size();
+         if (columnIndex > row.size()) {
+            // This shouldn't happen, as readAllFromDb always stores a value (albeit maybe an invalid one) for every
+            // column
+            qCritical() <<
+               Q_FUNC_INFO << "Only" << row.size() << "columns in row for" << this->primaryTable.tableName;
+            Q_ASSERT(false);
+            break;
+         }
+         auto const fieldValues = row.mid(firstColumnIndex, fieldDefn.columnNames.size());
+
+         // It's a coding error if we got the same parameter twice
+         Q_ASSERT(!namedParameterBundle.contains(fieldDefn.propertyName));
+
+         //
+         // It's a bit overkill to use a switch here, but we want the compiler to warn us if we add a new fieldType and
+         // don't update the code here.
+         //
+         switch (fieldDefn.fieldType) {
+            // Simple cases
+            case ObjectStore::FieldType::Bool  :
+            case ObjectStore::FieldType::Int   :
+            case ObjectStore::FieldType::UInt  :
+            case ObjectStore::FieldType::Double:
+            case ObjectStore::FieldType::String:
+            case ObjectStore::FieldType::Date  :
+            case ObjectStore::FieldType::Enum  :
+            case ObjectStore::FieldType::Unit  :
+               Q_ASSERT(fieldDefn.columnNames.size() == 1);
+               namedParameterBundle.insert(fieldDefn.propertyName, fieldValues[0]);
+               break;
+            case ObjectStore::FieldType::Money :
+               {
+                  QVariant currencyAmount;
+                  Q_ASSERT(fieldDefn.columnNames.size() == 2);
+                  if (this->typeLookup.getType(fieldDefn.propertyName).isOptional()) {
+                     //
+                     // For optional currency amounts, we only need to initialise this QVariant if both constituent
+                     // columns are not null
+                     //
+                     auto const isoAlphabeticCode = fieldValues[0].value<std::optional<QString>>();
+                     auto const totalAsCents      = fieldValues[1].value<std::optional<int    >>();
+                     if (isoAlphabeticCode && totalAsCents) {
+                        currencyAmount = QVariant::fromValue(
+                           std::optional<CurrencyAmount>{CurrencyAmount{*isoAlphabeticCode, *totalAsCents}}
+                        );
+                     }
+                  } else {
+                     auto const isoAlphabeticCode = fieldValues[0].value<QString>();
+                     auto const totalAsCents      = fieldValues[1].value<int    >();
+                     currencyAmount = QVariant::fromValue(CurrencyAmount{isoAlphabeticCode, totalAsCents});
+                  }
+
+                  namedParameterBundle.insert(fieldDefn.propertyName, currencyAmount);
+               }
+               break;
+            // NB: No default case as we want compiler to prompt us if we missed any type above.
+         }
+
+         // We assert that the insert always works!
+         Q_ASSERT(namedParameterBundle.contains(fieldDefn.propertyName));
+      }
+      return namedParameterBundle;
+   }
+
+   /**
+    * \brief Get the value of a single-column property from the raw column values for one row of the primary table.
+    *        Used for indexing objects that have not yet been hydrated, so we don't need to support multi-column
+    *        properties (eg \c FieldType::Money), which are never indexed.
+    *
+    * \return \c std::nullopt if the property is not in the primary table or is stored in more than one column
+    */
+   std::optional<QVariant> valueFromRow(QVector<QVariant> const & row, BtStringConst const & propertyName) const {
+      qsizetype columnIndex = 0;
+      for (auto const & fieldDefn : this->primaryTable.tableFields) {
+         if (fieldDefn.propertyName == propertyName) {
+            if (fieldDefn.columnNames.size() != 1 || columnIndex >= row.size()) {
+               return std::nullopt;
+            }
+            return row.at(columnIndex);
+         }
+         columnIndex += fieldDefn.columnNames.size();
+      }
+      return std::nullopt;
+   }
+
+   /**
+    * \brief Set on \c object the property for \c junctionTable from the "other" IDs we read for it from that table
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool setJunctionProperty(QObject & object,
+                            JunctionTableDefinition const & junctionTable,
+                            QVector<int> const & otherKeys) {
+      // We assert that we could not have created a mapping without at least one entry
+      Q_ASSERT(otherKeys.size() > 0);
 
-// This private implementation class holds all private non-virtual members of ObjectStore
-class ObjectStore::impl {
-public:
+      //
+      // Normally we'd pass a list of all the "other" keys for each "this" object, but if we've been told to assume
+      // there is at most one "other" per "this", then we'll pass just the first one we get back for each "this".
+      //
+      bool success = false;
+      if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
+         qDebug() <<
+            Q_FUNC_INFO << object.metaObject()->className() << ", " <<
+            GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << otherKeys.first();
+         success = object.setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable), otherKeys.first());
+      } else {
+         //
+         // The setProperty function always takes a QVariant, so we need to create one from the QList<QVariant> we
+         // have.  However, we need to be careful here.  There are several ways to get the call to setProperty wrong
+         // at runtime, which gives you a "false" return code but no diagnostics or log of why the call failed.
+         //
+         // In particular, we can't just shove a QList<QVariant> (ie otherKeys) inside a QVariant, because passing
+         // this to setProperty() (or equivalent calls via the metaObject) will cause Qt to attempt (and fail) to
+         // access a setter that takes QList<QVariant>.  We need a QVector<int> (ie what the setter expects) wrapped
+         // in a QVariant.
+         //
+         // To add to the challenge, despite QVariant having a huge number of constructors, none of them will accept
+         // QVector<int>, so, instead, you have to use the static function QVariant::fromValue to create a QVariant
+         // wrapper around QVector<int>.
+         //
+         QVariant wrappedConvertedOtherKeys = QVariant::fromValue(otherKeys);
+         qDebug() <<
+            Q_FUNC_INFO << object.metaObject()->className() << ", " <<
+            GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << otherKeys << "(" <<
+            wrappedConvertedOtherKeys << ")";
+         success = object.setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable),
+                                      wrappedConvertedOtherKeys);
+      }
+      if (!success) {
+         // This is a coding error - eg the property doesn't have a WRITE member function or it doesn't take the
+         // type of argument we supplied inside a QVariant.
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to set property" << GetJunctionTableDefinitionPropertyName(junctionTable) <<
+            "on" << object.metaObject()->className();
+         Q_ASSERT(false); // Stop here on a debug build
+      }
+      return success;
+   }
 
    /**
-    * Constructor
+    * \brief For a lazy store, create the object with the supplied ID if it has not already been created.  (Does nothing
+    *        if the object has already been hydrated or does not exist.)
+    *
+    *        Although this changes our internal state, it doesn't change what the store holds from the caller's point
+    *        of view, so it is OK to call from const member functions.  But it does mean that those functions (eg
+    *        \c getById) must only be called from the main thread, which owns all the objects.  See also comment in
+    *        \c ObjectStore::hydrateAll.
+    *
+    * \param self The store that owns us.  We need this to call \c createNewObject, which is virtual.
+    */
+   void hydrate(ObjectStore const & self, int const id) {
+      auto unhydrated = this->m_unhydrated.find(id);
+      if (unhydrated == this->m_unhydrated.end()) {
+         return;
+      }
+      Q_ASSERT(isOnMainThread());
+
+      // Take the data out of the hash before we create the object, so that, if anything we call ends up asking for the
+      // same object again, it won't get created twice.
+      UnhydratedObject data = std::move(unhydrated.value());
+      this->m_unhydrated.erase(unhydrated);
+
+      NamedParameterBundle namedParameterBundle = this->bundleFromRow(data.row);
+      auto object = self.createNewObject(namedParameterBundle);
+      this->m_allObjects.insert(id, object);
+      for (auto const & [junctionTableIndex, otherKeys] : data.junctionValues) {
+         // Any error will already have been logged, and there's not much else we can do
+         this->setJunctionProperty(*object, this->junctionTables.at(junctionTableIndex), otherKeys);
+      }
+      // The indexes should not change, but it doesn't hurt to make sure they are based on the object rather than the
+      // raw DB data.
+      this->addToIndexes(id, *object);
+
+      if (this->lazyLoadOptions->onHydrated) {
+         this->lazyLoadOptions->onHydrated(object);
+      }
+      return;
+   }
+
+   /**
+    * \brief For a lazy store, create all objects not already hydrated.  Needed by anything that wants to look at every
+    *        object in the store.
     */
-   impl(char const *             const   className,
-        TypeLookup               const & typeLookup,
-        TableDefinition          const & primaryTable,
-        JunctionTableDefinitions const & junctionTables) : m_className{className},
-                                                           m_state{ObjectStore::State::NotYetInitialised},
-                                                           typeLookup{typeLookup},
-                                                           primaryTable{primaryTable},
-                                                           junctionTables{junctionTables},
-                                                           m_allObjects{},
-                                                           database{nullptr} {
+   void hydrateAll(ObjectStore const & self) {
+      if (this->m_unhydrated.isEmpty()) {
+         return;
+      }
+      qDebug() <<
+         Q_FUNC_INFO << "Hydrating" << this->m_unhydrated.size() << "remaining objects in" << this->m_className;
+      for (int const id : this->m_unhydrated.keys()) {
+         this->hydrate(self, id);
+      }
       return;
    }
 
-   ~impl() = default;
+   /**
+    * \brief Remove the object with the supplied ID from all indexes
+    */
+   void removeFromIndexes(int const id) {
+      this->m_ownerIndex.remove(id);
+      for (auto index = this->m_propertyIndexes.begin(); index != this->m_propertyIndexes.end(); ++index) {
+         index.value().remove(id);
+      }
+      this->m_matchKeyIndex.remove(id);
+      this->m_nameIndex.remove(id);
+      return;
+   }
 
    /**
     * \brief This function does any required special handling for optional and/or enum fields retrieved from a
@@ -1289,33 +1947,17 @@ public:
    }
 
    /**
-    * \brief Insert an object in the database
+    * \brief Construct the SQL for inserting a row in our primary table, which will be of the form
     *
-    *        NB: Caller is responsible for handling transactions
+    *           INSERT INTO tablename (firstColumn, secondColumn, ...)
+    *           VALUES (:firstColumn, :secondColumn, ...);
     *
-    * \param connection
-    * \param object
-    * \param writePrimaryKey Normally this is \c false, meaning we are going to let the DB assign a primary key to the
-    *                        new object we are inserting.  However, if we are writing existing objects out to a new
-    *                        database, then this will be \c true, meaning we write out the existing primary keys (to
-    *                        keep any foreign key references to them valid.  (In this latter circumstance, we are also
-    *                        assuming the caller has disabled foreign key constraints for the duration of the
-    *                        transaction.)
+    *        Normally, we omit the primary key column because we can't know its value in advance.  We'll find out what
+    *        value the DB assigned to it after the query was run -- see \c insertObjectInDb.
     *
-    * \return the primary key of the inserted object, or -1 if there was an error.  Note that, in the case that
-    *         \c writePrimaryKey is \c false (ie we are inserting a new object), it is the \b caller's responsibility to
-    *         update the object with its new primary key.
+    * \param writePrimaryKey See \c insertObjectInDb
     */
-   int insertObjectInDb(QSqlDatabase & connection, QObject const & object, bool writePrimaryKey) {
-      //
-      // Construct the SQL, which will be of the form
-      //
-      //    INSERT INTO tablename (firstColumn, secondColumn, ...)
-      //    VALUES (:firstColumn, :secondColumn, ...);
-      //
-      // We omit the primary key column because we can't know its value in advance.  We'll find out what value the DB
-      // assigned to it after the query was run -- see below.
-      //
+   QString insertQueryString(bool const writePrimaryKey) {
       QString queryString{"INSERT INTO "};
       QTextStream queryStringAsStream{&queryString};
       queryStringAsStream << this->primaryTable.tableName << " (";
@@ -1323,18 +1965,17 @@ public:
       queryStringAsStream << ") VALUES (";
       this->appendColumnNames(queryStringAsStream, writePrimaryKey, true);
       queryStringAsStream << ");";
+      return queryString;
+   }
 
-      qDebug() <<
-         Q_FUNC_INFO << "Inserting" << object.metaObject()->className() << "main table row with database query " <<
-         queryString;
-      // Uncomment the following to track down errors where we're trying to insert an object to the database twice
-//      qDebug().noquote() << Q_FUNC_INFO << Logging::getStackTrace();
-
-      //
-      // Bind the values
-      //
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
+   /**
+    * \brief Calls \c functor with the column name and value to bind for each column of the row we would insert in our
+    *        primary table for \c object.  Columns are in the same order as output by \c appendColumnNames.
+    *
+    * \param writePrimaryKey See \c insertObjectInDb
+    */
+   template<typename Functor>
+   void forEachInsertBindValue(QObject const & object, bool const writePrimaryKey, Functor functor) {
       for (decltype(this->primaryTable.tableFields)::size_type fieldNum = (writePrimaryKey ? 0 : 1);
            fieldNum < this->primaryTable.tableFields.size();
            ++fieldNum) {
@@ -1342,7 +1983,7 @@ public:
 
          QVariant propertyValue{object.property(*fieldDefn.propertyName)};
          // Uncomment the following line if the assert below is firing
-         qDebug() << Q_FUNC_INFO << fieldDefn.propertyName << ":" << propertyValue;
+//         qDebug() << Q_FUNC_INFO << fieldDefn.propertyName << ":" << propertyValue;
 
          // It's a coding error if the property we are trying to read from does not exist
          Q_ASSERT(propertyValue.isValid());
@@ -1361,9 +2002,93 @@ public:
                propertyBindValues[ii] = QVariant();
             }
 
-            sqlQuery.bindValue(QString{":"} + *fieldDefn.columnNames[ii], propertyBindValues[ii]);
+            functor(fieldDefn.columnNames[ii], propertyBindValues[ii]);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Construct the SQL for inserting \c numRows rows in one go in our primary table, including the primary key
+    *        column, which will be of the form
+    *
+    *           INSERT INTO tablename (firstColumn, secondColumn, ...)
+    *           VALUES (?, ?, ...), (?, ?, ...), ...;
+    *
+    *        Used when writing everything to a new database -- see \c ObjectStore::writeAllToNewDb.
+    */
+   QString multiRowInsertQueryString(int const numRows) {
+      int numColumns = 0;
+      for (auto const & fieldDefn : this->primaryTable.tableFields) {
+         numColumns += fieldDefn.columnNames.size();
+      }
+      QString const rowPlaceholders = QString{"("} + QStringList(numColumns, "?").join(", ") + ")";
+
+      QString queryString{"INSERT INTO "};
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream << this->primaryTable.tableName << " (";
+      this->appendColumnNames(queryStringAsStream, true, false);
+      queryStringAsStream << ") VALUES ";
+      for (int rowNum = 0; rowNum < numRows; ++rowNum) {
+         if (rowNum > 0) {
+            queryStringAsStream << ", ";
          }
+         queryStringAsStream << rowPlaceholders;
+      }
+      queryStringAsStream << ";";
+      return queryString;
+   }
+
+   /**
+    * \brief Insert an object in the database
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \param connection
+    * \param object
+    * \param writePrimaryKey Normally this is \c false, meaning we are going to let the DB assign a primary key to the
+    *                        new object we are inserting.  However, if we are writing existing objects out to a new
+    *                        database, then this will be \c true, meaning we write out the existing primary keys (to
+    *                        keep any foreign key references to them valid.  (In this latter circumstance, we are also
+    *                        assuming the caller has disabled foreign key constraints for the duration of the
+    *                        transaction.)
+    *
+    * \param preparedQuery If not \c nullptr, a query already prepared with the SQL from \c insertQueryString (with
+    *                      the same \c writePrimaryKey).  This saves preparing the same statement over and over when we
+    *                      are inserting lots of objects -- see \c ObjectStore::insertAll.
+    *
+    * \return the primary key of the inserted object, or -1 if there was an error.  Note that, in the case that
+    *         \c writePrimaryKey is \c false (ie we are inserting a new object), it is the \b caller's responsibility to
+    *         update the object with its new primary key.
+    */
+   int insertObjectInDb(QSqlDatabase & connection,
+                        QObject const & object,
+                        bool writePrimaryKey,
+                        BtSqlQuery * preparedQuery = nullptr) {
+      std::optional<BtSqlQuery> ownQuery;
+      if (!preparedQuery) {
+         ownQuery.emplace(connection);
+         ownQuery->prepare(this->insertQueryString(writePrimaryKey));
       }
+      BtSqlQuery & sqlQuery = preparedQuery ? *preparedQuery : *ownQuery;
+
+      qDebug() <<
+         Q_FUNC_INFO << "Inserting" << object.metaObject()->className() << "main table row in" <<
+         this->primaryTable.tableName;
+      // Uncomment the following to track down errors where we're trying to insert an object to the database twice
+//      qDebug().noquote() << Q_FUNC_INFO << Logging::getStackTrace();
+
+      //
+      // Bind the values
+      //
+      this->forEachInsertBindValue(
+         object,
+         writePrimaryKey,
+         [&sqlQuery](BtStringConst const & columnName, QVariant const & bindValue) {
+            sqlQuery.bindValue(QString{":"} + *columnName, bindValue);
+            return;
+         }
+      );
 
       qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
 
@@ -1372,7 +2097,8 @@ public:
       //
       if (!sqlQuery.exec()) {
          qCritical() <<
-            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            Q_FUNC_INFO << "Error executing database query " << sqlQuery.lastQuery() << ": " <<
+            sqlQuery.lastError().text();
          return -1;
       }
 
@@ -1428,7 +2154,7 @@ public:
 
       qDebug() <<
          Q_FUNC_INFO << object.metaObject()->className() << "#" << primaryKeyInDb << "inserted in database using" <<
-         queryString;
+         sqlQuery.lastQuery();
 
       //
       // Now save data to the junction tables
@@ -1451,8 +2177,68 @@ public:
    TypeLookup const & typeLookup;
    TableDefinition const & primaryTable;
    JunctionTableDefinitions const & junctionTables;
+   IndexedProperties const indexedProperties;
+   std::optional<LazyLoadOptions> const lazyLoadOptions;
    QHash<int, std::shared_ptr<QObject> > m_allObjects;
+
+   //
+   // For a lazy store (see ObjectStore::LazyLoadOptions), the data read from the DB for each object that has not yet
+   // been created.  An object is either in m_allObjects or here, never both.
+   //
+   //
+   // We only keep the raw column values (see DataFromDb), rather than the NamedParameterBundle, as the latter is a hash
+   // keyed by property name, so takes several times as much memory per object.
+   //
+   struct UnhydratedObject {
+      QVector<QVariant> row;
+      //! Index into junctionTables and the "other" IDs from that junction table
+      QVector<std::pair<int, QVector<int>>> junctionValues;
+   };
+   QHash<int, UnhydratedObject> m_unhydrated;
+
+   //
+   // For stores of owned objects (eg MashStep, RecipeAdditionHop), this is how we get the owner ID from an object
+   // (empty for all other stores), and then an index from owner ID to the IDs of all objects with that owner.  This
+   // saves \c OwnedSet having to do a linear search of all objects in the store every time it wants to know what items
+   // an owner has.
+   //
+   std::function<int(QObject const &)> m_ownerIdGetter;
+   ValueIndex<int> m_ownerIndex;
+
+   //
+   // Index used for duplicate detection -- see ObjectStore::setMatchKey.  Empty (with null m_matchKeyProperty) if the
+   // store does not have a match key.
+   //
+   BtStringConst const * m_matchKeyProperty;
+   std::function<QString(QVariant const &)> m_matchKeyFunction;
+   ValueIndex<QString> m_matchKeyIndex;
+
+   //
+   // Names of all objects in the store (including ones not yet hydrated) -- see ObjectStore::containsName
+   //
+   NameIndex m_nameIndex;
+
+   //
+   // When write-behind is enabled, property changes that have not yet been written to the DB: for each object ID, the
+   // names of the changed properties.  We don't store values as we read the current value out of the object when we
+   // flush.
+   //
+   // NB: We store pointers to BtStringConst because property names are always the static constants in the
+   //     PropertyNames namespaces.
+   //
+   QHash<int, QSet<BtStringConst const *>> m_pendingWrites;
+
+   //
+   // Indexes on the properties declared as indexed by ObjectStoreTyped (eg ingredientId), keyed by property name
+   //
+   QHash<QString, ValueIndex<QString>> m_propertyIndexes;
+
    Database * database;
+
+   //
+   // Data read in by prefetchAll, waiting to be turned into objects by loadAll
+   //
+   std::optional<DataFromDb> m_prefetched;
 };
 
 QString ObjectStore::getDisplayName(ObjectStore::FieldType const fieldType) {
@@ -1471,11 +2257,18 @@ QString ObjectStore::getDisplayName(ObjectStore::FieldType const fieldType) {
    Q_UNREACHABLE();
 }
 
-ObjectStore::ObjectStore(char const *             const   className,
-                         TypeLookup               const & typeLookup,
-                         TableDefinition          const & primaryTable,
-                         JunctionTableDefinitions const & junctionTables) :
-   pimpl{ std::make_unique<impl>(className, typeLookup, primaryTable, junctionTables) } {
+ObjectStore::ObjectStore(char const *                   const   className,
+                         TypeLookup                     const & typeLookup,
+                         TableDefinition                const & primaryTable,
+                         JunctionTableDefinitions       const & junctionTables,
+                         IndexedProperties              const & indexedProperties,
+                         std::optional<LazyLoadOptions> const & lazyLoadOptions) :
+   pimpl{ std::make_unique<impl>(className,
+                                 typeLookup,
+                                 primaryTable,
+                                 junctionTables,
+                                 indexedProperties,
+                                 lazyLoadOptions) } {
    qDebug() << Q_FUNC_INFO << "Construct of object store for primary table" << this->pimpl->primaryTable.tableName;
    // We have seen a circumstance where primaryTable.tableName is null, which shouldn't be possible.  This is some
    // diagnostic to try to find out why.
@@ -1500,6 +2293,22 @@ QString ObjectStore::name() const {
    return this->pimpl->m_className;
 }
 
+ObjectStore::TableDefinition const & ObjectStore::primaryTable() const {
+   return this->pimpl->primaryTable;
+}
+
+ObjectStore::JunctionTableDefinitions const & ObjectStore::junctionTables() const {
+   return this->pimpl->junctionTables;
+}
+
+ObjectStore::IndexedProperties const & ObjectStore::indexedProperties() const {
+   return this->pimpl->indexedProperties;
+}
+
+std::optional<ObjectStore::LazyLoadOptions> const & ObjectStore::lazyLoadOptions() const {
+   return this->pimpl->lazyLoadOptions;
+}
+
 ObjectStore::State ObjectStore::state() const {
    return this->pimpl->m_state;
 }
@@ -1558,25 +2367,31 @@ bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connec
    return true;
 }
 
-void ObjectStore::loadAll(Database * database) {
-   // Assume we failed until we succeed!  (This saves us having to remember to set the error state in every error
-   // branch.  Instead, we just have to set the all OK state at the end of this function.)
-   this->pimpl->m_state = ObjectStore::State::ErrorInitialising;
+bool ObjectStore::createIndexes([[maybe_unused]] Database & database, QSqlDatabase & connection) const {
+   // Again, same structure as createTables()
+   if (!createIndexesOnTable(connection, this->pimpl->primaryTable)) {
+      return false;
+   }
 
-   if (database) {
-      this->pimpl->database = database;
-   } else {
-      this->pimpl->database = &Database::instance();
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      if (!createIndexesOnTable(connection, junctionTable)) {
+         return false;
+      }
    }
 
+   return true;
+}
+
+bool ObjectStore::impl::readAllFromDb(DataFromDb & dataFromDb) {
+   Q_ASSERT(this->database);
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    //
    // .:TBD:. In theory we don't need a transaction if we're _only_ reading data...
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database,
+   QSqlDatabase connection = this->database->sqlDatabase();
+   DbTransaction dbTransaction{*this->database,
                                connection,
-                               QString("Load All %1").arg(*this->pimpl->primaryTable.tableName)};
+                               QString("Load All %1").arg(*this->primaryTable.tableName)};
 
    //
    // Using QSqlTableModel would save us having to write a SELECT statement, however it is a bit hard to use it to
@@ -1590,18 +2405,18 @@ void ObjectStore::loadAll(Database * database) {
    //
    QString queryString{"SELECT "};
    QTextStream queryStringAsStream{&queryString};
-   this->pimpl->appendColumnNames(queryStringAsStream, true, false);
-   queryStringAsStream << "\n FROM " << this->pimpl->primaryTable.tableName << ";";
+   this->appendColumnNames(queryStringAsStream, true, false);
+   queryStringAsStream << "\n FROM " << this->primaryTable.tableName << ";";
    BtSqlQuery sqlQuery{connection};
    sqlQuery.prepare(queryString);
    if (!sqlQuery.exec()) {
       qCritical() <<
          Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return;
+      return false;
    }
 
    qDebug() <<
-      Q_FUNC_INFO << "Reading main table rows from" << this->pimpl->primaryTable.tableName <<
+      Q_FUNC_INFO << "Reading main table rows from" << this->primaryTable.tableName <<
       "database table using query " << queryString;
 
    while (sqlQuery.next()) {
@@ -1638,116 +2453,48 @@ void ObjectStore::loadAll(Database * database) {
       // Method (ii) is therefore our preferred approach.  We use NamedParameterBundle, which is a simple extension of
       // QHash.
       //
-      NamedParameterBundle namedParameterBundle;
-      int primaryKey = -1;
-
-      //
-      // Populate all the fields
-      // By convention, the primary key should be listed as the first field
-      //
-      // NB: For now we're assuming that the primary key is always an integer, but it would not be enormous work to
-      //     allow a wider range of types.
+      // Here, we just read the raw column values.  They get turned into a NamedParameterBundle by bundleFromRow when
+      // the object is created (which, for a lazy store, might be a lot later, or never).
       //
-      bool readPrimaryKey = false;
-      for (auto const & fieldDefn : this->pimpl->primaryTable.tableFields) {
-         QVector<QVariant> fieldValues;
+      QVector<QVariant> row;
+      row.reserve(this->primaryTable.tableFields.size());
+      for (auto const & fieldDefn : this->primaryTable.tableFields) {
          for (int colNum = 0; colNum < fieldDefn.columnNames.size(); ++colNum) {
             auto const & columnName = fieldDefn.columnNames[colNum];
 
-            fieldValues.emplace(colNum, sqlQuery.value(*columnName));
+            QVariant & columnValue = row.emplace_back(sqlQuery.value(*columnName));
 
             // Leave this log statement commented out normally as it generates too much output, but uncomment it if
             // asserts below are firing
 //            qDebug() <<
-//               Q_FUNC_INFO << "Reading col" << columnName << "(=" << fieldValues[colNum] << ") into property" <<
+//               Q_FUNC_INFO << "Reading col" << columnName << "(=" << columnValue << ") into property" <<
 //               fieldDefn.propertyName;
-            if (!fieldValues[colNum].isValid()) {
+            if (!columnValue.isValid()) {
                qCritical() <<
-                  Q_FUNC_INFO << "Error reading column " << columnName << " (" << fieldValues[colNum].toString() <<
-                  ") from database table " << this->pimpl->primaryTable.tableName << ". SQL error message: " <<
+                  Q_FUNC_INFO << "Error reading column " << columnName << " (" << columnValue.toString() <<
+                  ") from database table " << this->primaryTable.tableName << ". SQL error message: " <<
                   sqlQuery.lastError().text();
-               break;
+               continue;
             }
 
             // Fix-up the QVariant if needed, including converting enum string representation to int
-            this->pimpl->wrapAndUnmapAsNeeded(this->pimpl->primaryTable, fieldDefn, colNum, fieldValues[colNum]);
-         }
-
-         // It's a coding error if we got the same parameter twice
-         Q_ASSERT(!namedParameterBundle.contains(fieldDefn.propertyName));
-
-         //
-         // It's a bit overkill to use a switch here, but we want the compiler to warn us if we add a new fieldType and
-         // don't update the code here.
-         //
-         switch (fieldDefn.fieldType) {
-            // Simple cases
-            case ObjectStore::FieldType::Bool  :
-            case ObjectStore::FieldType::Int   :
-            case ObjectStore::FieldType::UInt  :
-            case ObjectStore::FieldType::Double:
-            case ObjectStore::FieldType::String:
-            case ObjectStore::FieldType::Date  :
-            case ObjectStore::FieldType::Enum  :
-            case ObjectStore::FieldType::Unit  :
-               Q_ASSERT(fieldDefn.columnNames.size() == 1);
-               namedParameterBundle.insert(fieldDefn.propertyName, fieldValues[0]);
-               break;
-            case ObjectStore::FieldType::Money :
-               {
-                  QVariant currencyAmount;
-                  Q_ASSERT(fieldDefn.columnNames.size() == 2);
-                  if (this->pimpl->typeLookup.getType(fieldDefn.propertyName).isOptional()) {
-                     //
-                     // For optional currency amounts, we only need to initialise this QVariant if both constituent columns
-                     // are not null
-                     //
-                     auto const isoAlphabeticCode = fieldValues[0].value<std::optional<QString>>();
-                     auto const totalAsCents      = fieldValues[1].value<std::optional<int    >>();
-                     if (isoAlphabeticCode && totalAsCents) {
-                        currencyAmount = QVariant::fromValue(
-                           std::optional<CurrencyAmount>{CurrencyAmount{*isoAlphabeticCode, *totalAsCents}}
-                        );
-                     }
-                  } else {
-                     auto const isoAlphabeticCode = fieldValues[0].value<QString>();
-                     auto const totalAsCents      = fieldValues[1].value<int    >();
-                     currencyAmount = QVariant::fromValue(CurrencyAmount{isoAlphabeticCode, totalAsCents});
-                  }
-
-                  namedParameterBundle.insert(fieldDefn.propertyName, currencyAmount);
-               }
-               break;
-            // NB: No default case as we want compiler to prompt us if we missed any type above.
-         }
-
-         // We assert that the insert always works!
-         Q_ASSERT(namedParameterBundle.contains(fieldDefn.propertyName));
-
-         if (!readPrimaryKey) {
-            readPrimaryKey = true;
-            Q_ASSERT(fieldDefn.fieldType == ObjectStore::FieldType::Int);
-            primaryKey = fieldValues[0].toInt();
+            this->wrapAndUnmapAsNeeded(this->primaryTable, fieldDefn, colNum, columnValue);
          }
       }
 
-      // Get a new object...
-      auto object = this->createNewObject(namedParameterBundle);
-
-      // ...and store it
-      // It's a coding error if we have two objects with the same primary key
-      Q_ASSERT(!this->pimpl->m_allObjects.contains(primaryKey));
-      this->pimpl->m_allObjects.insert(primaryKey, object);
-      // Normally leave this debug output commented, as it generates a lot of logging at start-up, but can be useful to
-      // enable for debugging.
-//      qDebug() <<
-//         Q_FUNC_INFO << "Cached" << object->metaObject()->className() << "#" << primaryKey << "in" <<
-//         this->metaObject()->className();
+      //
+      // By convention, the primary key should be listed as the first field
+      //
+      // NB: For now we're assuming that the primary key is always an integer, but it would not be enormous work to
+      //     allow a wider range of types.
+      //
+      Q_ASSERT(this->primaryTable.tableFields.front().fieldType == ObjectStore::FieldType::Int);
+      int const primaryKey = row.value(0).toInt();
+      dataFromDb.rows.append(std::make_pair(primaryKey, std::move(row)));
    }
 
    qDebug() <<
-      Q_FUNC_INFO << "Read" << this->pimpl->m_allObjects.size() << "entries from primary table" <<
-      this->pimpl->primaryTable.tableName;
+      Q_FUNC_INFO << "Read" << dataFromDb.rows.size() << "entries from primary table" << this->primaryTable.tableName;
 
    //
    // Now we load the data from the junction tables.  This, pretty much by definition, isn't needed for the object's
@@ -1756,7 +2503,7 @@ void ObjectStore::loadAll(Database * database) {
    // optimising every single SQL query (because the amount of data in the DB is not enormous), we prefer the
    // simplicity of separate queries.
    //
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
+   for (auto const & junctionTable : this->junctionTables) {
       qDebug() <<
          Q_FUNC_INFO << "Reading junction table " << junctionTable.tableName << " into " <<
          GetJunctionTableDefinitionPropertyName(junctionTable);
@@ -1782,14 +2529,14 @@ void ObjectStore::loadAll(Database * database) {
       if (!sqlQuery.exec()) {
          qCritical() <<
             Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-         return;
+         return false;
       }
 
       qDebug() << Q_FUNC_INFO << "Reading junction table rows from database query " << queryString;
 
       //
-      // The simplest way to process the data is first to build the ID-to-ordered-list-of-IDs map in memory, then loop
-      // through this to pass the data to the relevant objects.
+      // The simplest way to process the data is first to build the ID-to-ordered-list-of-IDs map in memory.  (Then, in
+      // ObjectStore::loadAll, we loop through this to pass the data to the relevant objects.)
       //
       int previousPrimaryKey = -1;
       QMap< int, QVector<int> > thisToOtherKeys;
@@ -1807,6 +2554,82 @@ void ObjectStore::loadAll(Database * database) {
          thisToOtherKeys[thisPrimaryKey].append(otherPrimaryKey);
       }
 
+      dataFromDb.junctionMappings.append(thisToOtherKeys);
+   }
+
+   dbTransaction.commit();
+   return true;
+}
+
+void ObjectStore::loadAll(Database * database) {
+   // Assume we failed until we succeed!  (This saves us having to remember to set the error state in every error
+   // branch.  Instead, we just have to set the all OK state at the end of this function.)
+   this->pimpl->m_state = ObjectStore::State::ErrorInitialising;
+
+   if (database) {
+      this->pimpl->database = database;
+   } else {
+      this->pimpl->database = &Database::instance();
+   }
+
+   QElapsedTimer timer;
+   timer.start();
+   bool const usingPrefetchedData = this->pimpl->m_prefetched.has_value();
+
+   //
+   // If the data has already been read in for us (see prefetchAll) then we use that, otherwise we read it now.
+   //
+   impl::DataFromDb dataFromDb;
+   if (this->pimpl->m_prefetched) {
+      dataFromDb = std::move(*this->pimpl->m_prefetched);
+      this->pimpl->m_prefetched.reset();
+   } else if (!this->pimpl->readAllFromDb(dataFromDb)) {
+      return;
+   }
+
+   //
+   // It's a coding error to have a lazy store of owned objects without telling us which field holds the owner ID, as we
+   // would not be able to maintain the owner index.
+   //
+   Q_ASSERT(!this->pimpl->lazyLoadOptions ||
+            !this->pimpl->m_ownerIdGetter ||
+            this->pimpl->lazyLoadOptions->ownerIdProperty);
+
+   for (auto & [primaryKey, row] : dataFromDb.rows) {
+      // It's a coding error if we have two objects with the same primary key
+      Q_ASSERT(!this->contains(primaryKey));
+
+      //
+      // For a lazy store, we just hang on to the data until someone asks for the object.  We still need to index it
+      // though.
+      //
+      if (this->pimpl->lazyLoadOptions) {
+         this->pimpl->addToIndexes(primaryKey, row);
+         this->pimpl->m_unhydrated.insert(primaryKey, impl::UnhydratedObject{std::move(row), {}});
+         continue;
+      }
+
+      // Get a new object...
+      NamedParameterBundle namedParameterBundle = this->pimpl->bundleFromRow(row);
+      auto object = this->createNewObject(namedParameterBundle);
+
+      // ...and store it
+      this->pimpl->m_allObjects.insert(primaryKey, object);
+      this->pimpl->addToIndexes(primaryKey, *object);
+      // Normally leave this debug output commented, as it generates a lot of logging at start-up, but can be useful to
+      // enable for debugging.
+//      qDebug() <<
+//         Q_FUNC_INFO << "Cached" << object->metaObject()->className() << "#" << primaryKey << "in" <<
+//         this->metaObject()->className();
+   }
+
+   //
+   // Now we apply the data from the junction tables.  This, pretty much by definition, isn't needed for the object's
+   // constructor, so we're OK to do it separately.
+   //
+   for (int junctionTableIndex = 0; junctionTableIndex < this->pimpl->junctionTables.size(); ++junctionTableIndex) {
+      auto const & junctionTable = this->pimpl->junctionTables.at(junctionTableIndex);
+      auto const & thisToOtherKeys = dataFromDb.junctionMappings.at(junctionTableIndex);
       for (auto currentMapping = thisToOtherKeys.cbegin();
            currentMapping != thisToOtherKeys.cend();
            ++currentMapping) {
@@ -1821,69 +2644,32 @@ void ObjectStore::loadAll(Database * database) {
             continue;
          }
 
-         auto currentObject = this->getById(currentMapping.key());
-
-         // We assert that we could not have created a mapping without at least one entry
-         Q_ASSERT(currentMapping.value().size() > 0);
-
-         //
-         // Normally we'd pass a list of all the "other" keys for each "this" object, but if we've been told to assume
-         // there is at most one "other" per "this", then we'll pass just the first one we get back for each "this".
-         //
-         bool success = false;
-         if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
-            qDebug() <<
-               Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << currentMapping.key() << ", " <<
-               GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << currentMapping.value().first();
-            success = currentObject->setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable),
-                                                 currentMapping.value().first());
-         } else {
-            //
-            // The setProperty function always takes a QVariant, so we need to create one from the QList<QVariant> we
-            // have.  However, we need to be careful here.  There are several ways to get the call to setProperty wrong
-            // at runtime, which gives you a "false" return code but no diagnostics or log of why the call failed.
-            //
-            // In particular, we can't just shove a QList<QVariant> (ie otherKeys) inside a QVariant, because passing
-            // this to setProperty() (or equivalent calls via the metaObject) will cause Qt to attempt (and fail) to
-            // access a setter that takes QList<QVariant>.  We need a QVector<int> (ie what the setter expects) wrapped
-            // in a QVariant.
-            //
-            // To add to the challenge, despite QVariant having a huge number of constructors, none of them will accept
-            // QVector<int>, so, instead, you have to use the static function QVariant::fromValue to create a QVariant
-            // wrapper around QVector<int>.
-            //
-            QVariant wrappedConvertedOtherKeys = QVariant::fromValue(currentMapping.value());
-            qDebug() <<
-               Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << currentMapping.key() << ", " <<
-               GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << currentMapping.value() << "(" <<
-               wrappedConvertedOtherKeys << ")";
-            success = currentObject->setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable),
-                                                 wrappedConvertedOtherKeys);
+         // For an object not yet hydrated, we just keep the data until we need it
+         auto unhydrated = this->pimpl->m_unhydrated.find(currentMapping.key());
+         if (unhydrated != this->pimpl->m_unhydrated.end()) {
+            unhydrated->junctionValues.append(std::make_pair(junctionTableIndex, currentMapping.value()));
+            continue;
          }
-         if (!success) {
-            // This is a coding error - eg the property doesn't have a WRITE member function or it doesn't take the
-            // type of argument we supplied inside a QVariant.
-            qCritical() <<
-               Q_FUNC_INFO << "Unable to set property" << GetJunctionTableDefinitionPropertyName(junctionTable) <<
-               "on" << currentObject->metaObject()->className();
-            Q_ASSERT(false); // Stop here on a debug build
-            return;          // Continue but abort the transaction on a non-debug build
+
+         auto currentObject = this->getById(currentMapping.key());
+         if (!this->pimpl->setJunctionProperty(*currentObject, junctionTable, currentMapping.value())) {
+            return; // Continue but leave the store in error state on a non-debug build
          }
 
          // This is useful for debugging but I usually leave it commented out as it generates a lot of logging at
          // start-up
 //         qDebug() <<
-//            Q_FUNC_INFO << "Set" <<
-//            (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY ? 1 : otherKeys.size()) <<
+//            Q_FUNC_INFO << "Set" << currentMapping.value().size() <<
 //            GetJunctionTableDefinitionPropertyName(junctionTable).c_str() << "property for" <<
-//            currentObject->metaObject()->className() << "#" << currentKey;
+//            currentObject->metaObject()->className() << "#" << currentMapping.key();
 
       }
    }
 
-   dbTransaction.commit();
-
-   qInfo() << Q_FUNC_INFO << "Read" << this->size() << "objects from DB table" << this->pimpl->primaryTable.tableName;
+   qInfo() <<
+      Q_FUNC_INFO << "Read" << this->size() << "objects from DB table" << this->pimpl->primaryTable.tableName << "in" <<
+      timer.elapsed() << "ms" << (usingPrefetchedData ? "(using prefetched data)" : "") <<
+      (this->pimpl->lazyLoadOptions ? "(lazy loading)" : "");
 
    // If we made it this far, everything must have loaded in OK (otherwise we'd have bailed out above).
    this->pimpl->m_state = ObjectStore::State::InitialisedOk;
@@ -1891,15 +2677,61 @@ void ObjectStore::loadAll(Database * database) {
    return;
 }
 
+bool ObjectStore::prefetchAll(Database * database) {
+   this->pimpl->database = database ? database : &Database::instance();
+
+   QElapsedTimer timer;
+   timer.start();
+
+   impl::DataFromDb dataFromDb;
+   bool succeeded = false;
+   //
+   // On a worker thread, an exception escaping would terminate the program, and it would anyway skip closing the
+   // connection below.  (In particular, Database::sqlDatabase() throws a QString if it can't open a connection.)  The
+   // store can always fall back to reading the DB itself in loadAll, so we just log the problem.
+   //
+   try {
+      succeeded = this->pimpl->readAllFromDb(dataFromDb);
+   } catch (QString const & errorMessage) {
+      qCritical() << Q_FUNC_INFO << "Error reading" << this->pimpl->primaryTable.tableName << ":" << errorMessage;
+   } catch (std::exception const & exception) {
+      qCritical() << Q_FUNC_INFO << "Error reading" << this->pimpl->primaryTable.tableName << ":" << exception.what();
+   }
+
+   //
+   // A worker thread won't use its DB connection again, and Qt requires that the connection be removed on the thread
+   // that created it, so we do that now rather than leave it for Database::unload() to do (wrongly) on the main thread.
+   //
+   if (!isOnMainThread()) {
+      this->pimpl->database->closeConnectionForThisThread();
+   }
+
+   if (!succeeded) {
+      qWarning() <<
+         Q_FUNC_INFO << "Could not prefetch" << this->pimpl->primaryTable.tableName << "- will read it in loadAll";
+      return false;
+   }
+
+   qInfo() <<
+      Q_FUNC_INFO << "Prefetched" << dataFromDb.rows.size() << "rows from DB table" <<
+      this->pimpl->primaryTable.tableName << "in" << timer.elapsed() << "ms";
+   this->pimpl->m_prefetched = std::move(dataFromDb);
+   return true;
+}
+
 size_t ObjectStore::size() const {
-   return this->pimpl->m_allObjects.size();
+   return this->pimpl->m_allObjects.size() + this->pimpl->m_unhydrated.size();
 }
 
 bool ObjectStore::contains(int id) const {
-   return this->pimpl->m_allObjects.contains(id);
+   return this->pimpl->m_allObjects.contains(id) || this->pimpl->m_unhydrated.contains(id);
 }
 
 std::shared_ptr<QObject> ObjectStore::getById(int id) const {
+   // Hydrating an object doesn't change what the store holds from the caller's point of view, so we allow it in const
+   // member functions -- see comment in impl::hydrate.
+   this->pimpl->hydrate(*this, id);
+
    // Callers should always check that the object they are requesting exists.  However, if a caller does request
    // something invalid, then we at least want to log that for debugging.
    if (!this->pimpl->m_allObjects.contains(id)) {
@@ -1913,6 +2745,7 @@ std::shared_ptr<QObject> ObjectStore::getById(int id) const {
 QList<std::shared_ptr<QObject> > ObjectStore::getByIds(QVector<int> const & listOfIds) const {
    QList<std::shared_ptr<QObject> > listToReturn;
    for (auto id : listOfIds) {
+      this->pimpl->hydrate(*this, id);
       if (this->pimpl->m_allObjects.contains(id)) {
          listToReturn.append(this->pimpl->m_allObjects.value(id));
       } else {
@@ -1940,6 +2773,7 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
    //
    Q_ASSERT(!this->pimpl->m_allObjects.contains(primaryKey));
    this->pimpl->m_allObjects.insert(primaryKey, object);
+   this->pimpl->addToIndexes(primaryKey, *object);
 
    // Everything succeeded if we got this far so we can wrap up the transaction
    dbTransaction.commit();
@@ -1965,6 +2799,82 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
    return primaryKey;
 }
 
+QList<int> ObjectStore::insertAll(QList<std::shared_ptr<QObject>> const & objects) {
+   QList<int> primaryKeys;
+   if (objects.isEmpty()) {
+      return primaryKeys;
+   }
+   primaryKeys.reserve(objects.size());
+
+   QElapsedTimer timer;
+   timer.start();
+
+   {
+      // Start transaction
+      // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
+      QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+      DbTransaction dbTransaction{*this->pimpl->database,
+                                  connection,
+                                  QString("Insert all %1").arg(*this->pimpl->primaryTable.tableName)};
+
+      //
+      // The INSERT statement is the same for every object, so we only need to prepare it once.  BtSqlQuery is happy to
+      // have new values bound and be re-executed as many times as we like.
+      //
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare(this->pimpl->insertQueryString(false));
+
+      for (auto const & object : objects) {
+         int const primaryKey = this->pimpl->insertObjectInDb(connection, *object, false, &sqlQuery);
+         if (primaryKey <= 0) {
+            // insertObjectInDb will already have logged the details
+            qCritical() <<
+               Q_FUNC_INFO << "Aborting insert of" << objects.size() << "rows in" <<
+               this->pimpl->primaryTable.tableName << "after" << primaryKeys.size() << "rows";
+            return QList<int>{};
+         }
+         primaryKeys.append(primaryKey);
+      }
+
+      // Everything succeeded if we got this far so we can wrap up the transaction
+      dbTransaction.commit();
+   }
+
+   //
+   // As in insert(), we only update the cache and tell the objects their primary keys once the transaction is
+   // finished.  (Doing it this way round also means there is nothing to undo in the cache if the insert fails part-way
+   // through.)
+   //
+   BtStringConst const & primaryKeyProperty = this->pimpl->getPrimaryKeyProperty();
+   for (int ii = 0; ii < objects.size(); ++ii) {
+      auto const & object = objects[ii];
+      int const primaryKey = primaryKeys[ii];
+      Q_ASSERT(!this->pimpl->m_allObjects.contains(primaryKey));
+      this->pimpl->m_allObjects.insert(primaryKey, object);
+      this->pimpl->addToIndexes(primaryKey, *object);
+
+      bool setPrimaryKeyOk = object->setProperty(*primaryKeyProperty, primaryKey);
+      if (!setPrimaryKeyOk) {
+         // This is a coding error - see comment in insert()
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to set property" << primaryKeyProperty << "on" << object->metaObject()->className();
+         Q_ASSERT(false);
+      }
+   }
+
+   //
+   // Tell any bits of the UI that need to know that there are new objects
+   //
+   for (int const primaryKey : primaryKeys) {
+      emit this->signalObjectInserted(primaryKey);
+   }
+
+   qInfo() <<
+      Q_FUNC_INFO << "Inserted" << primaryKeys.size() << "rows in" << this->pimpl->primaryTable.tableName << "in" <<
+      timer.elapsed() << "ms";
+   return primaryKeys;
+}
+
 void ObjectStore::update(std::shared_ptr<QObject> object) {
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
@@ -2087,6 +2997,12 @@ void ObjectStore::update(std::shared_ptr<QObject> object) {
    }
 
    dbTransaction.commit();
+
+   // We just wrote every column, so any pending writes for this object are now redundant
+   this->pimpl->m_pendingWrites.remove(primaryKey.toInt());
+
+   // We don't know what changed, so we just make sure the indexes are up-to-date
+   this->pimpl->addToIndexes(primaryKey.toInt(), *object);
    return;
 }
 
@@ -2127,25 +3043,44 @@ int ObjectStore::insertOrUpdate(QObject & object) {
 }
 
 void ObjectStore::updateProperty(QObject const & object, BtStringConst const & propertyName) {
-   // Start transaction
-   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{
-      *this->pimpl->database,
-      connection,
-      QString("Update property %1 on %2").arg(*propertyName).arg(*this->pimpl->primaryTable.tableName)
-   };
+   int const primaryKey = this->pimpl->getPrimaryKey(object).toInt();
 
-   if (!this->pimpl->updatePropertyInDb(connection, object, propertyName)) {
-      // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
-      return;
+   if (writeBehindEnabled) {
+      Q_ASSERT(isOnMainThread());
+      //
+      // Just note that the property needs writing.  If it was already pending, this is a no-op, which is the whole
+      // point: setting the same property (or several properties on the same object) many times in quick succession
+      // results in one UPDATE per property, all in one transaction.
+      //
+      this->pimpl->m_pendingWrites[primaryKey].insert(&propertyName);
+      if (!storesWithPendingWrites.contains(this)) {
+         storesWithPendingWrites.append(this);
+      }
+      scheduleFlush(writeBehindFlushDelay_ms);
+   } else {
+      // Start transaction
+      // (By the magic of RAII, this will abort if we return from this block without calling dbTransaction.commit()
+      QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+      DbTransaction dbTransaction{
+         *this->pimpl->database,
+         connection,
+         QString("Update property %1 on %2").arg(*propertyName).arg(*this->pimpl->primaryTable.tableName)
+      };
+
+      if (!this->pimpl->updatePropertyInDb(connection, object, propertyName)) {
+         // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
+         return;
+      }
+
+      // Everything went fine so we can commit the transaction
+      dbTransaction.commit();
    }
 
-   // Everything went fine so we can commit the transaction
-   dbTransaction.commit();
+   // If the property that changed is indexed (including being the owner ID), we need to update the index
+   this->pimpl->updateIndexes(primaryKey, object, propertyName);
 
    // Tell any bits of the UI that need to know that the property was updated
-   emit this->signalPropertyChanged(this->pimpl->getPrimaryKey(object).toInt(), propertyName);
+   emit this->signalPropertyChanged(primaryKey, propertyName);
 
    return;
 }
@@ -2156,9 +3091,26 @@ std::shared_ptr<QObject> ObjectStore::defaultSoftDelete(int id) {
    // deleted but remains in the DB) then there isn't actually anything we need to do with its MashSteps.
    //
    qDebug() << Q_FUNC_INFO << "Soft delete" << this->pimpl->m_className << "#" << id;
+   // We need the object to exist so we can pass it out in the signal below
+   this->pimpl->hydrate(*this, id);
    auto object = this->pimpl->m_allObjects.value(id);
    if (this->pimpl->m_allObjects.contains(id)) {
+      //
+      // The object is leaving our cache, so make sure any pending changes to it are written first.  If that fails, the
+      // pending changes are still queued (and will be retried), but they can only be written while the object is in
+      // the cache, so we have to leave it there.
+      //
+      if (this->pimpl->m_pendingWrites.contains(id)) {
+         ObjectStore::flushAllPendingWrites();
+         if (this->pimpl->m_pendingWrites.contains(id)) {
+            qWarning() <<
+               Q_FUNC_INFO << "Not removing" << this->pimpl->m_className << "#" << id << "from cache as unable to "
+               "write its pending changes to the DB";
+            return object;
+         }
+      }
       this->pimpl->m_allObjects.remove(id);
+      this->pimpl->removeFromIndexes(id);
 
       // Tell any bits of the UI that need to know that an object was deleted
       emit this->signalObjectDeleted(id, object);
@@ -2175,6 +3127,8 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
    // generically.
    //
    qDebug() << Q_FUNC_INFO << "Hard delete" << this->pimpl->m_className << "#" << id;
+   // As in defaultSoftDelete, we need the object to exist so we can return it
+   this->pimpl->hydrate(*this, id);
    auto object = this->pimpl->m_allObjects.value(id);
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
    DbTransaction dbTransaction{*this->pimpl->database,
@@ -2244,6 +3198,8 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
    // Remove the object from the cache
    //
    this->pimpl->m_allObjects.remove(id);
+   this->pimpl->removeFromIndexes(id);
+   this->pimpl->m_pendingWrites.remove(id);
 
    // Tell any bits of the UI that need to know that an object was deleted
    emit this->signalObjectDeleted(id, object);
@@ -2254,6 +3210,7 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
 std::shared_ptr<QObject> ObjectStore::findFirstMatching(
    std::function<bool(std::shared_ptr<QObject>)> const & matchFunction
 ) const {
+   this->pimpl->hydrateAll(*this);
    auto result = std::find_if(this->pimpl->m_allObjects.cbegin(), this->pimpl->m_allObjects.cend(), matchFunction);
    if (result == this->pimpl->m_allObjects.cend()) {
       return nullptr;
@@ -2268,6 +3225,7 @@ std::optional< QObject * > ObjectStore::findFirstMatching(std::function<bool(QOb
    auto wrapperMatchFunction {
       [matchFunction](std::shared_ptr<QObject> obj) {return matchFunction(obj.get());}
    };
+   this->pimpl->hydrateAll(*this);
    auto result = std::find_if(this->pimpl->m_allObjects.cbegin(), this->pimpl->m_allObjects.cend(), wrapperMatchFunction);
    if (result == this->pimpl->m_allObjects.cend()) {
       return std::nullopt;
@@ -2282,6 +3240,7 @@ QList<std::shared_ptr<QObject> > ObjectStore::findAllMatching(
    // rest of the code expects it and (b) from Qt 6, QList will become the same as QVector (see
    // https://www.qt.io/blog/qlist-changes-in-qt-6)
    QList<std::shared_ptr<QObject> > results;
+   this->pimpl->hydrateAll(*this);
    std::copy_if(this->pimpl->m_allObjects.cbegin(),
                 this->pimpl->m_allObjects.cend(),
                 std::back_inserter(results), matchFunction);
@@ -2311,6 +3270,7 @@ QVector<int> ObjectStore::idsOfAllMatching(
    // It would be nice to use C++20 ranges here, but I couldn't find a way to use them with QHash in such a way that the
    // keys of the hash would be accessible in the range.  So, for now, we do it the old way.
    QVector<int> results;
+   this->pimpl->hydrateAll(*this);
    for (auto hashEntry = this->pimpl->m_allObjects.cbegin(); hashEntry != this->pimpl->m_allObjects.cend(); ++hashEntry) {
       if (matchFunction(hashEntry.value().get())) {
          results.append(hashEntry.key());
@@ -2319,8 +3279,167 @@ QVector<int> ObjectStore::idsOfAllMatching(
    return results;
 }
 
+QVector<int> ObjectStore::idsOwnedBy(int const ownerId) const {
+   // It's a coding error to call this on a store that doesn't hold owned objects
+   Q_ASSERT(this->pimpl->m_ownerIdGetter);
+   return this->pimpl->m_ownerIndex.ids(ownerId);
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::getAllOwnedBy(int const ownerId) const {
+   return this->getByIds(this->idsOwnedBy(ownerId));
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::getAllHydratedOwnedBy(int const ownerId) const {
+   QList<std::shared_ptr<QObject> > listToReturn;
+   for (int const id : this->idsOwnedBy(ownerId)) {
+      if (this->pimpl->m_allObjects.contains(id)) {
+         listToReturn.append(this->pimpl->m_allObjects.value(id));
+      }
+   }
+   return listToReturn;
+}
+
+bool ObjectStore::setWriteBehindEnabled(bool const enabled) {
+   Q_ASSERT(isOnMainThread());
+   qInfo() << Q_FUNC_INFO << "Write-behind" << (enabled ? "enabled" : "disabled");
+   writeBehindEnabled = enabled;
+   if (!enabled) {
+      // Make sure nothing gets left behind
+      return ObjectStore::flushAllPendingWrites();
+   }
+   return true;
+}
+
+bool ObjectStore::isWriteBehindEnabled() {
+   return writeBehindEnabled;
+}
+
+bool ObjectStore::flushAllPendingWrites() {
+   Q_ASSERT(isOnMainThread());
+   flushScheduled = false;
+   if (storesWithPendingWrites.isEmpty()) {
+      return true;
+   }
+
+   //
+   // In practice all stores use the same database, but it costs us little to handle the general case
+   //
+   QHash<Database *, QList<ObjectStore *>> storesByDatabase;
+   for (ObjectStore * store : storesWithPendingWrites) {
+      storesByDatabase[store->pimpl->database].append(store);
+   }
+
+   bool succeeded = true;
+   for (auto entry = storesByDatabase.cbegin(); entry != storesByDatabase.cend(); ++entry) {
+      Database & database = *entry.key();
+      QSqlDatabase connection = database.sqlDatabase();
+      if (DbTransaction::isOpenOn(connection)) {
+         //
+         // We can't start our own transaction here, and we must not write into the caller's one, as we'd then think
+         // the writes were done even if the caller goes on to roll back.  So we leave the writes pending, and they'll
+         // get done by the retry below, after the caller's transaction has finished.
+         //
+         qWarning() << Q_FUNC_INFO << "Deferring flush of pending writes as called inside another DB transaction";
+         succeeded = false;
+         continue;
+      }
+      int numObjects = 0;
+      {
+         // By the magic of RAII, this will abort if we leave this block without calling dbTransaction.commit()
+         DbTransaction dbTransaction{database, connection, "Flush pending writes"};
+         bool writtenOk = true;
+         for (ObjectStore * store : entry.value()) {
+            numObjects += store->pimpl->m_pendingWrites.size();
+            if (!store->pimpl->writePendingToDb(connection)) {
+               writtenOk = false;
+               break;
+            }
+         }
+         if (!writtenOk || !dbTransaction.commit()) {
+            //
+            // We leave the pending writes where they are, so they will be retried on the next flush.  There's not much
+            // else we can do, but at least there will be something in the logs.
+            //
+            qCritical() << Q_FUNC_INFO << "Unable to flush pending writes for" << numObjects << "object(s)";
+            succeeded = false;
+            continue;
+         }
+      }
+      qDebug() << Q_FUNC_INFO << "Flushed pending writes for" << numObjects << "object(s)";
+      for (ObjectStore * store : entry.value()) {
+         store->pimpl->m_pendingWrites.clear();
+         storesWithPendingWrites.removeOne(store);
+      }
+   }
+
+   if (!succeeded) {
+      scheduleFlush(writeBehindRetryDelay_ms);
+   }
+   return succeeded;
+}
+
+bool ObjectStore::isIndexed(BtStringConst const & propertyName) const {
+   return this->pimpl->m_propertyIndexes.contains(*propertyName);
+}
+
+QVector<int> ObjectStore::idsByIndex(BtStringConst const & propertyName, QVariant const & value) const {
+   auto index = this->pimpl->m_propertyIndexes.constFind(*propertyName);
+   if (index == this->pimpl->m_propertyIndexes.cend()) {
+      // It's a coding error to ask for a lookup on an index that doesn't exist, but we can recover by doing it the slow
+      // way.
+      qWarning() << Q_FUNC_INFO << this->pimpl->m_className << "has no index on" << propertyName;
+      Q_ASSERT(false);
+      QString const key = indexKeyFor(value);
+      return this->idsOfAllMatching(
+         [&](QObject const * object) { return indexKeyFor(object->property(*propertyName)) == key; }
+      );
+   }
+   return index.value().ids(indexKeyFor(value));
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::findByIndex(BtStringConst const & propertyName,
+                                                          QVariant const & value) const {
+   return this->getByIds(this->idsByIndex(propertyName, value));
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::findPossibleMatches(QObject const & object) const {
+   if (!this->pimpl->m_matchKeyProperty) {
+      // It's a coding error to call this on a store without a match key, but we can recover by returning everything
+      qWarning() << Q_FUNC_INFO << this->pimpl->m_className << "has no match key";
+      Q_ASSERT(false);
+      return this->getAll();
+   }
+   QString const key = this->pimpl->m_matchKeyFunction(object.property(**this->pimpl->m_matchKeyProperty));
+   return this->getByIds(this->pimpl->m_matchKeyIndex.ids(key));
+}
+
+void ObjectStore::setOwnerIdGetter(std::function<int(QObject const &)> ownerIdGetter) {
+   // This should only be called (by ObjectStoreTyped) before we load anything
+   Q_ASSERT(this->pimpl->m_allObjects.isEmpty() && this->pimpl->m_unhydrated.isEmpty());
+   this->pimpl->m_ownerIdGetter = ownerIdGetter;
+   return;
+}
+
+bool ObjectStore::containsName(QString const & name) const {
+   return this->pimpl->m_nameIndex.contains(name);
+}
+
+int ObjectStore::highestNameNumber(QString const & baseName) const {
+   return this->pimpl->m_nameIndex.highestNumber(baseName);
+}
+
+void ObjectStore::setMatchKey(BtStringConst const & keyProperty,
+                              std::function<QString(QVariant const &)> keyFunction) {
+   // This should only be called (by ObjectStoreTyped) before we load anything
+   Q_ASSERT(this->pimpl->m_allObjects.isEmpty() && this->pimpl->m_unhydrated.isEmpty());
+   this->pimpl->m_matchKeyProperty = &keyProperty;
+   this->pimpl->m_matchKeyFunction = keyFunction;
+   return;
+}
+
 int ObjectStore::numMatching(std::function<bool(QObject const *)> const & matchFunction) const {
    int count = 0;
+   this->pimpl->hydrateAll(*this);
    for (auto hashEntry = this->pimpl->m_allObjects.cbegin(); hashEntry != this->pimpl->m_allObjects.cend(); ++hashEntry) {
       if (matchFunction(hashEntry.value().get())) {
          ++count;
@@ -2330,11 +3449,13 @@ int ObjectStore::numMatching(std::function<bool(QObject const *)> const & matchF
 }
 
 QList<std::shared_ptr<QObject> > ObjectStore::getAll() const {
+   this->pimpl->hydrateAll(*this);
    // QHash already knows how to return a QList of its values
    return this->pimpl->m_allObjects.values();
 }
 
 QList<QObject *> ObjectStore::getAllRaw() const {
+   this->pimpl->hydrateAll(*this);
    QList<QObject *> listToReturn;
    listToReturn.reserve(this->pimpl->m_allObjects.size());
    std::transform(this->pimpl->m_allObjects.cbegin(),
@@ -2344,23 +3465,138 @@ QList<QObject *> ObjectStore::getAllRaw() const {
    return listToReturn;
 }
 
-bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const {
+void ObjectStore::hydrateAll() const {
+   this->pimpl->hydrateAll(*this);
+   return;
+}
+
+ObjectStore::NewDbSnapshot ObjectStore::snapshotForNewDb() const {
+   // For a lazy store, we need all the objects to exist before we can read them
+   this->pimpl->hydrateAll(*this);
+
+   NewDbSnapshot snapshot;
+   snapshot.numRows = this->pimpl->m_allObjects.size();
+   snapshot.primaryKeys.reserve(snapshot.numRows);
+   snapshot.junctionTableValues.resize(this->pimpl->junctionTables.size());
+   for (auto const & object : std::as_const(this->pimpl->m_allObjects)) {
+      this->pimpl->forEachInsertBindValue(
+         *object,
+         true,
+         [&snapshot]([[maybe_unused]] BtStringConst const & columnName, QVariant const & bindValue) {
+            snapshot.primaryTableValues.append(bindValue);
+            return;
+         }
+      );
+
+      int const primaryKey = object->property(*this->pimpl->getPrimaryKeyProperty()).toInt();
+      snapshot.primaryKeys.append(primaryKey);
+      for (qsizetype junctionTableNum = 0; junctionTableNum < this->pimpl->junctionTables.size(); ++junctionTableNum) {
+         QVector<int> propertyValues;
+         // If this fails, it's a coding error, which will already have been logged.  The best we can do on non-debug
+         // builds is carry on without the junction table rows.
+         readJunctionTablePropertyValues(this->pimpl->junctionTables[junctionTableNum],
+                                         *object,
+                                         primaryKey,
+                                         propertyValues);
+         snapshot.junctionTableValues[junctionTableNum].append(propertyValues);
+      }
+   }
+   return snapshot;
+}
+
+bool ObjectStore::writeSnapshotToNewDb(NewDbSnapshot const & snapshot,
+                                       Database & databaseNew,
+                                       QSqlDatabase & connectionNew,
+                                       NewDbWriteProgress * progress) const {
    //
    // This is primarily used when someone is migrating data from, say, SQLite to PostgreSQL.
    //
-   // We've got all the data cached in memory, so we just need to write it to the new database ... with a couple of
+   // We've got all the data in the snapshot, so we just need to write it to the new database ... with a couple of
    // twists.  The assumption here is that we're already inside a transaction and that foreign key constraints are
-   // turned off.  So we just need to tell our insert member function to write to a different DB than normal and not to
-   // try to do anything with transactions ... AND we want to keep all the existing primary key values the same, rather
-   // than let the DB generate new ones when we do the inserts, so the third parameter to this->pimpl->insertObjectInDb
-   // is true.
+   // turned off.  So we just need to write to a different DB than normal and not to try to do anything with
+   // transactions ... AND we want to keep all the existing primary key values the same, rather than let the DB generate
+   // new ones when we do the inserts.
+   //
+   // NB: We can be called on a worker thread (see WriteAllObjectStoresToNewDb), so we must not touch any of the objects
+   //     in the store (or anything else in this->pimpl that changes after construction) here.
+   //
+   QElapsedTimer timer;
+   timer.start();
+
    //
-   for (auto object : this->pimpl->m_allObjects) {
-      if (this->pimpl->insertObjectInDb(connectionNew, *object, true) <= 0) {
+   // Inserting one row at a time means one round trip to the database per object, which is slow for big tables on a
+   // remote database (eg PostgreSQL).  So instead we insert as many rows as we can in each INSERT statement.  The limit
+   // is the number of bind values per statement, which depends on the type of database.
+   //
+   // We could go further for PostgreSQL and use "COPY ... FROM STDIN", but Qt's PostgreSQL driver does not give us a
+   // way to do that.
+   //
+   int const maxBindValuesPerQuery = databaseNew.maxBindValuesPerQuery();
+   int numColumns = 0;
+   for (auto const & fieldDefn : this->pimpl->primaryTable.tableFields) {
+      numColumns += fieldDefn.columnNames.size();
+   }
+   Q_ASSERT(snapshot.primaryTableValues.size() == snapshot.numRows * numColumns);
+   int const rowsPerQuery = std::max(1, maxBindValuesPerQuery / numColumns);
+
+   BtSqlQuery fullBatchQuery{connectionNew};
+   if (snapshot.numRows >= rowsPerQuery) {
+      fullBatchQuery.prepare(this->pimpl->multiRowInsertQueryString(rowsPerQuery));
+   }
+   for (qsizetype batchStart = 0; batchStart < snapshot.numRows; batchStart += rowsPerQuery) {
+      qsizetype const batchEnd = std::min(batchStart + rowsPerQuery, snapshot.numRows);
+      // Only the last batch can be smaller than rowsPerQuery, so it's the only one that needs its own query
+      std::optional<BtSqlQuery> partialBatchQuery;
+      if (batchEnd - batchStart < rowsPerQuery) {
+         partialBatchQuery.emplace(connectionNew);
+         partialBatchQuery->prepare(
+            this->pimpl->multiRowInsertQueryString(static_cast<int>(batchEnd - batchStart))
+         );
+      }
+      BtSqlQuery & sqlQuery = partialBatchQuery ? *partialBatchQuery : fullBatchQuery;
+
+      int bindPosition = 0;
+      for (qsizetype valueNum = batchStart * numColumns; valueNum < batchEnd * numColumns; ++valueNum) {
+         sqlQuery.bindValue(bindPosition++, snapshot.primaryTableValues[valueNum]);
+      }
+
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error writing rows" << batchStart << "to" << batchEnd << "of" <<
+            this->pimpl->primaryTable.tableName << "to new DB: " << sqlQuery.lastError().text();
          return false;
       }
+
+      //
+      // Junction tables, if any, are still written a row at a time.  (In practice, this is not a problem as we have
+      // moved away from using them.)
+      //
+      for (qsizetype rowNum = batchStart; rowNum < batchEnd; ++rowNum) {
+         for (qsizetype junctionTableNum = 0;
+              junctionTableNum < snapshot.junctionTableValues.size();
+              ++junctionTableNum) {
+            if (!insertJunctionTableRows(this->pimpl->junctionTables[junctionTableNum],
+                                         snapshot.primaryKeys[rowNum],
+                                         snapshot.junctionTableValues[junctionTableNum][rowNum],
+                                         connectionNew)) {
+               qCritical() <<
+                  Q_FUNC_INFO << "Error writing to junction tables:" << connectionNew.lastError().text();
+               return false;
+            }
+         }
+      }
+
+      if (progress) {
+         progress->recordRowsWritten(batchEnd - batchStart);
+      }
    }
 
+   qint64 const elapsed_ms = timer.elapsed();
+   qInfo() <<
+      Q_FUNC_INFO << "Wrote" << snapshot.numRows << "rows to" << this->pimpl->primaryTable.tableName <<
+      "in new DB in" << elapsed_ms << "ms (" << (elapsed_ms > 0 ? snapshot.numRows * 1000 / elapsed_ms : snapshot.numRows) <<
+      "rows/s)";
+
    //
    // Some databases (eg PostgreSQL) get confused if you manually insert values into a primary key column that is
    // normally automatically populated.  Database class knows how to put things back in order for such databases.
@@ -2372,9 +3608,34 @@ bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connect
    // explicitly insert an ID in primaryTable, but it's currently not necessary as this is the only place we ask
    // this->pimpl->insertObjectInDb() to do that.
    //
-   databaseNew.updatePrimaryKeySequenceIfNecessary(connectionNew,
-                                                   this->pimpl->primaryTable.tableName,
-                                                   this->pimpl->getPrimaryKeyColumn());
+   if (!databaseNew.updatePrimaryKeySequenceIfNecessary(connectionNew,
+                                                        this->pimpl->primaryTable.tableName,
+                                                        this->pimpl->getPrimaryKeyColumn())) {
+      return false;
+   }
+
+   return true;
+}
 
+bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const {
+   return this->writeSnapshotToNewDb(this->snapshotForNewDb(), databaseNew, connectionNew);
+}
+
+bool ObjectStore::deleteAllFromNewDb(QSqlDatabase & connectionNew) const {
+   QStringList tableNames;
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      tableNames.append(*junctionTable.tableName);
+   }
+   tableNames.append(*this->pimpl->primaryTable.tableName);
+   for (auto const & tableName : tableNames) {
+      QString const queryString = QString{"DELETE FROM %1;"}.arg(tableName);
+      BtSqlQuery sqlQuery{connectionNew};
+      sqlQuery.prepare(queryString);
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+   }
    return true;
 }
@@ -29,6 +29,7 @@
 #include <QObject>
 #include <QSqlDatabase>
 #include <QString>
+#include <QVariant>
 #include <QVector>
 
 #include "measurement/Unit.h"
@@ -39,6 +40,7 @@
 #include "utils/TypeLookup.h"
 
 class Database;
+class NewDbWriteProgress;
 class NamedParameterBundle;
 
 /**
@@ -131,6 +133,29 @@ public:
                  ValueDecoder                         const   valueDecoder = ValueDecoder{});
    };
 
+   /**
+    * \brief A secondary index on a table, eg on a foreign key column that we don't otherwise want the database to have
+    *        to scan the whole table for.
+    *
+    *        Indexes can be composite (ie more than one column) and/or partial (ie with a \c WHERE clause, such as
+    *        \c "NOT deleted").  NB: The \c WHERE clause is passed through to the database as is, so it needs to be
+    *        valid for both SQLite and PostgreSQL.
+    *
+    *        Indexes are created (with \c CREATE \c INDEX \c IF \c NOT \c EXISTS) after the table's foreign key columns
+    *        have been added -- see \c ObjectStore::createIndexes.  If you add an index here, you also need to add a
+    *        migration in \c DatabaseSchemaHelper so that it gets created on existing databases.
+    */
+   struct TableIndex {
+      BtStringConst          const indexName;
+      QVector<BtStringConst> const columnNames;   // Shouldn't ever be empty
+      BtStringConst          const whereClause;   // Null if the index is not partial
+
+      //! Constructor
+      TableIndex(char const *                  const indexName,
+                 std::initializer_list<BtStringConst> columnNames,
+                 char const *                  const whereClause = nullptr);
+   };
+
    /**
     * \brief The main table in which objects of the type handled by this \c ObjectStore live, and how to map between
     *        object properties and table fields.
@@ -138,15 +163,18 @@ public:
    struct TableDefinition {
       BtStringConst tableName;
       MultiVector<TableField> const tableFields;
+      QVector<TableIndex> const tableIndexes;
       /**
        * \brief Constructor
        *
        * \param commonFields Used when we have several column definitions that are shared between multiple tables (eg
        *                     InventoryFermentable, InventoryHop, etc).
+       * \param tableIndexes Optional secondary indexes on the table
        */
       TableDefinition(char const * const tableName,
                       std::initializer_list<TableField> thisTableFields,
-                      std::initializer_list<std::vector<TableField> const *> commonFields = {});
+                      std::initializer_list<std::vector<TableField> const *> commonFields = {},
+                      std::initializer_list<TableIndex> tableIndexes = {});
    };
 
    /**
@@ -210,6 +238,44 @@ public:
    // This isn't strictly necessary, but it makes various declarations more concise
    typedef QVector<JunctionTableDefinition> JunctionTableDefinitions;
 
+   /**
+    * \brief Properties on which we maintain an in-memory index (eg \c PropertyNames::IngredientAmount::ingredientId) so
+    *        that \c findByIndex and \c idsByIndex do not have to search through every object in the store.  Indexes are
+    *        kept up-to-date on load, insert, update, \c updateProperty and delete.
+    *
+    *        NB: Indexes are keyed on the string form of the property value, so this is intended for things like integer
+    *            foreign keys and names, not, eg, floating point values.
+    */
+   typedef QVector<BtStringConst const *> IndexedProperties;
+
+   /**
+    * \brief Most stores create all their objects in \c loadAll.  For stores with lots of rows, most of which are not
+    *        looked at in a typical session (eg \c BrewNote, \c RecipeAdditionHop), we can instead just keep the data
+    *        read from the DB and only create ("hydrate") each object the first time it is asked for (eg via
+    *        \c getById or \c getAllOwnedBy).  Functions that need to look at every object (eg \c findAllMatching,
+    *        \c numMatching, \c getAll) hydrate everything first, so callers do not need to know whether a store is
+    *        lazy.  However, this undoes the benefit of lazy loading, so, for lazy stores, callers should prefer the
+    *        functions that use indexes (\c idsOwnedBy, \c idsByIndex, \c findByIndex, etc), which only hydrate the
+    *        objects they return, if any.
+    *
+    *        NB: Hydration can happen inside const member functions (eg \c getById), since it does not change what the
+    *            store holds from the caller's point of view.  But, as it creates objects that belong to the main
+    *            thread, all such calls on a lazy store must be made from the main thread.
+    *
+    *        Passing one of these to the constructor turns on lazy loading for the store.
+    *
+    * \param ownerIdProperty For stores of owned objects, the property (ie field in the primary table) holding the owner
+    *                        ID.  We need this to maintain the index used by \c idsOwnedBy without creating objects.
+    *                        Similarly, \c IndexedProperties are read from the DB data for objects not yet hydrated.
+    * \param onHydrated If not \c nullptr, called after each object is hydrated.  Since objects in a lazy store are
+    *                   created after start-up, this is where they get hooked up to their owner (eg see
+    *                   \c Recipe::connectSignalsFor).
+    */
+   struct LazyLoadOptions {
+      BtStringConst const * ownerIdProperty;
+      void (*onHydrated)(std::shared_ptr<QObject> object);
+   };
+
    /**
     * \brief Constructor sets up mappings but does not read in data from DB
     *
@@ -218,16 +284,32 @@ public:
     *                   this object type are "optional" (ie wrapped in \c std::optional)
     * \param primaryTable  First in the list should be the primary key
     * \param junctionTables  Optional
+    * \param indexedProperties  Optional
+    * \param lazyLoadOptions  Optional.  If not set, all objects are created in \c loadAll.
     */
-   ObjectStore(char const *             const   className,
-               TypeLookup               const & typeLookup,
-               TableDefinition          const & primaryTable,
-               JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{});
+   ObjectStore(char const *                   const   className,
+               TypeLookup                     const & typeLookup,
+               TableDefinition                const & primaryTable,
+               JunctionTableDefinitions       const & junctionTables = JunctionTableDefinitions{},
+               IndexedProperties              const & indexedProperties = IndexedProperties{},
+               std::optional<LazyLoadOptions> const & lazyLoadOptions = std::nullopt);
 
    ~ObjectStore();
 
    QString name() const;
 
+   /**
+    * \brief The definitions this store was constructed with.  Mainly useful for making another store that works with
+    *        the same DB tables as this one (which the unit tests do so that they can load the same data in different
+    *        ways and compare the results).
+    */
+   //! @{
+   TableDefinition                const & primaryTable     () const;
+   JunctionTableDefinitions       const & junctionTables   () const;
+   IndexedProperties              const & indexedProperties() const;
+   std::optional<LazyLoadOptions> const & lazyLoadOptions  () const;
+   //! @}
+
    /**
     * \brief Gets the state of the ObjectStore.  If it's \c ErrorInitialising, we probably need to terminate the
     *        program.  (This is because, if we were unable to read some or all data from the database during startup,
@@ -253,6 +335,13 @@ public:
     */
    bool addTableConstraints(Database & database, QSqlDatabase & connection) const;
 
+   /**
+    * \brief Create the secondary indexes (see \c TableIndex) on the table(s) for the objects handled by this store.
+    *        Needs to be called after \c addTableConstraints(), as indexes are often on foreign key columns, which
+    *        don't exist until then.
+    */
+   bool createIndexes(Database & database, QSqlDatabase & connection) const;
+
    /**
     * \brief Load from database all objects handled by this store
     *
@@ -261,11 +350,29 @@ public:
     */
    void loadAll(Database * database = nullptr);
 
+   /**
+    * \brief Do the DB reading part of \c loadAll (ie run all the queries) but without creating any objects.  The data
+    *        read is held until the next call to \c loadAll, which will then use it rather than going to the DB.
+    *
+    *        Because no QObjects are created, this is safe to call on a worker thread (which will use its own DB
+    *        connection -- see \c Database::sqlDatabase), so we can read the data for lots of stores in parallel, and then
+    *        call \c loadAll for each one on the main thread.  See \c InitialiseAllObjectStores.
+    *
+    *        When called on a thread other than the main one, closes that thread's DB connection before returning.
+    *        Errors reading the DB are logged rather than thrown.
+    *
+    * \param database As for \c loadAll
+    *
+    * \return \c true if the data was read OK, \c false otherwise (in which case, \c loadAll will just read from the DB
+    *         itself).
+    */
+   bool prefetchAll(Database * database = nullptr);
+
    /**
     * \brief Create a new object of the type we are handling, using the parameters read from the DB.  Subclass needs to
     *        implement.
     */
-   virtual std::shared_ptr<QObject> createNewObject(NamedParameterBundle & namedParameterBundle) = 0;
+   virtual std::shared_ptr<QObject> createNewObject(NamedParameterBundle & namedParameterBundle) const = 0;
 
    /**
     * \brief Insert a new object in the DB (and in our cache list)
@@ -281,6 +388,18 @@ public:
    template <typename D> void insert(D) = delete;
    template <typename D> void insert(D *) = delete;
 
+   /**
+    * \brief Insert a number of new objects in the DB (and in our cache list).  This is for when we are adding lots of
+    *        objects at once (eg importing a file) and is a lot quicker than calling \c insert once per object, because
+    *        everything happens inside a single DB transaction and we prepare the INSERT statement only once.
+    *
+    *        Either all the objects are inserted or none of them are.  Primary keys are set on the objects (and
+    *        \c signalObjectInserted emitted for each of them) only once the transaction has been committed.
+    *
+    * \return The IDs of what was inserted, in the same order as \c objects, or an empty list if there was an error
+    */
+   QList<int> insertAll(QList<std::shared_ptr<QObject>> const & objects);
+
    /**
     * \brief Update an existing object in the DB
     */
@@ -319,9 +438,50 @@ public:
 
    /**
     * \brief Update a single property of an existing object in the DB
+    *
+    *        If write-behind is enabled (see \c setWriteBehindEnabled), the DB write is deferred and coalesced with any
+    *        other pending writes, but the in-memory indexes are updated and \c signalPropertyChanged is emitted
+    *        straight away.
+    *
+    * \param propertyName Must be one of the constants in a \c PropertyNames namespace, as we may hold on to its
+    *                     address until the write is flushed.
     */
    void updateProperty(QObject const & object, BtStringConst const & propertyName);
 
+   /**
+    * \brief Turn write-behind on or off for all object stores.
+    *
+    *        Every property change on a stored object results in a call to \c updateProperty.  Without write-behind,
+    *        each of these is a separate DB transaction, which gets expensive when, eg, scaling a recipe.  With
+    *        write-behind, property changes are accumulated (so that multiple changes to the same property on the same
+    *        object result in only one DB write) and then written in a single transaction as soon as control returns to
+    *        the event loop, or when \c flushAllPendingWrites is called explicitly.  \c Database::unload and
+    *        \c Database::backupToFile call \c flushAllPendingWrites, so nothing is lost at shutdown or in a backup.
+    *
+    *        Turning write-behind off flushes any pending writes.
+    *
+    *        Write-behind state is not guarded by a mutex, so this, \c flushAllPendingWrites and any \c updateProperty
+    *        calls made while write-behind is enabled must all happen on the main thread.
+    *
+    * \return \c false if write-behind was turned off but not all pending writes could be flushed (see
+    *         \c flushAllPendingWrites), \c true otherwise
+    */
+   static bool setWriteBehindEnabled(bool const enabled);
+
+   static bool isWriteBehindEnabled();
+
+   /**
+    * \brief Write all pending property changes (see \c setWriteBehindEnabled) for all object stores to the DB, in a
+    *        single transaction per database.
+    *
+    *        If this is called while there is already a \c DbTransaction open on the connection, nothing is written for
+    *        that DB, because the writes cannot safely be made part of someone else's transaction.
+    *
+    * \return \c true if succeeded (or there was nothing to do), \c false otherwise.  On failure (including the case
+    *         above), the pending writes are retained and a retry is scheduled.
+    */
+   static bool flushAllPendingWrites();
+
    /**
     * \brief Remove the object from our local in-memory cache
     *
@@ -330,6 +490,9 @@ public:
     *        (via the \c "deleted" property of \c NamedEntity which is also stored in the DB) but will leave the object
     *        in the local cache (ie will not call down to this base class member function).
     *
+    *        If the object has pending writes (see \c setWriteBehindEnabled) that cannot be flushed, it is left in the
+    *        cache, as otherwise those changes would be lost.
+    *
     * \param id ID of the object to delete
     *
     *        (We take the ID of the object to delete rather than, say, std::shared_ptr<QObject> because it's almost
@@ -355,12 +518,13 @@ public:
    std::shared_ptr<QObject> defaultHardDelete(int id);
 
    /**
-    * \brief Returns the number of objects in this store
+    * \brief Returns the number of objects in this store (including, for a lazy store, ones not yet hydrated)
     */
    size_t size() const;
 
    /**
-    * \brief Return \c true if an object with the supplied ID is stored in the cache or \c false otherwise
+    * \brief Return \c true if an object with the supplied ID is stored in the cache (hydrated or not) or \c false
+    *        otherwise
     */
    bool contains(int id) const;
 
@@ -431,6 +595,77 @@ public:
     */
    QVector<int> idsOfAllMatching(std::function<bool(QObject const *)> const & matchFunction) const;
 
+   /**
+    * \brief For stores of owned objects (eg \c MashStep, \c RecipeAdditionHop), returns the IDs of all objects (including
+    *        soft-deleted ones) whose owner has the supplied ID.  This is a lookup in an index that we maintain, rather
+    *        than a search through all objects, so it's a lot quicker than the equivalent call to \c idsOfAllMatching.
+    *
+    *        It is a coding error to call this on a store for which \c setOwnerIdGetter has not been called.
+    *
+    * \return IDs in ascending order.  (The list will be empty if there are no objects with the supplied owner.)
+    */
+   QVector<int> idsOwnedBy(int const ownerId) const;
+
+   /**
+    * \brief Similar to \c idsOwnedBy but returns the objects rather than their IDs
+    */
+   QList<std::shared_ptr<QObject> > getAllOwnedBy(int const ownerId) const;
+
+   /**
+    * \brief Similar to \c getAllOwnedBy, but, for a lazy store (see \c LazyLoadOptions), only returns the objects that
+    *        have already been hydrated.  Used when connecting signals at start-up, where we don't want to force every
+    *        object to be created.  (For a non-lazy store, this is the same as \c getAllOwnedBy.)
+    */
+   QList<std::shared_ptr<QObject> > getAllHydratedOwnedBy(int const ownerId) const;
+
+   /**
+    * \return \c true if there is an index on the supplied property, \c false otherwise
+    */
+   bool isIndexed(BtStringConst const & propertyName) const;
+
+   /**
+    * \brief Returns the IDs of all cached objects (including soft-deleted ones) for which the supplied property has the
+    *        supplied value.  Uses an index maintained by the store (see \c IndexedProperties), so is a lot quicker than
+    *        the equivalent call to \c idsOfAllMatching.
+    *
+    *        It is a coding error to call this for a property that is not indexed.
+    *
+    * \return IDs in ascending order.  (The list will be empty if no objects match.)
+    */
+   QVector<int> idsByIndex(BtStringConst const & propertyName, QVariant const & value) const;
+
+   /**
+    * \brief Similar to \c idsByIndex but returns the objects rather than their IDs
+    */
+   QList<std::shared_ptr<QObject> > findByIndex(BtStringConst const & propertyName, QVariant const & value) const;
+
+   /**
+    * \brief Returns all cached objects (including soft-deleted ones) that have the same "match key" as the supplied
+    *        object (see \c setMatchKey).  These are the only objects in the store that can be equal to it, so this is
+    *        a lot quicker than searching the whole store when looking for duplicates (eg on import).  Note that the
+    *        supplied object does not need to be in the store, but, if it is, it will be included in the results.
+    *
+    *        It is a coding error to call this on a store for which \c setMatchKey has not been called.
+    */
+   QList<std::shared_ptr<QObject> > findPossibleMatches(QObject const & object) const;
+
+   /**
+    * \brief Returns \c true if any cached object (including soft-deleted ones) has the supplied name, ignoring
+    *        differences in white space (as \c QString::simplified).  This is a lookup in an index that we maintain,
+    *        rather than a search through all objects.
+    */
+   bool containsName(QString const & name) const;
+
+   /**
+    * \brief When we need to avoid a name clash, we add a number in brackets to the end of the name (see
+    *        \c NamedEntity::modifyClashingName).  This returns the highest such number in use by cached objects
+    *        (including soft-deleted ones) with the supplied base name.  Eg, if "Foobar", "Foobar (1)" and "Foobar (3)"
+    *        are in use, then \c highestNameNumber("Foobar") returns 3.
+    *
+    * \return 0 if the base name is only used without a number; -1 if it is not used at all
+    */
+   int highestNameNumber(QString const & baseName) const;
+
    /**
     * \brief Similar to \c findAllMatching and \c idsOfAllMatching but just returns how many objects match
     */
@@ -446,9 +681,57 @@ public:
    QList<QObject *> getAllRaw() const;
 
    /**
-    * \brief Write everything in this object store to a new database.  Caller's responsibility to wrap everything in a
+    * \brief For a lazy store (see \c LazyLoadOptions), make sure every object has been created.  (Does nothing for a
+    *        store that is not lazy.)
+    */
+   void hydrateAll() const;
+
+   /**
+    * \brief Plain copy of everything in this object store, in the form it will be written to a new database.  See
+    *        \c snapshotForNewDb.
+    */
+   struct NewDbSnapshot {
+      //! Bind values for the primary table, one row after another, with the columns of each row in table order
+      QVector<QVariant> primaryTableValues;
+      qsizetype numRows = 0;
+      //! Primary key of each row, in the same order as \c primaryTableValues
+      QVector<int> primaryKeys;
+      //! For each junction table (in the same order as \c junctionTables), the values for each row in \c primaryKeys
+      QVector<QVector<QVector<int>>> junctionTableValues;
+   };
+
+   /**
+    * \brief Take a copy of all the data in this object store, so that it can be written to a new database (by
+    *        \c writeSnapshotToNewDb) on another thread.  Must be called on the thread that owns the store, since it
+    *        reads the objects' properties.
+    */
+   NewDbSnapshot snapshotForNewDb() const;
+
+   /**
+    * \brief Write a snapshot of this object store to a new database.  Caller's responsibility to wrap everything in a
     *        transaction and turn off foreign key constraints.
     *
+    *        Rows are written with multi-row INSERT statements, so this is a lot faster than inserting each object in
+    *        turn.  This does not touch any of the objects in the store, so it is OK to call it from a worker thread
+    *        with a connection belonging to that thread.
+    *
+    * \param snapshot As returned by \c snapshotForNewDb
+    * \param databaseNew
+    * \param connectionNew
+    * \param progress If supplied, told about each batch of rows written
+    *
+    * \return \c true if succeeded \c false otherwise
+    */
+   bool writeSnapshotToNewDb(NewDbSnapshot const & snapshot,
+                             Database & databaseNew,
+                             QSqlDatabase & connectionNew,
+                             NewDbWriteProgress * progress = nullptr) const;
+
+   /**
+    * \brief Write everything in this object store to a new database.  Caller's responsibility to wrap everything in a
+    *        transaction and turn off foreign key constraints.  Equivalent to calling \c snapshotForNewDb and then
+    *        \c writeSnapshotToNewDb.
+    *
     * \param databaseNew
     * \param connectionNew
     *
@@ -456,6 +739,33 @@ public:
     */
    bool writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const;
 
+   /**
+    * \brief Delete all rows in this object store's tables in a new database, after a failed attempt to write to it.
+    *        Caller's responsibility to wrap everything in a transaction and turn off foreign key constraints.
+    *
+    * \return \c true if succeeded \c false otherwise
+    */
+   bool deleteAllFromNewDb(QSqlDatabase & connectionNew) const;
+
+protected:
+   /**
+    * \brief Called by \c ObjectStoreTyped, before any objects are loaded, for stores of objects that have an owner ID.
+    *        Enables \c idsOwnedBy and \c getAllOwnedBy.
+    *
+    * \param ownerIdGetter Returns the owner ID of an object in this store
+    */
+   void setOwnerIdGetter(std::function<int(QObject const &)> ownerIdGetter);
+
+   /**
+    * \brief Called by \c ObjectStoreTyped, before any objects are loaded, to enable \c findPossibleMatches.  The
+    *        match key of an object is a value derived from one of its properties such that two objects can only be
+    *        equal if their match keys are the same.  We keep an index on it, updated whenever the property changes.
+    *
+    * \param keyProperty The property from which the match key is derived
+    * \param keyFunction Turns a value of \c keyProperty into a match key
+    */
+   void setMatchKey(BtStringConst const & keyProperty, std::function<QString(QVariant const &)> keyFunction);
+
 signals:
    /**
     * \brief Signal emitted when a new object is inserted in the database.  Parts of the UI that need to display all
@@ -15,10 +15,19 @@
  =====================================================================================================================*/
 #include "database/ObjectStoreTyped.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <mutex> // for std::once_flag
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QThreadPool>
+
+#include "database/Database.h"
 #include "database/DbTransaction.h"
+#include "database/NewDbWriteProgress.h"
 #include "measurement/Unit.h"
 #include "model/Boil.h"
 #include "model/BoilStep.h"
@@ -74,6 +83,47 @@ namespace {
    template<class NE> ObjectStore::TableDefinition          const PRIMARY_TABLE  {"", {}};
    template<class NE> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES{};
 
+   //
+   // Unlike PRIMARY_TABLE and JUNCTION_TABLES, most classes do not need any specialisation of INDEXED_PROPERTIES.  We
+   // only add indexes on properties that we frequently need to look up by (eg "all the recipe additions for a given
+   // ingredient").  Note that owned objects (eg MashStep, RecipeAdditionHop) are automatically indexed by owner ID (see
+   // ObjectStore::idsOwnedBy), so there is no need to add an index on that here.
+   //
+   template<class NE> ObjectStore::IndexedProperties        const INDEXED_PROPERTIES{};
+
+   //
+   // Similarly, most classes are loaded in full at start-up and so do not need any specialisation of LAZY_LOAD_OPTIONS.
+   // We only set this for classes where the DB is likely to hold a lot of rows that are not needed in a typical session
+   // -- see ObjectStore::LazyLoadOptions.
+   //
+   template<class NE> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS{std::nullopt};
+
+   /**
+    * \brief For lazily-loaded recipe additions, this is what connects signals between each one and its \c Recipe when
+    *        it gets created.  (For objects loaded at start-up, this is done in \c Recipe::connectSignals.)
+    */
+   template<class RA>
+   void connectToOwningRecipe(std::shared_ptr<QObject> object) {
+      //
+      // We can't use RA::owner() here, because it calls ObjectStoreTyped<Recipe>::getInstance(), and we might be being
+      // called while the Recipe store is itself still loading (eg if a Recipe constructor asks for its additions).  In
+      // that case, we'd be re-entering the std::call_once in getInstance on the same thread, which deadlocks.  Passing
+      // a Database to getInstance gets us the store without it trying to load anything.  If the Recipe store has not
+      // finished loading then there's nothing to do here, as Recipe::connectSignals will connect all the additions that
+      // exist at that point.
+      //
+      auto const & recipeStore = ObjectStoreTyped<Recipe>::getInstance(&Database::instance());
+      if (recipeStore.state() != ObjectStore::State::InitialisedOk) {
+         return;
+      }
+      auto recipeAddition = std::static_pointer_cast<RA>(object);
+      int const recipeId = recipeAddition->recipeId();
+      if (recipeStore.contains(recipeId)) {
+         recipeStore.getById(recipeId)->connectSignalsFor(recipeAddition);
+      }
+      return;
+   }
+
    //
    // NOTE: Unlike C++, SQL is generally case-insensitive, so we have slightly different naming conventions.
    //       Specifically, we use snake_case rather than camelCase for field and table names.  By convention, we also
@@ -285,7 +335,10 @@ namespace {
          {ObjectStore::FieldType::Double, {"start_acidity_ph"         }, PropertyNames::       Step::startAcidity_pH       },
          {ObjectStore::FieldType::Double, {"end_acidity_ph"           }, PropertyNames::       Step::endAcidity_pH         },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS},
+      {
+         {"mash_step_mash_id_idx", {"mash_id", "step_number"}},
+      }
    };
    // MashSteps don't have children
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<MashStep> {};
@@ -329,7 +382,10 @@ namespace {
          {ObjectStore::FieldType::Double, {"end_gravity_sg"  }, PropertyNames::StepExtended::  endGravity_sg},
          {ObjectStore::FieldType::Enum  , {"chilling_type"   }, PropertyNames::    BoilStep::chillingType   , &BoilStep::chillingTypeStringMapping},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS},
+      {
+         {"boil_step_boil_id_idx", {"boil_id", "step_number"}},
+      }
    };
    // BoilSteps don't have children
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<BoilStep> {};
@@ -376,7 +432,10 @@ namespace {
          {ObjectStore::FieldType::Bool  , {"free_rise"       }, PropertyNames::FermentationStep::freeRise       },
          {ObjectStore::FieldType::String, {"vessel"          }, PropertyNames::FermentationStep::vessel         },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS},
+      {
+         {"fermentation_step_fermentation_id_idx", {"fermentation_id", "step_number"}},
+      }
    };
    // FermentationSteps don't have children
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<FermentationStep> {};
@@ -550,13 +609,17 @@ namespace {
          {ObjectStore::FieldType::Enum  , {"type"               }, PropertyNames::Recipe::type              , &Recipe::typeStringMapping},
          {ObjectStore::FieldType::Int   , {"ancestor_id"        }, PropertyNames::Recipe::ancestorId        , &PRIMARY_TABLE<Recipe>},
          {ObjectStore::FieldType::Bool  , {"locked"             }, PropertyNames::Recipe::locked            },
+         {ObjectStore::FieldType::Int   , {"version_number"     }, PropertyNames::Recipe::versionNumber     },
          {ObjectStore::FieldType::Int   , {"boil_id"            }, PropertyNames::Recipe::boilId            , &PRIMARY_TABLE<Boil>},
          {ObjectStore::FieldType::Int   , {"fermentation_id"    }, PropertyNames::Recipe::fermentationId    , &PRIMARY_TABLE<Fermentation>},
          // ⮜⮜⮜ All below added for BeerJSON support ⮞⮞⮞
          {ObjectStore::FieldType::Double, {"beer_acidity_ph"         }, PropertyNames::Recipe::beerAcidity_pH         },
          {ObjectStore::FieldType::Double, {"apparent_attenuation_pct"}, PropertyNames::Recipe::apparentAttenuation_pct},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS},
+      {
+         {"recipe_ancestor_id_idx", {"ancestor_id"}},
+      }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<Recipe> {};
 
@@ -597,9 +660,18 @@ namespace {
       {
          {ObjectStore::FieldType::Int   , {"id"            }, PropertyNames::NamedEntity::key                },
          {ObjectStore::FieldType::Int   , {"recipe_id"     }, PropertyNames::OwnedByRecipe::recipeId         , &PRIMARY_TABLE<Recipe>     },
+         {ObjectStore::FieldType::Int   , {"recipe_version"}, PropertyNames::OwnedByRecipe::recipeVersion    },
          {ObjectStore::FieldType::Int   , {"fermentable_id"}, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Fermentable>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS},
+      {
+         {"fermentable_in_recipe_recipe_id_idx"     , {"recipe_id"}},
+         {"fermentable_in_recipe_fermentable_id_idx", {"fermentable_id"}},
+      }
+   };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<RecipeAdditionFermentable> {&PropertyNames::IngredientAmount::ingredientId};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<RecipeAdditionFermentable> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::OwnedByRecipe::recipeId, &connectToOwningRecipe<RecipeAdditionFermentable>}
    };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -610,9 +682,18 @@ namespace {
       {
          {ObjectStore::FieldType::Int   , {"id"       }, PropertyNames::NamedEntity::key                },
          {ObjectStore::FieldType::Int   , {"recipe_id"}, PropertyNames::OwnedByRecipe::recipeId         , &PRIMARY_TABLE<Recipe>},
+         {ObjectStore::FieldType::Int   , {"recipe_version"}, PropertyNames::OwnedByRecipe::recipeVersion    },
          {ObjectStore::FieldType::Int   , {"hop_id"   }, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Hop>   },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS},
+      {
+         {"hop_in_recipe_recipe_id_idx", {"recipe_id"}},
+         {"hop_in_recipe_hop_id_idx"   , {"hop_id"}},
+      }
+   };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<RecipeAdditionHop> {&PropertyNames::IngredientAmount::ingredientId};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<RecipeAdditionHop> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::OwnedByRecipe::recipeId, &connectToOwningRecipe<RecipeAdditionHop>}
    };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -623,9 +704,18 @@ namespace {
       {
          {ObjectStore::FieldType::Int   , {"id"       }, PropertyNames::NamedEntity::key                },
          {ObjectStore::FieldType::Int   , {"recipe_id"}, PropertyNames::OwnedByRecipe::recipeId         , &PRIMARY_TABLE<Recipe>},
+         {ObjectStore::FieldType::Int   , {"recipe_version"}, PropertyNames::OwnedByRecipe::recipeVersion    },
          {ObjectStore::FieldType::Int   , {"misc_id"  }, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Misc>   },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS},
+      {
+         {"misc_in_recipe_recipe_id_idx", {"recipe_id"}},
+         {"misc_in_recipe_misc_id_idx"  , {"misc_id"}},
+      }
+   };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<RecipeAdditionMisc> {&PropertyNames::IngredientAmount::ingredientId};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<RecipeAdditionMisc> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::OwnedByRecipe::recipeId, &connectToOwningRecipe<RecipeAdditionMisc>}
    };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -636,12 +726,21 @@ namespace {
       {
          {ObjectStore::FieldType::Int   , {"id"                 }, PropertyNames::NamedEntity::key                      },
          {ObjectStore::FieldType::Int   , {"recipe_id"          }, PropertyNames::OwnedByRecipe::recipeId               , &PRIMARY_TABLE<Recipe>},
+         {ObjectStore::FieldType::Int   , {"recipe_version"     }, PropertyNames::OwnedByRecipe::recipeVersion          },
          {ObjectStore::FieldType::Int   , {"yeast_id"           }, PropertyNames::IngredientAmount::ingredientId      , &PRIMARY_TABLE<Yeast>   },
          {ObjectStore::FieldType::Double, {"attenuation_pct"    }, PropertyNames::RecipeAdditionYeast::attenuation_pct  },
          {ObjectStore::FieldType::Int   , {"times_cultured"     }, PropertyNames::RecipeAdditionYeast::timesCultured    },
          {ObjectStore::FieldType::Int   , {"cell_count_billions"}, PropertyNames::RecipeAdditionYeast::cellCountBillions},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &RECIPE_ADDITION_COMMON_FIELDS},
+      {
+         {"yeast_in_recipe_recipe_id_idx", {"recipe_id"}},
+         {"yeast_in_recipe_yeast_id_idx" , {"yeast_id"}},
+      }
+   };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<RecipeAdditionYeast> {&PropertyNames::IngredientAmount::ingredientId};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<RecipeAdditionYeast> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::OwnedByRecipe::recipeId, &connectToOwningRecipe<RecipeAdditionYeast>}
    };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -652,11 +751,17 @@ namespace {
       {
          {ObjectStore::FieldType::Int   , {"id"         }, PropertyNames::NamedEntity::key                },
          {ObjectStore::FieldType::Int   , {"recipe_id"  }, PropertyNames::OwnedByRecipe::recipeId         , &PRIMARY_TABLE<Recipe>},
+         {ObjectStore::FieldType::Int   , {"recipe_version"}, PropertyNames::OwnedByRecipe::recipeVersion    },
          {ObjectStore::FieldType::Int   , {"salt_id"    }, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Salt>   },
          {ObjectStore::FieldType::Enum  , {"when_to_add"}, PropertyNames::RecipeAdjustmentSalt::whenToAdd , &RecipeAdjustmentSalt::whenToAddStringMapping},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS},
+      {
+         {"salt_in_recipe_recipe_id_idx", {"recipe_id"}},
+         {"salt_in_recipe_salt_id_idx"  , {"salt_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<RecipeAdjustmentSalt> {&PropertyNames::IngredientAmount::ingredientId};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for RecipeUseOfWater
@@ -666,10 +771,16 @@ namespace {
       {
          {ObjectStore::FieldType::Int   , {"id"       }, PropertyNames::NamedEntity::key                },
          {ObjectStore::FieldType::Int   , {"recipe_id"}, PropertyNames::OwnedByRecipe::recipeId         , &PRIMARY_TABLE<Recipe>},
+         {ObjectStore::FieldType::Int   , {"recipe_version"}, PropertyNames::OwnedByRecipe::recipeVersion    },
          {ObjectStore::FieldType::Int   , {"water_id" }, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Water>   },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS},
+      {
+         {"water_in_recipe_recipe_id_idx", {"recipe_id"}},
+         {"water_in_recipe_water_id_idx" , {"water_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<RecipeUseOfWater> {&PropertyNames::IngredientAmount::ingredientId};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for BrewNote
@@ -714,10 +825,16 @@ namespace {
          {ObjectStore::FieldType::Double, {"volume_into_fermenter"  }, PropertyNames::BrewNote::volumeIntoFerm_l },
          {ObjectStore::FieldType::Int   , {"recipe_id"              }, PropertyNames::OwnedByRecipe::recipeId    , &PRIMARY_TABLE<Recipe>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS},
+      {
+         {"brewnote_recipe_id_idx", {"recipe_id"}},
+      }
    };
    // BrewNotes don't have children
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<BrewNote> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<BrewNote> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::OwnedByRecipe::recipeId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for Instruction
@@ -735,10 +852,16 @@ namespace {
          {ObjectStore::FieldType::Bool  , {"completed"    }, PropertyNames::Instruction::completed    },
          {ObjectStore::FieldType::Double, {"interval_mins"}, PropertyNames::Instruction::interval_mins},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS},
+      {
+         {"instruction_recipe_id_idx", {"recipe_id", "step_number"}},
+      }
    };
    // Instructions don't have children
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<Instruction> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<Instruction> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::EnumeratedBase::ownerId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Common Database field mappings for StockPurchaseFermentable, StockPurchaseHop, etc
@@ -778,8 +901,12 @@ namespace {
          {ObjectStore::FieldType::Int, {"fermentable_id"}, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Fermentable>},
          {ObjectStore::FieldType::Double, {"color_lovibond"}, PropertyNames::StockPurchaseFermentable::color_lovibond        },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS},
+      {
+         {"fermentable_stock_purchase_fermentable_id_idx", {"fermentable_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<StockPurchaseFermentable> {&PropertyNames::IngredientAmount::ingredientId};
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockPurchaseFermentable> {};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -795,8 +922,12 @@ namespace {
          {ObjectStore::FieldType::String, {"form"     }, PropertyNames::StockPurchaseHop::form            , &Hop::typeStringMapping},
          {ObjectStore::FieldType::String, {"year"     }, PropertyNames::StockPurchaseHop::year            },
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS},
+      {
+         {"hop_stock_purchase_hop_id_idx", {"hop_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<StockPurchaseHop> {&PropertyNames::IngredientAmount::ingredientId};
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockPurchaseHop> {};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -808,8 +939,12 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"    }, PropertyNames::NamedEntity::key                     },
          {ObjectStore::FieldType::Int, {"misc_id"}, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Misc>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS},
+      {
+         {"misc_stock_purchase_misc_id_idx", {"misc_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<StockPurchaseMisc> {&PropertyNames::IngredientAmount::ingredientId};
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockPurchaseMisc> {};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -821,8 +956,12 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"     }, PropertyNames::NamedEntity::key              },
          {ObjectStore::FieldType::Int, {"salt_id"}, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Salt>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS},
+      {
+         {"salt_stock_purchase_salt_id_idx", {"salt_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<StockPurchaseSalt> {&PropertyNames::IngredientAmount::ingredientId};
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockPurchaseSalt> {};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -834,8 +973,12 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"      }, PropertyNames::NamedEntity::key              },
          {ObjectStore::FieldType::Int, {"yeast_id"}, PropertyNames::IngredientAmount::ingredientId, &PRIMARY_TABLE<Yeast>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &INGREDIENT_AMOUNT_COMMON_FIELDS, &STOCK_PURCHASE_COMMON_FIELDS},
+      {
+         {"yeast_stock_purchase_yeast_id_idx", {"yeast_id"}},
+      }
    };
+   template<> ObjectStore::IndexedProperties const INDEXED_PROPERTIES<StockPurchaseYeast> {&PropertyNames::IngredientAmount::ingredientId};
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockPurchaseYeast> {};
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
@@ -861,9 +1004,16 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"                }, PropertyNames::NamedEntity::key       },
          {ObjectStore::FieldType::Int, {"fermentable_purchase_id"}, PropertyNames::EnumeratedBase::ownerId, &PRIMARY_TABLE<StockPurchaseFermentable>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS},
+      {
+         {"fermentable_stock_use_fermentable_purchase_id_idx", {"fermentable_purchase_id"}},
+         {"fermentable_stock_use_brewnote_id_idx"            , {"brewnote_id"}},
+      }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockUseFermentable> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<StockUseFermentable> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::EnumeratedBase::ownerId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for StockUseHop
@@ -874,9 +1024,16 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"        }, PropertyNames::NamedEntity::key       },
          {ObjectStore::FieldType::Int, {"hop_purchase_id"}, PropertyNames::EnumeratedBase::ownerId, &PRIMARY_TABLE<StockPurchaseHop>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS},
+      {
+         {"hop_stock_use_hop_purchase_id_idx", {"hop_purchase_id"}},
+         {"hop_stock_use_brewnote_id_idx"    , {"brewnote_id"}},
+      }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockUseHop> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<StockUseHop> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::EnumeratedBase::ownerId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for StockUseMisc
@@ -887,9 +1044,16 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"         }, PropertyNames::NamedEntity::key       },
          {ObjectStore::FieldType::Int, {"misc_purchase_id"}, PropertyNames::EnumeratedBase::ownerId, &PRIMARY_TABLE<StockPurchaseMisc>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS},
+      {
+         {"misc_stock_use_misc_purchase_id_idx", {"misc_purchase_id"}},
+         {"misc_stock_use_brewnote_id_idx"     , {"brewnote_id"}},
+      }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockUseMisc> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<StockUseMisc> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::EnumeratedBase::ownerId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for StockUseSalt
@@ -900,9 +1064,16 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"         }, PropertyNames::NamedEntity::key       },
          {ObjectStore::FieldType::Int, {"salt_purchase_id"}, PropertyNames::EnumeratedBase::ownerId, &PRIMARY_TABLE<StockPurchaseSalt>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS},
+      {
+         {"salt_stock_use_salt_purchase_id_idx", {"salt_purchase_id"}},
+         {"salt_stock_use_brewnote_id_idx"     , {"brewnote_id"}},
+      }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockUseSalt> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<StockUseSalt> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::EnumeratedBase::ownerId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for StockUseYeast
@@ -913,9 +1084,16 @@ namespace {
          {ObjectStore::FieldType::Int, {"id"          }, PropertyNames::NamedEntity::key       },
          {ObjectStore::FieldType::Int, {"yeast_purchase_id"}, PropertyNames::EnumeratedBase::ownerId, &PRIMARY_TABLE<StockPurchaseYeast>},
       },
-      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS}
+      {&NAMED_ENTITY_COMMON_FIELDS, &STOCK_USE_COMMON_FIELDS},
+      {
+         {"yeast_stock_use_yeast_purchase_id_idx", {"yeast_purchase_id"}},
+         {"yeast_stock_use_brewnote_id_idx"      , {"brewnote_id"}},
+      }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<StockUseYeast> {};
+   template<> std::optional<ObjectStore::LazyLoadOptions> const LAZY_LOAD_OPTIONS<StockUseYeast> {
+      ObjectStore::LazyLoadOptions{&PropertyNames::EnumeratedBase::ownerId, nullptr}
+   };
 
    //»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»»
    // Database field mappings for Folder
@@ -938,7 +1116,11 @@ ObjectStoreTyped<NE> & ObjectStoreTyped<NE>::getInstance(Database * database) {
    // As of C++11, simple "Meyers singleton" is now thread-safe -- see
    // https://www.modernescpp.com/index.php/thread-safe-initialization-of-a-singleton#h3-guarantees-of-the-c-runtime
    //
-   static ObjectStoreTyped<NE> ostSingleton{NE::typeLookup, PRIMARY_TABLE<NE>, JUNCTION_TABLES<NE>};
+   static ObjectStoreTyped<NE> ostSingleton{NE::typeLookup,
+                                            PRIMARY_TABLE<NE>,
+                                            JUNCTION_TABLES<NE>,
+                                            INDEXED_PROPERTIES<NE>,
+                                            LAZY_LOAD_OPTIONS<NE>};
 
    //
    // C++11 provides a thread-safe way to ensure singleton.loadAll() is called exactly once
@@ -985,7 +1167,7 @@ namespace {
 
 
 //
-// We have to make sure that each version of the above function gets instantiated.  NOTE: This is the 1st of 4 places we
+// We have to make sure that each version of the above function gets instantiated.  NOTE: This is the 1st of 5 places we
 // need to add any new ObjectStoreTyped
 //
 // You might think the use in InitialiseAllObjectStores below is sufficient for this, but the GCC linker says
@@ -1026,11 +1208,122 @@ template ObjectStoreTyped<Style                     > & ObjectStoreTyped<Style
 template ObjectStoreTyped<Water                     > & ObjectStoreTyped<Water                     >::getInstance(Database * database = nullptr);
 template ObjectStoreTyped<Yeast                     > & ObjectStoreTyped<Yeast                     >::getInstance(Database * database = nullptr);
 
-bool InitialiseAllObjectStores(QString & errorMessage) {
+namespace {
+   /**
+    * \brief Called from \c InitialiseAllObjectStores to run the DB queries for one store on the supplied thread pool
+    */
+   template<class NE>
+   void startPrefetch(QThreadPool & threadPool) {
+      //
+      // We want the store itself to be created on this (the main) thread, so that it belongs to the main thread in the
+      // Qt sense.  Passing a Database to getInstance gets us the store without it loading any data.
+      //
+      ObjectStoreTyped<NE> & store = ObjectStoreTyped<NE>::getInstance(&Database::instance());
+
+      // If the store was already loaded before we were called then there's nothing to do
+      if (store.state() != ObjectStore::State::NotYetInitialised) {
+         return;
+      }
+
+      threadPool.start([&store]() {
+         //
+         // Anything escaping from here would terminate the program.  Since prefetching is only an optimisation (the
+         // store will read its own data in loadAll if we fail), we just log any problem.  Either way, we must not leave
+         // this thread's DB connection lying around.
+         //
+         try {
+            store.prefetchAll();
+         } catch (std::exception const & exception) {
+            qCritical() << Q_FUNC_INFO << "Error prefetching" << store.name() << ":" << exception.what();
+         } catch (...) {
+            qCritical() << Q_FUNC_INFO << "Unknown error prefetching" << store.name();
+         }
+         Database::instance().closeConnectionForThisThread();
+         return;
+      });
+      return;
+   }
+
+   /**
+    * \brief Prefetch all the supplied types of object store in parallel and wait for them all to finish
+    */
+   template<class... NEs>
+   void prefetchAllInParallel() {
+      QElapsedTimer timer;
+      timer.start();
+      QThreadPool threadPool;
+      (startPrefetch<NEs>(threadPool), ...);
+      threadPool.waitForDone();
+      qInfo() <<
+         Q_FUNC_INFO << "Prefetched data for" << sizeof...(NEs) << "object stores in" << timer.elapsed() << "ms using" <<
+         threadPool.maxThreadCount() << "threads";
+      return;
+   }
+}
+
+bool InitialiseAllObjectStores(QString & errorMessage, bool const prefetchInParallel) {
+   QElapsedTimer timer;
+   timer.start();
+
+   //
+   // Reading data from the DB is the slow part of loading an object store, and is independent for each store, so we
+   // can do it in parallel (each worker thread getting its own DB connection).  Creating the objects and connecting
+   // their signals still needs to happen on this thread, which it does below.  If any prefetch fails then the store
+   // just reads its own data below as normal.
+   //
+   // For SQLite, the main connection normally holds an exclusive lock, which stops any other connection reading the
+   // DB, so we relax that for the duration.  If we can't, we just skip the prefetch.
+   //
+   if (prefetchInParallel && Database::instance().setExclusiveLocking(false)) {
+      // NOTE: This is the 5th of 5 places we need to add any new ObjectStoreTyped
+      prefetchAllInParallel<
+         Boil                     ,
+         BoilStep                 ,
+         BrewNote                 ,
+         Equipment                ,
+         Fermentable              ,
+         Fermentation             ,
+         FermentationStep         ,
+         // Folders are not yet stored in the DB -- see below
+         Hop                      ,
+         Instruction              ,
+         StockUseFermentable      ,
+         StockUseHop              ,
+         StockUseMisc             ,
+         StockUseSalt             ,
+         StockUseYeast            ,
+         StockPurchaseFermentable ,
+         StockPurchaseHop         ,
+         StockPurchaseMisc        ,
+         StockPurchaseSalt        ,
+         StockPurchaseYeast       ,
+         Mash                     ,
+         MashStep                 ,
+         Misc                     ,
+         Recipe                   ,
+         RecipeAdditionFermentable,
+         RecipeAdditionHop        ,
+         RecipeAdditionMisc       ,
+         RecipeAdditionYeast      ,
+         RecipeAdjustmentSalt     ,
+         RecipeUseOfWater         ,
+         Salt                     ,
+         Style                    ,
+         Water                    ,
+         Yeast
+      >();
+
+      // The worker threads have finished and closed their connections, so we can go back to exclusive locking
+      if (!Database::instance().setExclusiveLocking(true)) {
+         errorMessage = QObject::tr("Could not restore exclusive locking on the database");
+         return false;
+      }
+   }
+
    // It's deliberate that we don't stop after the first error.  If there is a problem, it's quite useful to know how
    // extensive it is.
    QStringList errors;
-   // NOTE: This is the 2nd of 4 places we need to add any new ObjectStoreTyped
+   // NOTE: This is the 2nd of 5 places we need to add any new ObjectStoreTyped
    if (ObjectStoreTyped<Boil                      >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Boil"                     ; }
    if (ObjectStoreTyped<BoilStep                  >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "BoilStep"                 ; }
    if (ObjectStoreTyped<BrewNote                  >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "BrewNote"                 ; }
@@ -1083,7 +1376,7 @@ bool InitialiseAllObjectStores(QString & errorMessage) {
    // simpler to just include everything here, and rely on the compiler to optimise out the cases where there is no work
    // to be done (see postLoadInit above).
    //
-   // NOTE: This is the 3rd of 4 places we need to add any new ObjectStoreTyped
+   // NOTE: This is the 3rd of 5 places we need to add any new ObjectStoreTyped
    postLoadInit(ObjectStoreTyped<Boil                      >::getInstance());
    postLoadInit(ObjectStoreTyped<BoilStep                  >::getInstance());
    postLoadInit(ObjectStoreTyped<BrewNote                  >::getInstance());
@@ -1119,12 +1412,13 @@ bool InitialiseAllObjectStores(QString & errorMessage) {
    postLoadInit(ObjectStoreTyped<Water                     >::getInstance());
    postLoadInit(ObjectStoreTyped<Yeast                     >::getInstance());
 
+   qInfo() << Q_FUNC_INFO << "All object stores initialised in" << timer.elapsed() << "ms";
    return true;
 }
 
 namespace {
    QVector<ObjectStore const *> getAllObjectStores(Database * database = nullptr) {
-      // NOTE: This is the 4th of 4 places we need to add any new ObjectStoreTyped
+      // NOTE: This is the 4th of 5 places we need to add any new ObjectStoreTyped
       static QVector<ObjectStore const *> allObjectStores {
          &ObjectStoreTyped<Boil                      >::getInstance(database),
          &ObjectStoreTyped<BoilStep                  >::getInstance(database),
@@ -1168,8 +1462,9 @@ namespace {
 bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection) {
    qDebug() << Q_FUNC_INFO;
    //
-   // This is obviously deliberately two separate loops because we cannot add the constraints until after all the tables
-   // have been created.
+   // These are obviously deliberately separate loops because we cannot add the constraints until after all the tables
+   // have been created, and we cannot create indexes on foreign key columns until they have been added (along with
+   // their constraints).
    //
    // We only need to pass the database parameter to getAllObjectStores() the first time it is called.
    //
@@ -1185,24 +1480,188 @@ bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection) {
          return false;
       }
    }
+   for (auto store : getAllObjectStores()) {
+      qInfo() << Q_FUNC_INFO << "Creating indexes for" << *store;
+      if (!store->createIndexes(database, connection)) {
+         return false;
+      }
+   }
    return true;
 }
 
-bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connectionNew) {
+namespace {
+   //
+   // When writing to a new PostgreSQL database, how many connections to use in parallel.  Each connection writes whole
+   // tables (with foreign key checks turned off), so they do not contend with each other.  More than a handful doesn't
+   // help because the few biggest tables dominate the total time.
+   //
+   int constexpr maxParallelConnectionsToNewDb = 4;
+
+   // When writing to a new PostgreSQL database with progress reporting, how often the main thread delivers the progress
+   // signals from the worker threads
+   int constexpr progressPollInterval_ms = 100;
+
+   /**
+    * \brief Called from \c WriteAllObjectStoresToNewDb to write the supplied stores to the new DB in parallel, with
+    *        each worker thread using its own clone of \c connectionNew and writing each store in its own transaction.
+    *
+    *        The worker threads only read the snapshots (and the stores' table definitions, which do not change after
+    *        start-up) -- never the objects in the stores, which belong to the main thread.
+    *
+    * \param snapshots One for each of \c objectStores, taken on the main thread
+    * \param progress If not null, the main thread delivers its (queued) signals while waiting for the workers
+    */
+   bool writeObjectStoresToNewDbInParallel(Database & newDatabase,
+                                           QSqlDatabase & connectionNew,
+                                           QVector<ObjectStore const *> const & objectStores,
+                                           QVector<ObjectStore::NewDbSnapshot> const & snapshots,
+                                           NewDbWriteProgress * progress) {
+      Q_ASSERT(snapshots.size() == objectStores.size());
+      std::atomic<qsizetype> nextStoreIndex{0};
+      std::atomic<qsizetype> numStoresWritten{0};
+      std::atomic<bool> succeeded{true};
+      QString const connectionNameNew = connectionNew.connectionName();
+
+      QThreadPool threadPool;
+      int const numWorkers = std::min<int>(maxParallelConnectionsToNewDb, objectStores.size());
+      threadPool.setMaxThreadCount(numWorkers);
+      for (int workerNumber = 0; workerNumber < numWorkers; ++workerNumber) {
+         threadPool.start([&, workerNumber]() {
+            QString const workerConnectionName = QString{"%1-writer%2"}.arg(connectionNameNew).arg(workerNumber);
+            {
+               // This overload of cloneDatabase (taking a connection name rather than a QSqlDatabase) is the one that
+               // is safe to call from a thread other than the one that owns the original connection.
+               QSqlDatabase connection = QSqlDatabase::cloneDatabase(connectionNameNew, workerConnectionName);
+               if (!connection.open()) {
+                  qCritical() <<
+                     Q_FUNC_INFO << "Could not open connection" << workerConnectionName << "to new DB:" <<
+                     connection.lastError().text();
+                  succeeded = false;
+               }
+               while (succeeded) {
+                  qsizetype const storeIndex = nextStoreIndex++;
+                  if (storeIndex >= objectStores.size()) {
+                     break;
+                  }
+                  ObjectStore const & objectStore = *objectStores.at(storeIndex);
+                  DbTransaction dbTransaction{newDatabase,
+                                              connection,
+                                              QString{"Write All %1"}.arg(objectStore.name()),
+                                              DbTransaction::DISABLE_FOREIGN_KEYS};
+                  if (!objectStore.writeSnapshotToNewDb(snapshots.at(storeIndex), newDatabase, connection, progress) ||
+                      !dbTransaction.commit()) {
+                     succeeded = false;
+                     break;
+                  }
+                  if (progress) {
+                     progress->recordStoreWritten(objectStore.name());
+                  }
+                  qInfo() <<
+                     Q_FUNC_INFO << "Written" << ++numStoresWritten << "of" << objectStores.size() <<
+                     "object stores to new DB";
+               }
+               connection.close();
+            }
+            // Per the Qt docs, all QSqlDatabase objects for the connection need to be out of scope before we remove it
+            QSqlDatabase::removeDatabase(workerConnectionName);
+            return;
+         });
+      }
+      if (progress) {
+         // User input is excluded so that nothing can start using the object stores while we wait
+         while (!threadPool.waitForDone(progressPollInterval_ms)) {
+            QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+         }
+         // Deliver any progress signals queued after the last time round the loop
+         QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+      } else {
+         threadPool.waitForDone();
+      }
+      return succeeded;
+   }
+
+   /**
+    * \brief After a failed parallel write, some stores will have been committed to the new DB and others not.  This
+    *        puts the new DB back to having empty tables, as it would be after a failed write in a single transaction.
+    */
+   bool deleteAllFromNewDb(Database & newDatabase,
+                           QSqlDatabase & connectionNew,
+                           QVector<ObjectStore const *> const & objectStores) {
+      DbTransaction dbTransaction{newDatabase, connectionNew, "Delete All", DbTransaction::DISABLE_FOREIGN_KEYS};
+      for (ObjectStore const * objectStore : objectStores) {
+         if (!objectStore->deleteAllFromNewDb(connectionNew)) {
+            return false;
+         }
+      }
+      return dbTransaction.commit();
+   }
+}
+
+bool WriteAllObjectStoresToNewDb(Database & newDatabase,
+                                 QSqlDatabase & connectionNew,
+                                 NewDbWriteProgress * progress) {
+   QElapsedTimer timer;
+   timer.start();
+
+   QVector<ObjectStore const *> const objectStores = getAllObjectStores();
+
    //
-   // Start transaction
-   // By the magic of RAII, this will abort if we exit this function (including by throwing an exception) without
-   // having called dbTransaction.commit().  (It will also turn foreign keys back on either way -- whether the
-   // transaction is committed or rolled back.)
+   // Read everything we are going to write out on this (the main) thread, which owns the objects in the stores.  (For
+   // lazily-loaded stores, this also creates any objects not yet created.)  After this, writing to the new DB does not
+   // need to touch the objects, so it can be done on other threads.
    //
-   DbTransaction dbTransaction{newDatabase, connectionNew, "Write All", DbTransaction::DISABLE_FOREIGN_KEYS};
+   QVector<ObjectStore::NewDbSnapshot> snapshots;
+   snapshots.reserve(objectStores.size());
+   qsizetype totalRows = 0;
+   for (ObjectStore const * objectStore : objectStores) {
+      snapshots.append(objectStore->snapshotForNewDb());
+      totalRows += snapshots.last().numRows;
+   }
+   if (progress) {
+      progress->start(objectStores.size(), totalRows);
+   }
 
-   for (ObjectStore const * objectStore : getAllObjectStores()) {
-      if (!objectStore->writeAllToNewDb(newDatabase, connectionNew)) {
+   if (newDatabase.dbType() == Database::DbType::PGSQL) {
+      //
+      // With PostgreSQL, each connection has its own server process, so we can usefully write several tables at once.
+      // The price is that there is no longer a single transaction for the whole copy.  So, if anything goes wrong, we
+      // delete whatever did get written, to leave the new database with empty tables, the same as if a single
+      // transaction had been rolled back.
+      //
+      if (!writeObjectStoresToNewDbInParallel(newDatabase, connectionNew, objectStores, snapshots, progress)) {
+         if (!deleteAllFromNewDb(newDatabase, connectionNew, objectStores)) {
+            qCritical() << Q_FUNC_INFO << "Could not remove partially-copied data from new DB";
+         }
+         return false;
+      }
+   } else {
+      //
+      // SQLite only allows one writer at a time, so we just do everything in one transaction.
+      //
+      // By the magic of RAII, this will abort if we exit this function (including by throwing an exception) without
+      // having called dbTransaction.commit().  (It will also turn foreign keys back on either way -- whether the
+      // transaction is committed or rolled back.)
+      //
+      DbTransaction dbTransaction{newDatabase, connectionNew, "Write All", DbTransaction::DISABLE_FOREIGN_KEYS};
+      for (qsizetype storeIndex = 0; storeIndex < objectStores.size(); ++storeIndex) {
+         ObjectStore const & objectStore = *objectStores.at(storeIndex);
+         if (!objectStore.writeSnapshotToNewDb(snapshots.at(storeIndex), newDatabase, connectionNew, progress)) {
+            return false;
+         }
+         if (progress) {
+            progress->recordStoreWritten(objectStore.name());
+         }
+         qInfo() <<
+            Q_FUNC_INFO << "Written" << storeIndex + 1 << "of" << objectStores.size() << "object stores to new DB";
+      }
+      if (!dbTransaction.commit()) {
          return false;
       }
    }
 
-   dbTransaction.commit();
+   qint64 const elapsed_ms = timer.elapsed();
+   qInfo() <<
+      Q_FUNC_INFO << "Wrote" << totalRows << "rows to new DB in" << elapsed_ms << "ms (" <<
+      (elapsed_ms > 0 ? totalRows * 1000 / elapsed_ms : totalRows) << "rows/s)";
    return true;
-}
\ No newline at end of file
+}
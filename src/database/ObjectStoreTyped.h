@@ -16,6 +16,7 @@
 #ifndef DATABASE_OBJECTSTORETYPED_H
 #define DATABASE_OBJECTSTORETYPED_H
 #pragma once
+#include <concepts>
 #include <memory>
 
 #include <QDebug>
@@ -24,6 +25,15 @@
 #include "model/NamedEntity.h"
 #include "utils/CastAndConvert.h"
 
+/**
+ * \brief Concept satisfied by classes whose objects have an owner -- eg \c MashStep (owned by \c Mash),
+ *        \c RecipeAdditionHop (owned by \c Recipe).  See \c OwnedSet.
+ */
+template<typename T>
+concept HasOwnerId = requires(T const t) {
+   { t.ownerId() } -> std::convertible_to<int>;
+};
+
 /**
  * \brief Read, write and cache any subclass of \c NamedEntity in the database
  *
@@ -46,10 +56,29 @@ public:
     *
     * \param primaryTable First in the list of fields in this table defn should be the primary key
     */
-   ObjectStoreTyped(TypeLookup               const & typeLookup,
-                    TableDefinition          const & primaryTable,
-                    JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{}) :
-      ObjectStore(NE::staticMetaObject.className(), typeLookup, primaryTable, junctionTables) {
+   ObjectStoreTyped(TypeLookup                     const & typeLookup,
+                    TableDefinition                const & primaryTable,
+                    JunctionTableDefinitions       const & junctionTables = JunctionTableDefinitions{},
+                    IndexedProperties              const & indexedProperties = IndexedProperties{},
+                    std::optional<LazyLoadOptions> const & lazyLoadOptions = std::nullopt) :
+      ObjectStore(NE::staticMetaObject.className(),
+                  typeLookup,
+                  primaryTable,
+                  junctionTables,
+                  indexedProperties,
+                  lazyLoadOptions) {
+      if constexpr (HasOwnerId<NE>) {
+         this->setOwnerIdGetter([](QObject const & object) { return static_cast<NE const &>(object).ownerId(); });
+      }
+      //
+      // NamedEntity::operator== only ever says two objects are equal if their names match (ignoring any " (n)" suffix
+      // added to avoid name clashes), so the stripped name is a good match key for duplicate detection.  (We can't
+      // sensibly include other properties, as many of them are compared "fuzzily" -- eg floating point values.)
+      //
+      this->setMatchKey(
+         PropertyNames::NamedEntity::name,
+         [](QVariant const & name) { return NamedEntity::strippedName(name.toString()); }
+      );
       return;
    }
 
@@ -82,6 +111,22 @@ public:
       return this->ObjectStore::insert(std::static_pointer_cast<QObject>(ne));
    }
 
+   using ObjectStore::insertAll;
+
+   /**
+    * \brief Insert a number of new objects in the DB (and in our cache list).  See \c ObjectStore::insertAll.
+    */
+   QList<int> insertAll(QList<std::shared_ptr<NE>> const & nes) {
+      QList<std::shared_ptr<QObject>> objects;
+      objects.reserve(nes.size());
+      for (auto ne : nes) {
+         // See comment in insert() above
+         ne->setDeleted(false);
+         objects.append(std::static_pointer_cast<QObject>(ne));
+      }
+      return this->ObjectStore::insertAll(objects);
+   }
+
    /**
     * \brief Insert a copy of an existing object in the DB (and in our cache list)
     */
@@ -370,6 +415,50 @@ public:
       );
    }
 
+   /**
+    * \brief For owned objects, returns the IDs of all cached objects (including soft-deleted ones) with the supplied
+    *        owner ID.  See \c ObjectStore::idsOwnedBy.
+    */
+   QVector<int> idsOwnedBy(int const ownerId) const requires HasOwnerId<NE> {
+      return this->ObjectStore::idsOwnedBy(ownerId);
+   }
+
+   /**
+    * \brief Similar to \c idsOwnedBy but returns the objects rather than their IDs
+    */
+   QList<std::shared_ptr<NE>> getAllOwnedBy(int const ownerId) const requires HasOwnerId<NE> {
+      return CastAndConvert::toShared<NE>(this->ObjectStore::getAllOwnedBy(ownerId));
+   }
+
+   /**
+    * \brief See \c ObjectStore::getAllHydratedOwnedBy
+    */
+   QList<std::shared_ptr<NE>> getAllHydratedOwnedBy(int const ownerId) const requires HasOwnerId<NE> {
+      return CastAndConvert::toShared<NE>(this->ObjectStore::getAllHydratedOwnedBy(ownerId));
+   }
+
+   /**
+    * \brief Returns all cached objects (including soft-deleted ones) for which the supplied indexed property has the
+    *        supplied value.  See \c ObjectStore::idsByIndex.
+    */
+   QList<std::shared_ptr<NE>> findByIndex(BtStringConst const & propertyName, QVariant const & value) const {
+      return CastAndConvert::toShared<NE>(this->ObjectStore::findByIndex(propertyName, value));
+   }
+
+   /**
+    * \brief Raw pointer version of \c findByIndex
+    */
+   QList<NE *> findByIndexRaw(BtStringConst const & propertyName, QVariant const & value) const {
+      return CastAndConvert::toRaw<NE>(this->ObjectStore::findByIndex(propertyName, value));
+   }
+
+   /**
+    * \brief See \c ObjectStore::findPossibleMatches
+    */
+   QList<std::shared_ptr<NE>> findPossibleMatches(NE const & ne) const {
+      return CastAndConvert::toShared<NE>(this->ObjectStore::findPossibleMatches(ne));
+   }
+
    /**
     * \brief Similar to \c idsOfAllMatching but returns a count of the number of cached objects that "match" according
     *        to the lambda function.
@@ -397,7 +486,7 @@ protected:
    /**
     * \brief Create a new object of the type we are handling, using the parameters read from the DB
     */
-   virtual std::shared_ptr<QObject> createNewObject(NamedParameterBundle & namedParameterBundle) {
+   virtual std::shared_ptr<QObject> createNewObject(NamedParameterBundle & namedParameterBundle) const {
       //
       // NB: std::static_pointer_cast actually creates a new instance of std::shared_ptr (whose stored pointer is
       // obtained from its parameter's stored pointer using a cast expression).  So there is no point creating a
@@ -435,12 +524,17 @@ private:
  *
  *        NOTE: The other thing this function does is to ensure that, where it exists, \c NE::initialiseAll is called.
  *
+ *        NOTE: By default, the DB queries for all the stores are run in parallel on a thread pool (see
+ *              \c ObjectStore::prefetchAll), after which the objects are created, and post-load initialisation done, in
+ *              the usual order on the calling thread.
+ *
  * \param errorMessage OUT - In the event of an error, will hold info suitable for showing to the user about which
  *                           stores could not be initialised.
+ * \param prefetchInParallel If \c false, all the stores are read in one after another on the calling thread
  *
  * \return \c true if everything succeeded, \c false otherwise
  */
-bool InitialiseAllObjectStores(QString & errorMessage);
+bool InitialiseAllObjectStores(QString & errorMessage, bool const prefetchInParallel = true);
 
 /**
  * \brief Does what it says on the tin.  Note that it is the caller's responsibility to handle transactions.
@@ -457,8 +551,23 @@ bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection);
  *
  *        Caller's responsibility to have called \c CreateAllDatabaseTables
  *
+ *        Everything to be written is first copied out of the objects on the calling thread, which must be the one that
+ *        owns the object stores.  For an SQLite target, everything is then written in one transaction on
+ *        \c connectionNew.  For a PostgreSQL target, tables are written in parallel over several clones of
+ *        \c connectionNew, each table in its own transaction.  If any of these fails, everything written is deleted
+ *        again, so, either way, the new database's tables are only left non-empty if the whole copy succeeded.
+ *
+ *        Throughput is logged (at info level).  Progress is also reported via \c progress, if supplied.  In the
+ *        PostgreSQL case, whilst waiting for the worker threads, the calling thread processes events (other than user
+ *        input), so that it receives their progress signals and any UI showing them stays up to date.
+ *
+ * \param progress If supplied, told about each batch of rows and each object store written.  Its signals have all
+ *                 been delivered by the time this function returns.
+ *
  * \return \c true if succeeded \c false otherwise
  */
-bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connectionNew);
+bool WriteAllObjectStoresToNewDb(Database & newDatabase,
+                                 QSqlDatabase & connectionNew,
+                                 NewDbWriteProgress * progress = nullptr);
 
 #endif
\ No newline at end of file
@@ -59,24 +59,25 @@ namespace ObjectStoreUtils {
          return normalisedName;
       }
 
-      while (
-         //
-         // At the moment, we're pretty strict here and count a name clash even for things that are soft deleted.  If
-         // we wanted to allow clashes with such soft-deleted things then we could add a check against ne->deleted()
-         // as in the isDuplicate() function.
-         //
-         auto matchResult = ObjectStoreWrapper::findFirstMatching<NE>(
-            [normalisedName](std::shared_ptr<NE> ne) {return ne->name().simplified() == normalisedName;}
-         )
-      ) {
+      //
+      // At the moment, we're pretty strict here and count a name clash even for things that are soft deleted.  If we
+      // wanted to allow clashes with such soft-deleted things then we would need to exclude them from the name index in
+      // ObjectStore.
+      //
+      if (ObjectStoreWrapper::containsName<NE>(normalisedName)) {
          qDebug() << Q_FUNC_INFO << "Found existing " << NE::staticMetaObject.className() << "named" << normalisedName;
 
-         NamedEntity::modifyClashingName(normalisedName);
-
          //
-         // Now the for loop will search again with the new name
+         // Rather than trying "Foobar (1)", "Foobar (2)", etc in turn until we find a name that's not in use, we go
+         // straight to one more than the highest number in use.  (This means we don't fill in any gaps -- eg if we
+         // have "Foobar" and "Foobar (3)" then the new name will be "Foobar (4)" -- but that doesn't really matter.)
+         //
+         // Note that, because normalisedName is in use, highestNameNumber() will be at least as big as any number
+         // already on the end of it.
          //
-         qDebug() << Q_FUNC_INFO << "Trying " << normalisedName;
+         QString const baseName = NamedEntity::strippedName(normalisedName);
+         normalisedName = QString{"%1 (%2)"}.arg(baseName).arg(ObjectStoreWrapper::highestNameNumber<NE>(baseName) + 1);
+         qDebug() << Q_FUNC_INFO << "Using " << normalisedName;
       }
 
       return normalisedName;
@@ -155,6 +155,17 @@ namespace ObjectStoreWrapper {
    template<class NE> int insert(NE & ne) = delete;
    template<class NE> int insert(NE * ne) = delete;
 
+   /**
+    * \brief Quicker way of inserting lots of new objects in a store (eg when importing from a file).  See
+    *        \c ObjectStore::insertAll.
+    *
+    * \return IDs of the inserted objects, or an empty list if there was an error (in which case none of the objects
+    *         will have been stored)
+    */
+   template<class NE> QList<int> insertAll(QList<std::shared_ptr<NE>> const & nes) {
+      return ObjectStoreTyped<NE>::getInstance().insertAll(nes);
+   }
+
    template<class NE> std::shared_ptr<NE> insertCopyOf(NE const & ne) {
       return ObjectStoreTyped<NE>::getInstance().insertCopyOf(ne);
    }
@@ -237,6 +248,68 @@ namespace ObjectStoreWrapper {
       return ObjectStoreTyped<NE>::getInstance().idsOfAllMatching(matchFunction);
    }
 
+   /**
+    * \brief For owned objects (eg \c MashStep, \c RecipeAdditionHop), returns IDs of all objects with the supplied
+    *        owner.  Unlike \c idsOfAllMatching, this does not need to search all objects in the store.
+    */
+   template<class NE>
+   QVector<int> idsOwnedBy(int const ownerId) {
+      return ObjectStoreTyped<NE>::getInstance().idsOwnedBy(ownerId);
+   }
+
+   template<class NE>
+   QList<std::shared_ptr<NE>> getAllOwnedBy(int const ownerId) {
+      return ObjectStoreTyped<NE>::getInstance().getAllOwnedBy(ownerId);
+   }
+
+   template<class NE>
+   QList<std::shared_ptr<NE>> getAllHydratedOwnedBy(int const ownerId) {
+      return ObjectStoreTyped<NE>::getInstance().getAllHydratedOwnedBy(ownerId);
+   }
+
+   /**
+    * \brief Look up objects by the value of an indexed property (see \c ObjectStore::IndexedProperties).  Unlike
+    *        \c findAllMatching, this does not need to search all objects in the store.
+    */
+   template<class NE>
+   QList<std::shared_ptr<NE>> findByIndex(BtStringConst const & propertyName, QVariant const & value) {
+      return ObjectStoreTyped<NE>::getInstance().findByIndex(propertyName, value);
+   }
+
+   template<class NE>
+   QList<NE *> findByIndexRaw(BtStringConst const & propertyName, QVariant const & value) {
+      return ObjectStoreTyped<NE>::getInstance().findByIndexRaw(propertyName, value);
+   }
+
+   /**
+    * \brief Returns the only stored objects that could be equal to \c ne (see \c ObjectStore::findPossibleMatches)
+    */
+   template<class NE>
+   QList<std::shared_ptr<NE>> findPossibleMatches(NE const & ne) {
+      return ObjectStoreTyped<NE>::getInstance().findPossibleMatches(ne);
+   }
+
+   /**
+    * \brief See \c ObjectStore::containsName
+    */
+   template<class NE>
+   bool containsName(QString const & name) {
+      return ObjectStoreTyped<NE>::getInstance().containsName(name);
+   }
+
+   /**
+    * \brief See \c ObjectStore::highestNameNumber
+    */
+   template<class NE>
+   int highestNameNumber(QString const & baseName) {
+      return ObjectStoreTyped<NE>::getInstance().highestNameNumber(baseName);
+   }
+
+   template<class NE>
+   QVector<int> idsByIndex(BtStringConst const & propertyName, QVariant const & value) {
+      return ObjectStoreTyped<NE>::getInstance().idsByIndex(propertyName, value);
+   }
+
    /**
     * \brief Similar to \c idsOfAllMatching but returns a count of the number of cached objects that "match" according
     *        to the lambda function.
@@ -0,0 +1,201 @@
+/*======================================================================================================================
+ * database/SqliteBackup.cpp is part of Brewken, and is copyright the following authors 2025:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "database/SqliteBackup.h"
+
+#include <filesystem>
+#include <system_error>
+
+#include <QByteArray>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QString>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QtEndian>
+
+#include "database/BtSqlQuery.h"
+#include "utils/ErrorCodeToStream.h"
+
+namespace {
+   // Per https://www.sqlite.org/fileformat.html, the header is the first 100 bytes of the file and the file change
+   // counter is a 4-byte big-endian integer at offset 24.
+   QByteArray const sqliteHeaderMagic{"SQLite format 3\0", 16};
+   qint64 constexpr fileChangeCounterOffset = 24;
+
+   // How much of the database file we copy at a time (and therefore how often we report progress)
+   qint64 constexpr copyChunkSize = 1024 * 1024;
+
+   /**
+    * \brief Copy \c sourceFileName to \c target a chunk at a time
+    */
+   bool copyFile(QString const & sourceFileName,
+                 QFile & target,
+                 SqliteBackup::ProgressCallback const & progressCallback) {
+      QFile source{sourceFileName};
+      if (!source.open(QIODevice::ReadOnly)) {
+         qWarning() << Q_FUNC_INFO << "Could not open" << sourceFileName << "for reading:" << source.errorString();
+         return false;
+      }
+      qint64 const bytesTotal = source.size();
+      qint64 bytesCopied = 0;
+      while (!source.atEnd()) {
+         QByteArray const chunk = source.read(copyChunkSize);
+         if (chunk.isEmpty() && source.error() != QFileDevice::NoError) {
+            qWarning() << Q_FUNC_INFO << "Error reading" << sourceFileName << ":" << source.errorString();
+            return false;
+         }
+         if (target.write(chunk) != chunk.size()) {
+            qWarning() << Q_FUNC_INFO << "Error writing" << target.fileName() << ":" << target.errorString();
+            return false;
+         }
+         bytesCopied += chunk.size();
+         if (progressCallback) {
+            progressCallback(bytesCopied, bytesTotal);
+         }
+      }
+      if (!target.flush()) {
+         qWarning() << Q_FUNC_INFO << "Error writing" << target.fileName() << ":" << target.errorString();
+         return false;
+      }
+      return true;
+   }
+
+   /**
+    * \brief Copy the database that \c connection is open on to \c target, inside a read transaction so that no other
+    *        connection can change the database while we do so.  See comment in database/SqliteBackup.h.
+    */
+   bool copyInReadTransaction(QSqlDatabase & connection,
+                              QFile & target,
+                              SqliteBackup::ProgressCallback const & progressCallback) {
+      if (!connection.transaction()) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not start transaction on" << connection.databaseName() << ":" <<
+            connection.lastError().text();
+         return false;
+      }
+
+      //
+      // SQLite doesn't take any lock for a (deferred) transaction until it first reads the database, so we do a trivial
+      // read to make that happen now.  The lock is then held until the end of the transaction.
+      //
+      bool succeeded = false;
+      {
+         BtSqlQuery sqlQuery{connection};
+         if (!sqlQuery.exec("SELECT COUNT(*) FROM sqlite_master") || !sqlQuery.next()) {
+            qWarning() <<
+               Q_FUNC_INFO << "Could not read" << connection.databaseName() << ":" << sqlQuery.lastError().text();
+         } else {
+            sqlQuery.finish();
+            succeeded = copyFile(connection.databaseName(), target, progressCallback);
+         }
+      }
+
+      // We haven't changed anything, so rolling back is just the way to end the transaction and release the lock
+      if (!connection.rollback()) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not end transaction on" << connection.databaseName() << ":" <<
+            connection.lastError().text();
+         return false;
+      }
+      return succeeded;
+   }
+}
+
+bool SqliteBackup::backupToFile(QString const & sourceFileName,
+                                QString const & targetFileName,
+                                ProgressCallback const & progressCallback) {
+   qDebug() << Q_FUNC_INFO << "Backing up" << sourceFileName << "to" << targetFileName;
+   QElapsedTimer timer;
+   timer.start();
+
+   //
+   // We write the copy to a temporary file in the same directory as the target, so that we can rename it over the
+   // target at the end.  If we return early, QTemporaryFile deletes the temporary file for us.
+   //
+   QTemporaryFile tempFile{targetFileName + ".XXXXXX"};
+   if (!tempFile.open()) {
+      qWarning() <<
+         Q_FUNC_INFO << "Could not create temporary file to back up to" << targetFileName << ":" <<
+         tempFile.errorString();
+      return false;
+   }
+
+   //
+   // Connection names have to be unique, and Qt requires a connection be used and removed on the thread that created
+   // it, so we make a new one each time, named for this thread.  Extra braces are so that the QSqlDatabase object is
+   // out of scope before the call to QSqlDatabase::removeDatabase().
+   //
+   QString const connectionName = QString{"SqliteBackup-%1"}.arg(
+      reinterpret_cast<quintptr>(QThread::currentThreadId())
+   );
+   bool copiedOk = false;
+   {
+      QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+      connection.setDatabaseName(sourceFileName);
+      // We only need to read, and this stops SQLite creating an empty database if sourceFileName doesn't exist
+      connection.setConnectOptions("QSQLITE_OPEN_READONLY");
+      if (!connection.open()) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not open" << sourceFileName << "to back it up:" << connection.lastError().text();
+      } else {
+         copiedOk = copyInReadTransaction(connection, tempFile, progressCallback);
+         connection.close();
+      }
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   if (!copiedOk) {
+      return false;
+   }
+
+   //
+   // Unlike QFile::rename(), std::filesystem::rename() replaces any existing target (atomically on most platforms).  We
+   // need to close the temporary file first, as, on Windows, an open file cannot be renamed.
+   //
+   QString const tempFileName = tempFile.fileName();
+   tempFile.close();
+   std::error_code errorCode;
+   std::filesystem::rename(std::filesystem::path{tempFileName.toStdU16String()},
+                           std::filesystem::path{targetFileName.toStdU16String()},
+                           errorCode);
+   if (errorCode) {
+      qWarning() <<
+         Q_FUNC_INFO << "Could not rename" << tempFileName << "to" << targetFileName << ":" << errorCode;
+      return false;
+   }
+   tempFile.setAutoRemove(false);
+
+   qInfo() <<
+      Q_FUNC_INFO << "Backed up" << sourceFileName << "to" << targetFileName << "in" << timer.elapsed() << "ms";
+   return true;
+}
+
+std::optional<quint32> SqliteBackup::readFileChangeCounter(QString const & dbFileName) {
+   QFile dbFile{dbFileName};
+   if (!dbFile.open(QIODevice::ReadOnly)) {
+      qWarning() << Q_FUNC_INFO << "Could not open" << dbFileName << ":" << dbFile.errorString();
+      return std::nullopt;
+   }
+   QByteArray const header = dbFile.read(fileChangeCounterOffset + sizeof(quint32));
+   if (header.size() < fileChangeCounterOffset + static_cast<qint64>(sizeof(quint32)) ||
+       !header.startsWith(sqliteHeaderMagic)) {
+      qWarning() << Q_FUNC_INFO << dbFileName << "does not look like an SQLite database";
+      return std::nullopt;
+   }
+   return qFromBigEndian<quint32>(header.constData() + fileChangeCounterOffset);
+}
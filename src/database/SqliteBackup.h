@@ -0,0 +1,87 @@
+/*======================================================================================================================
+ * database/SqliteBackup.h is part of Brewken, and is copyright the following authors 2025:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef DATABASE_SQLITEBACKUP_H
+#define DATABASE_SQLITEBACKUP_H
+#pragma once
+
+#include <functional>
+#include <optional>
+
+#include <QtGlobal>
+
+class QString;
+
+/**
+ * \brief Backing up an SQLite database that may be in use.
+ *
+ *        We could use SQLite's online backup API (https://www.sqlite.org/backup.html), but that would mean calling the
+ *        SQLite C API directly, and so linking a second copy of SQLite alongside the one inside the Qt driver.  Having
+ *        two copies of SQLite open the same database file in one process is a good way to break SQLite's locking --
+ *        see https://www.sqlite.org/howtocorrupt.html#_multiple_copies_of_sqlite_linked_into_the_same_application.
+ *        Instead, we open a connection of our own through the Qt driver and start a read transaction on it.  While
+ *        that transaction holds its (SHARED) lock, no other connection can commit a change to the database file, so
+ *        we can just copy the file and know the copy is consistent.  (This relies on the database being in rollback
+ *        journal mode, which is what we use, rather than WAL mode.)  Copying the file is also a lot quicker than
+ *        having SQLite rebuild the database in a new file, eg with "VACUUM INTO".
+ *
+ *        Whilst the copy is being made, other connections can still read the database, but any that wants to write
+ *        has to wait (up to its busy timeout) until we are done.  For the sizes of database we deal with, that is not
+ *        long.
+ *
+ *        See \c SqliteBackupJob for running a backup on a worker thread.
+ */
+namespace SqliteBackup {
+   /**
+    * \brief Called, on the thread doing the backup, after each chunk of the database file is copied
+    */
+   using ProgressCallback = std::function<void(qint64 const bytesCopied, qint64 const bytesTotal)>;
+
+   /**
+    * \brief Copy an SQLite database to another file.
+    *
+    *        The copy is made to a temporary file in the same directory as \c targetFileName, which is only renamed to
+    *        \c targetFileName once the copy has succeeded.  So, if anything goes wrong, any existing file of that name
+    *        is left as it was.
+    *
+    *        This runs on, and blocks, the calling thread, using a connection of its own that is made and removed on
+    *        that thread.  Because it needs to read the database through that connection, no other connection can be
+    *        holding an exclusive lock on it -- see \c Database::setExclusiveLocking.
+    *
+    * \param sourceFileName The SQLite database to back up
+    * \param targetFileName Where to write the backup.  If this file already exists, it will be replaced.
+    * \param progressCallback If supplied, called as the backup progresses
+    *
+    * \return \c true if succeeded, \c false otherwise (in which case details will have been logged)
+    */
+   bool backupToFile(QString const & sourceFileName,
+                     QString const & targetFileName,
+                     ProgressCallback const & progressCallback = nullptr);
+
+   /**
+    * \brief Read the "file change counter" from the header of an SQLite database file.  See
+    *        https://www.sqlite.org/fileformat.html#file_change_counter.  SQLite increments this every time a
+    *        transaction modifies the database, so, if it is the same as the last time we backed up the file, then
+    *        nothing has changed and there is no need to make another backup.
+    *
+    *        NB: This is only true for rollback journal mode (which is what we use), not WAL mode.  Also, the caller
+    *            should make sure there are no writes pending (eg by closing the connection) before calling this.
+    *
+    * \return \c std::nullopt if the file could not be read or does not look like an SQLite database
+    */
+   std::optional<quint32> readFileChangeCounter(QString const & dbFileName);
+}
+
+#endif
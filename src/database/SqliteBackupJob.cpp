@@ -0,0 +1,91 @@
+/*======================================================================================================================
+ * database/SqliteBackupJob.cpp is part of Brewken, and is copyright the following authors 2026:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "database/SqliteBackupJob.h"
+
+#include <exception>
+#include <thread>
+
+#include <QDebug>
+#include <QMetaObject>
+
+#include "database/SqliteBackup.h"
+
+// This private implementation class holds all private non-virtual members of SqliteBackupJob
+class SqliteBackupJob::impl {
+public:
+   impl(QString const & sourceFileName, QString const & targetFileName) : m_sourceFileName{sourceFileName},
+                                                                          m_targetFileName{targetFileName},
+                                                                          m_thread{} {
+      return;
+   }
+
+   ~impl() = default;
+
+   QString const m_sourceFileName;
+   QString const m_targetFileName;
+   std::thread m_thread;
+};
+
+SqliteBackupJob::SqliteBackupJob(QString const & sourceFileName,
+                                 QString const & targetFileName,
+                                 QObject * parent) :
+   QObject{parent},
+   pimpl{std::make_unique<impl>(sourceFileName, targetFileName)} {
+   return;
+}
+
+SqliteBackupJob::~SqliteBackupJob() {
+   if (this->pimpl->m_thread.joinable()) {
+      this->pimpl->m_thread.join();
+   }
+   return;
+}
+
+void SqliteBackupJob::start() {
+   // It's a coding error to start the same job twice
+   Q_ASSERT(!this->pimpl->m_thread.joinable());
+
+   this->pimpl->m_thread = std::thread{[this]() {
+      //
+      // Rather than emit signals from this thread, we have them emitted on the thread this object belongs to.  This
+      // means they can't be emitted before whoever called start() has had the chance to connect to them, and, if this
+      // object is destroyed before they are delivered, they are just dropped.
+      //
+      bool succeeded = false;
+      try {
+         succeeded = SqliteBackup::backupToFile(
+            this->pimpl->m_sourceFileName,
+            this->pimpl->m_targetFileName,
+            [this](qint64 const bytesCopied, qint64 const bytesTotal) {
+               QMetaObject::invokeMethod(
+                  this,
+                  [this, bytesCopied, bytesTotal]() { emit this->progress(bytesCopied, bytesTotal); return; },
+                  Qt::QueuedConnection
+               );
+               return;
+            }
+         );
+      } catch (std::exception const & exception) {
+         // Anything escaping from here would terminate the program
+         qCritical() << Q_FUNC_INFO << "Error backing up" << this->pimpl->m_sourceFileName << ":" << exception.what();
+      }
+      QMetaObject::invokeMethod(this,
+                                [this, succeeded]() { emit this->finished(succeeded); return; },
+                                Qt::QueuedConnection);
+      return;
+   }};
+   return;
+}
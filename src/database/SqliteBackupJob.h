@@ -0,0 +1,70 @@
+/*======================================================================================================================
+ * database/SqliteBackupJob.h is part of Brewken, and is copyright the following authors 2026:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef DATABASE_SQLITEBACKUPJOB_H
+#define DATABASE_SQLITEBACKUPJOB_H
+#pragma once
+
+#include <memory>
+
+#include <QObject>
+#include <QString>
+
+/**
+ * \brief Runs \c SqliteBackup::backupToFile on a worker thread, so that a backup the user asked for doesn't freeze the
+ *        UI, and reports back via signals.
+ *
+ *        The signals are always emitted on the thread this object belongs to (normally the main thread), and never
+ *        before the event loop of that thread next runs.  So it is safe to connect to them after calling \c start().
+ *
+ *        Normally created by \c Database::startBackupToFile, which also takes care of letting the worker thread's
+ *        connection read the database.
+ */
+class SqliteBackupJob : public QObject {
+   Q_OBJECT
+
+public:
+   SqliteBackupJob(QString const & sourceFileName, QString const & targetFileName, QObject * parent = nullptr);
+
+   /**
+    * \brief If the backup is still running, we wait for it to finish, as the worker thread uses this object
+    */
+   ~SqliteBackupJob();
+
+   /**
+    * \brief Start the backup on a worker thread and return straight away.  Should only be called once.
+    */
+   void start();
+
+signals:
+   /**
+    * \brief Emitted after each chunk of the database is copied
+    */
+   void progress(qint64 bytesCopied, qint64 bytesTotal);
+
+   /**
+    * \brief Emitted once the backup is done
+    *
+    * \param succeeded \c true if the backup was made, \c false otherwise (in which case details will have been logged)
+    */
+   void finished(bool succeeded);
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+};
+
+#endif
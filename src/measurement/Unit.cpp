@@ -23,9 +23,10 @@
 #include <mutex>    // For std::once_flag etc
 #include <string>
 
-#include <QStringList>
-#include <QRegularExpression>
 #include <QDebug>
+#include <QHash>
+#include <QStringList>
+#include <QStringView>
 
 #include "Algorithms.h"
 #include "Localization.h"
@@ -54,32 +55,13 @@ namespace {
    //
    // Almost all of the time when we are doing look-ups, we know the PhysicalQuantity (and it is not meaningful for the
    // user to specify units relating to a different PhysicalQuantity) so it makes sense to group look-ups by that.
+   // Within each PhysicalQuantity, we then have a hash from case-folded unit name to all the units with that name.
+   // Look-ups happen a lot (eg every amount in every record we import) so we want them to be a single hash look-up.
    //
-   struct NameLookupKey {
-      Measurement::PhysicalQuantity physicalQuantity;
-      QString                       lowerCaseUnitName;
-      //
-      // We need an ordering on the struct to use it as a key of QMap / QMultiMap.  AIUI, these two operators suffice
-      // for the compiler to deduce all the others.
-      //
-      friend auto operator==(NameLookupKey const & lhs, NameLookupKey const & rhs);
-      friend auto operator<=>(NameLookupKey const & lhs, NameLookupKey const & rhs);
-
-   };
-
-   auto operator==(NameLookupKey const & lhs, NameLookupKey const & rhs) {
-      return lhs.physicalQuantity == rhs.physicalQuantity && lhs.lowerCaseUnitName == rhs.lowerCaseUnitName;
-   }
-
-   auto operator<=>(NameLookupKey const & lhs, NameLookupKey const & rhs) {
-      if (lhs.physicalQuantity < rhs.physicalQuantity) { return std::strong_ordering::less; }
-      if (lhs.physicalQuantity > rhs.physicalQuantity) { return std::strong_ordering::greater; }
-      if (lhs.lowerCaseUnitName < rhs.lowerCaseUnitName) { return std::strong_ordering::less; }
-      if (lhs.lowerCaseUnitName > rhs.lowerCaseUnitName) { return std::strong_ordering::greater; }
-      return std::strong_ordering::equal;
-   }
-
-   QMultiMap<NameLookupKey, Measurement::Unit const *> unitNameLookup;
+   // NB: Within each list, units are in reverse order of construction.  Where there is more than one equally good
+   //     match, callers (see Unit::getUnit) take the first or last in the list, so don't change the order lightly.
+   //
+   QMap<Measurement::PhysicalQuantity, QHash<QString, QList<Measurement::Unit const *>>> unitNameLookup;
 
    QMap<Measurement::PhysicalQuantity, Measurement::Unit const *> physicalQuantityToCanonicalUnit;
 
@@ -99,23 +81,22 @@ namespace {
       // Need this before we reference unitNameLookup or physicalQuantityToCanonicalUnit
       std::call_once(initFlag_Lookups, &Measurement::Unit::initialiseLookups);
 
-      auto matches = unitNameLookup.values(NameLookupKey{physicalQuantity, name.toLower()});
-      // Commented out this log statement as it otherwise takes up a lot of log space
-//      qDebug() << Q_FUNC_INFO << name << "has" << matches.length() << "case-insensitive match(es)";
+      // Since QList is implicitly shared, returning this by value does not copy the list
+      QList<Measurement::Unit const *> const matches =
+         unitNameLookup.value(physicalQuantity).value(name.toCaseFolded());
 
       if (caseInensitiveMatching) {
          return matches;
       }
 
-      // If we ever want to do case insensitive matching (which we think should be rare), the simplest thing is just to
-      // go through all the case-insensitive matches and exclude those that aren't an exact match
-      decltype(matches) filteredMatches;
+      // If we ever want to do case sensitive matching (which we think should be rare), the simplest thing is just to go
+      // through all the case-insensitive matches and exclude those that aren't an exact match
+      QList<Measurement::Unit const *> filteredMatches;
       for (auto match : matches) {
          if (match->name == name) {
             filteredMatches.append(match);
          }
       }
-      qDebug() << Q_FUNC_INFO << name << "has" << filteredMatches.length() << "case-sensitive match(es)";
       return filteredMatches;
    }
 
@@ -131,16 +112,14 @@ namespace {
       // Need this before we reference unitNameLookup or physicalQuantityToCanonicalUnit
       std::call_once(initFlag_Lookups, &Measurement::Unit::initialiseLookups);
 
+      QString const caseFoldedName = name.toCaseFolded();
       QList<Measurement::Unit const *> allMatches;
-      auto const & keys {unitNameLookup.uniqueKeys()};
-      for (auto const & key : keys) {
-
-         if (name.toLower() == key.lowerCaseUnitName) {
-            auto matches = unitNameLookup.values(key);
+      for (auto ii = unitNameLookup.cbegin(); ii != unitNameLookup.cend(); ++ii) {
+         auto const matches = ii.value().value(caseFoldedName);
+         if (!matches.isEmpty()) {
             allMatches.append(matches);
             qDebug() <<
-               Q_FUNC_INFO << "Added" << matches.length() << "matches for" << key.lowerCaseUnitName << "/" <<
-               key.physicalQuantity << ":";
+               Q_FUNC_INFO << "Added" << matches.length() << "matches for" << caseFoldedName << "/" << ii.key() << ":";
             for (auto & match : matches) {
                qDebug() << Q_FUNC_INFO << " - " << match;
             }
@@ -276,7 +255,7 @@ Measurement::Unit::~Unit() = default;
 void Measurement::Unit::initialiseLookups() {
    for (auto const unit : listOfAllUnits) {
       Measurement::PhysicalQuantity const physicalQuantity = unit->pimpl->m_unitSystem.getPhysicalQuantity();
-      unitNameLookup.insert(NameLookupKey{physicalQuantity, unit->name.toLower()}, unit);
+      unitNameLookup[physicalQuantity][unit->name.toCaseFolded()].prepend(unit);
       if (unit->pimpl->m_isCanonical) {
          physicalQuantityToCanonicalUnit.insert(physicalQuantity, unit);
       }
@@ -290,33 +269,74 @@ std::pair<double, QString> Measurement::Unit::splitAmountString(QString const &
       *ok = false;
    }
 
-   // All functions in QRegularExpression are reentrant, so it should be safe to use as a shared const in multi-threaded
-   // code.
-   static QRegularExpression const amtUnit {
-      //
-      // For the numeric part (the quantity) we need to make sure we get the right decimal point (. or ,) and the right
-      // grouping separator (, or .).  Some locales write 1.000,10 and others write 1,000.10.  We need to catch both.
-      //
-      // For the units, we have to be a bit careful.  We used to use "\\w" to match "word characters" for the unit name.
-      // This was fine when we had "simple" unit names such as "kg" and "floz", but it breaks for names containing
-      // symbols, such as "L/kg" or "c/g·C".  Instead, we have to match non-space characters
-      //
-      "((?:\\d+" + QRegularExpression::escape(Localization::getLocale().groupSeparator()) + ")?\\d+(?:" +
-      QRegularExpression::escape(Localization::getLocale().decimalPoint()) + "\\d+)?|" +
-      QRegularExpression::escape(Localization::getLocale().decimalPoint()) + "\\d+)\\s*([^\\s]+)?",
-      QRegularExpression::CaseInsensitiveOption
+   //
+   // We are looking for the first occurrence of a number, optionally followed by whitespace and then a unit name.
+   //
+   // For the numeric part (the quantity) we need to make sure we get the right decimal point (. or ,) and the right
+   // grouping separator (, or .).  Some locales write 1.000,10 and others write 1,000.10.  We accept:
+   //    - digits, optionally with a single grouping separator in them, optionally followed by decimal point and digits
+   //      (eg "1,000", "1,000.5", "12.5")
+   //    - decimal point followed by digits (eg ".5")
+   //
+   // For the units, we have to be a bit careful.  Names can contain symbols, such as "L/kg" or "c/g·C", so we take
+   // everything up to the next whitespace.
+   //
+   // This is the sort of thing a regular expression is good for, but we parse a lot of amounts (eg when importing
+   // recipes) and a hand-written scan is a lot faster.
+   //
+   Localization::NumberSeparators const & separators = Localization::getNumberSeparators();
+   QStringView const input{inputString};
+   qsizetype const length = input.size();
+
+   // Returns the position of the first non-digit at or after position
+   auto skipDigits = [&input, length](qsizetype position) {
+      while (position < length && input[position].isDigit()) {
+         ++position;
+      }
+      return position;
+   };
+   // True if there is the supplied separator at position followed by at least one digit
+   auto separatorThenDigitAt = [&input, length](qsizetype const position, QString const & separator) {
+      return !separator.isEmpty() &&
+             input.sliced(position).startsWith(separator) &&
+             position + separator.size() < length &&
+             input[position + separator.size()].isDigit();
    };
 
-   // Make sure we can parse the string
-   QRegularExpressionMatch match = amtUnit.match(inputString);
-   if (!match.hasMatch()) {
+   qsizetype numberStart = 0;
+   while (numberStart < length &&
+          !input[numberStart].isDigit() &&
+          !separatorThenDigitAt(numberStart, separators.decimalPoint)) {
+      ++numberStart;
+   }
+   if (numberStart == length) {
       qDebug() << Q_FUNC_INFO << "Unable to parse" << inputString << "so treating as 0.0";
       return std::pair<double, QString>{0.0, ""};
    }
 
-   QString const unitName = match.captured(2);
+   qsizetype numberEnd = numberStart;
+   if (input[numberStart].isDigit()) {
+      numberEnd = skipDigits(numberStart);
+      if (separatorThenDigitAt(numberEnd, separators.groupSeparator)) {
+         numberEnd = skipDigits(numberEnd + separators.groupSeparator.size());
+      }
+   }
+   if (separatorThenDigitAt(numberEnd, separators.decimalPoint)) {
+      numberEnd = skipDigits(numberEnd + separators.decimalPoint.size());
+   }
+
+   qsizetype unitStart = numberEnd;
+   while (unitStart < length && input[unitStart].isSpace()) {
+      ++unitStart;
+   }
+   qsizetype unitEnd = unitStart;
+   while (unitEnd < length && !input[unitEnd].isSpace()) {
+      ++unitEnd;
+   }
+
+   QString const unitName = input.sliced(unitStart, unitEnd - unitStart).toString();
 
-   QString numericPartOfInput{match.captured(1)};
+   QString const numericPartOfInput = input.sliced(numberStart, numberEnd - numberStart).toString();
    double const quantity = Localization::toDouble(numericPartOfInput, Q_FUNC_INFO, ok);
 
    return std::pair<double, QString>{quantity, unitName};
@@ -490,13 +510,14 @@ Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
    Measurement::Unit const * defUnit = nullptr;
    for (auto const unit : matches) {
       auto const & displayUnitSystem = Measurement::getDisplayUnitSystem(unit->getPhysicalQuantity());
-      qDebug() <<
+      qCDebug(Logging::category) <<
          Q_FUNC_INFO << "Look at" << *unit << "from" << unit->getUnitSystem() << "(Display Unit System for" <<
          unit->getPhysicalQuantity() << "is" << displayUnitSystem << ")";
       if (unit->getPhysicalQuantity() != physicalQuantity) {
          // If the caller knows the amount is, say, a Volume, don't bother trying to match against units for any other
          // physical quantity.
-         qDebug() << Q_FUNC_INFO << "Ignoring match in" << unit->getPhysicalQuantity() << "as not" << physicalQuantity;
+         qCDebug(Logging::category) <<
+            Q_FUNC_INFO << "Ignoring match in" << unit->getPhysicalQuantity() << "as not" << physicalQuantity;
          continue;
       }
 
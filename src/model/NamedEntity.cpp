@@ -20,6 +20,7 @@
 #include "model/NamedEntity.h"
 
 #include <compare>
+#include <exception>
 #include <typeinfo>
 #include <string>
 
@@ -105,7 +106,9 @@ NamedEntity::NamedEntity(QString t_name) :
    m_key          {-1       },
    m_name         {t_name   },
    m_deleted      {false    },
-   m_beingModified{false    } {
+   m_beingModified{false    },
+   m_batchEditDepth{0        },
+   m_deferredPropertyChanges{} {
 
    CONSTRUCTOR_END
    return;
@@ -125,7 +128,9 @@ NamedEntity::NamedEntity(NamedParameterBundle const & namedParameterBundle) :
    SET_REGULAR_FROM_NPB (m_key    , namedParameterBundle, PropertyNames::NamedEntity::key,       -1       ),
    SET_REGULAR_FROM_NPB (m_name   , namedParameterBundle, PropertyNames::NamedEntity::name,      QString{}),
    SET_REGULAR_FROM_NPB (m_deleted, namedParameterBundle, PropertyNames::NamedEntity::deleted,   false    ),
-   m_beingModified{false} {
+   m_beingModified{false},
+   m_batchEditDepth{0},
+   m_deferredPropertyChanges{} {
 
    CONSTRUCTOR_END
    return;
@@ -139,7 +144,9 @@ NamedEntity::NamedEntity(NamedEntity const & other) :
    m_key          {-1             }, // We don't want to copy the other object's key/ID
    m_name         {other.m_name   },
    m_deleted      {other.m_deleted},
-   m_beingModified{false} {
+   m_beingModified{false},
+   m_batchEditDepth{0},
+   m_deferredPropertyChanges{} {
 
    CONSTRUCTOR_END
    return;
@@ -157,6 +164,9 @@ void NamedEntity::swap(NamedEntity & other) noexcept {
    // Similarly, we assert we are never trying to swap an object that is in the middle of being modified
    Q_ASSERT(!this->m_beingModified);
    Q_ASSERT(!other.m_beingModified);
+   // Ditto batch edits
+   Q_ASSERT(0 == this->m_batchEditDepth);
+   Q_ASSERT(0 == other.m_batchEditDepth);
    // Now do the actual swapping
    std::swap(this->m_name   , other.m_name   );
    std::swap(this->m_deleted, other.m_deleted);
@@ -262,8 +272,16 @@ QString NamedEntity::name() const {
    return this->m_name;
 }
 
+QRegularExpression const & NamedEntity::getDuplicateNameNumberMatcher() {
+   return duplicateNameNumberMatcher;
+}
+
 QString NamedEntity::strippedName() const {
-   QString name {this->m_name};
+   return NamedEntity::strippedName(this->m_name);
+}
+
+QString NamedEntity::strippedName(QString const & nameToStrip) {
+   QString name {nameToStrip};
    QRegularExpressionMatch const match = duplicateNameNumberMatcher.match(name);
    QString matchedValue = match.captured(1);
    if (matchedValue.size() > 0) {
@@ -315,6 +333,99 @@ bool NamedEntity::isBeingModified() const {
    return this->m_beingModified;
 }
 
+void NamedEntity::beginBatchEdit() {
+   ++this->m_batchEditDepth;
+   return;
+}
+
+void NamedEntity::endBatchEdit() {
+   // It's a coding error to end a batch edit that wasn't started
+   Q_ASSERT(this->m_batchEditDepth > 0);
+   if (this->m_batchEditDepth <= 0 || --this->m_batchEditDepth > 0) {
+      return;
+   }
+
+   // Now we're at the end of the outermost batch edit, we can do the propagation we deferred
+   this->propagateDeferredPropertyChanges();
+   return;
+}
+
+void NamedEntity::propagateDeferredPropertyChanges() {
+   qDebug() <<
+      Q_FUNC_INFO << "End of batch edit on" << this->metaObject()->className() << "#" << this->m_key << ":" <<
+      this->m_deferredPropertyChanges.size() << "deferred property change(s)";
+
+   //
+   // We take each change off the list just before we do it.  Partly this is because what we do can trigger further
+   // property changes (which will be propagated as normal now that we're no longer in a batch edit).  But also it means
+   // that, if one change throws, we can carry on with the rest, rather than losing them.  Once everything has been
+   // done, we rethrow the first exception, if any.
+   //
+   std::exception_ptr firstException;
+   while (!this->m_deferredPropertyChanges.isEmpty()) {
+      DeferredPropertyChange const change = this->m_deferredPropertyChanges.takeFirst();
+      try {
+         if (change.writeToDb && this->m_key > 0) {
+            this->getObjectStoreTypedInstance().updateProperty(*this, *change.propertyName);
+         }
+         if (change.notify) {
+            this->notifyPropertyChange(*change.propertyName);
+         }
+      } catch (...) {
+         if (!firstException) {
+            firstException = std::current_exception();
+         }
+      }
+   }
+
+   try {
+      this->batchEditEnded();
+   } catch (...) {
+      if (!firstException) {
+         firstException = std::current_exception();
+      }
+   }
+
+   if (firstException) {
+      std::rethrow_exception(firstException);
+   }
+   return;
+}
+
+bool NamedEntity::isInBatchEdit() const {
+   return this->m_batchEditDepth > 0;
+}
+
+void NamedEntity::abandonBatchEdit() noexcept {
+   Q_ASSERT(this->m_batchEditDepth > 0);
+   if (this->m_batchEditDepth <= 0 || --this->m_batchEditDepth > 0) {
+      return;
+   }
+
+   //
+   // The changes made during the batch edit have already happened in memory, and we have no record of the old values,
+   // so the only way to keep the DB and the rest of the program in step with the object is to carry on and propagate
+   // them.  But we're being called during stack unwinding, so nothing must escape from here.
+   //
+   try {
+      this->propagateDeferredPropertyChanges();
+   } catch (std::exception const & exception) {
+      qCritical() <<
+         Q_FUNC_INFO << "Caught exception abandoning batch edit on" << this->metaObject()->className() << "#" <<
+         this->m_key << ":" << exception.what();
+   } catch (...) {
+      qCritical() <<
+         Q_FUNC_INFO << "Caught unknown exception abandoning batch edit on" << this->metaObject()->className() <<
+         "#" << this->m_key;
+   }
+   return;
+}
+
+void NamedEntity::batchEditEnded() {
+   // Default is that there is nothing extra to do
+   return;
+}
+
 QMetaProperty NamedEntity::metaProperty(char const * const name) const {
    return this->metaObject()->property(this->metaObject()->indexOfProperty(name));
 }
@@ -414,6 +525,24 @@ void NamedEntity::propagatePropertyChange(BtStringConst const & propertyName, bo
       return;
    }
 
+   //
+   // If we're in a batch edit, we just note what needs doing, combining with any previous change to the same property.
+   // (We only want to write to the DB if we were already stored at the time of the change.  If we get stored during the
+   // batch edit, the insert will have written the current value.)
+   //
+   if (this->m_batchEditDepth > 0) {
+      bool const writeToDb = this->m_key > 0;
+      for (auto & change : this->m_deferredPropertyChanges) {
+         if (*change.propertyName == propertyName) {
+            change.writeToDb = change.writeToDb || writeToDb;
+            change.notify    = change.notify    || notify;
+            return;
+         }
+      }
+      this->m_deferredPropertyChanges.append(DeferredPropertyChange{&propertyName, writeToDb, notify});
+      return;
+   }
+
    // If we're already stored in the object store, tell it about the property change so that it can write it to the
    // database.  (We don't pass the new value as it will get read out of the object via propertyName.)
    if (this->m_key > 0) {
@@ -506,6 +635,30 @@ NamedEntityModifyingMarker::NamedEntityModifyingMarker(NamedEntity & namedEntity
    return;
 }
 
+NamedEntityBatchEdit::NamedEntityBatchEdit(NamedEntity & namedEntity) :
+   namedEntity{namedEntity},
+   uncaughtExceptionsOnEntry{std::uncaught_exceptions()} {
+   this->namedEntity.beginBatchEdit();
+   return;
+}
+
+NamedEntityBatchEdit::~NamedEntityBatchEdit() noexcept {
+   if (std::uncaught_exceptions() > this->uncaughtExceptionsOnEntry) {
+      // We're being destroyed during stack unwinding, so nothing must escape from here
+      this->namedEntity.abandonBatchEdit();
+      return;
+   }
+
+   try {
+      this->namedEntity.endBatchEdit();
+   } catch (std::exception const & exception) {
+      qCritical() << Q_FUNC_INFO << "Caught exception at end of batch edit:" << exception.what();
+   } catch (...) {
+      qCritical() << Q_FUNC_INFO << "Caught unknown exception at end of batch edit";
+   }
+   return;
+}
+
 NamedEntityModifyingMarker::~NamedEntityModifyingMarker() {
    qDebug() <<
       Q_FUNC_INFO << "Restoring" << this->namedEntity.metaObject()->className() << "#" << this->namedEntity.key() <<
@@ -288,6 +288,9 @@ public:
     */
    static QRegularExpression const & getDuplicateNameNumberMatcher();
 
+   //! \brief As the member function of the same name, but for an arbitrary name (eg one not yet set on an object)
+   static QString strippedName(QString const & name);
+
    void setName(QString const & var);
    void setDeleted(bool const var);
 
@@ -310,6 +313,29 @@ public:
    void setBeingModified(bool set);
    bool isBeingModified() const;
 
+   /**
+    * \brief Start or end a "batch edit" on this object.  Callers should preferably access this via the
+    *        \c NamedEntityBatchEdit RAII wrapper.
+    *
+    *        Whilst a batch edit is in progress, property changes still update the object immediately, but writing them
+    *        to the DB and emitting \c changed signals are deferred until the end of the (outermost) batch edit.  At that
+    *        point, each property that changed is written and signalled once, regardless of how many times it was set,
+    *        and then \c batchEditEnded is called to allow subclasses to do any other deferred work (eg \c Recipe
+    *        recalculations).
+    *
+    *        Batch edits nest, so it is fine to start one when one is already in progress.
+    */
+   void beginBatchEdit();
+   void endBatchEdit();
+   bool isInBatchEdit() const;
+
+   /**
+    * \brief Used instead of \c endBatchEdit when a batch edit is being abandoned because an exception is propagating.
+    *        If this is the outermost batch edit, the deferred property changes are still written and signalled (since
+    *        the object has already changed in memory), but any exception this throws is logged and swallowed.
+    */
+   void abandonBatchEdit() noexcept;
+
    //! Convenience method to get a meta property by name.
    QMetaProperty metaProperty(char const * const name) const;
 
@@ -620,6 +646,12 @@ protected:
     */
    void propagatePropertyChange(BtStringConst const & propertyName, bool notify = true) const;
 
+   /**
+    * \brief Called at the end of the outermost batch edit (see \c beginBatchEdit), after deferred property changes have
+    *        been propagated.  Default implementation does nothing.
+    */
+   virtual void batchEditEnded();
+
    /**
     * \brief Emit a "changed" signal for the supplied \c propertyName.  Usually called from \c propagatePropertyChange,
     *        but can be called directly when the property being updated is not stored in the DB (or not stored in the
@@ -678,6 +710,57 @@ private:
   QString m_name;
   bool    m_deleted;
   bool    m_beingModified;
+
+  //! See \c beginBatchEdit
+  int     m_batchEditDepth;
+  struct DeferredPropertyChange {
+     BtStringConst const * propertyName;
+     bool writeToDb;
+     bool notify;
+  };
+  // Needs to be mutable because propagatePropertyChange is const
+  mutable QList<DeferredPropertyChange> m_deferredPropertyChanges;
+
+  /**
+   * \brief Does the DB writes and signals deferred during a batch edit, then calls \c batchEditEnded.  Carries on past
+   *        any exception thrown by one of the changes, so that none of the others is lost, and then rethrows the first
+   *        such exception.
+   */
+  void propagateDeferredPropertyChanges();
+};
+
+/**
+ * \class NamedEntityBatchEdit
+ *
+ * \brief RAII helper for batching up changes to a \c NamedEntity (see \c NamedEntity::beginBatchEdit).  Eg:
+ *
+ *           {
+ *              NamedEntityBatchEdit batchEdit{*recipe};
+ *              recipe->setBatchSize_l(...);
+ *              recipe->setEfficiency_pct(...);
+ *              ...
+ *           } // Recipe is written to DB, signals are sent and recalculations are done here, once
+ */
+class NamedEntityBatchEdit {
+public:
+   NamedEntityBatchEdit(NamedEntity & namedEntity);
+
+   /**
+    * \brief Ends the batch edit.  Never throws: if we are being destroyed because an exception is propagating, we just
+    *        abandon the batch edit (see \c NamedEntity::abandonBatchEdit), and if ending the batch edit normally throws,
+    *        the exception is logged and swallowed.
+    */
+   ~NamedEntityBatchEdit() noexcept;
+private:
+   NamedEntity & namedEntity;
+   //! Lets us tell, in the destructor, whether we are being destroyed as part of stack unwinding
+   int const uncaughtExceptionsOnEntry;
+
+   // RAII class shouldn't be getting copied or moved
+   NamedEntityBatchEdit(NamedEntityBatchEdit const &) = delete;
+   NamedEntityBatchEdit & operator=(NamedEntityBatchEdit const &) = delete;
+   NamedEntityBatchEdit(NamedEntityBatchEdit &&) = delete;
+   NamedEntityBatchEdit & operator=(NamedEntityBatchEdit &&) = delete;
 };
 
 /**
@@ -23,8 +23,9 @@
 #endif
 
 QString OwnedByRecipe::localisedName() { return tr("Owned By Recipe"); }
-QString OwnedByRecipe::localisedName_recipe  () { return tr("Recipe"   ); }
-QString OwnedByRecipe::localisedName_recipeId() { return tr("Recipe ID"); }
+QString OwnedByRecipe::localisedName_recipe       () { return tr("Recipe"        ); }
+QString OwnedByRecipe::localisedName_recipeId     () { return tr("Recipe ID"     ); }
+QString OwnedByRecipe::localisedName_recipeVersion() { return tr("Recipe Version"); }
 
 bool OwnedByRecipe::compareWith([[maybe_unused]] NamedEntity const & other,
                                 [[maybe_unused]] QList<BtStringConst const *> * propertiesThatDiffer) const {
@@ -33,9 +34,9 @@ bool OwnedByRecipe::compareWith([[maybe_unused]] NamedEntity const & other,
    // Base class will already have ensured names are equal
    return (
       //
-      // Note that we do _not_ compare m_recipeId.  We need to be able to compare classes with different owners.  Eg,
-      // as part of comparing whether two Recipe objects objects are equal, we need, amongst other things, to check
-      // whether their owned objects are equal.
+      // Note that we do _not_ compare m_recipeId (or m_recipeVersion).  We need to be able to compare classes with
+      // different owners.  Eg, as part of comparing whether two Recipe objects objects are equal, we need, amongst other
+      // things, to check whether their owned objects are equal.
       //
       true
    );
@@ -44,8 +45,9 @@ bool OwnedByRecipe::compareWith([[maybe_unused]] NamedEntity const & other,
 TypeLookup const OwnedByRecipe::typeLookup {
    "OwnedByRecipe",
    {
-      PROPERTY_TYPE_LOOKUP_ENTRY(OwnedByRecipe, recipeId, m_recipeId),
-      PROPERTY_TYPE_LOOKUP_NO_MV(OwnedByRecipe, recipe  , recipe    ),
+      PROPERTY_TYPE_LOOKUP_ENTRY(OwnedByRecipe, recipeId     , m_recipeId     ),
+      PROPERTY_TYPE_LOOKUP_NO_MV(OwnedByRecipe, recipe       , recipe         ),
+      PROPERTY_TYPE_LOOKUP_ENTRY(OwnedByRecipe, recipeVersion, m_recipeVersion),
    },
    // Parent class lookup
    {&NamedEntity::typeLookup}
@@ -53,7 +55,8 @@ TypeLookup const OwnedByRecipe::typeLookup {
 
 OwnedByRecipe::OwnedByRecipe(QString name, int const recipeId) :
    NamedEntity{name},
-   m_recipeId{recipeId} {
+   m_recipeId{recipeId},
+   m_recipeVersion{0} {
 
    CONSTRUCTOR_END
    return;
@@ -62,7 +65,8 @@ OwnedByRecipe::OwnedByRecipe(QString name, int const recipeId) :
 OwnedByRecipe::OwnedByRecipe(NamedParameterBundle const & namedParameterBundle) :
    NamedEntity{namedParameterBundle},
    // Although recipeId is required, we have to supply a default value for when we are reading from BeerXML or BeerJSON
-   SET_REGULAR_FROM_NPB(m_recipeId, namedParameterBundle, PropertyNames::OwnedByRecipe::recipeId, -1) {
+   SET_REGULAR_FROM_NPB(m_recipeId     , namedParameterBundle, PropertyNames::OwnedByRecipe::recipeId     , -1),
+   SET_REGULAR_FROM_NPB(m_recipeVersion, namedParameterBundle, PropertyNames::OwnedByRecipe::recipeVersion,  0) {
 
    CONSTRUCTOR_END
    return;
@@ -70,7 +74,8 @@ OwnedByRecipe::OwnedByRecipe(NamedParameterBundle const & namedParameterBundle)
 
 OwnedByRecipe::OwnedByRecipe(OwnedByRecipe const & other) :
    NamedEntity{other},
-   m_recipeId{other.m_recipeId} {
+   m_recipeId{other.m_recipeId},
+   m_recipeVersion{other.m_recipeVersion} {
 
    CONSTRUCTOR_END
    return;
@@ -79,6 +84,7 @@ OwnedByRecipe::OwnedByRecipe(OwnedByRecipe const & other) :
 OwnedByRecipe::~OwnedByRecipe() = default;
 
 int OwnedByRecipe::recipeId() const { return this->m_recipeId; }
+int OwnedByRecipe::recipeVersion() const { return this->m_recipeVersion; }
 std::shared_ptr<Recipe> OwnedByRecipe::recipe() const {
    if (!ObjectStoreWrapper::contains<Recipe>(this->m_recipeId)) {
       qCritical() << Q_FUNC_INFO << "No recipe for ID" << this->m_recipeId;
@@ -101,6 +107,7 @@ std::shared_ptr<Recipe> OwnedByRecipe::owningRecipe() const {
 }
 
 void OwnedByRecipe::setRecipeId(int const val) { SET_AND_NOTIFY(PropertyNames::OwnedByRecipe::recipeId, this->m_recipeId, val); return; }
+void OwnedByRecipe::setRecipeVersion(int const val) { SET_AND_NOTIFY(PropertyNames::OwnedByRecipe::recipeVersion, this->m_recipeVersion, val); return; }
 
 void OwnedByRecipe::setRecipe(Recipe * recipe) {
    Q_ASSERT(nullptr != recipe);
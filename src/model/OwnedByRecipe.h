@@ -25,8 +25,9 @@
 //========================================== Start of property name constants ==========================================
 // See comment in model/NamedEntity.h
 #define AddPropertyName(property) namespace PropertyNames::OwnedByRecipe { inline BtStringConst const property{#property}; }
-AddPropertyName(recipe  )
-AddPropertyName(recipeId)
+AddPropertyName(recipe       )
+AddPropertyName(recipeId     )
+AddPropertyName(recipeVersion)
 #undef AddPropertyName
 //=========================================== End of property name constants ===========================================
 //======================================================================================================================
@@ -42,8 +43,9 @@ public:
     * \brief See comment in model/NamedEntity.h
     */
    static QString localisedName();
-   static QString localisedName_recipe  ();
-   static QString localisedName_recipeId();
+   static QString localisedName_recipe       ();
+   static QString localisedName_recipeId     ();
+   static QString localisedName_recipeVersion();
 
    /**
     * \brief Mapping of names to types for the Qt properties of this class.  See \c NamedEntity::typeLookup for more
@@ -60,8 +62,15 @@ public:
    //=================================================== PROPERTIES ====================================================
    Q_PROPERTY(int                     recipeId   READ recipeId   WRITE setRecipeId)
    Q_PROPERTY(std::shared_ptr<Recipe> recipe     READ recipe     /*WRITE setRecipe*/  )
+   /**
+    * \brief The version (see \c Recipe::versionNumber) of the owning \c Recipe in which this was added or last changed.
+    *        Prior versions of the \c Recipe with the same or higher version number also see this object.  See
+    *        \c OwnedSetOptions::sharedWithPriorVersions.
+    */
+   Q_PROPERTY(int                     recipeVersion READ recipeVersion WRITE setRecipeVersion)
 
    void setRecipeId(int const val);
+   void setRecipeVersion(int const val);
    void setRecipe(Recipe * recipe);
 
    /**
@@ -72,16 +81,20 @@ public:
    virtual std::shared_ptr<Recipe> owningRecipe() const override;
    int recipeId() const;
    std::shared_ptr<Recipe> recipe() const;
+   int recipeVersion() const;
 
    // TODO: ownerId / setOwnerId are needed by OwnedSet.  Should ideally merge them with recipeId / setRecipeId
    inline void setOwnerId(int const val) { setRecipeId(val); return; }
    inline int ownerId() const { return recipeId(); }
+   inline void setOwnerVersion(int const val) { setRecipeVersion(val); return; }
+   inline int ownerVersion() const { return recipeVersion(); }
 
 protected:
    virtual bool compareWith(NamedEntity const & other, QList<BtStringConst const *> * propertiesThatDiffer) const override;
 
 protected:
    int m_recipeId;
+   int m_recipeVersion;
 };
 
 #endif
@@ -75,12 +75,32 @@ struct OwnedSetOptions {
     *        cannot meaningfully have two different owners.
     */
    bool copyable = true;
+
+   /**
+    * \brief An item still only has one owner, but, if this is \c true, prior versions of the owner (see
+    *        \c Recipe::ancestors) also see those of its owner's items that have not changed since the prior version was
+    *        made.  This saves us copying every item each time we make a prior version.
+    *
+    *        To make this work, each owner has a version number, which goes up each time a prior version of it is made,
+    *        and each item records (via \c ownerVersion / \c setOwnerVersion) the owner version it was added or last
+    *        changed in.  A prior version then sees all the items it owns itself, plus any item owned by a later version
+    *        whose \c ownerVersion is no higher than its own version number.  Before an item that a prior version sees is
+    *        changed or removed, the immediately prior version is given its own copy of it (see \c copyOnWrite and
+    *        \c remove).  And, before a prior version stops being one (eg because the later version is being deleted),
+    *        it is given copies of all the items it sees but does not own (see \c doMaterialiseSharedItems).
+    *
+    *        In such a set, \c Owner also needs to implement \c versionNumber, \c ancestors and \c descendants.  Sharing
+    *        is not supported for enumerated sets.
+    */
+   bool sharedWithPriorVersions = false;
 };
-template <OwnedSetOptions os> struct is_Enumerated : public std::integral_constant<bool, os.enumerated>{};
-template <OwnedSetOptions os> struct is_Copyable   : public std::integral_constant<bool, os.copyable  >{};
+template <OwnedSetOptions os> struct is_Enumerated              : public std::integral_constant<bool, os.enumerated             >{};
+template <OwnedSetOptions os> struct is_Copyable                : public std::integral_constant<bool, os.copyable               >{};
+template <OwnedSetOptions os> struct is_SharedWithPriorVersions : public std::integral_constant<bool, os.sharedWithPriorVersions>{};
 // See comment in utils/TypeTraits.h for definition of CONCEPT_FIX_UP (and why, for now, we need it)
-template <OwnedSetOptions os> concept CONCEPT_FIX_UP IsEnumerated = is_Enumerated<os>::value;
-template <OwnedSetOptions os> concept CONCEPT_FIX_UP IsCopyable   = is_Copyable  <os>::value;
+template <OwnedSetOptions os> concept CONCEPT_FIX_UP IsEnumerated              = is_Enumerated             <os>::value;
+template <OwnedSetOptions os> concept CONCEPT_FIX_UP IsCopyable                = is_Copyable               <os>::value;
+template <OwnedSetOptions os> concept CONCEPT_FIX_UP IsSharedWithPriorVersions = is_SharedWithPriorVersions<os>::value;
 
 /**
  * \brief Template class that handles ownership of either:
@@ -96,6 +116,7 @@ template <OwnedSetOptions os> concept CONCEPT_FIX_UP IsCopyable   = is_Copyable
  * \param Owner class needs to inherit from \c NamedEntity
  * \param Item class also needs to inherit from \c NamedEntity, plus implement: \c ownerId, \c setOwnerId
  *        For an enumerated set, \c Item also needs to implement \c seqNum, \c setSeqNum
+ *        For a set shared with prior versions, \c Item also needs to implement \c ownerVersion, \c setOwnerVersion
  * \param propertyName is the name of the property that we use to signal changes to the size of the owned set (eg item
  *        added or removed).  It is typically the name of the property holding this \c OwnedSet object, but the value
  *        that we send with the \c changed signal is simply the new size of the set.
@@ -115,6 +136,8 @@ template<class Owner,
          void (Owner::*itemChangedSlot)(QMetaProperty, QVariant),
          OwnedSetOptions ownedSetOptions = OwnedSetOptions{} >
 class OwnedSet {
+   static_assert(!(ownedSetOptions.enumerated && ownedSetOptions.sharedWithPriorVersions),
+                 "Enumerated sets cannot be shared with prior versions");
 public:
 
    //! Non-virtual equivalent of compareWith
@@ -161,16 +184,39 @@ public:
       m_owner{owner} {
       // Deep copy of Steps
       auto otherItems = other.items();
+      if (otherItems.isEmpty()) {
+         return;
+      }
+
+      QList<std::shared_ptr<Item>> itemsToAdd;
+      itemsToAdd.reserve(otherItems.size());
       for (auto item : otherItems) {
          // Make a copy of the current Item object we're looking at in the other OwnedSet
          auto itemToAdd = std::make_shared<Item>(*item);
 
          // The owner won't yet have an ID, so we can't give it to the new Item
          itemToAdd->setOwnerId(-1);
+         if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+            // The copy belongs to a brand new owner, which won't have any prior versions yet
+            itemToAdd->setOwnerVersion(0);
+         }
+         itemsToAdd.append(itemToAdd);
+      }
 
-         // However, if we insert the new Item in the object store, that will give it its own ID
-         ObjectStoreWrapper::insert(itemToAdd);
-         qDebug() << Q_FUNC_INFO << "Copied" << *item << "to" << *itemToAdd;
+      //
+      // However, if we insert the new Items in the object store, that will give them their own IDs.  Copying a Recipe
+      // copies every addition, water use and instruction, so we insert each set in one go rather than having a separate
+      // DB transaction for every item.
+      //
+      if (ObjectStoreWrapper::insertAll(itemsToAdd).isEmpty()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to store copies of" << itemsToAdd.size() << Item::staticMetaObject.className() <<
+            "items owned by" << other.m_owner;
+         return;
+      }
+
+      for (auto itemToAdd : itemsToAdd) {
+         qDebug() << Q_FUNC_INFO << "Copied to" << *itemToAdd;
 
          // Store the ID of the copy Item
          // If and when we get our ID then we can give it to our Items
@@ -217,30 +263,42 @@ public:
     * \brief Connect all our item's "changed" signals to us
     *
     *        Needs to be called by our Owner \b after all the calls to ObjectStoreTyped<FooBar>::getInstance().loadAll()
+    *
+    *        If \c Item objects are loaded lazily (see \c ObjectStore::LazyLoadOptions), this only connects the ones
+    *        that have already been created, and it is up to the Owner to call \c connectItemChangedSignal for the
+    *        others as and when they are created (eg see \c Recipe::connectSignalsFor).
     */
    void connectAllItemChangedSignals() {
-      for (auto item : this->items()) {
+      for (auto item : this->hydratedItems()) {
          this->connectItemChangedSignal(item);
       }
       return;
    }
 
-private:
    /**
-    * \brief Connect an item's "changed" signal to us.
+    * \brief Connect an item's "changed" signal to us.  It is safe to call this more than once for the same item.
     *
     *        Unusually, we don't worry about disconnecting this later.  The \c Item object (\c item) will never belong
     *        to any other \c OwnedSet, and Qt will do the disconnection itself when \c item is destroyed.
     */
    void connectItemChangedSignal(std::shared_ptr<Item> item) {
       if constexpr (itemChangedSlot) {
-         this->m_owner.connect(item.get(), &NamedEntity::changed, &this->m_owner, itemChangedSlot);
+         this->m_owner.connect(item.get(),
+                               &NamedEntity::changed,
+                               &this->m_owner,
+                               itemChangedSlot,
+                               Qt::UniqueConnection);
       } else {
-         this->m_owner.connect(item.get(), &NamedEntity::changed, &this->m_owner, &Owner::acceptSetMemberChange);
+         this->m_owner.connect(item.get(),
+                               &NamedEntity::changed,
+                               &this->m_owner,
+                               &Owner::acceptSetMemberChange,
+                               Qt::UniqueConnection);
       }
       return;
    }
 
+private:
    void putInOrder(QList<std::shared_ptr<Item>> & items) const requires (IsEnumerated<ownedSetOptions>) {
       std::sort(items.begin(),
                 items.end(),
@@ -287,8 +345,11 @@ private:
       return;
    }
 
-public:
-   QList<std::shared_ptr<Item>> items() const {
+   /**
+    * \brief The items that the owner actually owns, in no particular order.  Unless the set is shared with prior
+    *        versions of the owner, this is the same as \c items, apart from the ordering.
+    */
+   QList<std::shared_ptr<Item>> ownItems() const {
       //
       // The Owner object (eg Recipe) owns its Items (eg RecipeAdditionFermentables, RecipeAdditionHops, etc).  But,
       // it's the Item that knows which Owner it's in rather than the Owner which knows which Items it has, so we have
@@ -305,9 +366,93 @@ public:
          // We don't need to sort here as we assume m_itemIds is already in the correct order (if there is one)
 
       } else {
-         items = ObjectStoreWrapper::findAllMatching<Item>(
-            [ownerId](std::shared_ptr<Item> const item) {return item->ownerId() == ownerId && !item->deleted();}
-         );
+         // The object store keeps an index of items by owner, so we don't have to search through all of them
+         for (auto item : ObjectStoreWrapper::getAllOwnedBy<Item>(ownerId)) {
+            if (!item->deleted()) {
+               items.append(item);
+            }
+         }
+      }
+      return items;
+   }
+
+   /**
+    * \brief If the owner is a prior version, add to \c items the items it shares with later versions.  See
+    *        \c OwnedSetOptions::sharedWithPriorVersions.
+    *
+    * \param hydratedOnly If \c true, only add items that have already been created -- see \c hydratedItems
+    */
+   void appendSharedItems(QList<std::shared_ptr<Item>> & items,
+                          bool const hydratedOnly) const requires (IsSharedWithPriorVersions<ownedSetOptions>) {
+      int const versionNumber = this->m_owner.versionNumber();
+      // A negative version number means the owner was a full copy made before we shared items between versions
+      if (this->m_owner.key() < 0 || versionNumber < 0) {
+         return;
+      }
+
+      for (auto const & laterVersion : this->m_owner.descendants()) {
+         auto const laterVersionItems = hydratedOnly ?
+            ObjectStoreWrapper::getAllHydratedOwnedBy<Item>(laterVersion->key()) :
+            ObjectStoreWrapper::getAllOwnedBy<Item>(laterVersion->key());
+         for (auto item : laterVersionItems) {
+            if (!item->deleted() && item->ownerVersion() <= versionNumber) {
+               items.append(item);
+            }
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Make a copy of \c item (which is not changed) for \c newOwner.  The copy is not inserted in the DB.
+    */
+   static std::shared_ptr<Item> copyFor(Owner const & newOwner,
+                                        Item const & item) requires (IsSharedWithPriorVersions<ownedSetOptions>) {
+      auto copy = std::make_shared<Item>(item);
+      //
+      // Until we give it its new owner, the copy thinks it belongs to the same owner as the original.  Changing that
+      // mustn't look like a modification to the original owner (which might otherwise, eg, make a new version of it).
+      //
+      if (ObjectStoreWrapper::contains<Owner>(item.ownerId())) {
+         NamedEntityModifyingMarker originalOwnerModifyingMarker(*ObjectStoreWrapper::getById<Owner>(item.ownerId()));
+         copy->setOwnerId(newOwner.key());
+      } else {
+         copy->setOwnerId(newOwner.key());
+      }
+      return copy;
+   }
+
+   /**
+    * \brief If \c item, which the owner owns, is also seen by prior versions of the owner, give the immediately prior
+    *        version its own copy of it.  (Any earlier versions that see the item will then see that copy.)
+    *
+    * \return \c true if a copy was made, \c false if the item is not shared
+    */
+   bool copyForPriorVersionIfShared(Item const & item) requires (IsSharedWithPriorVersions<ownedSetOptions>) {
+      // Items not in the DB (eg ones part way through being copied) are never shared
+      if (item.key() <= 0 || item.ownerId() != this->m_owner.key() ||
+          item.ownerVersion() >= this->m_owner.versionNumber()) {
+         return false;
+      }
+      auto const priorVersions = this->m_owner.ancestors();
+      if (priorVersions.isEmpty() || priorVersions.first()->versionNumber() < item.ownerVersion()) {
+         return false;
+      }
+
+      auto const & priorVersion = priorVersions.first();
+      auto copy = OwnedSet::copyFor(*priorVersion, item);
+      ObjectStoreWrapper::insert(copy);
+      qDebug() <<
+         Q_FUNC_INFO << "Copied" << Item::staticMetaObject.className() << "#" << item.key() << "to #" << copy->key() <<
+         "for prior version" << Owner::staticMetaObject.className() << "#" << priorVersion->key();
+      return true;
+   }
+
+public:
+   QList<std::shared_ptr<Item>> items() const {
+      QList<std::shared_ptr<Item>> items = this->ownItems();
+      if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+         this->appendSharedItems(items, false);
       }
 
       //
@@ -337,6 +482,29 @@ public:
       return items;
    }
 
+   /**
+    * \brief Similar to \c items, but, if \c Item objects are loaded lazily (see \c ObjectStore::LazyLoadOptions), only
+    *        returns the ones that have already been created.  Unlike \c items, does not guarantee any ordering.
+    */
+   QList<std::shared_ptr<Item>> hydratedItems() const {
+      int const ownerId = this->m_owner.key();
+      if (ownerId < 0) {
+         // Items for an Owner not yet in the DB were all created after start-up
+         return this->items();
+      }
+
+      QList<std::shared_ptr<Item>> items;
+      for (auto item : ObjectStoreWrapper::getAllHydratedOwnedBy<Item>(ownerId)) {
+         if (!item->deleted()) {
+            items.append(item);
+         }
+      }
+      if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+         this->appendSharedItems(items, true);
+      }
+      return items;
+   }
+
    //! An alternate way of calling \c items.  Used in \c trees/TreeModelBase.h
    static QList<std::shared_ptr<Item>> ownedBy(Owner const & owner) {
       return owner.items();
@@ -360,9 +528,16 @@ public:
          return this->m_itemIds;
       }
 
-      return ObjectStoreWrapper::idsOfAllMatching<Item>(
-         [ownerId](Item const * item) { return item->ownerId() == ownerId; }
-      );
+      QVector<int> ids = ObjectStoreWrapper::idsOwnedBy<Item>(ownerId);
+      if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+         // The shared items have to be looked at to see which versions they are in, so this is slower
+         QList<std::shared_ptr<Item>> sharedItems;
+         this->appendSharedItems(sharedItems, false);
+         for (auto const & item : sharedItems) {
+            ids.append(item->key());
+         }
+      }
+      return ids;
    }
 
    /**
@@ -431,6 +606,11 @@ private:
             item->ownerId();
       }
 
+      if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+         // The new item is not in any prior version of the owner
+         item->setOwnerVersion(std::max(0, this->m_owner.versionNumber()));
+      }
+
       if (this->m_owner.key() > 0) {
          qDebug() <<
             Q_FUNC_INFO << "Add" << Item::staticMetaObject.className() << "#" << item->key() << "to" <<
@@ -539,6 +719,14 @@ public:
          }
       }
 
+      //
+      // If prior versions of the owner also see this item, they need to keep it.  We give them a copy, rather than the
+      // item itself, because the caller (eg for undo) is going to hold on to the item we return.
+      //
+      if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+         this->copyForPriorVersionIfShared(*item);
+      }
+
       //
       // Since a Owner owns its Items, we need to remove the Item from the DB when we remove it from the Owner.  It then
       // makes sense (in the context of undo/redo) to put the Item object back into "new" state, most of which
@@ -569,13 +757,17 @@ public:
     * \brief Remove all items from the set and delete them from the DB
     */
    void removeAll() {
-      auto items = this->items();
+      auto items = this->ownItems();
       qDebug() <<
          Q_FUNC_INFO << "Removing" << items.size() << Item::staticMetaObject.className() << "objects from" <<
          Owner::staticMetaObject.className() << "#" << this->m_owner.key();
 
       if (items.size() > 0) {
          for (auto item : items) {
+            // See comment in remove()
+            if constexpr (IsSharedWithPriorVersions<ownedSetOptions>) {
+               this->copyForPriorVersionIfShared(*item);
+            }
             ObjectStoreWrapper::hardDelete(*item);
          }
          this->m_itemIds.clear();
@@ -661,13 +853,76 @@ public:
     */
    void doHardDeleteOwnedEntities() {
       // It's the Item that stores its Owner ID, so all we need to do is delete our Items then the subsequent database
-      // delete of this Owner won't hit any foreign key problems.
-      for (auto item : this->items()) {
+      // delete of this Owner won't hit any foreign key problems.  (If we are a prior version, the items we share with
+      // later versions are not ours to delete.)
+      for (auto item : this->ownItems()) {
          ObjectStoreWrapper::hardDelete<Item>(*item);
       }
       return;
    }
 
+   /**
+    * \brief For a set shared with prior versions, needs to be called from the \c Owner before an item in the set is
+    *        modified.  If prior versions of the owner see the item, the immediately prior version gets its own copy of
+    *        the item as it is now, and, from then on, the item is only in the current version.
+    */
+   void copyOnWrite(Item & item) requires (IsSharedWithPriorVersions<ownedSetOptions>) {
+      // We don't want any of what we do here to count as a modification to the owner
+      NamedEntityModifyingMarker ownerModifyingMarker(this->m_owner);
+      if (this->copyForPriorVersionIfShared(item)) {
+         item.setOwnerVersion(this->m_owner.versionNumber());
+      }
+      return;
+   }
+
+   /**
+    * \brief For a set shared with prior versions, needs to be called from the \c Owner before it stops being a prior
+    *        version of the version(s) after it (eg because the next version is about to be deleted).  We make our own
+    *        copies of all the items we see but do not own, so that we no longer need the later versions.
+    *
+    *        The copies keep the \c ownerVersion of their originals, so any earlier versions that saw the originals now
+    *        see the copies instead.
+    */
+   void doMaterialiseSharedItems() requires (IsSharedWithPriorVersions<ownedSetOptions>) {
+      QList<std::shared_ptr<Item>> sharedItems;
+      this->appendSharedItems(sharedItems, false);
+      if (sharedItems.isEmpty()) {
+         return;
+      }
+
+      QList<std::shared_ptr<Item>> copies;
+      copies.reserve(sharedItems.size());
+      for (auto const & item : sharedItems) {
+         copies.append(OwnedSet::copyFor(this->m_owner, *item));
+      }
+      if (ObjectStoreWrapper::insertAll(copies).isEmpty()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to store copies of" << copies.size() << Item::staticMetaObject.className() <<
+            "items for" << this->m_owner;
+         return;
+      }
+      qDebug() <<
+         Q_FUNC_INFO << "Made" << copies.size() << Item::staticMetaObject.className() << "copies for" <<
+         Owner::staticMetaObject.className() << "#" << this->m_owner.key();
+
+      for (auto const & copy : copies) {
+         this->connectItemChangedSignal(copy);
+      }
+      return;
+   }
+
+   /**
+    * \brief For a set shared with prior versions, marks all the items the owner owns as only being in the current
+    *        version of it, ie not shared with any prior version.
+    */
+   void doSetOwnerVersionOfOwnItems(int const ownerVersion) requires (IsSharedWithPriorVersions<ownedSetOptions>) {
+      NamedEntityModifyingMarker ownerModifyingMarker(this->m_owner);
+      for (auto item : this->ownItems()) {
+         item->setOwnerVersion(ownerVersion);
+      }
+      return;
+   }
+
    /**
     * \brief For an enumerated set, returns the item at the specified position, if it exists, or \c nullptr if not
     *
@@ -24,6 +24,7 @@
  =====================================================================================================================*/
 #include "model/Recipe.h"
 
+#include <algorithm>
 #include <cmath> // For pow/log
 #include <compare> //
 
@@ -39,6 +40,7 @@
 #include "config.h"
 #include "database/ObjectStoreWrapper.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Amount.h"
 #include "measurement/ColorMethods.h"
 #include "measurement/IbuMethods.h"
@@ -63,6 +65,7 @@
 #include "model/RecipeAdditionMisc.h"
 #include "model/RecipeAdjustmentSalt.h"
 #include "model/RecipeAdditionYeast.h"
+#include "model/RecipeCalcGraph.h"
 #include "model/RecipeUseOfWater.h"
 #include "model/Salt.h"
 #include "model/Style.h"
@@ -103,6 +106,12 @@ namespace {
 
       return true;
    }
+
+   /**
+    * \brief Bumped whenever any Recipe's ancestor changes or a Recipe is deleted, so that each Recipe knows when the
+    *        list of its descendants that it cached might be out of date.  See \c Recipe::descendants.
+    */
+   unsigned int ancestryGeneration = 1;
 }
 
 //
@@ -151,7 +160,8 @@ public:
       m_grainsInMash_kg      {0.0},
       m_grains_kg            {0.0},
       m_og_fermentable       {0.0},
-      m_fg_fermentable       {0.0} {
+      m_fg_fermentable       {0.0},
+      m_staleValues          {}   {
       return;
    }
 
@@ -178,7 +188,8 @@ public:
       m_grainsInMash_kg      {other.pimpl->m_grainsInMash_kg      },
       m_grains_kg            {other.pimpl->m_grains_kg            },
       m_og_fermentable       {other.pimpl->m_og_fermentable       },
-      m_fg_fermentable       {other.pimpl->m_fg_fermentable       } {
+      m_fg_fermentable       {other.pimpl->m_fg_fermentable       },
+      m_staleValues          {} {
       return;
    }
 
@@ -240,7 +251,8 @@ public:
       this->m_self.connect(val.get(), &NamedEntity::changed, &this->m_self, &Recipe::acceptChangeToContainedObject);
       emit this->m_self.changed(this->m_self.metaProperty(*property), QVariant::fromValue<NE *>(val.get()));
 
-      this->m_self.recalcAll();
+      // Eg a new Equipment or Mash affects calculations, but a new Style doesn't
+      this->m_self.recalcIfNeeded(NE::staticMetaObject.className());
       return;
    }
 
@@ -692,7 +704,89 @@ public:
 
    //============================================== Calculation Functions ==============================================
    /**
-    * Emits changed(grains_kg), changed(grainsInMash_kg). Depends on: --.
+    * \brief Mark as stale everything that depends on the supplied inputs.  (Nothing is actually recalculated until
+    *        \c recalcStale is called.)
+    */
+   void invalidate(RecipeCalcGraph::CalcInputs const changedInputs) {
+      this->m_staleValues |= RecipeCalcGraph::derivedValuesAffectedBy(changedInputs);
+      return;
+   }
+
+   //! See \c recalcStale
+   static constexpr int maxRecalcPasses = 4;
+
+   /**
+    * \brief Recalculate all the derived values currently marked as stale, in dependency order.
+    *
+    *        If calculations are disabled, or we are in a batch edit, or there is already a recalculation further up
+    *        the call stack, then we leave things marked as stale, to be dealt with on a subsequent call.
+    */
+   void recalcStale() {
+      if (!this->m_self.m_calcsEnabled || this->m_self.isInBatchEdit() || this->m_staleValues.none()) {
+         return;
+      }
+
+      // WARNING
+      // Infinite recursion possible, since these methods will emit changed(),
+      // causing other objects to call finalVolume_l() for example, which may
+      // cause another call to recalcAll() and so on.
+      //
+      // GSG: Now only emit when m_uninitializedCalcs is true, which helps some.
+
+      // Someone has already called this function back in the call stack, so return to avoid recursion.
+      if (!this->m_self.m_recalcMutex.tryLock()) {
+         return;
+      }
+
+      // The first time through, we always need to calculate everything
+      if (this->m_self.m_uninitializedCalcs) {
+         this->m_staleValues.set();
+      }
+
+      //
+      // The recalcXxx functions emit signals, and the things listening to those signals can change the Recipe (eg by
+      // setting a property on one of its ingredients), which invalidates more derived values.  Such changes can't
+      // recalculate straight away, because we hold m_recalcMutex, so we go round again until nothing is stale.  We cap
+      // the number of passes in case some combination of signal handlers keeps invalidating things forever.
+      //
+      int numPasses = 0;
+      for (; numPasses < maxRecalcPasses && this->m_staleValues.any(); ++numPasses) {
+         for (auto const & node : RecipeCalcGraph::nodes) {
+            std::size_t const index = static_cast<std::size_t>(node.value);
+            if (!this->m_staleValues.test(index)) {
+               continue;
+            }
+            this->m_staleValues.reset(index);
+            switch (node.value) {
+               case RecipeCalcGraph::DerivedValue::Grains         : this->recalcGrains         (); break;
+               case RecipeCalcGraph::DerivedValue::VolumeEstimates: this->recalcVolumeEstimates(); break;
+               case RecipeCalcGraph::DerivedValue::Color          : this->recalcColor_mcu      (); break;
+               case RecipeCalcGraph::DerivedValue::OgFg           : this->recalcOgFg           (); break;
+               case RecipeCalcGraph::DerivedValue::ABV            : this->recalcABV_pct        (); break;
+               case RecipeCalcGraph::DerivedValue::BoilGrav       : this->recalcBoilGrav       (); break;
+               case RecipeCalcGraph::DerivedValue::IBU            : this->recalcIBU            (); break;
+               case RecipeCalcGraph::DerivedValue::Calories       : this->recalcCalories       (); break;
+               // NB: No default case as we want compiler to warn us if we missed a value above
+            }
+         }
+      }
+      if (this->m_staleValues.any()) {
+         qWarning() <<
+            Q_FUNC_INFO << "Derived values" << QString::fromStdString(this->m_staleValues.to_string()) << "still "
+            "stale after" << numPasses << "passes.  They will be recalculated on the next change.";
+      }
+
+      this->m_self.m_uninitializedCalcs = false;
+
+      this->m_self.m_recalcMutex.unlock();
+
+      qDebug() << Q_FUNC_INFO << "After calculations:" << this->m_self;
+      emit this->m_self.recalculated();
+      return;
+   }
+
+   /**
+    * Emits changed(grains_kg), changed(grainsInMash_kg). Depends on: fermentable additions.
     */
    void recalcGrains() {
       double calculatedGrains_kg = 0.0;
@@ -744,7 +838,7 @@ public:
 
    /**
     * Emits changed(wortFromMash_l), changed(boilVolume_l), changed(finalVolume_l), changed(postBoilVolume_l).
-    * Depends on: m_grainsInMash_kg
+    * Depends on: m_grainsInMash_kg, equipment, mash, boil, post-mash fermentable additions, batch size
     */
    void recalcVolumeEstimates() {
       double calculatedWortFromMash_l = 0.0;
@@ -859,7 +953,7 @@ public:
     *        than \c color_srm that we cache because, if the user changes \c ColorMethods::formula, then it changes how
     *        we derive SRM from MCU.
     *
-    *        Emits changed(color_srm). Depends on: \c m_finalVolume_l
+    *        Emits changed(color_srm). Depends on: \c m_finalVolumeNoLosses_l, fermentable additions
     */
    void recalcColor_mcu() {
 
@@ -910,7 +1004,8 @@ public:
 
    /**
     * Emits changed(og), changed(fg).
-    * Depends on: m_wortFromMash_l, m_finalVolume_l
+    * Depends on: m_wortFromMash_l, m_finalVolumeNoLosses_l, equipment, fermentable additions, yeast additions,
+    *             efficiency
     */
    void recalcOgFg() {
 
@@ -1058,7 +1153,7 @@ public:
    }
 
    /**
-    * Emits changed(ABV_pct). Depends on: m_og, m_fg
+    * Emits changed(ABV_pct). Depends on: m_og_fermentable, m_fg_fermentable
     */
    void recalcABV_pct() {
       double const calculatedABV_pct = Algorithms::abvFromOgAndFg(this->m_og_fermentable, this->m_fg_fermentable);
@@ -1075,7 +1170,7 @@ public:
    }
 
    /**
-    * Emits changed(boilGrav). Depends on: _postBoilVolume_l, _boilVolume_l
+    * Emits changed(boilGrav). Depends on: boil, fermentable additions, efficiency
     */
    void recalcBoilGrav() {
       auto const sugars = this->m_self.calcTotalPoints();
@@ -1104,7 +1199,8 @@ public:
    }
 
    /**
-    * Emits changed(IBU). Depends on: _batchSize_l, _boilGrav, _boilVolume_l, _finalVolume_l
+    * Emits changed(IBU). Depends on: batch size, m_boilGrav, m_finalVolumeNoLosses_l, m_og, equipment, boil, hop
+    * additions, fermentable additions
     */
    void recalcIBU() {
       qDebug() << Q_FUNC_INFO << "Recalculating IBU from" << this->m_IBU;
@@ -1215,15 +1311,19 @@ public:
     *        in this \c Recipe via a \c RecipeAdditionHop.
     */
    template<class IngredientType> bool usesIngredient(IngredientType const & ingredient) const {
-      auto recipeAddition = ObjectStoreWrapper::findFirstMatching<typename IngredientType::RecipeAdditionClass>(
-         [&](IngredientType::RecipeAdditionClass * addition) {
-            return addition->recipeId() == m_self.key() && addition->ingredient()->key() == ingredient.key();
-         }
+      //
+      // Searching through all the recipe additions would mean creating every one of them (as they are loaded lazily).
+      // Instead, we use the indexes that the object store keeps, which do not need any additions to be created.
+      //
+      using RecipeAdditionClass = typename IngredientType::RecipeAdditionClass;
+      QVector<int> const idsForIngredient = ObjectStoreWrapper::idsByIndex<RecipeAdditionClass>(
+         PropertyNames::IngredientAmount::ingredientId, ingredient.key()
       );
-      if (recipeAddition) {
-         return true;
-      }
-      return false;
+      // If we are a prior version, this includes the IDs of the additions we share with later versions
+      QVector<int> const idsForRecipe = this->m_self.ownedSetFor<RecipeAdditionClass>().itemIds();
+      return std::ranges::any_of(idsForRecipe, [&idsForIngredient](int const id) {
+         return idsForIngredient.contains(id);
+      });
    }
 
    /**
@@ -1231,7 +1331,11 @@ public:
     */
    template<class RA> void connectSignalForAdditionIngredient(std::shared_ptr<RA> addition) {
       typename RA::IngredientClass * ingredient = addition->ingredientRaw();
-      m_self.connect(ingredient, &NamedEntity::changed, &m_self, &Recipe::acceptChangeToContainedObject);
+      m_self.connect(ingredient,
+                     &NamedEntity::changed,
+                     &m_self,
+                     &Recipe::acceptChangeToContainedObject,
+                     Qt::UniqueConnection);
       return;
    }
 
@@ -1240,15 +1344,62 @@ public:
     */
    template<class OS> void connectSignalsForAllAdditionIngredients(OS const & additionsSet) {
       //
-      // It doesn't matter if we connect the same signal twice, so we don't bother checking whether we had the same
-      // ingredient already
+      // Because we use Qt::UniqueConnection, it doesn't matter if several additions have the same ingredient, so we
+      // don't bother checking whether we had the same ingredient already.
       //
-      for (auto addition : additionsSet.items()) {
+      // Recipe additions are loaded lazily, so we only want to connect the ones that already exist.  (Otherwise we'd
+      // force every addition for every recipe to be created at start-up.)  See Recipe::connectSignalsFor.
+      //
+      for (auto addition : additionsSet.hydratedItems()) {
          this->connectSignalForAdditionIngredient(addition);
       }
       return;
    }
 
+   /**
+    * \brief Before we stop being a prior version of the Recipe(s) after us, take our own copies of the additions etc
+    *        that we share with them.  See \c OwnedSet::doMaterialiseSharedItems.
+    */
+   void materialiseSharedItems() {
+      this->m_self.m_fermentableAdditions.doMaterialiseSharedItems();
+      this->m_self.m_hopAdditions        .doMaterialiseSharedItems();
+      this->m_self.m_miscAdditions       .doMaterialiseSharedItems();
+      this->m_self.m_yeastAdditions      .doMaterialiseSharedItems();
+      this->m_self.m_saltAdjustments     .doMaterialiseSharedItems();
+      this->m_self.m_waterUses           .doMaterialiseSharedItems();
+      return;
+   }
+
+   /**
+    * \brief Make sure our version number is at least \c minVersionNumber, and mark everything we own as being in our
+    *        current version (ie not shared with any version before it).  Needed when we (rather than a snapshot made
+    *        by \c Recipe::makePriorVersion) become the later version of another Recipe, as any of our own prior
+    *        versions are then no longer before us.
+    */
+   void setVersionNumberAndOwnItems(int const minVersionNumber) {
+      this->m_self.setVersionNumber(std::max(this->m_self.m_versionNumber, minVersionNumber));
+      int const versionNumber = this->m_self.m_versionNumber;
+      this->m_self.m_fermentableAdditions.doSetOwnerVersionOfOwnItems(versionNumber);
+      this->m_self.m_hopAdditions        .doSetOwnerVersionOfOwnItems(versionNumber);
+      this->m_self.m_miscAdditions       .doSetOwnerVersionOfOwnItems(versionNumber);
+      this->m_self.m_yeastAdditions      .doSetOwnerVersionOfOwnItems(versionNumber);
+      this->m_self.m_saltAdjustments     .doSetOwnerVersionOfOwnItems(versionNumber);
+      this->m_self.m_waterUses           .doSetOwnerVersionOfOwnItems(versionNumber);
+      return;
+   }
+
+   /**
+    * \brief Called from \c Recipe::prepareForChangeToOwnedItem.  If \c ne is an \c Item in \c ownedSet, does the
+    *        copy-on-write for it.
+    */
+   template<class Item, class OS> void copyOnWriteIfItem(OS & ownedSet, NamedEntity & ne) {
+      Item * item = dynamic_cast<Item *>(&ne);
+      if (item) {
+         ownedSet.copyOnWrite(*item);
+      }
+      return;
+   }
+
 
    //================================================ Member variables =================================================
    Recipe & m_self;
@@ -1271,6 +1422,14 @@ public:
    double        m_og_fermentable       {0.0};
    double        m_fg_fermentable       {0.0};
 
+   //! Derived values that need recalculating -- see \c invalidate and \c recalcStale
+   RecipeCalcGraph::DerivedValues m_staleValues;
+
+   //! Cached result of \c Recipe::descendants, valid only whilst \c m_descendantsGeneration matches
+   //  \c ancestryGeneration
+   QList<std::shared_ptr<Recipe>> m_descendants{};
+   unsigned int m_descendantsGeneration = 0;
+
 };
 
 template<> auto & Recipe::ownedSetFor<RecipeAdditionFermentable>() const { return this->m_fermentableAdditions; }
@@ -1352,6 +1511,7 @@ QString Recipe::localisedName_styleId                () { return tr("Style ID"
 QString Recipe::localisedName_tasteNotes             () { return tr("Taste Notes"            ); }
 QString Recipe::localisedName_tasteRating            () { return tr("Taste Rating"           ); }
 QString Recipe::localisedName_type                   () { return tr("Type"                   ); }
+QString Recipe::localisedName_versionNumber          () { return tr("Version Number"         ); }
 QString Recipe::localisedName_waterUses              () { return tr("Water Uses"             ); }
 QString Recipe::localisedName_wortFromMash_l         () { return tr("Wort From Mash"         ); }
 QString Recipe::localisedName_yeastAdditions         () { return tr("Yeast Additions"        ); }
@@ -1461,6 +1621,7 @@ TypeLookup const Recipe::typeLookup {
       PROPERTY_TYPE_LOOKUP_ENTRY(Recipe, locked           , m_locked            ),
       PROPERTY_TYPE_LOOKUP_ENTRY(Recipe, calcsEnabled     , m_calcsEnabled      ),
       PROPERTY_TYPE_LOOKUP_ENTRY(Recipe, ancestorId       , m_ancestor_id       ),
+      PROPERTY_TYPE_LOOKUP_ENTRY(Recipe, versionNumber    , m_versionNumber     ),
       PROPERTY_TYPE_LOOKUP_NO_MV(Recipe, numAncestors     , numAncestors       ,        NonPhysicalQuantity::CardinalNumber),
       PROPERTY_TYPE_LOOKUP_NO_MV(Recipe, ABV_pct          , ABV_pct         ,           NonPhysicalQuantity::Percentage   ), // Calculated, not in DB
       PROPERTY_TYPE_LOOKUP_NO_MV(Recipe, boilGrav         , boilGrav        , Measurement::PhysicalQuantity::Density      ), // Calculated, not in DB
@@ -1543,7 +1704,8 @@ Recipe::Recipe(QString name) :
    m_recalcMutex            {},
    m_ancestor_id            {-1                  },
    m_ancestors              {},
-   m_hasDescendants         {false               } {
+   m_hasDescendants         {false               },
+   m_versionNumber          {0                   } {
 
    CONSTRUCTOR_END
    return;
@@ -1598,7 +1760,8 @@ Recipe::Recipe(NamedParameterBundle const & namedParameterBundle) :
                          m_recalcMutex            {},
    SET_REGULAR_FROM_NPB (m_ancestor_id            , namedParameterBundle, PropertyNames::Recipe::ancestorId             , -1),
                          m_ancestors              {},
-                         m_hasDescendants         {false} {
+                         m_hasDescendants         {false},
+   SET_REGULAR_FROM_NPB (m_versionNumber          , namedParameterBundle, PropertyNames::Recipe::versionNumber          , 0) {
    // At this stage, we haven't set any Hops, Fermentables, etc.  This is deliberate because the caller typically needs
    // to access subsidiary records to obtain this info.   Callers will usually use setters (setHopIds, etc but via
    // setProperty) to finish constructing the object.
@@ -1658,7 +1821,9 @@ Recipe::Recipe(Recipe const & other) :
    // Copying a Recipe doesn't copy its descendants
    m_ancestor_id            {-1                        },
    m_ancestors              {},
-   m_hasDescendants         {false                     } {
+   m_hasDescendants         {false                     },
+   // The copy is a new Recipe, not a version of the one it was copied from
+   m_versionNumber          {0                         } {
    setObjectName("Recipe"); // .:TBD:. Would be good to understand whether/why we need this
 
    //
@@ -1677,6 +1842,74 @@ Recipe::Recipe(Recipe const & other) :
    return;
 }
 
+Recipe::Recipe(Recipe const & other, [[maybe_unused]] PriorVersionKey) :
+   NamedEntity{other},
+   FolderBase<Recipe>{other},
+   pimpl{std::make_unique<impl>(*this, other)},
+   m_type                   {other.m_type              },
+   m_brewer                 {other.m_brewer            },
+   m_asstBrewer             {other.m_asstBrewer        },
+   m_batchSize_l            {other.m_batchSize_l       },
+   m_efficiency_pct         {other.m_efficiency_pct    },
+   m_age_days               {other.m_age_days          },
+   m_ageTemp_c              {other.m_ageTemp_c         },
+   m_date                   {other.m_date              }, // Unlike a copy, a prior version keeps its date
+   m_carbonation_vols       {other.m_carbonation_vols  },
+   m_forcedCarbonation      {other.m_forcedCarbonation },
+   m_primingSugarName       {other.m_primingSugarName  },
+   m_carbonationTemp_c      {other.m_carbonationTemp_c },
+   m_primingSugarEquiv      {other.m_primingSugarEquiv },
+   m_kegPrimingFactor       {other.m_kegPrimingFactor  },
+   m_notes                  {other.m_notes             },
+   m_tasteNotes             {other.m_tasteNotes        },
+   m_tasteRating            {other.m_tasteRating       },
+   m_styleId                {other.m_styleId           },
+   m_equipmentId            {other.m_equipmentId       },
+   m_mashId                 {other.m_mashId            },
+   m_boilId                 {other.m_boilId            },
+   m_fermentationId         {other.m_fermentationId    },
+   m_beerAcidity_pH         {other.m_beerAcidity_pH    },
+   m_apparentAttenuation_pct{other.m_apparentAttenuation_pct},
+   // These are shared with other, so there is nothing to copy
+   m_fermentableAdditions   {*this                     },
+   m_hopAdditions           {*this                     },
+   m_miscAdditions          {*this                     },
+   m_yeastAdditions         {*this                     },
+   m_saltAdjustments        {*this                     },
+   m_waterUses              {*this                     },
+   // Brew notes stay with the version that was brewed, which is other
+   m_brewNotes              {*this                     },
+   m_instructions           {*this, other.m_instructions},
+   m_og                     {other.m_og                },
+   m_fg                     {other.m_fg                },
+   m_locked                 {other.m_locked            },
+   m_calcsEnabled           {other.m_calcsEnabled      },
+   m_uninitializedCalcs     {true                      },
+   m_uninitializedCalcsMutex{},
+   m_recalcMutex            {},
+   //
+   // We take over other's existing ancestors (if any) now, so that it is stored in the DB with us.  (If other has no
+   // ancestors, setKey will make us our own ancestor.)
+   //
+   m_ancestor_id            {other.m_ancestor_id != other.key() ? other.m_ancestor_id : -1},
+   m_ancestors              {},
+   m_hasDescendants         {false                     },
+   m_versionNumber          {other.m_versionNumber     } {
+   setObjectName("Recipe");
+
+   NamedEntityModifyingMarker modifyingMarker(*this);
+
+   this->connectSignals();
+
+   //
+   // Unlike the copy constructor, we don't call recalcAll() here.  Until we are stored in the DB (and thus have an ID
+   // that other's shared items can be matched up with), we can't see the items we share with other.  Instead, the
+   // calculated values are worked out the first time they are needed (see impl::getCalculated).
+   //
+   CONSTRUCTOR_END
+   return;
+}
+
 // See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
 // header file)
 Recipe::~Recipe() = default;
@@ -1699,6 +1932,9 @@ void Recipe::setKey(int key) {
    this->m_brewNotes           .doSetKey(key);
    this->m_instructions        .doSetKey(key);
 
+   // A newly stored Recipe might be a later version of one we already have
+   ++ancestryGeneration;
+
    // By convention, a new Recipe with no ancestor should have itself as its own ancestor.  So we need to check whether
    // to set that default here (which will then result in a DB update).  Otherwise, ancestor ID would remain as null.
    //
@@ -1757,6 +1993,30 @@ void Recipe::connectSignals() {
    return;
 }
 
+void Recipe::connectSignalsFor(std::shared_ptr<RecipeAdditionFermentable> fermentableAddition) {
+   this->m_fermentableAdditions.connectItemChangedSignal(fermentableAddition);
+   this->pimpl->connectSignalForAdditionIngredient(fermentableAddition);
+   return;
+}
+
+void Recipe::connectSignalsFor(std::shared_ptr<RecipeAdditionHop> hopAddition) {
+   this->m_hopAdditions.connectItemChangedSignal(hopAddition);
+   this->pimpl->connectSignalForAdditionIngredient(hopAddition);
+   return;
+}
+
+void Recipe::connectSignalsFor(std::shared_ptr<RecipeAdditionMisc> miscAddition) {
+   this->m_miscAdditions.connectItemChangedSignal(miscAddition);
+   this->pimpl->connectSignalForAdditionIngredient(miscAddition);
+   return;
+}
+
+void Recipe::connectSignalsFor(std::shared_ptr<RecipeAdditionYeast> yeastAddition) {
+   this->m_yeastAdditions.connectItemChangedSignal(yeastAddition);
+   this->pimpl->connectSignalForAdditionIngredient(yeastAddition);
+   return;
+}
+
 void Recipe::generateInstructions() {
    double totalWaterAdded_l = 0.0;
 
@@ -2017,17 +2277,15 @@ int Recipe::numRecipesUsing(IngredientType const & ingredient) requires (std::is
    //
    //    return ObjectStoreWrapper::numMatching<Recipe>( [& var](Recipe const * rec) {return rec->uses(var);} );
    //
+   // Recipe additions are indexed by ingredient ID, so we don't even need to search through all of them.
+   //
    boost::container::flat_set<int> matchingRecipeIds;
-   return ObjectStoreWrapper::numMatching<typename IngredientType::RecipeAdditionClass>(
-      [&](IngredientType::RecipeAdditionClass const * addition) {
-         if (addition->ingredientId() == ingredient.key()) {
-            // Emplace returns std::pair<iterator, bool>.  The bool component of this is true if and only if the
-            // insertion took place (ie the item wasn't already in the set).
-            return matchingRecipeIds.emplace(addition->recipeId()).second;
-         }
-         return false;
-      }
-   );
+   for (auto const * addition : ObjectStoreWrapper::findByIndexRaw<typename IngredientType::RecipeAdditionClass>(
+      PropertyNames::IngredientAmount::ingredientId, ingredient.key()
+   )) {
+      matchingRecipeIds.emplace(addition->recipeId());
+   }
+   return static_cast<int>(matchingRecipeIds.size());
 }
 template int Recipe::numRecipesUsing(Fermentable const & ingredient);
 template int Recipe::numRecipesUsing(Hop         const & ingredient);
@@ -2146,10 +2404,11 @@ void Recipe::setBatchSize_l(double var) {
                       this->m_batchSize_l,
                       this->enforceMin(var, "batch size"));
 
-   // NOTE: this is bad, but we have to call recalcAll(), because the estimated
-   // boil/batch volumes depend on the target volumes when there are no mash
-   // steps to actually provide an estimate for the volumes.
-   recalcAll();
+   // The estimated boil/batch volumes depend on the target volumes when there are no mash steps to actually provide
+   // an estimate for the volumes, so we have to recalculate everything that depends on the batch size.
+   this->pimpl->invalidate(RecipeCalcGraph::calcInputs({RecipeCalcGraph::CalcInput::BatchSize}));
+   this->pimpl->recalcStale();
+   return;
 }
 
 void Recipe::setEfficiency_pct(double val) {
@@ -2157,10 +2416,11 @@ void Recipe::setEfficiency_pct(double val) {
                       this->m_efficiency_pct,
                       this->enforceMinAndMax(val, "efficiency", 0.0, 100.0, 70.0));
 
-   // If you change the efficency, you really should recalc. And I'm afraid it
-   // means recalc all, since og and fg will change, which means your ratios
+   // If you change the efficiency, you really should recalc, since og and fg will change, which means your ratios
    // change
-   recalcAll();
+   this->pimpl->invalidate(RecipeCalcGraph::calcInputs({RecipeCalcGraph::CalcInput::Efficiency}));
+   this->pimpl->recalcStale();
+   return;
 }
 
 void Recipe::setAsstBrewer(const QString & val) {
@@ -2252,6 +2512,17 @@ void Recipe::setLocked(bool const isLocked) {
    return;
 }
 
+void Recipe::setVersionNumber(int const val) {
+   // As with locking, moving on to a new version number doesn't itself count as changing the Recipe, and isn't
+   // something the UI needs to know about.
+   if (this->newValueMatchesExisting(PropertyNames::Recipe::versionNumber, this->m_versionNumber, val)) {
+      return;
+   }
+   this->m_versionNumber = val;
+   this->propagatePropertyChange(PropertyNames::Recipe::versionNumber, false);
+   return;
+}
+
 void Recipe::setCalcsEnabled(bool const val) {
    this->m_calcsEnabled = val;
    return;
@@ -2278,6 +2549,18 @@ QList<std::shared_ptr<Recipe>> Recipe::ancestors() const {
          qDebug() << Q_FUNC_INFO << "Found ancestor Recipe #" << ancestor->key();
          ancestor->m_hasDescendants = true;
          this->m_ancestors.append(ancestor);
+
+         //
+         // A Recipe's ancestors are its parent plus its parent's ancestors.  If the parent has already worked out its
+         // own ancestors (which is typical when the tree is loading, as every version of a Recipe gets asked), we can
+         // just take them rather than carrying on down the chain one getById call at a time, which would otherwise
+         // make loading a long chain of versions quadratic.  (Their m_hasDescendants flags were set when the parent's
+         // list was built, so there is no need to go through them again here.)
+         //
+         if (!ancestor->m_ancestors.isEmpty()) {
+            this->m_ancestors.append(ancestor->m_ancestors);
+            break;
+         }
          recipe = ancestor.get();
       }
    }
@@ -2308,6 +2591,38 @@ bool Recipe::isMyAncestor(Recipe const & maybe) const {
 bool Recipe::hasDescendants() const {
    return this->m_hasDescendants;
 }
+
+QList<std::shared_ptr<Recipe>> Recipe::descendants() const {
+   if (this->key() < 0) {
+      return {};
+   }
+
+   if (this->pimpl->m_descendantsGeneration != ancestryGeneration) {
+      //
+      // Each Recipe only knows its immediate ancestor, so we have to search for each later version in turn.  This is
+      // why we cache the result.
+      //
+      QList<std::shared_ptr<Recipe>> laterVersions;
+      int currentKey = this->key();
+      while (true) {
+         auto descendant = ObjectStoreWrapper::findFirstMatching<Recipe>(
+            [currentKey](std::shared_ptr<Recipe> recipe) {
+               return recipe->key() != currentKey && recipe->m_ancestor_id == currentKey;
+            }
+         );
+         // Guard against a loop in the ancestry, which would be a bug elsewhere, but shouldn't hang us here
+         if (!descendant || descendant.get() == this || laterVersions.contains(descendant)) {
+            break;
+         }
+         laterVersions.append(descendant);
+         currentKey = descendant->key();
+      }
+      this->pimpl->m_descendants = laterVersions;
+      this->pimpl->m_descendantsGeneration = ancestryGeneration;
+   }
+
+   return this->pimpl->m_descendants;
+}
 void Recipe::setHasDescendants(bool spawned) {
    // This is not explicitly stored in the database, so no setAndNotify call etc here
    this->m_hasDescendants = spawned;
@@ -2336,18 +2651,52 @@ void Recipe::setAncestorId(int ancestorId, bool notify) {
    if (this->newValueMatchesExisting(PropertyNames::Recipe::ancestorId, this->m_ancestor_id, ancestorId)) {
       return;
    }
-   // Note that changing m_ancestor_id invalidates m_ancestors
+   // Note that changing m_ancestor_id invalidates m_ancestors, and the descendants of every Recipe in our ancestry
    this->m_ancestor_id = ancestorId;
    this->m_ancestors.clear();
+   ++ancestryGeneration;
    this->propagatePropertyChange(PropertyNames::Recipe::ancestorId, notify);
    return;
 }
 
 void Recipe::setAncestor(Recipe & ancestor) {
+   if (&ancestor == this) {
+      //
+      // We're about to be cut off from our prior versions, so the immediate one can no longer share things with us
+      // (or, via us, with any later versions).  (Earlier prior versions see what they share through the immediate
+      // one, so its copies are all they need.)
+      //
+      auto const priorVersions = this->ancestors();
+      if (!priorVersions.isEmpty()) {
+         priorVersions.first()->pimpl->materialiseSharedItems();
+      }
+      this->linkAncestor(*this);
+      return;
+   }
+
+   //
+   // Here, ancestor is a separate Recipe, with its own additions etc, rather than a snapshot of us made by
+   // makePriorVersion.  (Eg the user has used the ancestor dialog to say one Recipe is a prior version of another.)
+   // If we already have prior versions, they are going to become prior versions of ancestor, so the immediate one has
+   // to stop sharing things with us, and ancestor's version number has to come after it.  Then we come after ancestor,
+   // and nothing we own is shared with any version before us.
+   //
+   auto const priorVersions = this->ancestors();
+   if (!priorVersions.isEmpty()) {
+      priorVersions.first()->pimpl->materialiseSharedItems();
+      ancestor.pimpl->setVersionNumberAndOwnItems(priorVersions.first()->versionNumber() + 1);
+   }
+   this->pimpl->setVersionNumberAndOwnItems(ancestor.versionNumber() + 1);
+
+   this->linkAncestor(ancestor);
+   return;
+}
+
+void Recipe::linkAncestor(Recipe & ancestor) {
    //
    // Typical usage is:
    //    - Recipe A is about to be modified
-   //    - We create Recipe B as a deep copy of Recipe A
+   //    - We create Recipe B as a snapshot of Recipe A
    //    - Recipe B becomes Recipe A's immediate ancestor, via call to this function
    //    - Recipe A is modified
    // This means that, if Recipe A already has a direct ancestor, then Recipe B needs to take it
@@ -2369,10 +2718,13 @@ void Recipe::setAncestor(Recipe & ancestor) {
          }
       } else {
          // Give our existing ancestors them to the new direct ancestor (aka immediate prior version).  Note that it's
-         // a coding error if this new direct ancestor already has its own ancestors.
-         Q_ASSERT(ancestor.m_ancestor_id == ancestor.key() || ancestor.m_ancestor_id <= 0);
+         // a coding error if this new direct ancestor already has its own ancestors -- unless they are ours, which is
+         // the case for a snapshot made by makePriorVersion.
+         Q_ASSERT(ancestor.m_ancestor_id == ancestor.key() || ancestor.m_ancestor_id <= 0 ||
+                  ancestor.m_ancestor_id == this->m_ancestor_id);
          ancestor.m_ancestor_id = this->m_ancestor_id;
          ancestor.m_ancestors = this->ancestors();
+         ++ancestryGeneration;
       }
    }
 
@@ -2392,6 +2744,48 @@ void Recipe::setAncestor(Recipe & ancestor) {
    return;
 }
 
+std::shared_ptr<Recipe> Recipe::makePriorVersion() {
+   // A Recipe that was made as a full copy of a later version starts sharing things once it has a prior version itself
+   if (this->m_versionNumber < 0) {
+      this->setVersionNumber(0);
+   }
+
+   // We don't want to trigger versioning on the new prior version until we're completely done here!
+   auto priorVersion = std::make_shared<Recipe>(*this, PriorVersionKey{});
+   NamedEntityModifyingMarker priorVersionModifyingMarker(*priorVersion);
+
+   //
+   // The prior version has our current version number, so, once we move on to the next one, it sees everything we own
+   // as it is now.  Anything we change or add from here on is only in our new version.
+   //
+   this->setVersionNumber(this->m_versionNumber + 1);
+
+   // Put the prior version in the DB, so it has an ID.  (This will also emit signalObjectInserted for it from
+   // ObjectStoreTyped<Recipe>.)
+   ObjectStoreWrapper::insert(priorVersion);
+   qDebug() <<
+      Q_FUNC_INFO << "Made Recipe #" << priorVersion->key() << "version" << priorVersion->versionNumber() <<
+      "as prior version of Recipe #" << this->key();
+
+   this->linkAncestor(*priorVersion);
+   return priorVersion;
+}
+
+void Recipe::prepareForChangeToOwnedItem(NamedEntity & item) {
+   // Nothing is shared if we don't have any prior versions
+   if (this->m_ancestor_id <= 0 || this->m_ancestor_id == this->key()) {
+      return;
+   }
+
+   this->pimpl->copyOnWriteIfItem<RecipeAdditionFermentable>(this->m_fermentableAdditions, item);
+   this->pimpl->copyOnWriteIfItem<RecipeAdditionHop        >(this->m_hopAdditions        , item);
+   this->pimpl->copyOnWriteIfItem<RecipeAdditionMisc       >(this->m_miscAdditions       , item);
+   this->pimpl->copyOnWriteIfItem<RecipeAdditionYeast      >(this->m_yeastAdditions      , item);
+   this->pimpl->copyOnWriteIfItem<RecipeAdjustmentSalt     >(this->m_saltAdjustments     , item);
+   this->pimpl->copyOnWriteIfItem<RecipeUseOfWater         >(this->m_waterUses           , item);
+   return;
+}
+
 Recipe * Recipe::revertToPreviousVersion() {
    // If there are no ancestors then there is nothing to do
    if (!this->hasAncestors()) {
@@ -2400,6 +2794,8 @@ Recipe * Recipe::revertToPreviousVersion() {
 
    // Reactivate our immediate ancestor (aka previous version)
    Recipe * ancestor = ObjectStoreWrapper::getByIdRaw<Recipe>(this->m_ancestor_id);
+   // We are (usually) about to be deleted, so our ancestor needs its own copies of everything it shares with us
+   ancestor->pimpl->materialiseSharedItems();
    ancestor->setLocked(false);
    ancestor->setHasDescendants(false);
 
@@ -2510,6 +2906,7 @@ QList<std::shared_ptr<Instruction              >> Recipe::        instructions()
 
 int Recipe::getAncestorId() const { return this->m_ancestor_id; }
 int Recipe::numAncestors () const { return this->ancestors().size(); }
+int Recipe::versionNumber() const { return this->m_versionNumber; }
 
 //============================== Other Getters ===================================
 Recipe::Type           Recipe::type             () const { return m_type             ; }
@@ -2536,69 +2933,32 @@ bool                   Recipe::calcsEnabled     () const { return m_calcsEnabled
 std::optional<double> Recipe::beerAcidity_pH         () const { return m_beerAcidity_pH         ; }
 std::optional<double> Recipe::apparentAttenuation_pct() const { return m_apparentAttenuation_pct; }
 
+void Recipe::batchEditEnded() {
+   // Anything that changed during the batch edit will have marked the relevant derived values as stale
+   this->pimpl->recalcStale();
+   return;
+}
+
 //==============================Recalculators==================================
 
 void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged) {
    qDebug() << Q_FUNC_INFO << classNameOfWhatWasAddedOrChanged;
-   // We could just compare with "Hop", "Equipment", etc but there's then no compile-time checking of typos.  Using
-   // ::staticMetaObject.className() is a bit more clunky but it's safer.
-
-   if (classNameOfWhatWasAddedOrChanged ==               Hop::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged == RecipeAdditionHop::staticMetaObject.className()) {
-      this->pimpl->recalcIBU();
-      return;
-   }
-
-   if (classNameOfWhatWasAddedOrChanged ==                 Equipment::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged ==               Fermentable::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged == RecipeAdditionFermentable::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged ==                      Mash::staticMetaObject.className()) {
-      this->recalcAll();
-      return;
-   }
-
-   if (classNameOfWhatWasAddedOrChanged ==               Yeast::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged == RecipeAdditionYeast::staticMetaObject.className()) {
-      this->pimpl->recalcOgFg();
-      this->pimpl->recalcABV_pct();
+   RecipeCalcGraph::CalcInputs const changedInputs =
+      RecipeCalcGraph::calcInputsForClass(classNameOfWhatWasAddedOrChanged);
+   if (changedInputs.none()) {
       return;
    }
 
+   this->pimpl->invalidate(changedInputs);
+   this->pimpl->recalcStale();
    return;
 }
 
 void Recipe::recalcAll() {
-   qDebug() << Q_FUNC_INFO << "Calculations " << (this->m_calcsEnabled ? "enabled" : "disabled") << "for" << *this;
-   if (!this->m_calcsEnabled) {
-      return;
-   }
-
-   // WARNING
-   // Infinite recursion possible, since these methods will emit changed(),
-   // causing other objects to call finalVolume_l() for example, which may
-   // cause another call to recalcAll() and so on.
-   //
-   // GSG: Now only emit when m_uninitializedCalcs is true, which helps some.
-
-   // Someone has already called this function back in the call stack, so return to avoid recursion.
-   if (!this->m_recalcMutex.tryLock()) {
-      return;
-   }
-
-   this->pimpl->recalcGrains();
-   this->pimpl->recalcVolumeEstimates();
-   this->pimpl->recalcColor_mcu();
-   this->pimpl->recalcOgFg();
-   this->pimpl->recalcABV_pct();
-   this->pimpl->recalcBoilGrav();
-   this->pimpl->recalcIBU();
-   this->pimpl->recalcCalories();
-
-   this->m_uninitializedCalcs = false;
-
-   this->m_recalcMutex.unlock();
-
-   qDebug() << Q_FUNC_INFO << "After calculations:" << *this;
+   qCDebug(Logging::category) <<
+      Q_FUNC_INFO << "Calculations " << (this->m_calcsEnabled ? "enabled" : "disabled") << "for" << *this;
+   this->pimpl->invalidate(RecipeCalcGraph::CalcInputs{}.set());
+   this->pimpl->recalcStale();
    return;
 }
 
@@ -2647,14 +3007,9 @@ Recipe::Sugars Recipe::calcTotalPoints() {
 double Recipe::ibuFromHopAddition(RecipeAdditionHop const & hopAddition) {
    auto equipment = this->equipment();
    double ibus = 0.0;
-   double fwhAdjust = Localization::toDouble(
-      PersistentSettings::value_ck(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
-      Q_FUNC_INFO
-   );
-   double mashHopAdjust = Localization::toDouble(
-      PersistentSettings::value_ck(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
-      Q_FUNC_INFO
-   );
+   // These are called once per hop addition on every IBU recalculation, so we use the cached typed accessor
+   double fwhAdjust     = PersistentSettings::valueAsDouble_ck(PersistentSettings::Names::firstWortHopAdjustment, 1.1);
+   double mashHopAdjust = PersistentSettings::valueAsDouble_ck(PersistentSettings::Names::mashHopAdjustment     , 0.0);
 
    // It's a coding error to ask one recipe about another's hop additions!  Uncomment the log statement here if the
    // assert is firing.
@@ -2856,9 +3211,10 @@ void Recipe::acceptChangeToContainedObject(QMetaProperty prop, QVariant val) {
    }
 
    //
-   // ...but in general we just recalculate everything rather than try to work out whether the particular change to the
-   // Hop, RecipeAdditionHop, Fermentable, RecipeAdditionFermentable, Mash, Boil, etc would make a difference to our
-   // calculated fields.  This is marginally inefficient, but considerably simplifies the code here.
+   // ...but in general we just recalculate whatever depends on the type of thing that changed (Hop, RecipeAdditionHop,
+   // Fermentable, RecipeAdditionFermentable, Mash, Boil, etc).  We don't try to work out whether the particular
+   // property that changed would make a difference to our calculated fields, as that would considerably complicate the
+   // code here.
    //
    this->recalcIfNeeded(signalSenderClassName);
 
@@ -2988,6 +3344,16 @@ double Recipe::targetTotalMashVol_l() const {
 }
 
 void Recipe::hardDeleteOwnedEntities() {
+   //
+   // If we are a later version of another Recipe, it might be sharing some of the things we are about to delete, so
+   // it needs its own copies of them first.  (Normally, revertToPreviousVersion will already have done this.)
+   //
+   auto const priorVersions = this->ancestors();
+   if (!priorVersions.isEmpty()) {
+      priorVersions.first()->pimpl->materialiseSharedItems();
+   }
+   ++ancestryGeneration;
+
    this->m_fermentableAdditions.doHardDeleteOwnedEntities();
    this->m_hopAdditions        .doHardDeleteOwnedEntities();
    this->m_miscAdditions       .doHardDeleteOwnedEntities();
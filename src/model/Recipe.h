@@ -102,6 +102,7 @@ AddPropertyName(styleId                )
 AddPropertyName(tasteNotes             )
 AddPropertyName(tasteRating            )
 AddPropertyName(type                   )
+AddPropertyName(versionNumber          )
 AddPropertyName(waterUses              )
 AddPropertyName(wortFromMash_l         )
 AddPropertyName(yeastAdditions         )
@@ -215,6 +216,7 @@ public:
    static QString localisedName_tasteNotes             ();
    static QString localisedName_tasteRating            ();
    static QString localisedName_type                   ();
+   static QString localisedName_versionNumber          ();
    static QString localisedName_waterUses              ();
    static QString localisedName_wortFromMash_l         ();
    static QString localisedName_yeastAdditions         ();
@@ -226,9 +228,22 @@ public:
    static TypeLookup const typeLookup;
    TYPE_LOOKUP_GETTER
 
+private:
+   //! Only \c Recipe can construct one of these, so only \c Recipe can call the constructor that takes it
+   class PriorVersionKey {
+      friend class Recipe;
+      PriorVersionKey() = default;
+   };
+
+public:
    Recipe(QString name);
    Recipe(NamedParameterBundle const & namedParameterBundle);
    Recipe(Recipe const & other);
+   /**
+    * \brief Used by \c makePriorVersion.  Copies \c other but not the things it owns (apart from instructions), which
+    *        the new Recipe, as a prior version of \c other, shares instead.
+    */
+   Recipe(Recipe const & other, PriorVersionKey);
 
    virtual ~Recipe();
 
@@ -442,6 +457,17 @@ public:
    //! \brief The total number of ancestors
    Q_PROPERTY(int numAncestors READ numAncestors STORED false)
 
+   /**
+    * \brief Goes up by one each time a prior version (aka snapshot aka ancestor) of this Recipe is made with
+    *        \c makePriorVersion.  A prior version takes the version number this Recipe had when the prior version was
+    *        made, and shares with this Recipe all the additions, water uses etc that have not changed since.  See
+    *        \c OwnedSetOptions::sharedWithPriorVersions.
+    *
+    *        -1 means this Recipe is a prior version that was made as a full copy (which is how prior versions were
+    *        made before we shared things between versions), so shares nothing with later versions.
+    */
+   Q_PROPERTY(int versionNumber READ versionNumber WRITE setVersionNumber)
+
    /**
     * \brief We need to override \c NamedEntity::setKey to do some extra ancestor stuff
     */
@@ -454,9 +480,22 @@ public:
     *        if the alpha acid on a hop is modified then that will affect the recipe's IBU.
     *
     *        Called from \c ObjectStoreTyped::postLoadInit
+    *
+    *        NB: Recipe additions are loaded lazily (see \c ObjectStore::LazyLoadOptions), so this only connects the ones
+    *            that already exist.  The rest get connected via \c connectSignalsFor as and when they are created.
     */
    void connectSignals();
 
+   /**
+    * \brief Connect the signals for a single recipe addition (and its ingredient) to this \c Recipe.  Called by the
+    *        relevant object store when it creates the addition after start-up.  (It does no harm to call this for an
+    *        addition that is already connected.)
+    */
+   void connectSignalsFor(std::shared_ptr<RecipeAdditionFermentable> fermentableAddition);
+   void connectSignalsFor(std::shared_ptr<RecipeAdditionHop        > hopAddition        );
+   void connectSignalsFor(std::shared_ptr<RecipeAdditionMisc       > miscAddition       );
+   void connectSignalsFor(std::shared_ptr<RecipeAdditionYeast      > yeastAddition      );
+
    /**
     * \brief Use this for adding \c RecipeAdditionHop, etc.
     *
@@ -529,9 +568,29 @@ public:
     */
    virtual bool subsidiary() const override;
 
-   //! \brief convenience method to set ancestors
+   /**
+    * \brief Convenience method to set ancestors.  \c ancestor is assumed to be a separate copy of this Recipe, so it
+    *        does not share additions etc with this Recipe.  (See \c makePriorVersion for making one that does.)
+    */
    void setAncestor(Recipe & ancestor);
 
+   /**
+    * \brief Makes and stores a new prior version (aka snapshot aka ancestor) of this Recipe, and links it in as our
+    *        immediate ancestor.  Only the Recipe itself (and its instructions) are copied -- the prior version shares
+    *        this Recipe's additions, water uses etc until they are changed or removed here.
+    *
+    * \return The new prior version
+    */
+   std::shared_ptr<Recipe> makePriorVersion();
+
+   /**
+    * \brief Needs to be called before \c item, which should be one of the things this Recipe owns, is modified.  If
+    *        \c item is shared with prior versions of this Recipe, the immediately prior version is given a copy of it,
+    *        so that the change only affects this version.  Does nothing for things that are not shared between
+    *        versions.
+    */
+   void prepareForChangeToOwnedItem(NamedEntity & item);
+
    /**
     * \brief Usually called before deleting a Recipe.  Unlinks this Recipe from its its ancestors (aka previous
     *        versions) and set the most recent of these to be editable again.
@@ -625,6 +684,11 @@ public:
    QList<std::shared_ptr<Instruction>>               instructions          () const;
    QList<std::shared_ptr<Recipe>>                    ancestors             () const;
    QList<Recipe *>                                   ancestorsRaw          () const;
+   /**
+    * \brief The later versions of this Recipe, starting with the one whose immediate ancestor we are.  Empty unless we
+    *        are a prior version.  Worked out when first needed after any Recipe's ancestry changes.
+    */
+   QList<std::shared_ptr<Recipe>>                    descendants           () const;
    std::shared_ptr<Equipment>                        equipment             () const;
    int                                               getEquipmentId        () const;
    std::shared_ptr<Style>                            style                 () const;
@@ -661,6 +725,7 @@ public:
 
    int getAncestorId() const;
    int numAncestors () const;
+   int versionNumber() const;
 
    // Relational setters
    void setEquipment   (std::shared_ptr<Equipment   > val);
@@ -697,6 +762,7 @@ public:
    void setBoilId        (int const id);
    void setFermentationId(int const id);
    void setAncestorId    (int ancestorId, bool notify = true);
+   void setVersionNumber (int const val);
    //! @}
 
    // Other junk.
@@ -775,6 +841,13 @@ signals:
    //! Emitted when the number (or order) of instructions changes, or when you should call instructions() again.
    void ownedItemsChanged();
 
+   /**
+    * \brief Emitted after derived values (OG, IBU, etc) have been recalculated.  (Each derived value that changed will
+    *        also have had its own \c changed signal.)  In a batch edit (see \c NamedEntityBatchEdit), this happens
+    *        once, at the end.
+    */
+   void recalculated();
+
 public slots:
    void acceptChangeToContainedObject(QMetaProperty prop, QVariant val);
    // It would be neat if we could template these slots, but the Qt MOC does not allow it, and will give "error:
@@ -791,6 +864,7 @@ public slots:
 protected:
    virtual bool compareWith(NamedEntity const & other, QList<BtStringConst const *> * propertiesThatDiffer) const override;
    virtual ObjectStore & getObjectStoreTypedInstance() const override;
+   virtual void batchEditEnded() override;
 
 private:
    // Private implementation details - see https://herbsutter.com/gotw/_100/
@@ -826,12 +900,22 @@ private:
    std::optional<double> m_beerAcidity_pH         ;
    std::optional<double> m_apparentAttenuation_pct;
 
-   OwnedSet<Recipe, RecipeAdditionFermentable, PropertyNames::Recipe::fermentableAdditions, &Recipe::acceptChangeToRecipeAdditionFermentable> m_fermentableAdditions;
-   OwnedSet<Recipe, RecipeAdditionHop        , PropertyNames::Recipe::hopAdditions        , &Recipe::acceptChangeToRecipeAdditionHop        > m_hopAdditions        ;
-   OwnedSet<Recipe, RecipeAdditionMisc       , PropertyNames::Recipe::miscAdditions       , &Recipe::acceptChangeToRecipeAdditionMisc       > m_miscAdditions       ;
-   OwnedSet<Recipe, RecipeAdditionYeast      , PropertyNames::Recipe::yeastAdditions      , &Recipe::acceptChangeToRecipeAdditionYeast      > m_yeastAdditions      ;
-   OwnedSet<Recipe, RecipeAdjustmentSalt     , PropertyNames::Recipe::saltAdjustments     , &Recipe::acceptChangeToRecipeAdjustmentSalt     > m_saltAdjustments     ;
-   OwnedSet<Recipe, RecipeUseOfWater         , PropertyNames::Recipe::waterUses           , &Recipe::acceptChangeToRecipeUseOfWater         > m_waterUses           ;
+   /**
+    * \brief Additions, salt adjustments and water uses are shared with prior versions of the Recipe (see
+    *        \c makePriorVersion) until they change.
+    */
+   OwnedSet<Recipe, RecipeAdditionFermentable, PropertyNames::Recipe::fermentableAdditions, &Recipe::acceptChangeToRecipeAdditionFermentable,
+                                               OwnedSetOptions{.sharedWithPriorVersions = true}> m_fermentableAdditions;
+   OwnedSet<Recipe, RecipeAdditionHop        , PropertyNames::Recipe::hopAdditions        , &Recipe::acceptChangeToRecipeAdditionHop        ,
+                                               OwnedSetOptions{.sharedWithPriorVersions = true}> m_hopAdditions        ;
+   OwnedSet<Recipe, RecipeAdditionMisc       , PropertyNames::Recipe::miscAdditions       , &Recipe::acceptChangeToRecipeAdditionMisc       ,
+                                               OwnedSetOptions{.sharedWithPriorVersions = true}> m_miscAdditions       ;
+   OwnedSet<Recipe, RecipeAdditionYeast      , PropertyNames::Recipe::yeastAdditions      , &Recipe::acceptChangeToRecipeAdditionYeast      ,
+                                               OwnedSetOptions{.sharedWithPriorVersions = true}> m_yeastAdditions      ;
+   OwnedSet<Recipe, RecipeAdjustmentSalt     , PropertyNames::Recipe::saltAdjustments     , &Recipe::acceptChangeToRecipeAdjustmentSalt     ,
+                                               OwnedSetOptions{.sharedWithPriorVersions = true}> m_saltAdjustments     ;
+   OwnedSet<Recipe, RecipeUseOfWater         , PropertyNames::Recipe::waterUses           , &Recipe::acceptChangeToRecipeUseOfWater         ,
+                                               OwnedSetOptions{.sharedWithPriorVersions = true}> m_waterUses           ;
    /**
     * \brief Each \c BrewNote is a record of a brew day.  We assume that if you're copying a \c Recipe, it is in order
     *        to modify it into a new \c Recipe, in which case it does not make sense to bring the original brew notes
@@ -840,7 +924,9 @@ private:
    OwnedSet<Recipe, BrewNote                 , PropertyNames::Recipe::brewNotes           , &Recipe::acceptChangeToBrewNote,
                                                OwnedSetOptions{.copyable = false}         > m_brewNotes           ;
    /**
-    * \brief Instructions are copyable, but they differ from Recipe's other owned sets in being numbered
+    * \brief Instructions are copyable, but they differ from Recipe's other owned sets in being numbered.  Because
+    *        they are renumbered whenever one is added or removed, and changes to them do not make a new version of the
+    *        Recipe, they are not shared between versions, and a prior version gets its own copy of them.
     */
    OwnedSet<Recipe, Instruction              , PropertyNames::Recipe::instructions        , &Recipe::acceptChangeToInstruction,
                                                OwnedSetOptions{.enumerated = true}        > m_instructions        ;
@@ -871,14 +957,24 @@ private:
    int                                    m_ancestor_id;
    mutable QList<std::shared_ptr<Recipe>> m_ancestors;
    mutable bool                           m_hasDescendants;
+   int                                    m_versionNumber;
+
+   /**
+    * \brief Does the work of \c setAncestor once any renumbering of versions has been done
+    */
+   void linkAncestor(Recipe & ancestor);
 
-   // Some recalculators for calculated properties.
+   /**
+    * \brief Recalculates those calculated properties that depend on the supplied type of thing (eg \c Hop,
+    *        \c RecipeAdditionFermentable, \c Equipment) that was added, removed or changed.
+    */
    void recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged);
 
    /**
     * Recalculates all the calculated properties.
     *
-    * WARNING: this call took 0.15s in rev 916!
+    * WARNING: this call took 0.15s in rev 916!  Where possible, prefer \c recalcIfNeeded, which only recalculates
+    *          the things that actually depend on what changed.
     */
    void recalcAll();
 };
@@ -0,0 +1,109 @@
+/*======================================================================================================================
+ * model/RecipeCalcGraph.cpp is part of Brewken, and is copyright the following authors 2026:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "model/RecipeCalcGraph.h"
+
+#include "model/Boil.h"
+#include "model/Equipment.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Mash.h"
+#include "model/RecipeAdditionFermentable.h"
+#include "model/RecipeAdditionHop.h"
+#include "model/RecipeAdditionYeast.h"
+#include "model/Yeast.h"
+
+RecipeCalcGraph::CalcInputs RecipeCalcGraph::calcInputs(std::initializer_list<CalcInput> inputs) {
+   CalcInputs result;
+   for (auto const input : inputs) {
+      result.set(static_cast<std::size_t>(input));
+   }
+   return result;
+}
+
+RecipeCalcGraph::DerivedValues RecipeCalcGraph::derivedValues(std::initializer_list<DerivedValue> values) {
+   DerivedValues result;
+   for (auto const value : values) {
+      result.set(static_cast<std::size_t>(value));
+   }
+   return result;
+}
+
+//
+// This needs to be kept in step with the "Depends on" comments on the Recipe::impl::recalcXxx functions.
+//
+// Note that, because dependencies are followed transitively, a few changes trigger more recalculation than they did
+// when each setter called the recalcXxx functions it thought relevant directly.  In particular:
+//    - Changing yeast now also recalculates calories and IBU, as well as OG, FG and ABV, because calories and IBU
+//      are calculated from OG/FG, which depend on yeast attenuation.  (Previously calories and IBU could be left out
+//      of date until something else changed.)
+//    - Changing the boil now recalculates volume estimates and everything downstream of them (colour, OG/FG, ABV,
+//      IBU, calories) as well as boil gravity.  (Previously boil edits did not trigger any recalculation.)
+//
+std::array<RecipeCalcGraph::Node, RecipeCalcGraph::numDerivedValues> const RecipeCalcGraph::nodes {{
+   {DerivedValue::Grains         , calcInputs({CalcInput::Fermentables}), {}},
+   {DerivedValue::VolumeEstimates, calcInputs({CalcInput::Equipment,
+                                               CalcInput::Mash,
+                                               CalcInput::Boil,
+                                               CalcInput::Fermentables,
+                                               CalcInput::BatchSize})   , {DerivedValue::Grains}},
+   {DerivedValue::Color          , calcInputs({CalcInput::Fermentables}), {DerivedValue::VolumeEstimates}},
+   {DerivedValue::OgFg           , calcInputs({CalcInput::Equipment,
+                                               CalcInput::Fermentables,
+                                               CalcInput::Yeasts,
+                                               CalcInput::Efficiency})  , {DerivedValue::VolumeEstimates}},
+   {DerivedValue::ABV            , calcInputs({})                       , {DerivedValue::OgFg}},
+   {DerivedValue::BoilGrav       , calcInputs({CalcInput::Boil,
+                                               CalcInput::Fermentables,
+                                               CalcInput::Efficiency})  , {}},
+   {DerivedValue::IBU            , calcInputs({CalcInput::Equipment,
+                                               CalcInput::Boil,
+                                               CalcInput::Fermentables,
+                                               CalcInput::Hops,
+                                               CalcInput::BatchSize})   , {DerivedValue::VolumeEstimates,
+                                                                           DerivedValue::OgFg,
+                                                                           DerivedValue::BoilGrav}},
+   {DerivedValue::Calories       , calcInputs({})                       , {DerivedValue::OgFg}},
+}};
+
+RecipeCalcGraph::DerivedValues RecipeCalcGraph::derivedValuesAffectedBy(CalcInputs const changedInputs) {
+   DerivedValues affected;
+   // Because nodes are in dependency order, one pass is enough to pick up indirect dependencies
+   for (auto const & node : nodes) {
+      bool isAffected = (node.inputs & changedInputs).any();
+      for (auto const upstream : node.dependsOn) {
+         isAffected = isAffected || affected.test(static_cast<std::size_t>(upstream));
+      }
+      if (isAffected) {
+         affected.set(static_cast<std::size_t>(node.value));
+      }
+   }
+   return affected;
+}
+
+RecipeCalcGraph::CalcInputs RecipeCalcGraph::calcInputsForClass(QString const & className) {
+   // We could just compare with "Hop", "Equipment", etc but there's then no compile-time checking of typos.  Using
+   // ::staticMetaObject.className() is a bit more clunky but it's safer.
+   if (className ==                 Equipment::staticMetaObject.className()) { return calcInputs({CalcInput::Equipment   }); }
+   if (className ==                      Mash::staticMetaObject.className()) { return calcInputs({CalcInput::Mash        }); }
+   if (className ==                      Boil::staticMetaObject.className()) { return calcInputs({CalcInput::Boil        }); }
+   if (className ==               Fermentable::staticMetaObject.className() ||
+       className == RecipeAdditionFermentable::staticMetaObject.className()) { return calcInputs({CalcInput::Fermentables}); }
+   if (className ==                       Hop::staticMetaObject.className() ||
+       className ==         RecipeAdditionHop::staticMetaObject.className()) { return calcInputs({CalcInput::Hops        }); }
+   if (className ==                     Yeast::staticMetaObject.className() ||
+       className ==       RecipeAdditionYeast::staticMetaObject.className()) { return calcInputs({CalcInput::Yeasts      }); }
+   return CalcInputs{};
+}
@@ -0,0 +1,93 @@
+/*======================================================================================================================
+ * model/RecipeCalcGraph.h is part of Brewken, and is copyright the following authors 2026:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef MODEL_RECIPECALCGRAPH_H
+#define MODEL_RECIPECALCGRAPH_H
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <initializer_list>
+
+#include <QString>
+#include <QVector>
+
+/**
+ * \brief Rather than rerun all the calculations whenever anything changes, \c Recipe has a small dataflow graph of its
+ *        derived values.  Each derived value (or, strictly, each group of values computed by one of the recalcXxx
+ *        functions in \c Recipe::impl) lists the inputs and other derived values it is calculated from.  When an input
+ *        changes, we invalidate just the derived values that (directly or indirectly) depend on it and recalculate only
+ *        those.
+ *
+ *        This lives outside \c Recipe so that the graph can be checked in the unit tests.
+ */
+namespace RecipeCalcGraph {
+
+   enum class CalcInput {
+      Equipment   ,
+      Mash        ,
+      Boil        ,
+      Fermentables,
+      Hops        ,
+      Yeasts      ,
+      BatchSize   ,
+      Efficiency  ,
+   };
+   std::size_t constexpr numCalcInputs = static_cast<std::size_t>(CalcInput::Efficiency) + 1;
+   using CalcInputs = std::bitset<numCalcInputs>;
+
+   CalcInputs calcInputs(std::initializer_list<CalcInput> inputs);
+
+   //! Derived values, in an order where everything comes after all the things it depends on
+   enum class DerivedValue {
+      Grains         ,
+      VolumeEstimates,
+      Color          ,
+      OgFg           ,
+      ABV            ,
+      BoilGrav       ,
+      IBU            ,
+      Calories       ,
+   };
+   std::size_t constexpr numDerivedValues = static_cast<std::size_t>(DerivedValue::Calories) + 1;
+   using DerivedValues = std::bitset<numDerivedValues>;
+
+   DerivedValues derivedValues(std::initializer_list<DerivedValue> values);
+
+   struct Node {
+      DerivedValue              value;
+      CalcInputs                inputs;
+      QVector<DerivedValue>     dependsOn;
+   };
+
+   /**
+    * \brief The graph itself.  Entries are in the same order as \c DerivedValue.
+    */
+   extern std::array<Node, numDerivedValues> const nodes;
+
+   /**
+    * \brief Returns all the derived values that need recalculating when the supplied inputs change
+    */
+   DerivedValues derivedValuesAffectedBy(CalcInputs const changedInputs);
+
+   /**
+    * \brief Maps from the class name of something that was added to, removed from or changed in a Recipe to the
+    *        calculation input(s) it affects.  Returns an empty set if the change doesn't affect any calculations.
+    */
+   CalcInputs calcInputsForClass(QString const & className);
+}
+
+#endif
@@ -26,17 +26,6 @@ QList<std::shared_ptr<BrewNote>> RecipeUtils::brewNotesForRecipeAndAncestors(Rec
 }
 
 void RecipeUtils::prepareForPropertyChange(NamedEntity & ne, BtStringConst const & propertyName) {
-
-   //
-   // If the user has said they don't want versioning, just return
-   //
-   if (!RecipeUtils::getAutomaticVersioningEnabled()) {
-      return;
-   }
-
-   qDebug() <<
-      Q_FUNC_INFO << "Modifying: " << ne.metaObject()->className() << "#" << ne.key() << "property" << propertyName;
-
    //
    // If the object we're about to change a property on is a Recipe or is used in a Recipe, then it might need a new
    // version -- unless it's already being versioned.
@@ -50,55 +39,42 @@ void RecipeUtils::prepareForPropertyChange(NamedEntity & ne, BtStringConst const
       return;
    }
 
+   qDebug() <<
+      Q_FUNC_INFO << "Modifying: " << ne.metaObject()->className() << "#" << ne.key() << "property" << propertyName;
+
    //
    // Automatic versioning means that, once a recipe is brewed, it is "soft locked" and the first change should spawn a
    // new version.  Any subsequent change should not spawn a new version until it is brewed again.
    //
-   if (owningRecipe->brewNotes().empty()) {
-      // Recipe hasn't been brewed
-      return;
-   }
-
    // If the object we're about to change already has descendants, then we don't want to create new ones.
-   if (owningRecipe->hasDescendants()) {
-      qDebug() << Q_FUNC_INFO << "Recipe #" << owningRecipe->key() << "already has descendants, so not creating any more";
-      return;
-   }
-
-   //
-   // Once we've started doing versioning, we don't want to trigger it again on the same Recipe until we've finished
-   //
-   NamedEntityModifyingMarker ownerModifyingMarker(*owningRecipe);
-
    //
-   // Versioning when modifying something in a recipe is *hard*.  If we copy the recipe, there is no easy way to say
-   // "this ingredient in the old recipe is that ingredient in the new".  One approach would be to use the delete idea,
-   // ie copy everything but what's being modified, clone what's being modified and add the clone to the copy.  Another
-   // is to take a deep copy of the Recipe and make that the "prior version".
-   //
-
-   // Create a deep copy of the Recipe, and put it in the DB, so it has an ID.
-   // (This will also emit signalObjectInserted for the new Recipe from ObjectStoreTyped<Recipe>.)
-   qDebug() << Q_FUNC_INFO << "Copying Recipe" << owningRecipe->key();
-
-   // We also don't want to trigger versioning on the newly spawned Recipe until we're completely done here!
-   std::shared_ptr<Recipe> spawn = std::make_shared<Recipe>(*owningRecipe);
-   NamedEntityModifyingMarker spawnModifyingMarker(*spawn);
-   ObjectStoreWrapper::insert(spawn);
-
-   qDebug() << Q_FUNC_INFO << "Copied Recipe #" << owningRecipe->key() << "to new Recipe #" << spawn->key();
-
-   // We assert that the newly created version of the recipe has not yet been brewed (and therefore will not get
-   // automatically versioned on subsequent changes before it is brewed).
-   Q_ASSERT(spawn->brewNotes().empty());
+   if (RecipeUtils::getAutomaticVersioningEnabled() &&
+       !owningRecipe->brewNotes().empty() &&
+       !owningRecipe->hasDescendants()) {
+      //
+      // Once we've started doing versioning, we don't want to trigger it again on the same Recipe until we've finished
+      //
+      NamedEntityModifyingMarker ownerModifyingMarker(*owningRecipe);
+
+      //
+      // The prior version is a copy of the Recipe itself, but it shares the Recipe's additions, water uses etc rather
+      // than having its own copies of them.  Ingredients, style, equipment etc are, as before, shared between versions
+      // (as they are referenced by ID).  This will also emit a signalPropertyChanged from ObjectStoreTyped<Recipe>,
+      // which the UI can pick up to update tree display of Recipes etc.
+      //
+      qDebug() << Q_FUNC_INFO << "Making prior version of Recipe" << owningRecipe->key();
+      auto priorVersion = owningRecipe->makePriorVersion();
+
+      // We assert that the new prior version has not been brewed (as brew notes stay with the Recipe that was brewed).
+      Q_ASSERT(priorVersion->brewNotes().empty());
+   }
 
    //
-   // By default, copying a Recipe does not copy all its ancestry.  Here, we want the copy to become our ancestor (ie
-   // previous version).  This will also emit a signalPropertyChanged from ObjectStoreTyped<Recipe>, which the UI can
-   // pick up to update tree display of Recipes etc.
+   // Whether or not we just made a prior version, if ne is shared with one, the prior version needs to keep its own
+   // copy of ne as it is now.  (This applies even if versioning has since been turned off, as existing prior versions still
+   // share things with the Recipe.)
    //
-   owningRecipe->setAncestor(*spawn);
-
+   owningRecipe->prepareForChangeToOwnedItem(ne);
    return;
 }
 
@@ -17,9 +17,12 @@
 #define MODEL_STOCKPURCHASEBASE_H
 #pragma once
 
+#include <algorithm>
 #include <memory>
 
+#include <QHash>
 #include <QList>
+#include <QObject>
 #include <QtNumeric>
 
 #include "utils/CuriouslyRecurringTemplateBase.h"
@@ -259,22 +262,138 @@ public:
       return this->m_changes.remove(change);
    }
 
+   /**
+    * \brief All the StockPurchase objects (including deleted ones) for the supplied ingredient.  StockPurchase objects
+    *        are indexed by ingredient ID in the object store, so this does not need to search through all of them.
+    */
+   static QList<Derived *> purchasesFor(IngredientClass const & ingredient) {
+      return ObjectStoreWrapper::findByIndexRaw<Derived>(PropertyNames::IngredientAmount::ingredientId, ingredient.key());
+   }
+
    /**
     * \brief For a given ingredient, get the total amount we have on hand -- ie total of all purchases minus total of
     *        all uses.
+    *
+    *        This gets called for every row of the ingredient tables every time they are painted, so we cache the
+    *        result per ingredient.  See \c InventoryCache for how the cache is kept up-to-date.  (An ingredient that is
+    *        not yet in the DB has no ID to key the cache on, so we always calculate its total.)
     */
    static Measurement::Amount getTotalInventory(IngredientClass const & ingredient) {
+      if (ingredient.key() <= 0) {
+         return StockPurchaseBase::calculateTotalInventory(ingredient);
+      }
+
+      InventoryCache & cache = StockPurchaseBase::inventoryCache();
+      auto const cachedTotal = cache.totals.constFind(ingredient.key());
+      if (cachedTotal != cache.totals.cend()) {
+         return *cachedTotal;
+      }
+
+      Measurement::Amount const total = StockPurchaseBase::calculateTotalInventory(ingredient);
+      cache.totals.insert(ingredient.key(), total);
+      return total;
+   }
+
+   /**
+    * \brief Similar to \c getTotalInventory, but just tells us whether we have any Inventory (aka Stock)
+    *
+    * @param ingredient
+    */
+   static bool isOnHand(IngredientClass const & ingredient) {
+      //
+      // We don't need all the non-deleted non-zero StockPurchase objects for the supplied ingredient -- just the first
+      // one will do!
+      //
+      auto const purchases = StockPurchaseBase::purchasesFor(ingredient);
+      return std::any_of(
+         purchases.cbegin(),
+         purchases.cend(),
+         [](Derived const * sp) { return !sp->deleted() && !qFuzzyIsNull(sp->amountRemaining().quantity); }
+      );
+   }
+
+private:
+   /**
+    * \brief Per-ingredient cache of \c getTotalInventory results, keyed by ingredient ID.
+    *
+    *        Rather than trying to keep running totals up-to-date (which would mean, amongst other things, replicating
+    *        the logic of \c doUpdateChangeItems), we just drop the cached total for an ingredient whenever one of its
+    *        StockPurchase or StockUse objects is inserted, changed or deleted, and work it out again next time it is
+    *        asked for.  We find out about such changes from the object store signals.  If a StockPurchase moves to a
+    *        different ingredient, or a StockUse to a different StockPurchase, we don't know what it moved from, so we
+    *        just drop everything (but this is rare).
+    */
+   struct InventoryCache {
+      InventoryCache() {
+         auto & purchaseStore = ObjectStoreTyped<Derived      >::getInstance();
+         auto & useStore      = ObjectStoreTyped<StockUseClass>::getInstance();
+         QObject::connect(&purchaseStore, &ObjectStore::signalObjectInserted, &purchaseStore,
+                          [this](int id) { this->purchaseChanged(ObjectStoreWrapper::getByIdRaw<Derived>(id)); });
+         QObject::connect(&purchaseStore, &ObjectStore::signalObjectDeleted, &purchaseStore,
+                          [this](int, std::shared_ptr<QObject> object) {
+                             this->purchaseChanged(qobject_cast<Derived const *>(object.get()));
+                          });
+         QObject::connect(&purchaseStore, &ObjectStore::signalPropertyChanged, &purchaseStore,
+                          [this](int id, BtStringConst const & propertyName) {
+                             if (propertyName == PropertyNames::IngredientAmount::ingredientId) {
+                                this->totals.clear();
+                                return;
+                             }
+                             this->purchaseChanged(ObjectStoreWrapper::getByIdRaw<Derived>(id));
+                          });
+         QObject::connect(&useStore, &ObjectStore::signalObjectInserted, &useStore,
+                          [this](int id) { this->useChanged(ObjectStoreWrapper::getByIdRaw<StockUseClass>(id)); });
+         QObject::connect(&useStore, &ObjectStore::signalObjectDeleted, &useStore,
+                          [this](int, std::shared_ptr<QObject> object) {
+                             this->useChanged(qobject_cast<StockUseClass const *>(object.get()));
+                          });
+         QObject::connect(&useStore, &ObjectStore::signalPropertyChanged, &useStore,
+                          [this](int id, BtStringConst const & propertyName) {
+                             if (propertyName == PropertyNames::EnumeratedBase::ownerId) {
+                                this->totals.clear();
+                                return;
+                             }
+                             this->useChanged(ObjectStoreWrapper::getByIdRaw<StockUseClass>(id));
+                          });
+         return;
+      }
+
+      void purchaseChanged(Derived const * purchase) {
+         if (purchase) {
+            this->totals.remove(purchase->ingredientId());
+         }
+         return;
+      }
+
+      void useChanged(StockUseClass const * use) {
+         if (use && use->ownerId() > 0) {
+            this->purchaseChanged(ObjectStoreWrapper::getByIdRaw<Derived>(use->ownerId()));
+         }
+         return;
+      }
+
+      QHash<int, Measurement::Amount> totals;
+   };
+
+   static InventoryCache & inventoryCache() {
+      // Function-local static means we don't try to connect to the object stores before they exist
+      static InventoryCache cache;
+      return cache;
+   }
+
+   /**
+    * \brief Does the actual work for \c getTotalInventory
+    */
+   static Measurement::Amount calculateTotalInventory(IngredientClass const & ingredient) {
       //
       // Get all the non-deleted non-zero StockPurchase objects for the supplied ingredient
       //
-      int const ingredientKey = ingredient.key();
-      auto purchases = ObjectStoreWrapper::findAllMatching<Derived>(
-         [ingredientKey](Derived const * sp) {
-            return !sp->deleted() &&
-                   (ingredientKey == sp->ingredientId()) &&
-                   !qFuzzyIsNull(sp->amountRemaining().quantity);
+      QList<Derived *> purchases;
+      for (Derived * sp : StockPurchaseBase::purchasesFor(ingredient)) {
+         if (!sp->deleted() && !qFuzzyIsNull(sp->amountRemaining().quantity)) {
+            purchases.append(sp);
          }
-      );
+      }
 
       if (purchases.size() == 0) {
          return Measurement::Amount{Derived::defaultMeasure, 0.0};
@@ -291,28 +410,7 @@ public:
                              [](Measurement::Amount sum, Derived const * sp) { return sum + sp->amountRemaining(); });
    }
 
-   /**
-    * \brief Similar to \c getTotalInventory, but just tells us whether we have any Inventory (aka Stock)
-    *
-    * @param ingredient
-    */
-   static bool isOnHand(IngredientClass const & ingredient) {
-      //
-      // We don't need all the non-deleted non-zero StockPurchase objects for the supplied ingredient -- just the first
-      // one will do!
-      //
-      int const ingredientKey = ingredient.key();
-      auto purchase = ObjectStoreWrapper::findFirstMatching<Derived>(
-         [ingredientKey](Derived const * sp) {
-            return !sp->deleted() &&
-                   (ingredientKey == sp->ingredientId()) &&
-                   !qFuzzyIsNull(sp->amountRemaining().quantity);
-         }
-      );
-
-      return (purchase != nullptr);
-   }
-
+public:
    /**
     * \brief For a given ingredient, reduce the total amount we have on hand (as a consequence of it being used in a
     *        Recipe).
@@ -329,10 +427,8 @@ public:
       //
       // Get all the non-deleted StockPurchase objects for the supplied ingredient
       //
-      int const ingredientKey = ingredient.key();
-      auto purchases = ObjectStoreWrapper::findAllMatching<Derived>(
-         [ingredientKey](Derived const * sp) { return !sp->deleted() && (ingredientKey == sp->ingredientId()); }
-      );
+      QList<Derived *> purchases = StockPurchaseBase::purchasesFor(ingredient);
+      purchases.removeIf([](Derived const * sp) { return sp->deleted(); });
 
       //
       // Put everything in date order
@@ -17,6 +17,7 @@
 #define QTMODELS_TABLEMODELS_ENUMERATEDITEMTABLEMODELBASE_H
 #pragma once
 
+#include <algorithm>
 #include <memory>
 
 #include <QDebug>
@@ -56,6 +57,7 @@ public:
             this->derived().disconnect(item.get(), nullptr, &this->derived(), nullptr);
          }
          this->derived().m_rows.clear();
+         this->derived().reindexRows();
          this->derived().endRemoveRows();
       }
 
@@ -86,6 +88,7 @@ public:
                "rows";
             this->derived().beginInsertRows(QModelIndex(), 0, tmpEnumeratedItems.size() - 1);
             this->derived().m_rows = tmpEnumeratedItems;
+            this->derived().reindexRows();
             for (auto item : this->derived().m_rows) {
                this->derived().connect(item.get(), &NamedEntity::changed, &this->derived(), &Derived::itemChanged);
             }
@@ -108,7 +111,7 @@ public:
 protected:
    //! \returns true if \c item is successfully found and removed.
    bool doRemoveItem(std::shared_ptr<ItemClass> item) {
-      int ii {static_cast<int>(this->derived().m_rows.indexOf(item))};
+      int ii {this->derived().findIndexOf(item.get())};
       if (ii >= 0) {
          qDebug() <<
             Q_FUNC_INFO << "Removing" << ItemClass::staticMetaObject.className() << item->name() << "(#" <<
@@ -116,6 +119,7 @@ protected:
          this->derived().beginRemoveRows(QModelIndex(), ii, ii);
          this->derived().disconnect(item.get(), nullptr, &this->derived(), nullptr);
          this->derived().m_rows.removeAt(ii);
+         this->derived().reindexRows();
          //reset(); // Tell everybody the table has changed.
          this->derived().endRemoveRows();
 
@@ -169,6 +173,7 @@ private:
       // current -1 when moving up, and swap current with current+1 when moving
       // down
       this->derived().m_rows.swapItemsAt(current, current + doSomething);
+      this->derived().reindexRows(std::min(current, current + doSomething));
       this->derived().endMoveRows();
       return;
    }
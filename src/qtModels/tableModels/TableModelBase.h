@@ -21,8 +21,10 @@
 #include <utility> // For std::pair
 #include <vector>
 
+#include <QHash>
 #include <QList>
 #include <QModelIndex>
+#include <QSet>
 
 #include "database/ObjectStoreTyped.h"
 #include "database/ObjectStoreWrapper.h"
@@ -142,7 +144,7 @@ public:
    using UnderlyingItem = NE;
 
 protected:
-   TableModelBase() : m_rows{} {
+   TableModelBase() : m_rows{}, m_rowIndexes{} {
       return;
    }
    // Need a virtual destructor as we have a virtual member function
@@ -244,12 +246,15 @@ public:
    QList< std::shared_ptr<NE> > removeDuplicates(QList< std::shared_ptr<NE> > items,
                                                  Recipe const * recipe = nullptr) {
       decltype(items) tmp;
+      // We also need to remove duplicates within the supplied list
+      QSet<NE const *> itemsSeen;
 
       for (auto ii : items) {
          if (!recipe && ii->deleted()) {
             continue;
          }
-         if (!this->m_rows.contains(ii) ) {
+         if (!this->m_rowIndexes.contains(ii.get()) && !itemsSeen.contains(ii.get())) {
+            itemsSeen.insert(ii.get());
             tmp.append(ii);
          }
       }
@@ -270,23 +275,27 @@ public:
     *
     *        Function name is for consistency with \c QList::indexOf
     *
+    *        This is a lookup in \c m_rowIndexes, so there is no need to search through the list.
+    *
     * \param object  what to search for
     * \return index of object in this->m_rows or -1 if it's not found
     */
    int findIndexOf(NE const * object) const {
-      for (int index = 0; index < this->m_rows.size(); ++index) {
-         if (this->m_rows.at(index).get() == object) {
-            return index;
-         }
+      auto match = this->m_rowIndexes.constFind(object);
+      if (match == this->m_rowIndexes.cend()) {
+         return -1;
       }
-      return -1;
+      int const index = match.value();
+      // It's a coding error if m_rows was modified without calling reindexRows()
+      Q_ASSERT(index < this->m_rows.size() && this->m_rows.at(index).get() == object);
+      return index;
    }
 
    void add(std::shared_ptr<NE> item) {
       qDebug() << Q_FUNC_INFO << item->name();
 
       // Check to see if it's already in the list
-      if (this->m_rows.contains(item)) {
+      if (this->m_rowIndexes.contains(item.get())) {
          return;
       }
 
@@ -299,6 +308,7 @@ public:
       int size = this->m_rows.size();
       this->derived().beginInsertRows(QModelIndex(), size, size);
       this->m_rows.append(item);
+      this->m_rowIndexes.insert(item.get(), size);
       this->derived().connect(item.get(), &NamedEntity::changed, &this->derived(), &Derived::changed);
       this->derived().added(item);
       //reset(); // Tell everybody that the table has changed.
@@ -322,11 +332,13 @@ public:
 
    //! \returns true if \c item is successfully found and removed.
    bool remove(std::shared_ptr<NE> item) {
-      int rowNum = this->m_rows.indexOf(item);
+      int rowNum = this->findIndexOf(item.get());
       if (rowNum >= 0)  {
          this->derived().beginRemoveRows(QModelIndex(), rowNum, rowNum);
          this->derived().disconnect(item.get(), nullptr, &this->derived(), nullptr);
          this->m_rows.removeAt(rowNum);
+         this->m_rowIndexes.remove(item.get());
+         this->reindexRows(rowNum);
 
          this->derived().removed(item);
 
@@ -429,11 +441,16 @@ protected:
 
       qDebug() << Q_FUNC_INFO << "After de-duping, adding " << tmp.size() << "of" << NE::staticMetaObject.className();
 
+      //
+      // Note that we add all the rows with a single beginInsertRows()/endInsertRows(), which is a lot quicker than
+      // adding them one at a time when there are thousands of them (eg all the hops in the database).
+      //
       int size = this->m_rows.size();
-      if (size + tmp.size()) {
+      if (tmp.size() > 0) {
          this->derived().beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
 
          this->m_rows.append(tmp);
+         this->reindexRows(size);
 
          for (auto item : tmp) {
             this->derived().connect(item.get(), &NamedEntity::changed, &this->derived(), &Derived::changed);
@@ -457,6 +474,7 @@ protected:
             this->derived().disconnect(item.get(), nullptr, &this->derived(), nullptr);
             //this->derived().removed(item); // Shouldn't be necessary as we call updateTotals() below
          }
+         this->m_rowIndexes.clear();
          this->derived().endRemoveRows();
          this->derived().updateTotals();
       }
@@ -808,9 +826,28 @@ protected:
       return retVal;
    }
 
+   /**
+    * \brief Update \c m_rowIndexes for all rows from \c firstRow onwards.  Code that modifies \c m_rows directly
+    *        (rather than via \c add, \c addItems, \c remove or \c removeAll) needs to call this afterwards.  (If rows
+    *        were removed, it should be called with \c firstRow of 0, or the caller should remove the relevant entries
+    *        from \c m_rowIndexes itself.)
+    */
+   void reindexRows(int const firstRow = 0) {
+      if (firstRow == 0) {
+         this->m_rowIndexes.clear();
+      }
+      for (int row = firstRow; row < this->m_rows.size(); ++row) {
+         this->m_rowIndexes.insert(this->m_rows.at(row).get(), row);
+      }
+      return;
+   }
+
    //================================================ Member Variables =================================================
 
    QList< std::shared_ptr<NE> > m_rows;
+
+   //! \brief Reverse lookup for \c m_rows: for each item, its row number.  See \c findIndexOf.
+   QHash<NE const *, int> m_rowIndexes;
 };
 
 
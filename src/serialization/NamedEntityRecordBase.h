@@ -65,6 +65,15 @@ namespace Serialization {
          return ObjectStoreWrapper::insert(namedEntity);
       }
 
+      bool doStoreNamedEntitiesInDb(QList<std::shared_ptr<NamedEntity>> const & namedEntities) {
+         QList<std::shared_ptr<NE>> nes;
+         nes.reserve(namedEntities.size());
+         for (auto const & namedEntity : namedEntities) {
+            nes.append(std::static_pointer_cast<NE>(namedEntity));
+         }
+         return ObjectStoreWrapper::insertAll(nes).size() == nes.size();
+      }
+
       void doDeleteNamedEntityFromDb() {
          auto namedEntity = std::static_pointer_cast<NE>(this->derived().m_namedEntity);
 
@@ -112,10 +121,15 @@ namespace Serialization {
          // ourselves have multiple copies of such objects.
          //
 
-         // This copy of the pointer is just to make it clearer what we're passing to lambda in findFirstMatching() below
          std::shared_ptr<NE const> const namedEntity =
             std::static_pointer_cast<NE const>(this->derived().m_namedEntity);
-         auto matchResult = ObjectStoreTyped<NE>::getInstance().findFirstMatching(
+
+         //
+         // Rather than compare against every stored object, we only need to look at the ones with a matching name (see
+         // ObjectStore::findPossibleMatches), which is usually none or a handful.
+         //
+         std::shared_ptr<NE> matchResult{nullptr};
+         for (auto const & candidate : ObjectStoreWrapper::findPossibleMatches(*namedEntity)) {
             //
             // Note that, because we run this check both before and after something has been stored in the database (for
             // reasons explained in XmlRecord::normaliseAndStoreInDb and JsonRecord::normaliseAndStoreInDb) we need to
@@ -124,16 +138,18 @@ namespace Serialization {
             // Note too that we don't want to match against soft-deleted entities.  (Otherwise, if you delete something
             // and then try to import it again, it will never import!)
             //
-            [namedEntity](std::shared_ptr<NE> ne) {
-               return
-                  // Don't compare object against itself!
-                  (ne->key() != namedEntity->key()) &&
-                  // Don't compare with deleted objects
-                  (!ne->deleted()) &&
-                  // Substantive comparison
-                  (*ne == *namedEntity);
+            if (
+               // Don't compare object against itself!
+               (candidate->key() != namedEntity->key()) &&
+               // Don't compare with deleted objects
+               (!candidate->deleted()) &&
+               // Substantive comparison
+               (*candidate == *namedEntity)
+            ) {
+               matchResult = candidate;
+               break;
             }
-         );
+         }
          if (matchResult) {
             qDebug() <<
                Q_FUNC_INFO << "Found a match (#" << matchResult->key() << "," << matchResult->name() <<
@@ -230,6 +246,9 @@ namespace Serialization {
    public:                                                                                           \
       virtual void deleteNamedEntityFromDb() override { this->doDeleteNamedEntityFromDb(); return; } \
       virtual bool includedInStats() const override { return this->doIncludedInStats(); }            \
+      virtual bool storeNamedEntitiesInDb(                                                           \
+         QList<std::shared_ptr<NamedEntity>> const & namedEntities                                   \
+      ) override { return this->doStoreNamedEntitiesInDb(namedEntities); }                           \
    protected:                                                                                        \
       virtual bool resolveDuplicates() override { return this->doResolveDuplicates(); }              \
       virtual void normaliseName() override { this->doNormaliseName(); return; }                     \
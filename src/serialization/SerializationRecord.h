@@ -17,7 +17,11 @@
 #define SERIALIZATION_SERIALIZATIONRECORD_H
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+
+#include <QSet>
 
 #include "model/NamedEntity.h"
 #include "model/NamedParameterBundle.h"
@@ -137,6 +141,33 @@ public:
       return false;
    }
 
+   /**
+    * \brief Whether this record can be stored as part of a batch (see \c normaliseAndStoreRecordsInBulk) rather than
+    *        on its own via \c normaliseAndStoreInDb.  By default this is the case for "leaf" records -- ie ones that
+    *        have a \c NamedEntity but no child records.  Subclasses that override \c normaliseAndStoreInDb to do extra
+    *        work should override this to return \c false (unless the extra work is not needed for the record).
+    */
+   virtual bool canStoreInBulk() const {
+      return this->m_namedEntity && std::all_of(
+         this->m_childRecordSets.begin(),
+         this->m_childRecordSets.end(),
+         [](ChildRecordSet const & childRecordSet) { return childRecordSet.records.empty(); }
+      );
+   }
+
+   /**
+    * \brief Subclasses need to implement this to store, in one go, a batch of objects of the same type as
+    *        \c this->m_namedEntity in the appropriate ObjectStore.  (It's a member function rather than a static one
+    *        so that we get the right subclass via the virtual call.)
+    *
+    * \return \c true if all the objects were stored, \c false otherwise (in which case none of them will have been)
+    */
+   virtual bool storeNamedEntitiesInDb([[maybe_unused]] QList<std::shared_ptr<NamedEntity>> const & namedEntities) {
+      qCritical().noquote() << Q_FUNC_INFO << Logging::getStackTrace();
+      Q_ASSERT(false && "Trying to store named entities for base record");
+      return false;
+   }
+
    /**
     * \brief Once the record (including all its sub-records) is loaded into memory, we this function does any final
     *        validation and data correction before then storing the object(s) in the database.  Most validation should
@@ -206,7 +237,21 @@ public:
       // Note, of course, that this still needs to be done, even if nullptr == this->m_namedEntity, because that just means
       // we're processing the root node.
       //
-      if (this->normaliseAndStoreChildRecordsInDb(userMessage, stats)) {
+      bool childRecordsStoredOk;
+      {
+         //
+         // Storing and linking child records (eg the hop additions in a recipe) can set a lot of properties on our
+         // NamedEntity.  Doing it inside a batch edit means each changed property is written to the DB and signalled
+         // once, and things like recipe recalculations happen once at the end, rather than after every change.  The
+         // batch edit needs to finish before the late duplicate check below, as that looks at the finished object.
+         //
+         std::optional<NamedEntityBatchEdit> batchEdit;
+         if (this->m_namedEntity) {
+            batchEdit.emplace(*this->m_namedEntity);
+         }
+         childRecordsStoredOk = this->normaliseAndStoreChildRecordsInDb(userMessage, stats);
+      }
+      if (childRecordsStoredOk) {
          //
          // Now all the processing succeeded, we do that final duplicate check for any complex object such as Recipe that
          // had to be fully constructed before we could meaningfully check whether it's the same as something we already
@@ -303,6 +348,18 @@ public:
             continue;
          }
 
+         //
+         // Top-level records (ie those not contained in another record) often come in large numbers -- eg a file with
+         // hundreds of hop varieties -- so, where we can, we store them in batches, which is a lot quicker.  There's
+         // nothing to link them to afterwards, so we can move straight on to the next set.
+         //
+         if (!this->m_namedEntity && childRecordSet.records.size() > 1) {
+            if (!this->normaliseAndStoreRecordsInBulk(childRecordSet.records, userMessage, stats)) {
+               return false;
+            }
+            continue;
+         }
+
          QList< std::shared_ptr<NamedEntity> > processedChildren;
          for (auto & childRecord : childRecordSet.records) {
             // The childRecord variable is a reference to a std::unique_ptr (because the vector we're looping over owns the
@@ -416,6 +473,103 @@ public:
 
 protected:
 
+   /**
+    * \brief Used by \c normaliseAndStoreChildRecordsInDb for a set of top-level records.  For each record that
+    *        \c canStoreInBulk, we do the same duplicate check and name normalisation as \c normaliseAndStoreInDb, but
+    *        then, rather than storing it straight away, add it to a batch to be stored via \c storeNamedEntitiesInDb.
+    *        Any other record is stored in the usual way (after storing the current batch, so that order is preserved).
+    *
+    *        Both the duplicate check and the name normalisation look at what is already stored, so we must not check a
+    *        record that might match one sitting in the unstored batch.  Since both checks only ever match names that are
+    *        the same once any " (n)" suffix is stripped off, we just store the current batch whenever we are about to
+    *        check such a name.
+    *
+    *        Note that, unlike \c normaliseAndStoreInDb, we don't need a "late" duplicate check here, as nothing about a
+    *        record with no children changes between storing it and the point where that check would be made.
+    *
+    * \return \c true if everything went OK, \c false if there was an unresolvable problem
+    */
+   [[nodiscard]] bool normaliseAndStoreRecordsInBulk(std::vector<std::unique_ptr<Derived>> & records,
+                                                    QTextStream & userMessage,
+                                                    ImportRecordCount & stats) {
+      // We access the records via base class pointers so that we can call protected member functions on them
+      QList<SerializationRecord *> batch;
+      QSet<QString> batchNames;
+
+      auto storeBatch = [&]() {
+         if (batch.isEmpty()) {
+            return true;
+         }
+         QList<std::shared_ptr<NamedEntity>> namedEntities;
+         namedEntities.reserve(batch.size());
+         for (SerializationRecord * record : batch) {
+            namedEntities.append(record->m_namedEntity);
+         }
+         if (!batch.first()->storeNamedEntitiesInDb(namedEntities)) {
+            userMessage << "Error storing " << namedEntities.size() << " " <<
+            namedEntities.first()->metaObject()->className() << " records in database.  See logs for more details";
+            return false;
+         }
+         for (SerializationRecord * record : batch) {
+            if (record->includedInStats()) {
+               stats.processedOk(record->recordDefinition().m_localisedEntityName);
+            }
+         }
+         batch.clear();
+         batchNames.clear();
+         return true;
+      };
+
+      // Name normalisation simplifies whitespace, so we do the same when comparing names
+      auto nameKey = [](QString const & name) {
+         return NamedEntity::strippedName(name.simplified()).simplified();
+      };
+
+      for (auto & childRecord : records) {
+         SerializationRecord & record = *childRecord;
+         if (!record.canStoreInBulk()) {
+            if (!storeBatch()) {
+               return false;
+            }
+            if (SerializationRecord::ProcessingResult::Failed ==
+               record.normaliseAndStoreInDb(this->m_namedEntity, userMessage, stats)) {
+               return false;
+            }
+            continue;
+         }
+
+         //
+         // An empty name will get a default one in normaliseName(), which we can't easily predict here, so we just
+         // store what we have so far.
+         //
+         QString const key = nameKey(record.m_namedEntity->name());
+         if (key.isEmpty() || batchNames.contains(key)) {
+            if (!storeBatch()) {
+               return false;
+            }
+         }
+
+         // See comments in normaliseAndStoreInDb for the equivalent calls to the ones below
+         if (record.resolveDuplicates()) {
+            qDebug() <<
+               Q_FUNC_INFO << "Duplicate" << record.recordDefinition().m_namedEntityClassName <<
+               (record.includedInStats() ? " will" : " won't") << " be included in stats";
+            if (record.includedInStats()) {
+               stats.skipped(*record.recordDefinition().m_namedEntityClassName);
+            }
+            continue;
+         }
+         record.normaliseName();
+         record.setContainingEntity(this->m_namedEntity);
+
+         batch.append(&record);
+         batchNames.insert(key);
+         batchNames.insert(nameKey(record.m_namedEntity->name()));
+      }
+
+      return storeBatch();
+   }
+
    /**
     * \brief Checks whether the \b NamedEntity for this record is, in all the ways that count, a duplicate of one we
     *        already have stored in the DB
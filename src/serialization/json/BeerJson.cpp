@@ -16,11 +16,15 @@
 #include "serialization/json/BeerJson.h"
 
 #include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
 
 // We could just include <boost/json.hpp> which pulls all the Boost.JSON headers in, but that seems overkill
 #include <boost/json/kind.hpp>
 #include <boost/json/parse_options.hpp>
 #include <boost/json/parse.hpp>
+#include <boost/json/serialize.hpp>
 #include <boost/json/string.hpp>
 
 #include <valijson/adapters/boost_json_adapter.hpp>
@@ -63,6 +67,9 @@ namespace {
    // min/max versions we can read plus whatever version we write.
    BtStringConst const jsonVersionWeSupport{"2.06"};
 
+   // Indentation we use when writing BeerJSON files -- see JsonUtils::serialize
+   std::string_view const tabString{"  "};
+
    // These are only used in BEER_JSON_RECORD_DEFN<Equipment>
    BtStringConst const nameForHlt            {"Hot Liquor Tank" };
    BtStringConst const nameForMashTun        {"Mash Tun"        };
@@ -1165,15 +1172,21 @@ namespace {
     * \brief This function first validates the input file against a JSON schema (https://json-schema.org/)
     */
    bool validateAndLoad(QString const & fileName, QTextStream & userMessage) {
-      boost::json::value inputDocument;
+      //
+      // We use std::optional here so that we move-construct the loaded document, which keeps it in the memory arena
+      // loadJsonDocument allocated it in.  (Move-assigning it to a default-constructed boost::json::value would copy
+      // the whole document.)
+      //
+      std::optional<boost::json::value> loadedDocument;
       try {
-         inputDocument = JsonUtils::loadJsonDocument(fileName);
+         loadedDocument.emplace(JsonUtils::loadJsonDocument(fileName));
       } catch (std::exception const & exception) {
          qWarning() <<
             Q_FUNC_INFO << "Caught exception while reading" << fileName << ":" << exception.what();
          userMessage << exception.what();
          return false;
       }
+      boost::json::value & inputDocument = *loadedDocument;
 
       //
       // If there are ever multiple versions of BeerJSON, this is where we'll work out which one to use for reading
@@ -1274,6 +1287,11 @@ namespace BeerJson {
    //
    // This private implementation class holds all private non-virtual members of Exporter
    //
+   // Rather than building a boost::json::object for the whole document and serialising it at the end, we write the
+   // document out as we go.  Only the enclosing "beerjson" object and its arrays are written by hand here; each record
+   // is converted to a (small) boost::json::value by JsonRecord::toJson and serialised as soon as it has been built.
+   // This means memory usage does not grow with the number of records being exported.
+   //
    class Exporter::impl {
    public:
 
@@ -1286,10 +1304,16 @@ namespace BeerJson {
                                       outFile{outFile},
                                       userMessage{userMessage},
                                       writtenToFile{false},
-                                      outputDocument{} {
-         // We have to pass in jsonVersionWeSupport as a double, not a char * or a std::string, otherwise it will get
-         // quotes put around it.
-         this->outputDocument["beerjson"] = { {"version", std::atof(*jsonVersionWeSupport)} };
+                                      outStream{outFile} {
+         //
+         // Write the opening of the document, up to and including the version number.  We have to write
+         // jsonVersionWeSupport as a double, not a char * or a std::string, otherwise it will get quotes put around it.
+         //
+         std::string indent{tabString};
+         this->outStream << "{\n" << indent << "\"beerjson\": {\n";
+         indent.append(tabString);
+         this->outStream << indent << "\"version\": ";
+         JsonUtils::serialize(this->outStream, boost::json::value(std::atof(*jsonVersionWeSupport)), tabString, &indent);
          return;
       }
 
@@ -1298,12 +1322,50 @@ namespace BeerJson {
       */
       ~impl() = default;
 
+      /**
+       * \brief Write one array of records (eg all the hops) inside the "beerjson" object
+       */
+      template<class NE> void writeArray(QList<NE const *> const & nes) {
+         // Everything inside "beerjson" is at the second level of indentation, and the records themselves at the third
+         std::string indent{tabString};
+         indent.append(tabString);
+         // Record names are plain ASCII, but we let Boost.JSON do the quoting in case that ever changes
+         boost::json::string_view const recordName{*BEER_JSON_RECORD_DEFN<NE>.m_recordName};
+         this->outStream << ",\n" << indent << boost::json::serialize(recordName) << ": [\n";
+         indent.append(tabString);
+
+         bool firstWritten = false;
+         for (NE const * ne : nes) {
+            // Comments in JsonRecord::listToJson about object vs value apply here too
+            boost::json::value neJson(boost::json::object_kind);
+            std::unique_ptr<JsonRecord> jsonRecord{
+               BEER_JSON_RECORD_DEFN<NE>.makeRecord(BEER_JSON_1_CODING, neJson)
+            };
+            if (!jsonRecord->toJson(*ne)) {
+               // As in JsonRecord::listToJson, we stop at the first record we cannot convert
+               qWarning() << Q_FUNC_INFO << "Unable to convert" << *ne << "to JSON";
+               break;
+            }
+
+            if (firstWritten) {
+               this->outStream << ",\n";
+            }
+            this->outStream << indent;
+            JsonUtils::serialize(this->outStream, neJson, tabString, &indent);
+            firstWritten = true;
+         }
+
+         indent.resize(indent.size() - tabString.length());
+         this->outStream << "\n" << indent << "]";
+         return;
+      }
+
       Exporter & self;
       QFile & outFile;
       QTextStream & userMessage;
       bool writtenToFile;
 
-      boost::json::object outputDocument;
+      OStreamWriterForQFile outStream;
 
    };
 
@@ -1318,21 +1380,9 @@ namespace BeerJson {
    }
 
    template<class NE> void Exporter::add(QList<NE const *> const & nes) {
-      QList< std::shared_ptr<NamedEntity> > objectsToWrite;
-      objectsToWrite.reserve(nes.size());
-      for (NE const * ne : nes) {
-         //
-         // We have to cast away const on ne, as otherwise we'll end up with static_pointer to const that's harder to
-         // cast away.  Or we'd have to write const and non-const versions of all the functions we're calling, which
-         // is strictly correct but a bit overkill here.
-         //
-         objectsToWrite.append(
-            std::static_pointer_cast<NamedEntity>(ObjectStoreWrapper::getSharedFromRaw(const_cast<NE *>(ne)))
-         );
-      }
-      boost::json::array outputArray;
-      JsonRecord::listToJson(objectsToWrite, outputArray, BEER_JSON_1_CODING, BEER_JSON_RECORD_DEFN<NE>);
-      this->pimpl->outputDocument["beerjson"].get_object()[*BEER_JSON_RECORD_DEFN<NE>.m_recordName] = outputArray;
+      // It's a coding error to try to add things after we closed off the document
+      Q_ASSERT(!this->pimpl->writtenToFile);
+      this->pimpl->writeArray(nes);
       return;
    }
 
@@ -1362,8 +1412,9 @@ namespace BeerJson {
          return;
       }
 
-      OStreamWriterForQFile outStream(this->pimpl->outFile);
-      JsonUtils::serialize(outStream, this->pimpl->outputDocument, "  ");
+      // Close the "beerjson" object and then the document itself
+      this->pimpl->outStream << "\n" << tabString << "}\n}";
+      this->pimpl->outStream.flush();
 
       this->pimpl->writtenToFile = true;
 
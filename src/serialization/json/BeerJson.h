@@ -39,6 +39,9 @@ namespace BeerJson {
    /**
     * \brief Objects of this class are intended to be relatively short-lived, existing only for the time it takes to
     *        construct the serialized representation and write it to a file.
+    *
+    *        Output is streamed to the file as it is generated (ie each record is written as soon as it has been
+    *        converted to JSON), so memory usage does not depend on how many records are exported.
     */
    class Exporter {
    public:
@@ -51,12 +54,14 @@ namespace BeerJson {
       ~Exporter();
 
       /**
-      * \brief Add a list of \c NamedEntity objects to the serializer
+      * \brief Write a list of \c NamedEntity objects to the file.  Each type of object should be added at most once,
+      *        and only before \c close() is called.
       */
       template<class NE> void add(QList<NE const *> const & nes);
 
       /**
-      * \brief Write the serialized data to the file.  Will be called in destructor if not already invoked directly.
+      * \brief Finish writing the serialized data to the file.  Will be called in destructor if not already invoked
+      *        directly.
       */
       void close();
 
@@ -696,6 +696,10 @@ SerializationRecordDefinition const & JsonRecord::recordDefinition() const {
    return processingResult;
 }
 
+bool JsonRecord::canStoreInBulk() const {
+   return !this->m_recordDefinition.isOutlineRecord && this->SerializationRecord::canStoreInBulk();
+}
+
 [[nodiscard]] bool JsonRecord::loadChildRecord(JsonRecordDefinition::FieldDefinition const & parentFieldDefinition,
                                                JsonRecordDefinition const & childRecordDefinition,
                                                boost::json::value & childRecordData,
@@ -82,6 +82,12 @@ public:
                                                                 QTextStream & userMessage,
                                                                 ImportRecordCount & stats) override;
 
+   /**
+    * \brief Override base class member function.  Outline records need the extra processing we do in
+    *        \c normaliseAndStoreInDb, so they have to be stored one at a time.
+    */
+   virtual bool canStoreInBulk() const override;
+
    static bool listToJson(QList< std::shared_ptr<NamedEntity> > const & objectsToWrite,
                           boost::json::array & outputArray,
                           JsonCoding const & coding,
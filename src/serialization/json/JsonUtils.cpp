@@ -15,14 +15,18 @@
  =====================================================================================================================*/
 #include "serialization/json/JsonUtils.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 // We could just include <boost/json.hpp> which pulls all the Boost.JSON headers in, but that seems overkill
+#include <boost/json/monotonic_resource.hpp>
 #include <boost/json/parse_options.hpp>
 #include <boost/json/parse.hpp>
 #include <boost/json/string.hpp>
 #include <boost/json/serialize.hpp>
+#include <boost/json/storage_ptr.hpp>
 #include <boost/json/stream_parser.hpp>
 
 #include <QDebug>
@@ -33,6 +37,61 @@
 #include "utils/BtStringStream.h"
 #include "utils/ErrorCodeToStream.h"
 
+namespace {
+   // How much of a file to read at a time when we cannot memory-map it
+   qint64 constexpr readChunkSize = 1024 * 1024;
+
+   /**
+    * \brief Throw a \c BtException describing a parse error at the given byte offset in \c inputFile.
+    *
+    *        Line and column numbers are 1-based.  The column is counted in bytes rather than characters, which is what
+    *        most text editors will show for ASCII and is close enough for anything else.
+    *
+    * \param inputFile  The file being parsed
+    * \param mappedFile If not \c nullptr, the memory-mapped contents of \c inputFile.  Otherwise, we'll re-read the
+    *                   start of the file to find where the error is.
+    * \param errorOffset Byte offset in the file of the error
+    */
+   [[noreturn]] void throwParseError(QFile & inputFile,
+                                     uchar const * mappedFile,
+                                     qint64 const errorOffset,
+                                     std::error_code const & errorCode) {
+      int lineNumber = 1;
+      qint64 startOfLine = 0;
+      auto countLines = [&](char const * data, qint64 const size, qint64 const offsetOfData) {
+         char const * const end = data + size;
+         char const * newline = static_cast<char const *>(std::memchr(data, '\n', end - data));
+         while (newline) {
+            ++lineNumber;
+            startOfLine = offsetOfData + (newline - data) + 1;
+            newline = static_cast<char const *>(std::memchr(newline + 1, '\n', end - (newline + 1)));
+         }
+         return;
+      };
+
+      if (mappedFile) {
+         countLines(reinterpret_cast<char const *>(mappedFile), errorOffset, 0);
+      } else if (inputFile.seek(0)) {
+         QByteArray chunk(readChunkSize, Qt::Uninitialized);
+         for (qint64 offsetOfChunk = 0; offsetOfChunk < errorOffset; ) {
+            qint64 const bytesRead = inputFile.read(chunk.data(), std::min(readChunkSize, errorOffset - offsetOfChunk));
+            if (bytesRead <= 0) {
+               break;
+            }
+            countLines(chunk.constData(), bytesRead, offsetOfChunk);
+            offsetOfChunk += bytesRead;
+         }
+      }
+
+      BtStringStream errorMessage;
+      errorMessage <<
+         "Parsing failed at line " << lineNumber << ", column " << (errorOffset - startOfLine + 1) << ": " <<
+         errorCode;
+      qWarning() << Q_FUNC_INFO << errorMessage.asString();
+      throw BtException(errorMessage.asString());
+   }
+}
+
 [[nodiscard]] boost::json::value JsonUtils::loadJsonDocument(QString const & fileName, bool allowComments) {
 
    QFile inputFile(fileName);
@@ -66,8 +125,22 @@
    // give you the best error handling.  In particular if there is a problem with the json input, you'll just get
    // a std::error_code that says, eg, "syntax error" without giving you any clue where in the input the problem is.
    //
-   // So, instead, we need to create a streaming parser and give it the source one line at a time.  That way, if we
-   // hit an error we can get the line number that first caused it.
+   // So, instead, we create a streaming parser and give it the source in pieces.  When it hits an error, it tells us
+   // how much of the current piece it consumed, which gives us the byte offset of the problem, from which we can work
+   // out line and column numbers.
+   //
+   // We used to feed the parser one line at a time (so the line number came for free), but this is slow for big files
+   // (a new QByteArray per line) and useless for minified JSON, which is typically all on one line.  Instead, where
+   // possible, we memory-map the file and hand the parser the whole thing in one go.  Where we cannot map the file (eg
+   // it's a compressed Qt resource) we read it in large fixed-size chunks into a single reused buffer.  Either way,
+   // we only pay for working out line/column numbers when there is actually an error to report.
+   //
+   // Memory for the parsed document
+   // ------------------------------
+   // The document we return is only ever read, and is discarded in one go once we've finished with it, so we give the
+   // parser a monotonic_resource arena for its storage.  This is a lot faster than allocating each string, array and
+   // object individually.  Note that the arena lives as long as the returned value (or anything moved from it), but
+   // copying the returned value into a value with different storage will (deep) copy it out of the arena.
    //
    // String encodings
    // ----------------
@@ -144,33 +217,54 @@
 
       boost::json::parse_options parseOptions;
       parseOptions.allow_comments = allowComments;
+      // Small stack buffer for the parser's own temporary storage -- it only falls back to the heap for deeply-nested
+      // documents
+      unsigned char parserTempBuffer[4096];
       boost::json::stream_parser streamParser{
-         boost::json::storage_ptr{}, // Default memory resource
-         parseOptions,               // Default parse options (strict parsing)
+         boost::json::storage_ptr{}, // Default memory resource for anything that doesn't fit in parserTempBuffer
+         parseOptions,
+         parserTempBuffer,
+         sizeof(parserTempBuffer)
       };
-      QByteArray rawInputLine{};
-      for (auto [lineNumber, bytesLeftToRead] = std::tuple{1, fileSize};
-         bytesLeftToRead > 0;
-         ++lineNumber, bytesLeftToRead -= rawInputLine.size()) {
-         // Because of the way UTF-8 is encoded (see eg https://www.johndcook.com/blog/2019/09/09/how-utf-8-works/), it
-         // is entirely valid to treat it as an ASCII file for many purposes, including "give me a line of text".
-         rawInputLine = inputFile.readLine();
-         boost::json::string_view inputStringView{rawInputLine.data()};
-         streamParser.write(inputStringView, errorCode);
+      streamParser.reset(boost::json::make_shared_resource<boost::json::monotonic_resource>());
+
+      //
+      // Note that QFile::map() returns nullptr rather than throwing if it cannot map the file, and that the mapping is
+      // automatically released when inputFile is closed (ie when it goes out of scope).
+      //
+      uchar const * mappedFile = inputFile.map(0, fileSize);
+      if (mappedFile) {
+         char const * data = reinterpret_cast<char const *>(mappedFile);
+         std::size_t const bytesParsed = streamParser.write(data, static_cast<std::size_t>(fileSize), errorCode);
          if (errorCode) {
-            BtStringStream errorMessage{};
-            errorMessage << "Parsing failed at line " << lineNumber << ": " << errorCode;
-            qWarning() << Q_FUNC_INFO << errorMessage.asString();
-            throw BtException(errorMessage.asString());
+            throwParseError(inputFile, mappedFile, static_cast<qint64>(bytesParsed), errorCode);
+         }
+      } else {
+         qDebug() << Q_FUNC_INFO << "Unable to map" << fileName << "so reading it in chunks";
+         QByteArray chunk(readChunkSize, Qt::Uninitialized);
+         qint64 offsetOfChunk = 0;
+         while (offsetOfChunk < fileSize) {
+            qint64 const bytesRead = inputFile.read(chunk.data(), chunk.size());
+            if (bytesRead <= 0) {
+               BtStringStream errorMessage;
+               errorMessage <<
+                  "Error reading " << fileName << " at byte " << offsetOfChunk << " of " << fileSize << ": " <<
+                  inputFile.errorString();
+               qWarning() << Q_FUNC_INFO << errorMessage.asString();
+               throw BtException(errorMessage.asString());
+            }
+            std::size_t const bytesParsed =
+               streamParser.write(chunk.constData(), static_cast<std::size_t>(bytesRead), errorCode);
+            if (errorCode) {
+               throwParseError(inputFile, nullptr, offsetOfChunk + static_cast<qint64>(bytesParsed), errorCode);
+            }
+            offsetOfChunk += bytesRead;
          }
       }
 
       streamParser.finish(errorCode);
       if (errorCode) {
-         BtStringStream errorMessage;
-         errorMessage << "Parsing failed after reading last line: " << errorCode;
-         qWarning() << Q_FUNC_INFO << errorMessage.asString();
-         throw BtException(errorMessage.asString());
+         throwParseError(inputFile, mappedFile, fileSize, errorCode);
       }
       boost::json::value parsedDocument = streamParser.release();
 
@@ -39,6 +39,9 @@ namespace JsonUtils {
     *                      useful for us to have such comments in data/DefaultContent002-BJCP_2021_Styles.json and
     *                      similar files.
     *
+    * \return The parsed document.  Its storage is a memory arena that is freed when the document is destroyed, so
+    *         callers should move rather than copy it if they want to avoid a deep copy.
+    *
     * \throw BtException containing text that can be displayed to the user
     */
    [[nodiscard]] boost::json::value loadJsonDocument(QString const & fileName, bool allowComments = true);
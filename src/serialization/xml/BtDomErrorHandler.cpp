@@ -37,7 +37,8 @@ public:
                                                lastError(),
                                                errorPatternsToIgnore(errorPatternsToIgnore),
                                                numberOfLinesInserted(numberOfLinesInserted),
-                                               lineAfterWhichInserted(lineAfterWhichInserted) {
+                                               lineAfterWhichInserted(lineAfterWhichInserted),
+                                               lineOffset(0) {
       return;
    }
 
@@ -54,6 +55,7 @@ public:
    QVector<BtDomErrorHandler::PatternAndReason> const * errorPatternsToIgnore;
    unsigned int numberOfLinesInserted;
    unsigned int lineAfterWhichInserted;
+   unsigned int lineOffset;
 
 };
 
@@ -89,6 +91,8 @@ QString BtDomErrorHandler::getlastError() {
 }
 
 unsigned int BtDomErrorHandler::correctErrorLine(unsigned int lineNumberOfError) {
+   lineNumberOfError += this->pimpl->lineOffset;
+
    if (this->pimpl->numberOfLinesInserted > 0 &&
          lineNumberOfError > (this->pimpl->lineAfterWhichInserted + this->pimpl->numberOfLinesInserted)) {
       qDebug() <<
@@ -100,6 +104,11 @@ unsigned int BtDomErrorHandler::correctErrorLine(unsigned int lineNumberOfError)
    return lineNumberOfError;
 }
 
+void BtDomErrorHandler::setLineOffset(unsigned int lineOffset) {
+   this->pimpl->lineOffset = lineOffset;
+   return;
+}
+
 bool BtDomErrorHandler::handleError(xercesc::DOMError const & domError) {
    //
    // Although they are often reasonably clear and straightforward, there can sometimes be a bit of an art to
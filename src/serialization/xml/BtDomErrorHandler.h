@@ -80,6 +80,14 @@ public:
     */
    unsigned int correctErrorLine(unsigned int lineNumberOfError);
 
+   /**
+    * If the document being parsed is actually a piece cut out of a bigger one (see \c XmlCoding), this says how many
+    * lines of the bigger document come before the first line of the piece, so that we can report errors at the right
+    * places in the bigger document.  The offset is added to the line number of an error before any correction for
+    * insertions.  Default is 0.
+    */
+   void setLineOffset(unsigned int lineOffset);
+
    /**
     * If the handleError method returns true the DOM implementation should continue as if the error didn't happen when
     * possible, if the method returns false then the DOM implementation should stop the current processing when possible.
@@ -15,8 +15,13 @@
  =====================================================================================================================*/
 #include "serialization/xml/XmlCoding.h"
 
+#include <functional>
+#include <memory>
+
 #include <QDebug>
 #include <QFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 #include <xercesc/dom/DOMConfiguration.hpp>
 #include <xercesc/dom/DOMDocument.hpp>
@@ -93,6 +98,17 @@
 // using a huge number of different function calls.
 //
 
+namespace {
+   //
+   // Documents bigger than this get imported a batch of records at a time (see
+   // XmlCoding::impl::validateLoadAndStoreInDbStreamed), with each batch being roughly this size (or one record, if a
+   // record is bigger than that).  The numbers are somewhat arbitrary, but the aim is that almost all real-world files
+   // get processed in one go, as that gives the best error reporting, and that the really big ones don't need more
+   // than a few tens of megabytes of DOM tree at any one time.
+   //
+   qsizetype constexpr streamingThreshold = 8 * 1024 * 1024;
+   qsizetype constexpr streamingBatchSize = 1024 * 1024;
+}
 
 //
 // Private implementation class for XmlCoding
@@ -361,6 +377,256 @@ public:
                                  QString const & fileName,
                                  BtDomErrorHandler & domErrorHandler,
                                  QTextStream & userMessage) {
+      //
+      // Small files (which is almost all of them) we validate and load in one go.  Big ones we split up -- see
+      // validateLoadAndStoreInDbStreamed.
+      //
+      if (documentData.size() > streamingThreshold) {
+         return this->validateLoadAndStoreInDbStreamed(documentData, fileName, domErrorHandler, userMessage);
+      }
+
+      ImportRecordCount stats;
+      if (!this->validateAndLoad(documentData, fileName, domErrorHandler, userMessage, &stats)) {
+         return false;
+      }
+
+      // Everything went OK - unless we found no content to read.
+      // Summarise what we read in into the message displayed on-screen to the user, and return false if no content,
+      // true otherwise
+      return stats.writeToUserMessage(userMessage);
+   }
+
+   /**
+    * \brief Import a large XML document a piece at a time.
+    *
+    *        Validating and loading a document means building a Xerces DOM for it and then a Xalan wrapper around that,
+    *        ie two in-memory trees for the whole file.  For very large files, we instead split the document into a
+    *        series of small ones, each holding a batch of records (see \c forEachBatch), so memory usage for the DOM
+    *        trees is bounded by the batch size (or the largest record) rather than the file size.
+    *
+    *        We go through the batches twice: first just to validate them all, then to load them and store them in the
+    *        DB.  This way, as with a small file, a document that fails validation does not get partially imported.  If
+    *        something goes wrong at the loading stage, we tell the user what was stored before the problem was found.
+    *
+    *        Parameters and return value are as for \c validateLoadAndStoreInDb.
+    */
+   bool validateLoadAndStoreInDbStreamed(QByteArray const & documentData,
+                                         QString const & fileName,
+                                         BtDomErrorHandler & domErrorHandler,
+                                         QTextStream & userMessage) {
+      qInfo() <<
+         Q_FUNC_INFO << "Importing" << fileName << "(" << documentData.size() << "bytes) in batches of up to" <<
+         streamingBatchSize << "bytes";
+
+      int numBatches = 0;
+      bool const validatedOk = this->forEachBatch(
+         documentData,
+         fileName,
+         domErrorHandler,
+         userMessage,
+         [&](QByteArray const & batchDocument) {
+            ++numBatches;
+            return this->validateAndLoad(batchDocument, fileName, domErrorHandler, userMessage, nullptr);
+         }
+      );
+      if (!validatedOk) {
+         return false;
+      }
+      qInfo() << Q_FUNC_INFO << "Validated" << fileName << "in" << numBatches << "batches";
+
+      ImportRecordCount stats;
+      bool const loadedOk = this->forEachBatch(
+         documentData,
+         fileName,
+         domErrorHandler,
+         userMessage,
+         [&](QByteArray const & batchDocument) {
+            return this->validateAndLoad(batchDocument, fileName, domErrorHandler, userMessage, &stats);
+         }
+      );
+      if (!loadedOk) {
+         //
+         // Unlike with a small document, records from earlier batches (and from earlier in the batch that failed) will
+         // already be in the DB, so the user needs to know about them.
+         //
+         QString importedSoFar;
+         QTextStream importedSoFarAsStream{&importedSoFar};
+         if (stats.writeToUserMessage(importedSoFarAsStream)) {
+            qWarning() << Q_FUNC_INFO << "Partial import of" << fileName << ":" << importedSoFar;
+            userMessage <<
+               "\n\n" << XmlCoding::tr("The following was imported before the problem was found:") << "\n" <<
+               importedSoFar;
+         }
+         return false;
+      }
+
+      qInfo() << Q_FUNC_INFO << "Loaded" << fileName << "in" << numBatches << "batches";
+      return stats.writeToUserMessage(userMessage);
+   }
+
+   /**
+    * \brief Walk through a document with \c QXmlStreamReader, copying its top-level records (eg RECIPE, HOP) out into
+    *        a series of small documents, and call \c processBatchDocument for each one in turn.
+    *
+    *        Each small document holds roughly \c streamingBatchSize bytes of records (or one record, if a record is
+    *        bigger than that) inside the same root and container elements as the original, including any attributes
+    *        and namespace declarations they have.  While each small document is being processed, we tell
+    *        \c domErrorHandler where in \c documentData its records came from, so that it reports errors at the right
+    *        places in the original file.
+    *
+    *        Other parameters are as for \c validateLoadAndStoreInDb.
+    *
+    * \return \c false if there was a problem reading the document or \c processBatchDocument returned \c false (in
+    *         which case we stop straight away), \c true otherwise
+    */
+   bool forEachBatch(QByteArray const & documentData,
+                     QString const & fileName,
+                     BtDomErrorHandler & domErrorHandler,
+                     QTextStream & userMessage,
+                     std::function<bool(QByteArray const &)> const & processBatchDocument) const {
+      QXmlStreamReader reader{documentData};
+      QString const rootName{*this->m_rootRecordDefinition.m_recordName};
+
+      ElementTags rootTags;
+      ElementTags containerTags;
+      QByteArray batch;
+      std::unique_ptr<QXmlStreamWriter> batchWriter;
+      qint64 firstLineOfBatch = 0;
+
+      //
+      // Wrap up the current batch as a document and process it.  We put the XML declaration and the root and container
+      // start tags on the same line as the first record of the batch, so line 1 of the batch document is line
+      // firstLineOfBatch of documentData.
+      //
+      auto processBatch = [&]() {
+         batchWriter.reset();
+         QByteArray batchDocument{"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"};
+         batchDocument.append((rootTags.start + containerTags.start).toUtf8());
+         batchDocument.append(batch);
+         batchDocument.append((containerTags.end + rootTags.end).toUtf8());
+         batchDocument.append('\n');
+         batch.clear();
+         domErrorHandler.setLineOffset(static_cast<unsigned int>(firstLineOfBatch - 1));
+         bool const succeeded = processBatchDocument(batchDocument);
+         domErrorHandler.setLineOffset(0);
+         return succeeded;
+      };
+
+      //
+      // Depth 1 is the root element, depth 2 is containers (eg RECIPES, HOPS) and depth 3 is the records we want
+      //
+      int depth = 0;
+      while (!reader.atEnd()) {
+         switch (reader.readNext()) {
+            case QXmlStreamReader::StartElement:
+               ++depth;
+               if (1 == depth) {
+                  if (reader.name() != rootName) {
+                     qCritical() <<
+                        Q_FUNC_INFO << "First node in document was not the one we inserted!  Found " << reader.name() <<
+                        "instead of" << rootName;
+                     userMessage << XmlCoding::tr("Could not understand file format");
+                     return false;
+                  }
+                  setTags(reader, rootTags);
+               } else if (2 == depth) {
+                  setTags(reader, containerTags);
+               } else {
+                  if (!batchWriter) {
+                     firstLineOfBatch = reader.lineNumber();
+                     batchWriter = std::make_unique<QXmlStreamWriter>(&batch);
+                  }
+                  batchWriter->writeCurrentToken(reader);
+               }
+               break;
+
+            case QXmlStreamReader::EndElement:
+               if (depth >= 3) {
+                  batchWriter->writeCurrentToken(reader);
+                  if (3 == depth && batch.size() >= streamingBatchSize && !processBatch()) {
+                     return false;
+                  }
+               } else if (2 == depth && batchWriter && !processBatch()) {
+                  return false;
+               }
+               --depth;
+               break;
+
+            case QXmlStreamReader::Characters:
+            case QXmlStreamReader::Comment:
+            case QXmlStreamReader::ProcessingInstruction:
+            case QXmlStreamReader::EntityReference:
+               // Anything between records in the same batch needs to be copied, otherwise line numbers would be off
+               if (batchWriter) {
+                  batchWriter->writeCurrentToken(reader);
+               }
+               break;
+
+            default:
+               // StartDocument, EndDocument, DTD etc are not part of any record
+               break;
+         }
+      }
+
+      if (reader.hasError()) {
+         //
+         // The line number needs correcting in the same way as Xerces ones, because it's counted in the same
+         // (modified) document.
+         //
+         unsigned int const lineNumberOfError =
+            domErrorHandler.correctErrorLine(static_cast<unsigned int>(reader.lineNumber()));
+         qWarning() <<
+            Q_FUNC_INFO << "Error reading" << fileName << "at line" << lineNumberOfError << ":" << reader.errorString();
+         userMessage << "Error at line " << lineNumberOfError << ": " << reader.errorString();
+         return false;
+      }
+
+      return true;
+   }
+
+   /**
+    * \brief Start and end tags of an element, as text
+    */
+   struct ElementTags {
+      QString start;
+      QString end;
+   };
+
+   /**
+    * \brief Set \c tags to the start and end tags of the element \c reader is currently at the start of.  The start
+    *        tag includes the element's namespace declarations and attributes, so that an element we write with it
+    *        means the same as the one in the original document.
+    */
+   static void setTags(QXmlStreamReader const & reader, ElementTags & tags) {
+      QString const elementName = reader.qualifiedName().toString();
+      tags.start = QString{"<"} + elementName;
+      for (QXmlStreamNamespaceDeclaration const & declaration : reader.namespaceDeclarations()) {
+         tags.start += declaration.prefix().isEmpty() ? QString{" xmlns"} :
+                                                        QString{" xmlns:%1"}.arg(declaration.prefix().toString());
+         tags.start += QString{"=\"%1\""}.arg(declaration.namespaceUri().toString().toHtmlEscaped());
+      }
+      for (QXmlStreamAttribute const & attribute : reader.attributes()) {
+         tags.start += QString{" %1=\"%2\""}.arg(attribute.qualifiedName().toString(),
+                                                 attribute.value().toString().toHtmlEscaped());
+      }
+      tags.start += QString{">"};
+      tags.end = QString{"</%1>"}.arg(elementName);
+      return;
+   }
+
+   /**
+    * \brief Validate a document against the schema, load its contents and store them in the DB, adding to \c stats
+    *
+    *        Other parameters and return value are as for \c validateLoadAndStoreInDb, except that it is the caller's
+    *        responsibility to write \c stats to \c userMessage afterwards.
+    *
+    * \param stats If \c nullptr, we only validate the document, and do not load or store anything
+    */
+   bool validateAndLoad(QByteArray const & documentData,
+                        QString const & fileName,
+                        BtDomErrorHandler & domErrorHandler,
+                        QTextStream & userMessage,
+                        ImportRecordCount * stats) {
       if (!m_initialised) {
          this->loadSchema(m_schemaResource);
          m_initialised = true;
@@ -416,8 +682,11 @@ public:
             return false;
          }
 
-         // If we got this far, the validation has succeeded, and we can now proceed to loading
-         return this->loadValidated(domDocumentOwner.getDomDocument(), userMessage);
+         // If we got this far, the validation has succeeded, and we can now proceed to loading (if asked to)
+         if (!stats) {
+            return true;
+         }
+         return this->loadValidated(domDocumentOwner.getDomDocument(), userMessage, *stats);
 
       } catch(const std::exception& se) {
          qCritical() << Q_FUNC_INFO << "Caught std::exception: " << se.what();
@@ -455,10 +724,12 @@ public:
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this.
     *
+    * \param stats Tallies of what was read in
+    *
     * \return true if file validated OK (including if there were "errors" that we can safely ignore)
     *         false if there was a problem that means it's not worth trying to read in the data from the file
     */
-   bool loadValidated(xercesc::DOMDocument * domDocument, QTextStream & userMessage) {
+   bool loadValidated(xercesc::DOMDocument * domDocument, QTextStream & userMessage, ImportRecordCount & stats) {
 
       //
       // Some of the initial things we're doing here are just as easy to do in Xerces, but it's easiest to start
@@ -490,7 +761,7 @@ public:
          return false;
       }
 
-      return this->loadNormaliseAndStoreInDb(domSupport, rootNode, userMessage);
+      return this->loadNormaliseAndStoreInDb(domSupport, rootNode, userMessage, stats);
    }
 
 
@@ -500,11 +771,13 @@ public:
     * \param rootNode root node of document
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this.
+    * \param stats Tallies of what was read in
     * \return
     */
    bool loadNormaliseAndStoreInDb(xalanc::DOMSupport & domSupport,
                                   xalanc::XalanNode * rootNode,
-                                  QTextStream & userMessage) const {
+                                  QTextStream & userMessage,
+                                  ImportRecordCount & stats) const {
 
       XQString rootNodeName{rootNode->getNodeName()};
       qDebug() << Q_FUNC_INFO << "Processing root node: " << rootNodeName;
@@ -516,8 +789,6 @@ public:
       qDebug() <<
          Q_FUNC_INFO << "Looking at field definitions of root element (" << this->m_rootRecordDefinition.m_recordName << ")";
 
-      ImportRecordCount stats;
-
       if (!rootRecord.load(domSupport, rootNode, userMessage)) {
          return false;
       }
@@ -528,10 +799,7 @@ public:
          return false;
       }
 
-      // Everything went OK - unless we found no content to read.
-      // Summarise what we read in into the message displayed on-screen to the user, and return false if no content,
-      // true otherwise
-      return stats.writeToUserMessage(userMessage);
+      return true;
    }
 
    // =========================================== Member variables for impl ============================================
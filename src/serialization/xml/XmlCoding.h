@@ -145,6 +145,9 @@ public:
    /**
     * \brief Validate XML file against schema, load its contents into objects, and store then in the DB
     *
+    *        Very large files are validated and loaded a batch of top-level records at a time, to avoid holding DOM
+    *        trees for the whole file in memory.
+    *
     * \param documentData The contents of the XML file, which the caller should already have loaded into memory
     * \param fileName Used only for logging / error message
     * \param domErrorHandler The rules for handling any errors encountered in the file - in particular which errors
@@ -39,6 +39,16 @@ protected:
                                                                            QTextStream & userMessage,
                                                                            ImportRecordCount & stats) override;
 
+public:
+   /**
+    * \brief Because of the extra work we do in \c normaliseAndStoreInDb and \c normaliseAndStoreChildRecordsInDb,
+    *        recipes always need to be stored one at a time.
+    */
+   virtual bool canStoreInBulk() const override {
+      return false;
+   }
+
+protected:
    /**
     * \brief We override \c XmlRecord::normaliseAndStoreChildRecordsInDb because we want to create a child record for
     *        \c Boil (which isn't modelled as a child record in BeerXML).
@@ -15,10 +15,15 @@
  =====================================================================================================================*/
 #include "serialization/xml/XmlRecord.h"
 
+#include <optional>
+#include <vector>
+
 #include <QDate>
 #include <QDebug>
+#include <QHash>
 #include <QXmlStreamWriter>
 
+#include <xalanc/XalanDOM/XalanNode.hpp>
 #include <xalanc/XalanDOM/XalanNodeList.hpp>
 #include <xalanc/XPath/NodeRefList.hpp>
 #include <xalanc/XPath/XPathEvaluator.hpp>
@@ -50,6 +55,33 @@ namespace {
       "UNRECOGNISED!"
    };
 
+   /**
+    * \brief Add all the child elements of \c parent to \c childElementsByTagName, in document order
+    */
+   void appendChildElements(xalanc::XalanNode * parent,
+                            QHash<QString, std::vector<xalanc::XalanNode *>> & childElementsByTagName) {
+      for (xalanc::XalanNode * child = parent->getFirstChild(); child; child = child->getNextSibling()) {
+         if (child->getNodeType() == xalanc::XalanNode::ELEMENT_NODE) {
+            childElementsByTagName[XQString{child->getNodeName()}].push_back(child);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Add the child elements of \c parent that have the given tag name to \c childElements, in document order
+    */
+   void appendChildElements(xalanc::XalanNode * parent,
+                            std::vector<xalanc::XalanNode *> & childElements,
+                            QString const & tagName) {
+      for (xalanc::XalanNode * child = parent->getFirstChild(); child; child = child->getNextSibling()) {
+         if (child->getNodeType() == xalanc::XalanNode::ELEMENT_NODE && XQString{child->getNodeName()} == tagName) {
+            childElements.push_back(child);
+         }
+      }
+      return;
+   }
+
    /**
     * \brief Helper function for writing multiple indents
     */
@@ -78,7 +110,15 @@ SerializationRecordDefinition const & XmlRecord::recordDefinition() const {
 bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                      xalanc::XalanNode * rootNodeOfRecord,
                      QTextStream & userMessage) {
-   xalanc::XPathEvaluator xPathEvaluator;
+   //
+   // Almost all fields are identified by a plain tag name (eg "NAME") or a short path of them (eg "HOPS/HOP"), so,
+   // rather than have Xalan parse and evaluate an XPath for each field, we walk the child elements of the record once,
+   // grouping them by tag name.  We then only need the (comparatively expensive) XPath evaluator for any field whose
+   // xPath is something more complicated (see XmlRecordDefinition::FieldDefinition::tagNamePath).
+   //
+   QHash<QString, std::vector<xalanc::XalanNode *>> childElementsByTagName;
+   appendChildElements(rootNodeOfRecord, childElementsByTagName);
+   std::optional<xalanc::XPathEvaluator> xPathEvaluator;
    //
    // Loop through all the fields that we know/care about.  Anything else is intentionally ignored.  (We won't know
    // what to do with it, and, if it weren't allowed to be there, it would have generated an error at XSD parsing.)
@@ -128,9 +168,21 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
          // type.  (Even then, it's only in certain cases.)
          Q_ASSERT(std::holds_alternative<XmlRecordDefinition const *>(fieldDefinition.valueDecoder));
          nodesForCurrentXPath.push_back(rootNodeOfRecord);
+      } else if (!fieldDefinition.tagNamePath.isEmpty()) {
+         nodesForCurrentXPath = childElementsByTagName.value(fieldDefinition.tagNamePath.first());
+         for (auto step = fieldDefinition.tagNamePath.cbegin() + 1; step != fieldDefinition.tagNamePath.cend(); ++step) {
+            std::vector<xalanc::XalanNode *> nodesForNextStep;
+            for (xalanc::XalanNode * node : nodesForCurrentXPath) {
+               appendChildElements(node, nodesForNextStep, *step);
+            }
+            nodesForCurrentXPath.swap(nodesForNextStep);
+         }
       } else {
+         if (!xPathEvaluator) {
+            xPathEvaluator.emplace();
+         }
          xalanc::NodeRefList tempNodesForCurrentXPath;
-         xPathEvaluator.selectNodeList(tempNodesForCurrentXPath,
+         xPathEvaluator->selectNodeList(tempNodesForCurrentXPath,
                                        domSupport,
                                        rootNodeOfRecord,
                                        fieldDefinition.xPath.getXalanString());
@@ -15,7 +15,10 @@
  =====================================================================================================================*/
 #include "serialization/xml/XmlRecordDefinition.h"
 
+#include <algorithm>
+
 #include <QDebug>
+#include <QRegularExpression>
 
 #include "utils/EnumStringMapping.h"
 #include "serialization/xml/XmlRecord.h"
@@ -42,7 +45,8 @@ XmlRecordDefinition::FieldDefinition::FieldDefinition(FieldType    type,
    type{type},
    xPath{xPath},
    propertyPath{propertyPath},
-   valueDecoder{valueDecoder} {
+   valueDecoder{valueDecoder},
+   tagNamePath{} {
    // An XmlRecordDefinition address should be in the valueDecoder if and only if the record type is Record or
    // ListOfRecords.  Otherwise there's a coding error in the mappings in BeerXML.cpp.  We assert this also when we're
    // processing an XML file, but the advantage of doing so here is that we'll get a start-up error, so bugs will be
@@ -53,6 +57,20 @@ XmlRecordDefinition::FieldDefinition::FieldDefinition(FieldType    type,
    Q_ASSERT((XmlRecordDefinition::FieldType::Record        == this->type ||
              XmlRecordDefinition::FieldType::ListOfRecords == this->type) ==
             std::holds_alternative<XmlRecordDefinition const *>(this->valueDecoder));
+
+   //
+   // Work out whether the XPath is simple enough for XmlRecord::load to follow without using an XPath evaluator.  Note
+   // that field definitions are mostly static objects in other files, so we use a function-local static for the regexp
+   // to avoid any static initialisation order problems.
+   //
+   static QRegularExpression const tagNameMatcher{"^[A-Za-z_][A-Za-z0-9_.-]*$"};
+   QStringList const steps = this->xPath.split('/');
+   if (!this->xPath.isEmpty() &&
+       std::all_of(steps.cbegin(),
+                   steps.cend(),
+                   [](QString const & step) { return tagNameMatcher.match(step).hasMatch(); })) {
+      this->tagNamePath = steps;
+   }
    return;
 }
 
@@ -21,6 +21,8 @@
 #include <utility> // For std::in_place_type_t
 #include <variant>
 
+#include <QStringList>
+
 #include "measurement/Unit.h"
 #include "serialization/xml/XQString.h"
 #include "serialization/SerializationRecordDefinition.h"
@@ -82,6 +84,12 @@ public:
                       double                         >;        // Default value (for fields that are required in the XML
                                                                // but optional in our internal data model).
       ValueDecoder valueDecoder;
+      /**
+       * If \c xPath is just one or more plain tag names separated by slashes (eg "NAME" or "HOPS/HOP"), which is the
+       * case for almost all fields, then this holds those tag names, and \c XmlRecord::load can find the field by
+       * walking child elements directly rather than evaluating an XPath.  Otherwise it is empty.
+       */
+      QStringList tagNamePath;
       /**
        * Defining a constructor allows us to control the default value of valueDecoder
        */
@@ -30,6 +30,7 @@
 #include <utility>
 
 #include <QDebug>
+#include <QHash>
 #include <QMimeData>
 #include <QModelIndex>
 #include <QQueue>
@@ -39,6 +40,7 @@
 #include <qglobal.h> // For Q_ASSERT and Q_UNREACHABLE
 
 #include "database/ObjectStoreWrapper.h"
+#include "Logging.h"
 #include "trees/TreeNode.h"
 #include "trees/TreeModel.h"
 #include "trees/TreeModelChangeGuard.h"
@@ -512,7 +514,7 @@ public:
       qDebug() <<
          Q_FUNC_INFO << NE::staticMetaObject.className() << "tree now has" <<
          numPrimaryItems << "primary items";
-      qDebug().noquote() << Q_FUNC_INFO << "Tree:\n" << this->m_rootNode->subTreeToString();
+      qCDebug(Logging::category).noquote() << Q_FUNC_INFO << "Tree:\n" << this->m_rootNode->subTreeToString();
       //
       // It's possible for the tree to have _more_ primary items than we inserted (because, eg in a Recipe tree, we add
       // the ancestors of each recipe), but it should never have fewer.
@@ -584,6 +586,17 @@ public:
          parent = this->m_rootNode.get();
       }
 
+      //
+      // Usually we already know where the element lives, because we recorded its node when we inserted it (or the
+      // last time we found it).  The tree owns its nodes, so a node that has been removed from the tree will have been
+      // destroyed and its weak_ptr will have expired.  We still check the node is for the right element and inside
+      // the requested part of the tree, and fall back to searching if not.
+      //
+      if (auto cachedNode = this->m_elementNodes.value(ne).lock();
+          cachedNode && cachedNode->underlyingItem().get() == ne && this->isInSubTree(*cachedNode, *parent)) {
+         return this->derived().createIndex(cachedNode->childNumber(), 0, cachedNode.get());
+      }
+
       //
       // We do a breadth-first search of the tree.  It seems as good as anything, given we don't have any a priori
       // reason to prefer one search order over another.  An obvious alternative would be a depth-first search using
@@ -623,6 +636,7 @@ public:
                      if (itemNode->underlyingItem().get() == const_cast<NE *>(ne)) {
                         // We found what we were looking for
 //                        qDebug() << Q_FUNC_INFO << "Found as child #" << childNumInPrimaryItem << "of" << searchInItem;
+                        this->m_elementNodes.insert(ne, itemNode);
                         return this->derived().createIndex(childNumInPrimaryItem, 0, itemNode.get());
                      }
                      //
@@ -661,6 +675,7 @@ public:
                if (itemNode->underlyingItem().get() == const_cast<NE *>(ne)) {
                   // We found what we were looking for
 //                  qDebug() << Q_FUNC_INFO << "Found as child #" << childNumInFolder << "of" << folderNodeToSearchIn;
+                  this->m_elementNodes.insert(ne, itemNode);
                   return this->derived().createIndex(childNumInFolder, 0, itemNode.get());
                }
                if constexpr (std::is_constructible_v<typename TreeItemNode<NE>::ChildPtrTypes,
@@ -750,6 +765,24 @@ public:
          return QModelIndex();
       }
 
+      //
+      // Searches from the root of the tree are by far the most common (eg every time a primary item is inserted), so
+      // we remember where we found each folder.  As in findElement, we have to check the cached node is still what we
+      // think it is, because folders can be renamed and removed.
+      //
+      bool const searchingFromRoot = (pItem == this->m_rootNode.get());
+      QString const cacheKey = "/" % dirs.join("/");
+      if (searchingFromRoot) {
+         if (auto cachedNode = this->m_folderNodes.value(cacheKey).lock();
+             cachedNode && cachedNode->underlyingItem()->fullPath() == cacheKey &&
+             this->isInSubTree(*cachedNode, *pItem)) {
+            if (folderIsNewlyCreated) {
+               *folderIsNewlyCreated = false;
+            }
+            return this->derived().createIndex(cachedNode->childNumber(), 0, cachedNode.get());
+         }
+      }
+
       QString current = dirs.takeFirst();
       QString fullPath = "/";
       QString targetPath = fullPath % current;
@@ -767,6 +800,9 @@ public:
                // The folder name matches the part we are looking at
                if (dirs.isEmpty()) {
                   // There are no more subtrees to look for, we found it
+                  if (searchingFromRoot) {
+                     this->m_folderNodes.insert(cacheKey, folderNode);
+                  }
                   return this->derived().createIndex(ii, 0, folderNode.get());
                }
                // Otherwise, we found a parent folder in our path
@@ -840,6 +876,9 @@ public:
       auto childNode = std::make_shared<TreeItemNode<ElementType>>(this->derived(), &parentNode, element);
       // Normally leave this debug statement commented out as otherwise it generates too much logging
 //      qDebug() << Q_FUNC_INFO << "Inserting new node " << *childNode << "as child #" << row << "of" << parentNode;
+      if constexpr (std::same_as<ElementType, NE>) {
+         this->m_elementNodes.insert(element.get(), childNode);
+      }
 
       // Parent node can only be one of two types. (It cannot be SecondaryItem because, although we allow Recipes to
       // contain Recipes -- for Recipe versioning -- we don't allow BrewNotes to contain BrewNotes etc.)
@@ -969,6 +1008,18 @@ public:
    }
 
 private:
+   /**
+    * \brief Returns \c true if \c node is \c ancestor or one of its descendants, \c false otherwise
+    */
+   bool isInSubTree(TreeNode const & node, TreeNode const & ancestor) const {
+      for (TreeNode const * current = &node; current; current = current->rawParent()) {
+         if (current == &ancestor) {
+            return true;
+         }
+      }
+      return false;
+   }
+
    QModelIndex createFolderTree(QStringList const & dirs,
                                 TreeFolderNode<NE> * parentNode,
                                 QString const & parentPath) {
@@ -1460,7 +1511,7 @@ public:
       int const numPrimaryItems = this->m_rootNode->nodeCount(TreeNodeClassifier::PrimaryItem);
       qDebug() <<
          Q_FUNC_INFO << NE::staticMetaObject.className() << "tree now has" << numPrimaryItems << "primary items";
-      qDebug().noquote() << Q_FUNC_INFO << "Tree:\n" << this->m_rootNode->subTreeToString();
+      qCDebug(Logging::category).noquote() << Q_FUNC_INFO << "Tree:\n" << this->m_rootNode->subTreeToString();
       return;
    }
 
@@ -1647,6 +1698,15 @@ protected:
    //================================================ Member Variables =================================================
    std::unique_ptr<TreeFolderNode<NE>> m_rootNode;
 
+   //
+   // Lookup caches for findElement and findFolder.  We hold weak pointers because the tree nodes own each other (and
+   // are destroyed when removed from the tree by any of the various routes for doing so), so an expired entry simply
+   // means the node is no longer in the tree.  Entries are refreshed on insert and whenever a search falls back to
+   // walking the tree.
+   //
+   QHash<NE const *, std::weak_ptr<TreeItemNode<NE>>> m_elementNodes;
+   QHash<QString, std::weak_ptr<TreeFolderNode<NE>>> m_folderNodes;
+
 };
 
 //
@@ -21,14 +21,19 @@
  =====================================================================================================================*/
 #include "unitTests/Testing.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <exception>
 #include <filesystem>
 #include <iostream>
 #include <iostream> // For std::cout
+#include <limits>
 #include <math.h>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
 
 #include <boost/json/src.hpp> // Needs to be included exactly once in the code to use header-only version of Boost.JSON
@@ -39,13 +44,26 @@
 #include <QString>
 #include <QtTest/QtTest>
 #include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
 #include <QVector>
 
 #include "Application.h"
 #include "Logging.h"
 #include "Algorithms.h"
 #include "config.h"
+#include "database/Database.h"
+#include "database/DatabaseSchemaHelper.h"
+#include "database/DbTransaction.h"
+#include "database/ObjectStore.h"
+#include "database/ObjectStoreTyped.h"
+#include "database/ObjectStoreUtils.h"
+#include "database/NewDbWriteProgress.h"
 #include "database/ObjectStoreWrapper.h"
+#include "database/SqliteBackupJob.h"
 #include "Localization.h"
 #include "Logging.h"
 #include "measurement/Measurement.h"
@@ -61,8 +79,12 @@
 #include "model/Recipe.h"
 #include "model/RecipeAdditionFermentable.h"
 #include "model/RecipeAdditionHop.h"
+#include "model/RecipeAdditionYeast.h"
+#include "model/RecipeCalcGraph.h"
 #include "model/StockPurchaseHop.h"
+#include "model/Style.h"
 #include "PersistentSettings.h"
+#include "serialization/xml/BeerXml.h"
 #include "unitTests/TestMultiVector.h"
 #include "utils/ErrorCodeToStream.h"
 #include "utils/FileSystemHelpers.h"
@@ -283,6 +305,46 @@ namespace {
       return hop;
    }
 
+   /**
+    * \return The name of the hop with the given ID in the SQLite database at \c dbFileName, or an empty string if there
+    *         isn't one (or the file can't be read as a database)
+    */
+   QString readHopNameFromSqliteFile(QString const & dbFileName, int const hopId) {
+      QString hopName;
+      //
+      // Extra braces are so that the QSqlDatabase object is out of scope before the call to
+      // QSqlDatabase::removeDatabase()
+      //
+      QString const connectionName{"readHopNameFromSqliteFile"};
+      {
+         QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+         connection.setDatabaseName(dbFileName);
+         if (connection.open()) {
+            QSqlQuery query{connection};
+            if (query.exec(QString{"SELECT name FROM hop WHERE id = %1;"}.arg(hopId)) && query.next()) {
+               hopName = query.value(0).toString();
+            }
+            query.finish();
+            connection.close();
+         }
+      }
+      QSqlDatabase::removeDatabase(connectionName);
+      return hopName;
+   }
+
+   /**
+    * \return The locking mode ("exclusive" or "normal") of the main database connection
+    */
+   QString mainConnectionLockingMode() {
+      QSqlQuery query{Database::instance().sqlDatabase()};
+      if (!query.exec("PRAGMA locking_mode;") || !query.next()) {
+         return QString{};
+      }
+      QString const lockingMode = query.value(0).toString().toLower();
+      query.finish();
+      return lockingMode;
+   }
+
 }
 
 class Testing::impl {
@@ -860,6 +922,9 @@ void Testing::testLogRotation() {
       qInfo() << QString("iteration %1-4; (%2)").arg(i).arg(randomStringGenerator());
    }
 
+   // Log files are written (and rotated) on a background thread, so wait for it to catch up before we look at them
+   Logging::flush();
+
    // Put logging back to normal
    Logging::setLoggingToStderr(true);
 
@@ -943,3 +1008,1229 @@ void Testing::testInventory() {
 
    return;
 }
+
+void Testing::testWriteBehind() {
+   auto hop = std::make_shared<Hop>("Write-behind test hop");
+   hop->setAlpha_pct(1.0);
+   hop->setBeta_pct(2.0);
+   ObjectStoreWrapper::insert(hop);
+   int const hopId = hop->key();
+   QVERIFY(hopId > 0);
+
+   //
+   // Read what is actually stored in the DB, bypassing the object store.  We use the main connection, rather than one
+   // of our own, as, in exclusive locking mode, another connection would not be able to read the file.
+   //
+   auto readAlphaAndBeta = [hopId]() {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      QSqlQuery query{connection};
+      if (!query.exec(QString{"SELECT alpha, beta FROM hop WHERE id = %1;"}.arg(hopId)) || !query.next()) {
+         return std::pair<double, double>{-1.0, -1.0};
+      }
+      return std::pair<double, double>{query.value(0).toDouble(), query.value(1).toDouble()};
+   };
+
+   ObjectStore::setWriteBehindEnabled(true);
+   QVERIFY(ObjectStore::isWriteBehindEnabled());
+
+   //
+   // Lots of changes to the same property should get coalesced into one DB write, but the last value set is the one
+   // that must end up in the DB.  NB: We deliberately don't process events here, so the flush timer does not get a
+   // chance to fire.
+   //
+   for (int ii = 1; ii <= 100; ++ii) {
+      hop->setAlpha_pct(ii / 10.0);
+   }
+   hop->setBeta_pct(5.5);
+
+   // Nothing has been written yet...
+   auto const [alphaBeforeFlush, betaBeforeFlush] = readAlphaAndBeta();
+   QVERIFY2(fuzzyComp(alphaBeforeFlush, 1.0, 0.0000001), "Alpha written before flush");
+   QVERIFY2(fuzzyComp(betaBeforeFlush , 2.0, 0.0000001), "Beta written before flush");
+
+   // ...until write-behind is turned off, which flushes everything pending
+   QVERIFY(ObjectStore::setWriteBehindEnabled(false));
+   QVERIFY(!ObjectStore::isWriteBehindEnabled());
+   auto const [alphaAfterFlush, betaAfterFlush] = readAlphaAndBeta();
+   QVERIFY2(fuzzyComp(alphaAfterFlush, 10.0, 0.0000001), "Wrong alpha after write-behind");
+   QVERIFY2(fuzzyComp(betaAfterFlush ,  5.5, 0.0000001), "Wrong beta after write-behind");
+   return;
+}
+
+void Testing::testBatchEdit() {
+   auto hop = std::make_shared<Hop>("Batch edit test hop");
+   ObjectStoreWrapper::insert(hop);
+
+   // Batch edits nest, and changes are visible in memory straight away
+   {
+      NamedEntityBatchEdit outerBatchEdit{*hop};
+      {
+         NamedEntityBatchEdit innerBatchEdit{*hop};
+         hop->setAlpha_pct(7.0);
+      }
+      QVERIFY(hop->isInBatchEdit());
+      QVERIFY(fuzzyComp(hop->alpha_pct(), 7.0, 0.0000001));
+   }
+   QVERIFY(!hop->isInBatchEdit());
+
+   //
+   // Counts, for the supplied object, DB writes (ie calls to ObjectStore::updateProperty, each of which is followed by
+   // ObjectStore::signalPropertyChanged) and changed signals for the supplied property.  Caller's responsibility to
+   // disconnect the returned connections.
+   //
+   struct PropertyChangeCounts {
+      int numDbWrites = 0;
+      int numChangedSignals = 0;
+   };
+   auto countPropertyChanges = [](NamedEntity const & namedEntity,
+                                  ObjectStore const & objectStore,
+                                  BtStringConst const & propertyName,
+                                  PropertyChangeCounts & counts) {
+      int const id = namedEntity.key();
+      return std::array<QMetaObject::Connection, 2>{
+         QObject::connect(
+            &objectStore,
+            &ObjectStore::signalPropertyChanged,
+            [&counts, &propertyName, id](int const changedId, BtStringConst const & changedPropertyName) {
+               if (changedId == id && changedPropertyName == propertyName) {
+                  ++counts.numDbWrites;
+               }
+               return;
+            }
+         ),
+         QObject::connect(
+            &namedEntity,
+            &NamedEntity::changed,
+            [&counts, &propertyName](QMetaProperty property, [[maybe_unused]] QVariant value) {
+               if (propertyName == property.name()) {
+                  ++counts.numChangedSignals;
+               }
+               return;
+            }
+         )
+      };
+   };
+   auto disconnectAll = [](std::array<QMetaObject::Connection, 2> const & connections) {
+      for (auto const & connection : connections) {
+         QObject::disconnect(connection);
+      }
+      return;
+   };
+
+   //
+   // If an exception propagates out of a batch edit, the batch edit ends (without the exception being replaced by
+   // another or the program terminating), and the changes made before the exception still get written to the DB and
+   // signalled.
+   //
+   PropertyChangeCounts abandonedCounts;
+   auto const abandonedConnections = countPropertyChanges(*hop,
+                                                          ObjectStoreTyped<Hop>::getInstance(),
+                                                          PropertyNames::Hop::alpha_pct,
+                                                          abandonedCounts);
+   bool caughtException = false;
+   try {
+      NamedEntityBatchEdit batchEdit{*hop};
+      hop->setAlpha_pct(8.0);
+      throw std::runtime_error{"Exception thrown inside batch edit"};
+   } catch (std::runtime_error const &) {
+      caughtException = true;
+   }
+   disconnectAll(abandonedConnections);
+   QVERIFY(caughtException);
+   QVERIFY(!hop->isInBatchEdit());
+   QVERIFY(fuzzyComp(hop->alpha_pct(), 8.0, 0.0000001));
+   QCOMPARE(abandonedCounts.numDbWrites, 1);
+   QCOMPARE(abandonedCounts.numChangedSignals, 1);
+
+   // We can still do batch edits afterwards
+   {
+      NamedEntityBatchEdit batchEdit{*hop};
+      hop->setAlpha_pct(9.0);
+   }
+   QVERIFY(!hop->isInBatchEdit());
+   QVERIFY(fuzzyComp(hop->alpha_pct(), 9.0, 0.0000001));
+
+   //
+   // Setting the same properties many times in a batch edit results in one DB write and one changed signal per
+   // property, and, for a Recipe, one recalculation, all at the end of the batch edit.
+   //
+   auto recipe = std::make_shared<Recipe>("Batch edit test recipe");
+   ObjectStoreWrapper::insert(recipe);
+   // Get the first calculations out of the way
+   recipe->setBatchSize_l(20.0);
+
+   PropertyChangeCounts batchSizeCounts;
+   PropertyChangeCounts efficiencyCounts;
+   auto const batchSizeConnections = countPropertyChanges(*recipe,
+                                                          ObjectStoreTyped<Recipe>::getInstance(),
+                                                          PropertyNames::Recipe::batchSize_l,
+                                                          batchSizeCounts);
+   auto const efficiencyConnections = countPropertyChanges(*recipe,
+                                                           ObjectStoreTyped<Recipe>::getInstance(),
+                                                           PropertyNames::Recipe::efficiency_pct,
+                                                           efficiencyCounts);
+   QSignalSpy recalculatedSpy{recipe.get(), &Recipe::recalculated};
+   {
+      NamedEntityBatchEdit batchEdit{*recipe};
+      for (int ii = 1; ii <= 10; ++ii) {
+         recipe->setBatchSize_l(20.0 + ii);
+         recipe->setEfficiency_pct(50.0 + ii);
+      }
+      QCOMPARE(batchSizeCounts.numDbWrites, 0);
+      QCOMPARE(batchSizeCounts.numChangedSignals, 0);
+      QCOMPARE(efficiencyCounts.numDbWrites, 0);
+      QCOMPARE(efficiencyCounts.numChangedSignals, 0);
+      QCOMPARE(recalculatedSpy.count(), 0);
+   }
+   disconnectAll(batchSizeConnections);
+   disconnectAll(efficiencyConnections);
+   QCOMPARE(batchSizeCounts.numDbWrites, 1);
+   QCOMPARE(batchSizeCounts.numChangedSignals, 1);
+   QCOMPARE(efficiencyCounts.numDbWrites, 1);
+   QCOMPARE(efficiencyCounts.numChangedSignals, 1);
+   QCOMPARE(recalculatedSpy.count(), 1);
+   QVERIFY(fuzzyComp(recipe->batchSize_l(), 30.0, 0.0000001));
+   QVERIFY(fuzzyComp(recipe->efficiency_pct(), 60.0, 0.0000001));
+   return;
+}
+
+void Testing::testRecipeCalcGraph() {
+   using RecipeCalcGraph::CalcInput;
+   using RecipeCalcGraph::DerivedValue;
+   using RecipeCalcGraph::calcInputs;
+   using RecipeCalcGraph::derivedValues;
+   using RecipeCalcGraph::derivedValuesAffectedBy;
+
+   // Nodes need to be in the same order as DerivedValue, and everything needs to come after what it depends on
+   for (std::size_t ii = 0; ii < RecipeCalcGraph::nodes.size(); ++ii) {
+      auto const & node = RecipeCalcGraph::nodes[ii];
+      QCOMPARE(static_cast<std::size_t>(node.value), ii);
+      for (auto const upstream : node.dependsOn) {
+         QVERIFY2(static_cast<std::size_t>(upstream) < ii, "Recipe calculation graph not in dependency order");
+      }
+   }
+
+   QVERIFY(derivedValuesAffectedBy(calcInputs({})).none());
+
+   QCOMPARE(derivedValuesAffectedBy(calcInputs({CalcInput::Hops})), derivedValues({DerivedValue::IBU}));
+
+   QCOMPARE(
+      derivedValuesAffectedBy(calcInputs({CalcInput::Yeasts})),
+      derivedValues({DerivedValue::OgFg, DerivedValue::ABV, DerivedValue::IBU, DerivedValue::Calories})
+   );
+
+   QCOMPARE(
+      derivedValuesAffectedBy(calcInputs({CalcInput::Efficiency})),
+      derivedValues({DerivedValue::OgFg, DerivedValue::ABV, DerivedValue::BoilGrav, DerivedValue::IBU,
+                     DerivedValue::Calories})
+   );
+
+   QCOMPARE(
+      derivedValuesAffectedBy(calcInputs({CalcInput::Boil})),
+      derivedValues({DerivedValue::VolumeEstimates, DerivedValue::Color, DerivedValue::OgFg, DerivedValue::ABV,
+                     DerivedValue::BoilGrav, DerivedValue::IBU, DerivedValue::Calories})
+   );
+
+   // Fermentables feed into everything
+   QVERIFY(derivedValuesAffectedBy(calcInputs({CalcInput::Fermentables})).all());
+
+   // Several inputs at once gives the union of what each affects
+   QCOMPARE(
+      derivedValuesAffectedBy(calcInputs({CalcInput::Hops, CalcInput::Yeasts})),
+      derivedValuesAffectedBy(calcInputs({CalcInput::Hops})) | derivedValuesAffectedBy(calcInputs({CalcInput::Yeasts}))
+   );
+
+   QCOMPARE(RecipeCalcGraph::calcInputsForClass(Hop::staticMetaObject.className()),
+            calcInputs({CalcInput::Hops}));
+   QCOMPARE(RecipeCalcGraph::calcInputsForClass(RecipeAdditionYeast::staticMetaObject.className()),
+            calcInputs({CalcInput::Yeasts}));
+   QCOMPARE(RecipeCalcGraph::calcInputsForClass(Boil::staticMetaObject.className()),
+            calcInputs({CalcInput::Boil}));
+   QVERIFY(RecipeCalcGraph::calcInputsForClass(Style::staticMetaObject.className()).none());
+   return;
+}
+
+namespace {
+   /**
+    * \brief Make a new object store for \c NE that is separate from the singleton returned by
+    *        \c ObjectStoreTyped<NE>::getInstance but works with the same DB tables.  No data is read from the DB until
+    *        the caller calls \c loadAll (and optionally \c prefetchAll first).
+    */
+   template<class NE>
+   std::unique_ptr<ObjectStoreTyped<NE>> MakeSeparateObjectStore() {
+      // Passing a Database gets us the singleton without it loading any data
+      ObjectStoreTyped<NE> const & singleton = ObjectStoreTyped<NE>::getInstance(&Database::instance());
+      return std::make_unique<ObjectStoreTyped<NE>>(NE::typeLookup,
+                                                    singleton.primaryTable(),
+                                                    singleton.junctionTables(),
+                                                    singleton.indexedProperties(),
+                                                    singleton.lazyLoadOptions());
+   }
+
+   /**
+    * \brief Load all the \c NE objects from the DB twice -- once the normal way on this thread and once with the DB
+    *        reading done on a worker thread, as \c InitialiseAllObjectStores does at start-up -- and check we get the
+    *        same objects either way.
+    */
+   template<class NE>
+   void checkParallelLoadMatchesSerialLoad() {
+      auto serialStore = MakeSeparateObjectStore<NE>();
+      serialStore->loadAll();
+
+      auto parallelStore = MakeSeparateObjectStore<NE>();
+      bool prefetchedOk = false;
+      std::thread worker{[&parallelStore, &prefetchedOk]() { prefetchedOk = parallelStore->prefetchAll(); }};
+      worker.join();
+      QVERIFY2(prefetchedOk, "Prefetch on worker thread failed");
+      parallelStore->loadAll();
+
+      QList<std::shared_ptr<NE>> const serialObjects = serialStore->getAll();
+      QVERIFY(!serialObjects.isEmpty());
+      QCOMPARE(parallelStore->size(), serialStore->size());
+      for (auto const & serialObject : serialObjects) {
+         std::shared_ptr<NE> const parallelObject = parallelStore->getById(serialObject->key());
+         QVERIFY2(parallelObject, qPrintable(QString{"%1 #%2 missing from parallel load"}.arg(
+            NE::staticMetaObject.className()
+         ).arg(serialObject->key())));
+         QCOMPARE(parallelObject->name(), serialObject->name());
+         QVERIFY2(*parallelObject == *serialObject, qPrintable(QString{"%1 #%2 differs between loads"}.arg(
+            NE::staticMetaObject.className()
+         ).arg(serialObject->key())));
+      }
+      return;
+   }
+}
+
+void Testing::testParallelLoad() {
+   // Make sure there is something in the DB to load
+   for (int ii = 1; ii <= 3; ++ii) {
+      auto hop = std::make_shared<Hop>(QString{"Parallel load test hop %1"}.arg(ii));
+      hop->setAlpha_pct(ii * 2.5);
+      ObjectStoreWrapper::insert(hop);
+
+      auto fermentable = std::make_shared<Fermentable>(QString{"Parallel load test fermentable %1"}.arg(ii));
+      fermentable->setColor_srm(ii * 10.0);
+      ObjectStoreWrapper::insert(fermentable);
+   }
+
+   // As in InitialiseAllObjectStores, the worker threads can only read the DB if we relax the exclusive lock
+   QVERIFY(Database::instance().setExclusiveLocking(false));
+   checkParallelLoadMatchesSerialLoad<Hop>();
+   checkParallelLoadMatchesSerialLoad<Fermentable>();
+   QVERIFY(Database::instance().setExclusiveLocking(true));
+
+   // The worker thread should have cleaned up its own DB connection, so only this thread's one should be left
+   QString const ourConnectionName = Database::instance().sqlDatabase().connectionName();
+   QString const connectionPrefix = ourConnectionName.left(ourConnectionName.lastIndexOf('-') + 1);
+   QCOMPARE(QSqlDatabase::connectionNames().filter(connectionPrefix).size(), 1);
+   return;
+}
+
+void Testing::testLazyHydration() {
+   auto recipe = std::make_shared<Recipe>(QString{"Lazy hydration test recipe"});
+   ObjectStoreWrapper::insert(recipe);
+   for (int ii = 1; ii <= 3; ++ii) {
+      auto hopAddition = std::make_shared<RecipeAdditionHop>(QString{"Lazy hydration test hop addition %1"}.arg(ii));
+      hopAddition->setHop(this->pimpl->m_cascade_4pct.get());
+      hopAddition->setStage(RecipeAddition::Stage::Boil);
+      hopAddition->setAddAtTime_mins(ii * 10);
+      hopAddition->setQuantity(ii * 0.01);
+      hopAddition->setMeasure(Measurement::PhysicalQuantity::Mass);
+      recipe->addAddition(hopAddition);
+   }
+   QVector<int> const additionIds = ObjectStoreWrapper::idsOwnedBy<RecipeAdditionHop>(recipe->key());
+   QCOMPARE(additionIds.size(), 3);
+
+   // Recipe::uses works from the indexes, so should give the right answer without needing to look at every addition
+   auto unusedHop = std::make_shared<Hop>("Lazy hydration test unused hop");
+   ObjectStoreWrapper::insert(unusedHop);
+   QVERIFY( recipe->uses(*this->pimpl->m_cascade_4pct));
+   QVERIFY(!recipe->uses(*unusedHop));
+
+   //
+   // Now load the same data into a separate store, where nothing has yet been asked for.  We can look things up in
+   // the indexes without any objects being created.
+   //
+   auto store = MakeSeparateObjectStore<RecipeAdditionHop>();
+   store->loadAll();
+   QVERIFY(store->state() == ObjectStore::State::InitialisedOk);
+   for (int const id : additionIds) {
+      QVERIFY(store->contains(id));
+   }
+   QCOMPARE(store->idsOwnedBy(recipe->key()), additionIds);
+   QVERIFY(store->idsByIndex(PropertyNames::IngredientAmount::ingredientId,
+                             this->pimpl->m_cascade_4pct->key()).contains(additionIds.first()));
+   QVERIFY(store->getAllHydratedOwnedBy(recipe->key()).isEmpty());
+
+   // Asking for one object creates just that one, from the data we read from the DB
+   std::shared_ptr<RecipeAdditionHop> const firstAddition = store->getById(additionIds.first());
+   QVERIFY(firstAddition);
+   QCOMPARE(store->getAllHydratedOwnedBy(recipe->key()).size(), 1);
+   auto const original = ObjectStoreWrapper::getById<RecipeAdditionHop>(additionIds.first());
+   QCOMPARE(firstAddition->name(), original->name());
+   QCOMPARE(firstAddition->recipeId(), recipe->key());
+   QVERIFY(*firstAddition == *original);
+
+   // Asking for all the recipe's additions creates the rest
+   QCOMPARE(store->getAllOwnedBy(recipe->key()).size(), 3);
+   QCOMPARE(store->getAllHydratedOwnedBy(recipe->key()).size(), 3);
+   return;
+}
+
+namespace {
+   /**
+    * \brief Write a BeerXML file of fermentables that is big enough to be imported in batches, with an invalid value
+    *        in record number \c badRecord (if it is not -1), followed by \c numHops hops.
+    *
+    * \return The line of the file on which the invalid value is, or 0 if there isn't one
+    */
+   int writeBigBeerXmlFile(QString const & fileName, int const numRecords, int const badRecord, int const numHops = 0) {
+      QFile file{fileName};
+      if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         return 0;
+      }
+      QTextStream out{&file};
+      QString const notes(500, QChar{'x'});
+      out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" << "<FERMENTABLES>\n";
+      int lineNumber = 2;
+      int lineOfError = 0;
+      for (int ii = 0; ii < numRecords; ++ii) {
+         out <<
+            "  <FERMENTABLE>\n"
+            "    <NAME>Streamed import test fermentable " << ii << "</NAME>\n"
+            "    <VERSION>1</VERSION>\n"
+            "    <TYPE>Grain</TYPE>\n"
+            "    <AMOUNT>1.0</AMOUNT>\n"
+            "    <YIELD>75.0</YIELD>\n";
+         lineNumber += 6;
+         out << "    <COLOR>" << (ii == badRecord ? "dark" : "3.0") << "</COLOR>\n";
+         ++lineNumber;
+         if (ii == badRecord) {
+            lineOfError = lineNumber;
+         }
+         out <<
+            "    <NOTES>" << notes << "</NOTES>\n"
+            "  </FERMENTABLE>\n";
+         lineNumber += 2;
+      }
+      out << "</FERMENTABLES>\n";
+      if (numHops > 0) {
+         out << "<HOPS>\n";
+         for (int ii = 0; ii < numHops; ++ii) {
+            out <<
+               "  <HOP>\n"
+               "    <NAME>Streamed import test hop " << ii << "</NAME>\n"
+               "    <VERSION>1</VERSION>\n"
+               "    <ALPHA>5.0</ALPHA>\n"
+               "    <AMOUNT>0.1</AMOUNT>\n"
+               "    <USE>Boil</USE>\n"
+               "    <TIME>60</TIME>\n"
+               "    <NOTES>" << notes << "</NOTES>\n"
+               "  </HOP>\n";
+         }
+         out << "</HOPS>\n";
+      }
+      return lineOfError;
+   }
+}
+
+void Testing::testStreamedImport() {
+   QString const fileName = this->pimpl->m_tempDir.filePath("streamedImportTest.xml");
+   // Each record is about 700 bytes, so this gives us a file of about 10 MB, ie above the streaming threshold
+   int const numRecords = 15000;
+
+   // Error in the first batch and error in one of the later ones
+   for (int const badRecord : {0, numRecords - 10}) {
+      int const lineOfError = writeBigBeerXmlFile(fileName, numRecords, badRecord);
+      QVERIFY(lineOfError > 0);
+      QVERIFY(QFileInfo{fileName}.size() > 8 * 1024 * 1024);
+
+      QString userMessage;
+      QTextStream userMessageAsStream{&userMessage};
+      QVERIFY(!BeerXML::getInstance().importFromXML(fileName, userMessageAsStream));
+      qDebug() << Q_FUNC_INFO << "Error importing record" << badRecord << ":" << userMessage;
+      QVERIFY2(userMessage.contains(QString{" at line %1,"}.arg(lineOfError)), qPrintable(userMessage));
+
+      // Everything is validated before anything is stored, so none of the good records should have been imported
+      QVERIFY(!ObjectStoreWrapper::findFirstMatching<Fermentable>(
+         [](Fermentable * fermentable) { return fermentable->name().startsWith("Streamed import test"); }
+      ));
+   }
+
+   //
+   // Now a file with no errors, with enough hops after the fermentables that they also span more than one batch.  Every
+   // record should get stored, exactly once.
+   //
+   int const numHops = 2000;
+   QCOMPARE(writeBigBeerXmlFile(fileName, numRecords, -1, numHops), 0);
+   QString userMessage;
+   QTextStream userMessageAsStream{&userMessage};
+   QVERIFY2(BeerXML::getInstance().importFromXML(fileName, userMessageAsStream), qPrintable(userMessage));
+   qDebug() << Q_FUNC_INFO << "Successful import:" << userMessage;
+   QVERIFY2(userMessage.contains(QString{"%1 fermentable, %2 hop records"}.arg(numRecords).arg(numHops)),
+            qPrintable(userMessage));
+
+   QSet<QString> fermentableNames;
+   for (Fermentable const * fermentable : ObjectStoreWrapper::findAllMatching<Fermentable>(
+      [](Fermentable * fermentable) { return fermentable->name().startsWith("Streamed import test"); }
+   )) {
+      fermentableNames.insert(fermentable->name());
+   }
+   QCOMPARE(fermentableNames.size(), numRecords);
+   QSet<QString> hopNames;
+   for (Hop const * hop : ObjectStoreWrapper::findAllMatching<Hop>(
+      [](Hop * hop) { return hop->name().startsWith("Streamed import test"); }
+   )) {
+      hopNames.insert(hop->name());
+   }
+   QCOMPARE(hopNames.size(), numHops);
+   for (int ii = 0; ii < numRecords; ++ii) {
+      QVERIFY(fermentableNames.contains(QString{"Streamed import test fermentable %1"}.arg(ii)));
+   }
+   for (int ii = 0; ii < numHops; ++ii) {
+      QVERIFY(hopNames.contains(QString{"Streamed import test hop %1"}.arg(ii)));
+   }
+   return;
+}
+
+void Testing::testInventoryCache() {
+   auto hop = std::make_shared<Hop>("Inventory cache test hop");
+   ObjectStoreWrapper::insert(hop);
+   QVERIFY(fuzzyComp(StockPurchaseHop::getTotalInventory(*hop).quantity, 0.0, 0.00000001));
+   QVERIFY(!StockPurchaseHop::isOnHand(*hop));
+
+   // Buying some of the hop should update the (now cached) total
+   auto hopPurchase = std::make_shared<StockPurchaseHop>("Inventory cache test purchase");
+   hopPurchase->setHop(hop.get());
+   hopPurchase->setAmount(Measurement::Amount{10.0, Measurement::Units::kilograms});
+   ObjectStoreWrapper::insert(hopPurchase);
+   QVERIFY(fuzzyComp(StockPurchaseHop::getTotalInventory(*hop).quantity, 10.0, 0.00000001));
+   QVERIFY(StockPurchaseHop::isOnHand(*hop));
+
+   // As should changing the purchase
+   hopPurchase->setAmount(Measurement::Amount{20.0, Measurement::Units::kilograms});
+   QVERIFY(fuzzyComp(StockPurchaseHop::getTotalInventory(*hop).quantity, 20.0, 0.00000001));
+
+   // And using some of it
+   auto hopUse = std::make_shared<StockUseHop>();
+   hopUse->setDate(QDate::currentDate());
+   hopUse->setReason(StockUse::Reason::Used);
+   hopUse->setQuantityUsed(5.0);
+   hopPurchase->add(hopUse);
+   QVERIFY(fuzzyComp(StockPurchaseHop::getTotalInventory(*hop).quantity, 15.0, 0.00000001));
+
+   // And changing how much was used
+   hopUse->setQuantityUsed(20.0);
+   QVERIFY(fuzzyComp(StockPurchaseHop::getTotalInventory(*hop).quantity, 0.0, 0.00000001));
+   QVERIFY(!StockPurchaseHop::isOnHand(*hop));
+
+   // An ingredient that isn't in the DB yet doesn't have any inventory, and doesn't get mixed up with other ones
+   Hop const unstoredHop{"Inventory cache test unstored hop"};
+   QVERIFY(unstoredHop.key() <= 0);
+   QVERIFY(fuzzyComp(StockPurchaseHop::getTotalInventory(unstoredHop).quantity, 0.0, 0.00000001));
+   return;
+}
+
+void Testing::testBackup() {
+   auto hop = std::make_shared<Hop>("Backup test hop");
+   ObjectStoreWrapper::insert(hop);
+   int const hopId = hop->key();
+   QVERIFY(hopId > 0);
+
+   // Whatever is already at the target gets replaced, even if it isn't a database
+   QString const backupFileName = this->pimpl->m_tempDir.filePath("backupTest.sqlite");
+   {
+      QFile existingFile{backupFileName};
+      QVERIFY(existingFile.open(QIODevice::WriteOnly));
+      existingFile.write("Not a database");
+   }
+   QVERIFY(Database::instance().backupToFile(backupFileName));
+
+   // The temporary file that the backup was written to should have been renamed, so there is nothing left behind
+   QCOMPARE(this->pimpl->m_tempDir.entryList({"backupTest.sqlite.*"}, QDir::Files).size(), 0);
+
+   // Check the backup is a proper database with our hop in it
+   QCOMPARE(readHopNameFromSqliteFile(backupFileName, hopId), hop->name());
+
+   // Our connection was only out of exclusive locking mode for the duration of the backup
+   QCOMPARE(mainConnectionLockingMode(), QString{"exclusive"});
+
+   // Backing up the database onto itself is not allowed
+   QVERIFY(!Database::instance().backupToFile(Database::instance().sqlDatabase().databaseName()));
+   return;
+}
+
+void Testing::testBackupJob() {
+   auto hop = std::make_shared<Hop>("Backup job test hop");
+   ObjectStoreWrapper::insert(hop);
+   int const hopId = hop->key();
+   QVERIFY(hopId > 0);
+
+   QString const backupFileName = this->pimpl->m_tempDir.filePath("backupJobTest.sqlite");
+   QFile::remove(backupFileName);
+
+   Database & database = Database::instance();
+   std::unique_ptr<SqliteBackupJob> backupJob{database.startBackupToFile(backupFileName)};
+   QVERIFY(backupJob);
+
+   // Only one backup at a time
+   QVERIFY(!database.startBackupToFile(this->pimpl->m_tempDir.filePath("backupJobTest2.sqlite")));
+
+   // Signals are not emitted until we get back to the event loop, so it's fine to connect to them after start()
+   QSignalSpy progressSpy{backupJob.get(), &SqliteBackupJob::progress};
+   QSignalSpy finishedSpy{backupJob.get(), &SqliteBackupJob::finished};
+   QVERIFY(finishedSpy.wait(30000));
+   QCOMPARE(finishedSpy.count(), 1);
+   QCOMPARE(finishedSpy.at(0).at(0).toBool(), true);
+
+   // By the time we hear about the backup finishing, we should have heard about all of it being copied
+   QVERIFY(progressSpy.count() >= 1);
+   QList<QVariant> const lastProgress = progressSpy.last();
+   QVERIFY(lastProgress.at(1).toLongLong() > 0);
+   QCOMPARE(lastProgress.at(0).toLongLong(), lastProgress.at(1).toLongLong());
+
+   QCOMPARE(readHopNameFromSqliteFile(backupFileName, hopId), hop->name());
+
+   // Exclusive locking is restored before the caller hears about the backup finishing
+   QCOMPARE(mainConnectionLockingMode(), QString{"exclusive"});
+
+   // Once the backup has finished, we can start another
+   backupJob.reset(database.startBackupToFile(backupFileName));
+   QVERIFY(backupJob);
+   QSignalSpy secondFinishedSpy{backupJob.get(), &SqliteBackupJob::finished};
+   QVERIFY(secondFinishedSpy.wait(30000));
+   QCOMPARE(secondFinishedSpy.at(0).at(0).toBool(), true);
+   return;
+}
+
+void Testing::testCopyToNewDb() {
+   auto hop = std::make_shared<Hop>("Copy test hop");
+   ObjectStoreWrapper::insert(hop);
+   int const hopId = hop->key();
+   QVERIFY(hopId > 0);
+   auto const & hopStore = ObjectStoreTyped<Hop>::getInstance();
+   qsizetype const numHops = static_cast<qsizetype>(hopStore.size());
+
+   QString const newDbFileName = this->pimpl->m_tempDir.filePath("copyTest.sqlite");
+   QFile::remove(newDbFileName);
+
+   auto countHops = [](QSqlDatabase & connection) {
+      QSqlQuery query{connection};
+      if (!query.exec("SELECT COUNT(*) FROM hop;") || !query.next()) {
+         return qsizetype{-1};
+      }
+      return static_cast<qsizetype>(query.value(0).toLongLong());
+   };
+
+   // Extra braces are so that the QSqlDatabase object is out of scope before the call to QSqlDatabase::removeDatabase()
+   QString const connectionName{"testCopyToNewDb"};
+   {
+      // Copying the test database to a new SQLite database (the PostgreSQL case is the same but with several writers)
+      QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+      connection.setDatabaseName(newDbFileName);
+      QVERIFY(connection.open());
+      Database & database = Database::instance();
+      QVERIFY(DatabaseSchemaHelper::create(database, connection));
+      NewDbWriteProgress progress;
+      QSignalSpy rowsWrittenSpy{&progress, &NewDbWriteProgress::rowsWritten};
+      QSignalSpy storeWrittenSpy{&progress, &NewDbWriteProgress::storeWritten};
+      QVERIFY(WriteAllObjectStoresToNewDb(database, connection, &progress));
+      QCOMPARE(countHops(connection), numHops);
+
+      // We should have heard about every store, and about every row
+      QVERIFY(storeWrittenSpy.count() > 0);
+      QCOMPARE(storeWrittenSpy.count(), storeWrittenSpy.last().at(2).toLongLong());
+      QVERIFY(std::ranges::any_of(storeWrittenSpy, [&](QList<QVariant> const & signalArgs) {
+         return signalArgs.at(0).toString() == hopStore.name();
+      }));
+      QVERIFY(rowsWrittenSpy.count() > 0);
+      QVERIFY(rowsWrittenSpy.last().at(1).toLongLong() >= numHops);
+      QCOMPARE(rowsWrittenSpy.last().at(0).toLongLong(), rowsWrittenSpy.last().at(1).toLongLong());
+      {
+         QSqlQuery query{connection};
+         QVERIFY(query.exec(QString{"SELECT name FROM hop WHERE id = %1;"}.arg(hopId)));
+         QVERIFY(query.next());
+         QCOMPARE(query.value(0).toString(), hop->name());
+      }
+
+      // This is what gets done to clean up after a failed copy
+      {
+         DbTransaction dbTransaction{database, connection, "testCopyToNewDb", DbTransaction::DISABLE_FOREIGN_KEYS};
+         QVERIFY(hopStore.deleteAllFromNewDb(connection));
+         QVERIFY(dbTransaction.commit());
+      }
+      QCOMPARE(countHops(connection), 0);
+
+      //
+      // A snapshot taken on this thread can be written out on another thread, with its own connection, which is what
+      // happens when copying to PostgreSQL.
+      //
+      ObjectStore::NewDbSnapshot const snapshot = hopStore.snapshotForNewDb();
+      QCOMPARE(snapshot.numRows, numHops);
+      connection.close();
+      bool writtenOnWorkerThread = false;
+      std::thread worker{[&]() {
+         QString const workerConnectionName{"testCopyToNewDb-writer"};
+         {
+            QSqlDatabase workerConnection = QSqlDatabase::addDatabase("QSQLITE", workerConnectionName);
+            workerConnection.setDatabaseName(newDbFileName);
+            if (workerConnection.open()) {
+               DbTransaction dbTransaction{database,
+                                           workerConnection,
+                                           "testCopyToNewDb-writer",
+                                           DbTransaction::DISABLE_FOREIGN_KEYS};
+               writtenOnWorkerThread = hopStore.writeSnapshotToNewDb(snapshot, database, workerConnection) &&
+                                       dbTransaction.commit();
+            }
+            workerConnection.close();
+         }
+         QSqlDatabase::removeDatabase(workerConnectionName);
+         return;
+      }};
+      worker.join();
+      QVERIFY(writtenOnWorkerThread);
+
+      QVERIFY(connection.open());
+      QCOMPARE(countHops(connection), numHops);
+      connection.close();
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   return;
+}
+
+void Testing::testCopyToNewPgDb() {
+   //
+   // We need a PostgreSQL server for this, so the test is skipped unless one has been configured.  The database it
+   // uses is emptied at the start of the test, so it needs to be one set aside for the purpose.  The user also needs
+   // permission to set session_replication_role, as that's how we turn off foreign key checks on PostgreSQL.
+   //
+   QString const hostName = qEnvironmentVariable("BREWKEN_TEST_PGSQL_HOST");
+   if (hostName.isEmpty()) {
+      QSKIP("No PostgreSQL server configured.  Set BREWKEN_TEST_PGSQL_HOST (and, optionally, BREWKEN_TEST_PGSQL_PORT, "
+            "BREWKEN_TEST_PGSQL_DBNAME, BREWKEN_TEST_PGSQL_USER and BREWKEN_TEST_PGSQL_PASSWORD) to run this test.");
+   }
+
+   auto hop = std::make_shared<Hop>("PostgreSQL copy test hop");
+   ObjectStoreWrapper::insert(hop);
+   int const hopId = hop->key();
+   QVERIFY(hopId > 0);
+   auto const & hopStore = ObjectStoreTyped<Hop>::getInstance();
+
+   // Returns -1 if the query fails
+   auto queryForNumber = [](QSqlDatabase & connection, QString const & queryString) {
+      QSqlQuery query{connection};
+      if (!query.exec(queryString) || !query.next()) {
+         qWarning() << Q_FUNC_INFO << "Error executing" << queryString << ":" << query.lastError().text();
+         return qint64{-1};
+      }
+      return query.value(0).toLongLong();
+   };
+
+   //
+   // Extra braces are so that the QSqlDatabase object is out of scope before the call to
+   // QSqlDatabase::removeDatabase().  (The worker threads in WriteAllObjectStoresToNewDb make their connections by
+   // cloning this one, so it needs a name.)
+   //
+   QString const connectionName{"testCopyToNewPgDb"};
+   {
+      QSqlDatabase connection = QSqlDatabase::addDatabase("QPSQL", connectionName);
+      connection.setHostName(hostName);
+      connection.setPort(qEnvironmentVariable("BREWKEN_TEST_PGSQL_PORT", "5432").toInt());
+      connection.setDatabaseName(qEnvironmentVariable("BREWKEN_TEST_PGSQL_DBNAME", "brewken_test"));
+      connection.setUserName(qEnvironmentVariable("BREWKEN_TEST_PGSQL_USER"));
+      connection.setPassword(qEnvironmentVariable("BREWKEN_TEST_PGSQL_PASSWORD"));
+      QVERIFY2(connection.open(), qPrintable(connection.lastError().text()));
+      {
+         QSqlQuery query{connection};
+         QVERIFY2(query.exec("DROP SCHEMA public CASCADE;"), qPrintable(query.lastError().text()));
+         QVERIFY2(query.exec("CREATE SCHEMA public;"), qPrintable(query.lastError().text()));
+      }
+
+      //
+      // Copying to PostgreSQL writes the tables in parallel, each worker thread with its own connection
+      //
+      Database & database = Database::instance(Database::DbType::PGSQL);
+      NewDbWriteProgress progress;
+      QSignalSpy rowsWrittenSpy{&progress, &NewDbWriteProgress::rowsWritten};
+      QSignalSpy storeWrittenSpy{&progress, &NewDbWriteProgress::storeWritten};
+      QVERIFY(DatabaseSchemaHelper::copyToNewDatabase(database, connection, &progress));
+      QCOMPARE(queryForNumber(connection, "SELECT COUNT(*) FROM hop;"), static_cast<qint64>(hopStore.size()));
+      QCOMPARE(queryForNumber(connection, QString{"SELECT COUNT(*) FROM hop WHERE id = %1;"}.arg(hopId)), qint64{1});
+
+      // Signals from the worker threads should all have been delivered by the time the copy returns
+      QVERIFY(storeWrittenSpy.count() > 0);
+      QCOMPARE(storeWrittenSpy.count(), storeWrittenSpy.last().at(2).toLongLong());
+      QVERIFY(rowsWrittenSpy.count() > 0);
+      QCOMPARE(rowsWrittenSpy.last().at(0).toLongLong(), rowsWrittenSpy.last().at(1).toLongLong());
+
+      //
+      // The worker connections should have updated the sequences for the primary keys, so the next automatically
+      // generated ID on each table is after all the ones we copied.
+      //
+      for (char const * const tableName : {"hop", "fermentable", "recipe"}) {
+         qint64 const maxId = queryForNumber(connection,
+                                             QString{"SELECT COALESCE(MAX(id), 0) FROM %1;"}.arg(tableName));
+         QVERIFY(maxId >= 0);
+         qint64 const nextId = queryForNumber(
+            connection, QString{"SELECT nextval(pg_get_serial_sequence('%1', 'id'));"}.arg(tableName)
+         );
+         QVERIFY2(nextId > maxId, tableName);
+      }
+
+      //
+      // Now make the parallel copy fail part way through.  We empty the tables and then write just the hops, so that,
+      // when we copy everything again, writing the hop table fails (on duplicate primary keys) but other tables get
+      // written and committed.  Afterwards, those should have been emptied again.
+      //
+      QStringList tableNames;
+      {
+         QSqlQuery query{connection};
+         QVERIFY(query.exec(
+            "SELECT tablename FROM pg_tables WHERE schemaname = 'public' AND tablename <> 'settings';"
+         ));
+         while (query.next()) {
+            tableNames.append(query.value(0).toString());
+         }
+      }
+      QVERIFY(tableNames.contains("hop"));
+      {
+         QSqlQuery query{connection};
+         QVERIFY2(query.exec(QString{"TRUNCATE %1;"}.arg(tableNames.join(", "))), qPrintable(query.lastError().text()));
+      }
+      {
+         DbTransaction dbTransaction{database, connection, "testCopyToNewPgDb", DbTransaction::DISABLE_FOREIGN_KEYS};
+         QVERIFY(hopStore.writeSnapshotToNewDb(hopStore.snapshotForNewDb(), database, connection));
+         QVERIFY(dbTransaction.commit());
+      }
+      QVERIFY(!WriteAllObjectStoresToNewDb(database, connection));
+      for (QString const & tableName : tableNames) {
+         QVERIFY2(queryForNumber(connection, QString{"SELECT COUNT(*) FROM %1;"}.arg(tableName)) == 0,
+                  qPrintable(tableName));
+      }
+
+      connection.close();
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   return;
+}
+
+void Testing::testAsyncLogging() {
+   Logging::Level const savedLogLevel = Logging::getLogLevel();
+   Logging::setLogLevel(Logging::LogLevel_INFO);
+   Logging::setLoggingToStderr(false);
+
+   // Reads everything in the log files, oldest first
+   auto readLogs = []() {
+      QString contents;
+      for (auto const & fileInfo : Logging::getLogFileList()) {
+         QFile file{fileInfo.canonicalFilePath()};
+         if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            contents += QString::fromUtf8(file.readAll());
+         }
+      }
+      return contents;
+   };
+
+   //
+   // Enough threads and messages that the ring buffer fills up and producers have to wait for the writer thread.  The
+   // marker makes sure we are not looking at the output of some previous run.
+   //
+   QString const marker = QUuid::createUuid().toString(QUuid::WithoutBraces);
+   int constexpr numThreads = 4;
+   int constexpr numMessagesPerThread = 3000;
+   std::vector<std::thread> threads;
+   for (int threadNum = 0; threadNum < numThreads; ++threadNum) {
+      threads.emplace_back([&marker, threadNum]() {
+         for (int messageNum = 0; messageNum < numMessagesPerThread; ++messageNum) {
+            qInfo().noquote() << QString{"%1 thread %2 message %3 end"}.arg(marker).arg(threadNum).arg(messageNum);
+         }
+         return;
+      });
+   }
+   for (auto & thread : threads) {
+      thread.join();
+   }
+   Logging::flush();
+
+   QString const logs = readLogs();
+   for (int threadNum = 0; threadNum < numThreads; ++threadNum) {
+      qsizetype previousPosition = -1;
+      for (int messageNum = 0; messageNum < numMessagesPerThread; ++messageNum) {
+         qsizetype const position =
+            logs.indexOf(QString{"%1 thread %2 message %3 end"}.arg(marker).arg(threadNum).arg(messageNum));
+         QVERIFY2(position >= 0, "Message missing from log");
+         QVERIFY2(position > previousPosition, "Messages from one thread written out of order");
+         previousPosition = position;
+      }
+   }
+
+   // Errors are written before qCritical() returns, without needing to call Logging::flush()
+   QString const errorMessage = QString{"%1 error"}.arg(marker);
+   qCritical().noquote() << errorMessage;
+   QVERIFY(readLogs().contains(errorMessage));
+
+   Logging::setLoggingToStderr(true);
+   Logging::setLogLevel(savedLogLevel);
+   return;
+}
+
+void Testing::testSplitAmountString() {
+   //
+   // This is the regular expression that Measurement::Unit::splitAmountString used before we replaced it with a
+   // hand-written scan.  The two should give the same results.  (NB: \d and \s in QRegularExpression only match ASCII
+   // digits and whitespace, so the inputs below stick to those.)
+   //
+   QLocale const & locale = Localization::getLocale();
+   QRegularExpression const amtUnit {
+      "((?:\\d+" + QRegularExpression::escape(locale.groupSeparator()) + ")?\\d+(?:" +
+      QRegularExpression::escape(locale.decimalPoint()) + "\\d+)?|" +
+      QRegularExpression::escape(locale.decimalPoint()) + "\\d+)\\s*([^\\s]+)?",
+      QRegularExpression::CaseInsensitiveOption
+   };
+   QVERIFY(amtUnit.isValid());
+   auto regexSplitAmountString = [&amtUnit](QString const & inputString, bool * ok) {
+      *ok = false;
+      QRegularExpressionMatch match = amtUnit.match(inputString);
+      if (!match.hasMatch()) {
+         return std::pair<double, QString>{0.0, ""};
+      }
+      double const quantity = Localization::toDouble(match.captured(1), Q_FUNC_INFO, ok);
+      return std::pair<double, QString>{quantity, match.captured(2)};
+   };
+
+   // In each input, "{d}" is replaced by the locale's decimal point and "{g}" by its grouping separator
+   QStringList const inputs{
+      "",
+      "   ",
+      "kg",
+      "5",
+      "5 kg",
+      "5kg",
+      "  5   kg  ",
+      "5\tkg",
+      "5\n kg",
+      "5 kg extra words",
+      "007 pt",
+      "{d}5 L",
+      "  {d}75  ",
+      "{d}{d}5",
+      "5{d}25 L/kg",
+      "5{d} gal",
+      "5{d}{d}25 gal",
+      "1{d}2{d}3 c/g·C",
+      "1{g}000 g",
+      "1{g}000{d}5 g",
+      "12{g}345{g}678 mL",
+      "1{g}{d}5 x",
+      "1{g}a",
+      "{g}5 kg",
+      "2{d}5{g}3 kg",
+      "1 000 kg",
+      "-5 kg",
+      "+7 oz",
+      "1e3 g",
+      "0x1F lb",
+      "x{d}5y",
+      "100%",
+      "3 1/2 cups",
+      "°P 12{d}5",
+      "12{d}5 °P",
+      "abc 3 qt",
+      "99999999999999999999 g",
+   };
+   for (auto const & input : inputs) {
+      QString inputString{input};
+      inputString.replace("{d}", locale.decimalPoint()).replace("{g}", locale.groupSeparator());
+
+      bool regexOk = false;
+      auto const expected = regexSplitAmountString(inputString, &regexOk);
+      bool ok = false;
+      auto const actual = Measurement::Unit::splitAmountString(inputString, &ok);
+      qDebug() <<
+         Q_FUNC_INFO << inputString << ": expected" << expected.first << expected.second << regexOk << ", got" <<
+         actual.first << actual.second << ok;
+      QCOMPARE(actual.first, expected.first);
+      QCOMPARE(actual.second, expected.second);
+      QCOMPARE(ok, regexOk);
+   }
+   return;
+}
+
+void Testing::testNormaliseName() {
+   for (QString const name : {"Foo", "Foo (1)", "Foo (3)"}) {
+      ObjectStoreWrapper::insert(std::make_shared<Hop>(name));
+   }
+
+   // A clash with any of the names gets one more than the highest number in use, without filling in the gap
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo"    ), QString{"Foo (4)"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo (1)"), QString{"Foo (4)"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo (3)"), QString{"Foo (4)"});
+   // Names are simplified before we look for clashes
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("  Foo\t(1) "), QString{"Foo (4)"});
+   // Names not in use are left alone, even if they have the same base name as ones that are
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo (2)"), QString{"Foo (2)"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo (5)"), QString{"Foo (5)"});
+
+   // As before we had the name index, names that differ only in case do not clash
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("foo"), QString{"foo"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("FOO (3)"), QString{"FOO (3)"});
+   ObjectStoreWrapper::insert(std::make_shared<Hop>("foo"));
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("foo"), QString{"foo (1)"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo"), QString{"Foo (4)"});
+
+   // Other types of object have their own names
+   QCOMPARE(ObjectStoreUtils::normaliseName<Fermentable>("Foo"), QString{"Foo"});
+
+   // Renaming an object updates the index
+   auto foo3 = ObjectStoreWrapper::findFirstMatching<Hop>([](Hop * hop) { return hop->name() == "Foo (3)"; });
+   QVERIFY(foo3);
+   foo3->setName("Bar");
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo"    ), QString{"Foo (2)"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Foo (3)"), QString{"Foo (3)"});
+   QCOMPARE(ObjectStoreUtils::normaliseName<Hop>("Bar"    ), QString{"Bar (1)"});
+   return;
+}
+
+void Testing::testDuplicateDetection() {
+   //
+   // The match key is the name without any " (n)" suffix, so the only possible matches for an object are the ones with
+   // the same stripped name.
+   //
+   auto storedHop = std::make_shared<Hop>("Duplicate detection test hop (2)");
+   ObjectStoreWrapper::insert(storedHop);
+   auto isStoredHop = [&storedHop](std::shared_ptr<Hop> const & hop) { return hop->key() == storedHop->key(); };
+   QVERIFY(std::ranges::any_of(ObjectStoreWrapper::findPossibleMatches(Hop{"Duplicate detection test hop"}),
+                               isStoredHop));
+   QVERIFY(std::ranges::any_of(ObjectStoreWrapper::findPossibleMatches(Hop{"Duplicate detection test hop (7)"}),
+                               isStoredHop));
+   QVERIFY(std::ranges::none_of(ObjectStoreWrapper::findPossibleMatches(Hop{"Duplicate detection test hops"}),
+                                isStoredHop));
+
+   // Renaming the stored object updates the index
+   storedHop->setName("Renamed duplicate detection test hop");
+   QVERIFY(std::ranges::none_of(ObjectStoreWrapper::findPossibleMatches(Hop{"Duplicate detection test hop"}),
+                                isStoredHop));
+   QVERIFY(std::ranges::any_of(ObjectStoreWrapper::findPossibleMatches(Hop{"Renamed duplicate detection test hop"}),
+                               isStoredHop));
+
+   //
+   // Now check what the user sees.  Importing the same file twice should only store its records the first time.  If
+   // one of the records has changed in the meantime, only that one should be stored the next time.
+   //
+   QString const fileName = this->pimpl->m_tempDir.filePath("duplicateDetectionTest.xml");
+   int const numHops = 3;
+   auto writeHopsFile = [&](double const alphaOfFirstHop) {
+      QFile file{fileName};
+      if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         return false;
+      }
+      QTextStream out{&file};
+      out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" << "<HOPS>\n";
+      for (int ii = 0; ii < numHops; ++ii) {
+         out <<
+            "  <HOP>\n"
+            "    <NAME>Duplicate detection test import hop " << ii << "</NAME>\n"
+            "    <VERSION>1</VERSION>\n"
+            "    <ALPHA>" << (0 == ii ? alphaOfFirstHop : 5.0) << "</ALPHA>\n"
+            "    <AMOUNT>0.1</AMOUNT>\n"
+            "    <USE>Boil</USE>\n"
+            "    <TIME>60</TIME>\n"
+            "  </HOP>\n";
+      }
+      out << "</HOPS>\n";
+      return true;
+   };
+   auto importHopsFile = [&fileName]() {
+      QString userMessage;
+      QTextStream userMessageAsStream{&userMessage};
+      bool const succeeded = BeerXML::getInstance().importFromXML(fileName, userMessageAsStream);
+      qDebug() << Q_FUNC_INFO << "Import result" << succeeded << ":" << userMessage;
+      return succeeded ? userMessage : QString{};
+   };
+   auto numImportedHops = []() {
+      return ObjectStoreWrapper::findAllMatching<Hop>(
+         [](Hop * hop) { return hop->name().startsWith("Duplicate detection test import hop"); }
+      ).size();
+   };
+
+   QVERIFY(writeHopsFile(5.0));
+   QString userMessage = importHopsFile();
+   QVERIFY2(userMessage.contains(QString{"Read %1 hop records"}.arg(numHops)), qPrintable(userMessage));
+   QCOMPARE(numImportedHops(), numHops);
+
+   userMessage = importHopsFile();
+   QVERIFY2(!userMessage.contains("Read"), qPrintable(userMessage));
+   QVERIFY2(userMessage.contains(QString{"Skipped %1 hop records already in database"}.arg(numHops)),
+            qPrintable(userMessage));
+   QCOMPARE(numImportedHops(), numHops);
+
+   QVERIFY(writeHopsFile(12.5));
+   userMessage = importHopsFile();
+   QVERIFY2(userMessage.contains("Read 1 hop record"), qPrintable(userMessage));
+   QVERIFY2(userMessage.contains(QString{"Skipped %1 hop records already in database"}.arg(numHops - 1)),
+            qPrintable(userMessage));
+   QCOMPARE(numImportedHops(), numHops + 1);
+   // The new hop has the same name as an existing one, so gets a number added to it
+   QVERIFY(ObjectStoreWrapper::findFirstMatching<Hop>(
+      [](Hop * hop) { return hop->name() == "Duplicate detection test import hop 0 (1)"; }
+   ));
+   return;
+}
+
+void Testing::testInsertAll() {
+   auto mash = std::make_shared<Mash>("Bulk insert test mash");
+   ObjectStoreWrapper::insert(mash);
+   QVERIFY(mash->key() > 0);
+
+   ObjectStoreTyped<MashStep> & store = ObjectStoreTyped<MashStep>::getInstance();
+   QSignalSpy insertedSpy{&store, &ObjectStore::signalObjectInserted};
+   int const initialSize = static_cast<int>(store.size());
+
+   auto makeSteps = [&mash](QString const & namePrefix) {
+      QList<std::shared_ptr<MashStep>> steps;
+      for (int ii = 1; ii <= 3; ++ii) {
+         auto step = std::make_shared<MashStep>(QString{"%1 %2"}.arg(namePrefix).arg(ii));
+         step->setOwnerId(mash->key());
+         step->setSequenceNumber(ii);
+         steps.append(step);
+      }
+      return steps;
+   };
+   auto countRowsNamed = [](QString const & namePrefix) {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      QSqlQuery query{connection};
+      query.prepare("SELECT COUNT(*) FROM mash_step WHERE name LIKE :namePattern;");
+      query.bindValue(":namePattern", namePrefix + "%");
+      return (query.exec() && query.next()) ? query.value(0).toInt() : -1;
+   };
+
+   //
+   // A successful insert gives each object its ID, in order, and puts it in the cache and all the indexes
+   //
+   QList<std::shared_ptr<MashStep>> const steps = makeSteps("Bulk insert test step");
+   int const numSteps = static_cast<int>(steps.size());
+   QList<int> const ids = ObjectStoreWrapper::insertAll(steps);
+   QCOMPARE(ids.size(), steps.size());
+   for (int ii = 0; ii < numSteps; ++ii) {
+      QVERIFY(ids[ii] > 0);
+      QCOMPARE(steps[ii]->key(), ids[ii]);
+      QVERIFY(ObjectStoreWrapper::getById<MashStep>(ids[ii]) == steps[ii]);
+      QVERIFY(store.containsName(steps[ii]->name()));
+      QVERIFY(ObjectStoreWrapper::findPossibleMatches(*steps[ii]).contains(steps[ii]));
+      QCOMPARE(insertedSpy.at(ii).at(0).toInt(), ids[ii]);
+   }
+   QCOMPARE(QSet<int>(ids.cbegin(), ids.cend()).size(), ids.size());
+   QCOMPARE(insertedSpy.count(), numSteps);
+   QCOMPARE(static_cast<int>(store.size()), initialSize + numSteps);
+   QCOMPARE(ObjectStoreWrapper::idsOwnedBy<MashStep>(mash->key()), QVector<int>(ids.cbegin(), ids.cend()));
+   QCOMPARE(countRowsNamed("Bulk insert test step"), numSteps);
+
+   //
+   // If one of the inserts fails (here because the second object refers to a mash that does not exist) then none of the
+   // objects get stored, either in the DB or in the cache.
+   //
+   insertedSpy.clear();
+   QList<std::shared_ptr<MashStep>> const badSteps = makeSteps("Bulk insert failure test step");
+   badSteps[1]->setOwnerId(std::numeric_limits<int>::max());
+   QVERIFY(ObjectStoreWrapper::insertAll(badSteps).isEmpty());
+   for (auto const & step : badSteps) {
+      QVERIFY(step->key() <= 0);
+      QVERIFY(!store.containsName(step->name()));
+   }
+   QCOMPARE(insertedSpy.count(), 0);
+   QCOMPARE(static_cast<int>(store.size()), initialSize + numSteps);
+   QCOMPARE(ObjectStoreWrapper::idsOwnedBy<MashStep>(mash->key()), QVector<int>(ids.cbegin(), ids.cend()));
+   QCOMPARE(countRowsNamed("Bulk insert failure test step"), 0);
+   return;
+}
+
+void Testing::testRecipeVersionSharing() {
+   auto makeHopAddition = [this](QString const & name, double const quantity) {
+      auto hopAddition = std::make_shared<RecipeAdditionHop>(name);
+      hopAddition->setHop(this->pimpl->m_cascade_4pct.get());
+      hopAddition->setStage(RecipeAddition::Stage::Boil);
+      hopAddition->setAddAtTime_mins(60);
+      hopAddition->setQuantity(quantity);
+      hopAddition->setMeasure(Measurement::PhysicalQuantity::Mass);
+      return hopAddition;
+   };
+   auto quantitiesOf = [](Recipe const & recipe) {
+      QList<double> quantities;
+      for (auto const & hopAddition : recipe.hopAdditions()) {
+         quantities.append(hopAddition->quantity());
+      }
+      std::sort(quantities.begin(), quantities.end());
+      return quantities;
+   };
+   ObjectStoreTyped<RecipeAdditionHop> & store = ObjectStoreTyped<RecipeAdditionHop>::getInstance();
+
+   auto recipe = std::make_shared<Recipe>(QString{"Version sharing test recipe"});
+   ObjectStoreWrapper::insert(recipe);
+   auto firstAddition  = recipe->addAddition(makeHopAddition("Version sharing test hop addition 1", 0.01));
+   auto secondAddition = recipe->addAddition(makeHopAddition("Version sharing test hop addition 2", 0.02));
+   QCOMPARE(quantitiesOf(*recipe), (QList<double>{0.01, 0.02}));
+
+   //
+   // Making a prior version copies the Recipe but none of its additions, which the prior version sees through the
+   // Recipe instead
+   //
+   size_t const initialSize = store.size();
+   auto priorVersion = recipe->makePriorVersion();
+   QVERIFY(priorVersion->key() > 0);
+   QCOMPARE(recipe->getAncestorId(), priorVersion->key());
+   QCOMPARE(recipe->versionNumber(), priorVersion->versionNumber() + 1);
+   QVERIFY(priorVersion->locked());
+   QVERIFY(priorVersion->descendants() == QList<std::shared_ptr<Recipe>>{recipe});
+   QCOMPARE(store.size(), initialSize);
+   QVERIFY(ObjectStoreWrapper::idsOwnedBy<RecipeAdditionHop>(priorVersion->key()).isEmpty());
+   QCOMPARE(quantitiesOf(*priorVersion), (QList<double>{0.01, 0.02}));
+   QVERIFY(priorVersion->uses(*this->pimpl->m_cascade_4pct));
+
+   //
+   // Changing an addition gives the prior version its own copy of just that addition, as it was before the change
+   //
+   firstAddition->setQuantity(0.05);
+   QCOMPARE(store.size(), initialSize + 1);
+   QCOMPARE(ObjectStoreWrapper::idsOwnedBy<RecipeAdditionHop>(priorVersion->key()).size(), 1);
+   QCOMPARE(quantitiesOf(*recipe      ), (QList<double>{0.02, 0.05}));
+   QCOMPARE(quantitiesOf(*priorVersion), (QList<double>{0.01, 0.02}));
+
+   // Changing it again doesn't need another copy
+   firstAddition->setQuantity(0.06);
+   QCOMPARE(store.size(), initialSize + 1);
+   QCOMPARE(quantitiesOf(*priorVersion), (QList<double>{0.01, 0.02}));
+
+   // Additions made after the prior version are not in it
+   recipe->addAddition(makeHopAddition("Version sharing test hop addition 3", 0.03));
+   QCOMPARE(quantitiesOf(*recipe      ), (QList<double>{0.02, 0.03, 0.06}));
+   QCOMPARE(quantitiesOf(*priorVersion), (QList<double>{0.01, 0.02}));
+
+   // Removing a shared addition leaves the prior version with a copy of it
+   recipe->removeAddition(secondAddition);
+   QCOMPARE(ObjectStoreWrapper::idsOwnedBy<RecipeAdditionHop>(priorVersion->key()).size(), 2);
+   QCOMPARE(quantitiesOf(*recipe      ), (QList<double>{0.03, 0.06}));
+   QCOMPARE(quantitiesOf(*priorVersion), (QList<double>{0.01, 0.02}));
+
+   //
+   // A second prior version sees the additions it shares with the Recipe, and the first prior version still sees
+   // only what it did before
+   //
+   auto secondPriorVersion = recipe->makePriorVersion();
+   QCOMPARE(secondPriorVersion->getAncestorId(), priorVersion->key());
+   QVERIFY(priorVersion->descendants() == (QList<std::shared_ptr<Recipe>>{secondPriorVersion, recipe}));
+   QVERIFY(ObjectStoreWrapper::idsOwnedBy<RecipeAdditionHop>(secondPriorVersion->key()).isEmpty());
+   QCOMPARE(quantitiesOf(*secondPriorVersion), (QList<double>{0.03, 0.06}));
+   QCOMPARE(quantitiesOf(*priorVersion      ), (QList<double>{0.01, 0.02}));
+
+   //
+   // Reverting to the previous version rebuilds it with its own copies of everything it shared, so it no longer needs
+   // the Recipe
+   //
+   QVERIFY(recipe->revertToPreviousVersion() == secondPriorVersion.get());
+   QCOMPARE(ObjectStoreWrapper::idsOwnedBy<RecipeAdditionHop>(secondPriorVersion->key()).size(), 2);
+   QVERIFY(secondPriorVersion->descendants().isEmpty());
+   QCOMPARE(quantitiesOf(*secondPriorVersion), (QList<double>{0.03, 0.06}));
+   QCOMPARE(quantitiesOf(*priorVersion      ), (QList<double>{0.01, 0.02}));
+   QVERIFY(!secondPriorVersion->locked());
+   return;
+}
@@ -102,6 +102,57 @@ private slots:
    //! \brief Verify Log rotation is working
    void testLogRotation();
 
+   //! \brief Verify that property changes held by write-behind are not lost when the DB is unloaded
+   void testWriteBehind();
+
+   //! \brief Verify that \c NamedEntityBatchEdit nests and copes with exceptions
+   void testBatchEdit();
+
+   //! \brief Verify which derived values of a \c Recipe get recalculated when its inputs change
+   void testRecipeCalcGraph();
+
+   //! \brief Verify that prefetching object stores on worker threads loads the same objects as a serial load
+   void testParallelLoad();
+
+   //! \brief Verify that objects in lazily-loaded object stores are only created when first needed
+   void testLazyHydration();
+
+   //! \brief Check very large XML files (imported in batches) are stored in full, or report errors at the right lines
+   void testStreamedImport();
+
+   //! \brief Check cached inventory totals are updated when purchases and uses of an ingredient change
+   void testInventoryCache();
+
+   //! \brief Check database backups are complete copies and replace whatever was at the target
+   void testBackup();
+
+   //! \brief Test writing all data to a new database, including from a worker thread
+   void testCopyToNewDb();
+
+   //! \brief Test that messages logged from several threads all get written, in order, and errors straight away
+   void testAsyncLogging();
+
+   //! \brief Test the hand-written amount parser against the regular expression it replaced
+   void testSplitAmountString();
+
+   //! \brief Check name clashes are resolved with the next unused number
+   void testNormaliseName();
+
+   //! \brief Check importing records already in the DB finds them as duplicates, via the match-key index
+   void testDuplicateDetection();
+
+   //! \brief Check inserting lots of objects at once sets IDs and indexes, or does nothing if any insert fails
+   void testInsertAll();
+
+   //! \brief Check backups made on a worker thread report progress and restore exclusive locking
+   void testBackupJob();
+
+   //! \brief Test copying all data to a new PostgreSQL database (skipped if no server is configured)
+   void testCopyToNewPgDb();
+
+   //! \brief Test that prior versions of a recipe share unchanged additions with later versions
+   void testRecipeVersionSharing();
+
 };
 
 #endif
@@ -21,7 +21,9 @@ PropertyPath::PropertyPath(BtStringConst const & singleProperty) :
    m_properties   {1, &singleProperty},
    m_path         {*singleProperty},
    m_indexOfName  {0},
-   m_localisedName{nullptr} {
+   m_localisedName{nullptr},
+   m_resolvedSteps{} {
+   m_resolvedSteps.resize(1);
    return;
 }
 
@@ -30,7 +32,8 @@ PropertyPath::PropertyPath(std::initializer_list<std::reference_wrapper<BtString
    m_properties{},
    m_path{},
    m_indexOfName  {indexOfName},
-   m_localisedName{nullptr} {
+   m_localisedName{nullptr},
+   m_resolvedSteps{} {
    bool first = true;
    for (auto const & ii : listOfProperties) {
       m_properties.append(&ii.get());
@@ -40,6 +43,7 @@ PropertyPath::PropertyPath(std::initializer_list<std::reference_wrapper<BtString
       first = false;
       m_path.append(*ii.get());
    }
+   m_resolvedSteps.resize(m_properties.size());
 
    // Obviously a coding error if name index is out of range
    Q_ASSERT(m_indexOfName >= 0);
@@ -51,7 +55,8 @@ PropertyPath::PropertyPath(PropertyPath const & other) :
    m_properties   {other.m_properties   },
    m_path         {other.m_path         },
    m_indexOfName  {other.m_indexOfName  },
-   m_localisedName{other.m_localisedName} {
+   m_localisedName{other.m_localisedName},
+   m_resolvedSteps{other.m_resolvedSteps} {
    return;
 }
 
@@ -61,6 +66,7 @@ PropertyPath & PropertyPath::operator=(PropertyPath const & other) {
       this->m_path          = other.m_path         ;
       this->m_indexOfName   = other.m_indexOfName  ;
       this->m_localisedName = other.m_localisedName;
+      this->m_resolvedSteps = other.m_resolvedSteps;
    }
    return *this;
 }
@@ -151,28 +157,42 @@ TypeInfo const & PropertyPath::getTypeInfo(TypeLookup const & baseTypeLookup) co
    return false;
 }
 
+PropertyPath::ResolvedStep const & PropertyPath::resolveStep(int const stepIndex, NamedEntity const & ne) const {
+   ResolvedStep & step = this->m_resolvedSteps[stepIndex];
+   QMetaObject const * neMetaObject = ne.metaObject();
+   if (step.metaObject != neMetaObject) {
+      BtStringConst const & property = *this->m_properties[stepIndex];
+      // Uncomment the next line if the assert below is firing
+//      qDebug() <<
+//         Q_FUNC_INFO << "Resolving" << *property << "(step" << stepIndex << "of" << this->m_path << ") on" <<
+//         neMetaObject->className();
+
+      // It's a coding error if we're trying to get a non-existent property on the NamedEntity subclass
+      int const propertyIndex = neMetaObject->indexOfProperty(*property);
+      Q_ASSERT(propertyIndex >= 0);
+      step.metaObject   = neMetaObject;
+      step.metaProperty = neMetaObject->property(propertyIndex);
+      step.typeInfo     = (stepIndex < this->m_properties.size() - 1) ? &ne.getTypeLookup().getType(property) : nullptr;
+   }
+   return step;
+}
+
 QVariant PropertyPath::getValue(NamedEntity const & obj) const {
    QVariant retVal{};
    NamedEntity const * ne = &obj;
-   for (auto const property : this->m_properties) {
+   int const lastStepIndex = this->m_properties.size() - 1;
+   for (int stepIndex = 0; stepIndex <= lastStepIndex; ++stepIndex) {
+      BtStringConst const * property = this->m_properties[stepIndex];
       // Normally keep the next line commented out otherwise it generates too many lines in the log file
 //      qDebug() << Q_FUNC_INFO << "Looking at" << *property;
 
-      if (property == this->m_properties.last()) {
+      ResolvedStep const & step = this->resolveStep(stepIndex, *ne);
+
+      if (stepIndex == lastStepIndex) {
          //
          // We've chained through the properties and found the end one that we want the actual value of
          //
-         QMetaObject const * neMetaObject = ne->metaObject();
-         // Uncomment the next line if the assert below is firing
-//         qDebug() <<
-//            Q_FUNC_INFO << "Request to get" << this->m_path << "on" << obj.metaObject()->className() << "(=" <<
-//            *property << "on" << ne->metaObject()->className() << ")";
-
-         // It's a coding error if we're trying to get a non-existent property on the NamedEntity subclass for this
-         // record.
-         int propertyIndex = neMetaObject->indexOfProperty(**property);
-         Q_ASSERT(propertyIndex >= 0);
-         QMetaProperty neMetaProperty = neMetaObject->property(propertyIndex);
+         QMetaProperty const & neMetaProperty = step.metaProperty;
 
          // Normally keep this log statement commented out otherwise it generates too many lines in the log file
 //         qDebug() <<
@@ -181,7 +201,7 @@ QVariant PropertyPath::getValue(NamedEntity const & obj) const {
 //            "; readable =" << neMetaProperty.isReadable();
 
          if (neMetaProperty.isReadable()) {
-            retVal = ne->property(**property);
+            retVal = neMetaProperty.read(ne);
             if (!retVal.isValid()) {
                auto mo = ne->metaObject();
                qWarning() <<
@@ -205,8 +225,8 @@ QVariant PropertyPath::getValue(NamedEntity const & obj) const {
       // complicated and we need some help from TypeInfo to obtain a `NamedEntity *`.  Either way, we need to get the
       // TypeInfo object first to find out what sort of pointer we're dealing with.
       //
-      QVariant containedNe = ne->property(**property);
-      TypeInfo const & typeInfo = ne->getTypeLookup().getType(*property);
+      QVariant containedNe = step.metaProperty.read(ne);
+      TypeInfo const & typeInfo = *step.typeInfo;
       switch (typeInfo.pointerType) {
          case TypeInfo::PointerType::RawPointer:
             // In this case, what we are expecting inside the containedNe QVariant is `NamedEntity *`.  It's OK for
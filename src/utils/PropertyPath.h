@@ -20,6 +20,7 @@
 #include <functional>
 #include <initializer_list>
 
+#include <QMetaProperty>
 #include <QString>
 #include <QVector>
 
@@ -118,6 +119,10 @@ public:
 
    /**
     * \brief Counterpart to \c setValue
+    *
+    *        This gets called a \b lot -- eg for every cell painted in a table or tree view, and for every comparison
+    *        when sorting one -- so we remember what we looked up for each step of the path (see \c resolveStep) rather
+    *        than looking up property names every time.
     */
    QVariant getValue(NamedEntity const & obj) const;
 
@@ -151,6 +156,30 @@ private:
     */
    mutable QString (*m_localisedName) () = nullptr;
 
+   /**
+    * \brief What we need to read one step of the path on an object of a particular class.  We only have to look this
+    *        up again if the path is used on an object of a different class (which, in practice, is rare, as a path is
+    *        typically used for one column in one table etc).
+    */
+   struct ResolvedStep {
+      QMetaObject const * metaObject = nullptr;
+      QMetaProperty metaProperty{};
+      //! Only set for steps other than the last one, as we only need it to get to the next object in the path
+      TypeInfo const * typeInfo = nullptr;
+   };
+
+   /**
+    * \brief One entry per element of \c m_properties.  Populated lazily by \c resolveStep.
+    *
+    *        Note that, like the objects it is used on, this is not thread-safe.
+    */
+   mutable QVector<ResolvedStep> m_resolvedSteps;
+
+   /**
+    * \brief Returns the \c ResolvedStep for step \c stepIndex of the path on \c ne, looking it up if necessary.
+    */
+   ResolvedStep const & resolveStep(int const stepIndex, NamedEntity const & ne) const;
+
 };
 
 /**
@@ -705,11 +705,11 @@ public:
             //
             int const lastItemKey = lastItem->key();
             if constexpr (std::is_base_of_v<Ingredient, NE>) {
+               // Recipe additions are indexed by ingredient ID, so we don't need to search through (and thus, because
+               // they are loaded lazily, create) all of them.
                QList<std::shared_ptr<typename NE::RecipeAdditionClass>> recipeAdditions =
-                  ObjectStoreWrapper::findAllMatching<typename NE::RecipeAdditionClass>(
-                     [lastItemKey](std::shared_ptr<typename NE::RecipeAdditionClass> ra) {
-                        return ra->ingredientId() == lastItemKey;
-                     }
+                  ObjectStoreWrapper::findByIndex<typename NE::RecipeAdditionClass>(
+                     PropertyNames::IngredientAmount::ingredientId, lastItemKey
                   );
                qInfo() <<
                   Q_FUNC_INFO << "Replacing" << recipeAdditions.size() << "uses of" << lastItem << "with" << firstItem;
@@ -723,10 +723,8 @@ public:
                // field we care about.
                //
                QList<std::shared_ptr<typename NE::StockPurchaseClass>> inventoryEntries =
-                  ObjectStoreWrapper::findAllMatching<typename NE::StockPurchaseClass>(
-                     [lastItemKey](std::shared_ptr<typename NE::StockPurchaseClass> inv) {
-                        return inv->ingredientId() == lastItemKey;
-                     }
+                  ObjectStoreWrapper::findByIndex<typename NE::StockPurchaseClass>(
+                     PropertyNames::IngredientAmount::ingredientId, lastItemKey
                   );
                qInfo() <<
                   Q_FUNC_INFO << "Assigning" << inventoryEntries.size() << "inventory entries for" << lastItem << "to" <<